@@ -31,6 +31,19 @@ UserAmplitude< BreitWigner >( args )
   
   // make sure the input variables look reasonable
   assert( ( m_orbitL >= 0 ) && ( m_orbitL <= 4 ) );
+
+  // each digit in the daughter strings is one particle index
+  for( unsigned int i = 0; i < m_daughters.first.size(); ++i ){
+    
+    string num; num += m_daughters.first[i];
+    m_daughter1.push_back( atoi(num.c_str()) );
+  }
+  
+  for( unsigned int i = 0; i < m_daughters.second.size(); ++i ){
+    
+    string num; num += m_daughters.second[i];
+    m_daughter2.push_back( atoi(num.c_str()) );
+  }
 }
 
 complex< GDouble >
@@ -38,20 +51,18 @@ BreitWigner::calcAmplitude( GDouble** pKin ) const
 {
   TLorentzVector P1, P2, Ptot, Ptemp;
   
-  for( unsigned int i = 0; i < m_daughters.first.size(); ++i ){
+  for( unsigned int i = 0; i < m_daughter1.size(); ++i ){
     
-    string num; num += m_daughters.first[i];
-    int index = atoi(num.c_str());
+    int index = m_daughter1[i];
     Ptemp.SetPxPyPzE( pKin[index][1], pKin[index][2],
                       pKin[index][3], pKin[index][0] );
     P1 += Ptemp;
     Ptot += Ptemp;
   }
   
-  for( unsigned int i = 0; i < m_daughters.second.size(); ++i ){
+  for( unsigned int i = 0; i < m_daughter2.size(); ++i ){
     
-    string num; num += m_daughters.second[i];
-    int index = atoi(num.c_str());
+    int index = m_daughter2[i];
     Ptemp.SetPxPyPzE( pKin[index][1], pKin[index][2],
                       pKin[index][3], pKin[index][0] );
     P2 += Ptemp;
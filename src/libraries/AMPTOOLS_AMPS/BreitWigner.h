@@ -54,6 +54,11 @@ private:
   int m_orbitL;
   
   pair< string, string > m_daughters;  
+
+  // indices into the kinematics array of the particles making up
+  // each daughter, decoded from m_daughters in the constructor
+  vector< int > m_daughter1;
+  vector< int > m_daughter2;
 };
 
 #endif
@@ -15,6 +15,9 @@
 #include "AMPTOOLS_AMPS/wignerD.h"
 #include "AMPTOOLS_AMPS/breakupMomentum.h"
 
+// largest isobar spin for which the angular functions are cached per event
+static const int kMaxIsobarJ = 8;
+
 ThreePiAngles::ThreePiAngles( const vector< string >& args ) :
 UserAmplitude< ThreePiAngles >( args )
 {
@@ -53,7 +56,27 @@ UserAmplitude< ThreePiAngles >( args )
   m_iZ.push_back( m_iZ0 );
   m_iZ.push_back( m_iZ1 );
   m_iZ.push_back( m_iZ2 );
-  
+
+  assert( m_jI <= kMaxIsobarJ );
+
+  for( int mL = -m_lX; mL <= m_lX; ++mL ){
+    for( int mI = -m_jI; mI <= m_jI; ++mI ){
+
+      m_cgNeg.push_back( clebschGordan( m_jI, m_lX, mI, mL, m_jX, -1 ) );
+      m_cgPos.push_back( clebschGordan( m_jI, m_lX, mI, mL, m_jX,  1 ) );
+    }
+  }
+
+  for( int iZ0 = -1; iZ0 <= 1; ++iZ0 ){
+    for( int iZ1 = -1; iZ1 <= 1; ++iZ1 ){
+      for( int iZ2 = -1; iZ2 <= 1; ++iZ2 ){
+
+        m_cgIso[iZ0+1][iZ1+1][iZ2+1] =
+          clebschGordan( 1, 1, iZ0, iZ1, m_iI, iZ0 + iZ1 ) *
+          clebschGordan( m_iI, 1, iZ0 + iZ1, iZ2, m_iX, iZ0 + iZ1 + iZ2 );
+      }
+    }
+  }
 }
 
 complex< GDouble >
@@ -123,15 +146,27 @@ ThreePiAngles::calcAmplitude( GDouble** pKin ) const
   // however, we assume a production mechanism that only produces
   // resonance helicities +-1
   
+  // the isobar decay angular distribution does not depend on mL so
+  // evaluate it once for each mI
+  complex< GDouble > yIso[2*kMaxIsobarJ+1];
+  for( int mI = -m_jI; mI <= m_jI; ++mI ){
+
+    yIso[mI+m_jI] = Y( m_jI, mI, cosThetaIso, phiIso );
+  }
+
+  const int nI = 2 * m_jI + 1;
+
   for( int mL = -m_lX; mL <= m_lX; ++mL ){
     
     complex< GDouble > term( 0, 0 );
+
+    const int offset = ( mL + m_lX ) * nI;
     
     for( int mI = -m_jI; mI <= m_jI; ++mI ){
               
-      term += Y( m_jI, mI, cosThetaIso, phiIso ) *
-       ( negResHelProd * clebschGordan( m_jI, m_lX, mI, mL, m_jX, -1 ) +
-         clebschGordan( m_jI, m_lX, mI, mL, m_jX, 1 ) );
+      term += yIso[mI+m_jI] *
+       ( negResHelProd * m_cgNeg[offset+mI+m_jI] +
+         m_cgPos[offset+mI+m_jI] );
     }
     
     term *= Y( m_lX, mL, cosThetaRes, phiRes );
@@ -140,8 +175,7 @@ ThreePiAngles::calcAmplitude( GDouble** pKin ) const
 
   ans *= ( m_polBeam == 0 ? ( 1 + m_polFrac ) / 4 : ( 1 - m_polFrac ) / 4 );
 
-  ans *= clebschGordan( 1, 1, iZ0, iZ1, m_iI, iZ0 + iZ1 )    *
-         clebschGordan( m_iI, 1, iZ0 + iZ1, iZ2, m_iX, iZ0 + iZ1 + iZ2 ) *
+  ans *= m_cgIso[iZ0+1][iZ1+1][iZ2+1] *
          pow( k, m_lX ) * pow( q, m_jI );
     
   return ans;
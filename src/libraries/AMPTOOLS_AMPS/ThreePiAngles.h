@@ -58,6 +58,14 @@ private:
   int m_iZ2;
 
   vector< int > m_iZ;
+
+  // Clebsch-Gordan coefficients that depend only on the quantum numbers
+  // of the amplitude, computed once in the constructor:
+  // m_cgPos/m_cgNeg indexed [(mL+lX)*(2*jI+1)+(mI+jI)] for resonance
+  // helicity +1/-1 and m_cgIso indexed [iZ0+1][iZ1+1][iZ2+1]
+  vector< GDouble > m_cgPos;
+  vector< GDouble > m_cgNeg;
+  GDouble m_cgIso[3][3][3];
     
 };
 
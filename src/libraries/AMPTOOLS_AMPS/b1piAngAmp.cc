@@ -97,6 +97,14 @@ b1piAngAmp::b1piAngAmp( const vector< string >& args ):
   mIz[3]=Iz_b1;
   mIz[5]=-1;
   mIz[6]=+1;
+
+  // coupling coefficients that depend only on the quantum numbers
+  // of the amplitude
+  for(int l_b1=-1; l_b1<=1; l_b1++)
+    m_CB_X[l_b1+1]=CB(mL_X, 1, 0, l_b1, mJ_X, l_b1);
+  for(int iz_b1=-1; iz_b1<=1; iz_b1++)
+    for(int iz_pi=-1; iz_pi<=1; iz_pi++)
+      m_CB_I[iz_b1+1][iz_pi+1]=CB(1, 1, iz_b1, iz_pi, mI_X, iz_b1 + iz_pi);
 }
 
 void PrintHEPvector(TLorentzVector &v){
@@ -393,6 +401,93 @@ b1piAngAmp::calcAmplitude( GDouble** pKin ) const
 
   if(mJ_X==0) if(mPar_X*pol*(*epsilon_R) ==  -1 ) return CZero;
 
+  // The b1 decay amplitude for each l_b1 (summed over L_b1 and the
+  // omega and rho decays) does not depend on the photon or resonance
+  // helicities, so evaluate it once here rather than inside the
+  // helicity sums below.  Likewise the omega decay amplitude for
+  // each l_omega does not depend on L_b1 or l_b1.
+  complex <GDouble> L_omegaDepTerms[3];
+  for(vector<int>::iterator l_omega=List_l_omega.begin(); 
+      l_omega != List_l_omega.end() ; l_omega++){
+
+    complex <GDouble> L_omegaDepTerm(0,0);
+    //only odd L_omega allowed to given off J_rho to honor P_omega=-1
+    for(vector<int>::iterator L_omega=List_L_omega.begin(); 
+	L_omega != List_L_omega.end() ; L_omega++){
+
+      complex <GDouble> J_rhoDepTerm(0,0);
+      for(vector<int>::iterator J_rho=List_J_rho.begin(); 
+	  J_rho != List_J_rho.end() ; J_rho++){
+
+	//enforces triang. ineq. betw. J_omega=1, J_rho and L_omega
+	if( abs(*J_rho-*L_omega) > 1) continue; 
+	
+	complex <GDouble> l_rhoDepTerm(0,0);
+	for(vector<int>::iterator l_rho = List_l_rho.begin(); 
+	    l_rho != List_l_rho.end() ; l_rho++){
+	  //shortcut CB(1,1,0,0;1,0)=0
+	  if(*L_omega==1 && *J_rho==1 && *l_rho==0) continue;
+	  l_rhoDepTerm+= conj(wignerD(1, *l_omega, *l_rho,
+				      rho_omegaRF_cosTheta, 
+				      rho_omegaRF_phi))*
+	    CB(*L_omega, *J_rho, 0, *l_rho, 1, *l_rho) *
+	    Y(*J_rho, *l_rho, rhos_pip_rhoRF_cosTheta, rhos_pip_rhoRF_phi);
+	  
+	  IMLnum++;
+	}
+
+	J_rhoDepTerm += u_rho(*J_rho) * l_rhoDepTerm *
+	  BreitWigner(m0_rho,G0_rho, *J_rho,rhos_pip,rhos_pim);
+      }
+      
+      if(!m_disableBW_omega) J_rhoDepTerm*=
+	BreitWigner(m0_omega,mG0_omega, *L_omega, omegas_pi,rho);
+      
+      L_omegaDepTerm += u_omega(*L_omega)*J_rhoDepTerm*N(*L_omega);
+    }
+    L_omegaDepTerms[*l_omega+1]=L_omegaDepTerm;
+  }
+
+  complex <GDouble> BW_b1[2];
+  if(!m_disableBW_b1){
+    for(vector<int>::iterator L_b1=List_L_b1.begin(); 
+	L_b1 != List_L_b1.end() ; L_b1++){
+      BW_b1[*L_b1/2]=BreitWigner(m0_b1, mG0_b1, *L_b1, b1s_pi, omega);
+    }
+  }
+
+  GDouble omega_b1RF_cosTheta=omega_b1RF.CosTheta();
+  GDouble omega_b1RF_phi     =omega_b1RF.Phi();
+
+  complex <GDouble> L_b1DepTerms[3];
+  for(vector<int>::iterator l_b1=List_l_b1.begin(); 
+      l_b1 != List_l_b1.end() ; l_b1++){
+    
+    complex <GDouble> L_b1DepTerm(0,0);
+    for(vector<int>::iterator L_b1=List_L_b1.begin(); 
+	L_b1 != List_L_b1.end() ; L_b1++){
+      
+      complex <GDouble> l_omegaDepTerm(0,0);
+      for(vector<int>::iterator l_omega=List_l_omega.begin(); 
+	  l_omega != List_l_omega.end() ; l_omega++){
+
+	l_omegaDepTerm += 
+	  L_omegaDepTerms[*l_omega+1] *
+	  conj(wignerD(1, *l_b1, *l_omega, omega_b1RF_cosTheta, 
+		       omega_b1RF_phi)) *
+	  CB(*L_b1, 1, 0, *l_omega, 1, *l_omega);
+      }
+      
+      if(!m_disableBW_b1) l_omegaDepTerm*=BW_b1[*L_b1/2];
+      
+      L_b1DepTerm += u_b1(*L_b1)*l_omegaDepTerm * N(*L_b1);
+    }
+    L_b1DepTerms[*l_b1+1]=L_b1DepTerm;
+  }
+
+  GDouble ang_b1_cosTheta=ang_b1.CosTheta();
+  GDouble ang_b1_phi     =ang_b1.Phi();
+
   complex <GDouble> expFact(cos(alpha), sin(alpha));
   complex <GDouble> expFact_conj(conj(expFact));
   //summing positive and negative helicity terms
@@ -420,68 +515,9 @@ b1piAngAmp::calcAmplitude( GDouble** pKin ) const
 	  for(vector<int>::iterator l_b1=List_l_b1.begin(); 
 	      l_b1 != List_l_b1.end() ; l_b1++){
 	    
-	    complex <GDouble> L_b1DepTerm(0,0);
-	    for(vector<int>::iterator L_b1=List_L_b1.begin(); 
-		L_b1 != List_L_b1.end() ; L_b1++){
-	      
-	      complex <GDouble> l_omegaDepTerm(0,0);
-	      for(vector<int>::iterator l_omega=List_l_omega.begin(); 
-		  l_omega != List_l_omega.end() ; l_omega++){
-
-		complex <GDouble> L_omegaDepTerm(0,0);
-		//only odd L_omega allowed to given off J_rho to honor P_omega=-1
-		for(vector<int>::iterator L_omega=List_L_omega.begin(); 
-		    L_omega != List_L_omega.end() ; L_omega++){
-
-		  complex <GDouble> J_rhoDepTerm(0,0);
-		  for(vector<int>::iterator J_rho=List_J_rho.begin(); 
-		      J_rho != List_J_rho.end() ; J_rho++){
-
-		    //enforces triang. ineq. betw. J_omega=1, J_rho and L_omega
-		    if( abs(*J_rho-*L_omega) > 1) continue; 
-		    
-		    complex <GDouble> l_rhoDepTerm(0,0);
-		    for(vector<int>::iterator l_rho = List_l_rho.begin(); 
-			l_rho != List_l_rho.end() ; l_rho++){
-		      //shortcut CB(1,1,0,0;1,0)=0
-		      if(*L_omega==1 && *J_rho==1 && *l_rho==0) continue;
-		      l_rhoDepTerm+= conj(wignerD(1, *l_omega, *l_rho,
-						  rho_omegaRF_cosTheta, 
-						  rho_omegaRF_phi))*
-			CB(*L_omega, *J_rho, 0, *l_rho, 1, *l_rho) *
-			Y(*J_rho, *l_rho, rhos_pip_rhoRF_cosTheta, rhos_pip_rhoRF_phi);
-		      
-		      IMLnum++;
-		    }
-
-		    J_rhoDepTerm += u_rho(*J_rho) * l_rhoDepTerm *
-		      BreitWigner(m0_rho,G0_rho, *J_rho,rhos_pip,rhos_pim);
-		  }
-		  
-		  if(!m_disableBW_omega) J_rhoDepTerm*=
-		    BreitWigner(m0_omega,mG0_omega, *L_omega, omegas_pi,rho);
-		  
-		  L_omegaDepTerm += u_omega(*L_omega)*J_rhoDepTerm*N(*L_omega);
-		}
-		
-		l_omegaDepTerm += 
-		  L_omegaDepTerm *
-		  conj(wignerD(1, *l_b1, *l_omega, omega_b1RF.CosTheta(), 
-			       omega_b1RF.Phi())) *
-		  CB(*L_b1, 1, 0, *l_omega, 1, *l_omega);
-	      }
-	      
-	      if(!m_disableBW_b1) l_omegaDepTerm*=
-		BreitWigner(m0_b1, mG0_b1, *L_b1, b1s_pi, omega);
-	      
-	      L_b1DepTerm += u_b1(*L_b1)*l_omegaDepTerm * N(*L_b1);
-	    }
-	    
 	    l_b1DepTerm += 
-	      L_b1DepTerm * CB(mL_X, 1, 0, *l_b1, mJ_X, *l_b1)*
-	      conj(wignerD(mJ_X, m_X, *l_b1, ang_b1.CosTheta(), ang_b1.Phi()));
-	    
-	    
+	      L_b1DepTerms[*l_b1+1] * m_CB_X[*l_b1+1]*
+	      conj(wignerD(mJ_X, m_X, *l_b1, ang_b1_cosTheta, ang_b1_phi));
 	  }
 	  
 	  ThelSum += 
@@ -512,7 +548,7 @@ b1piAngAmp::calcAmplitude( GDouble** pKin ) const
     // to apply polarization fraction weights: 
     (GDouble)sqrt((1.0-pol*mpolFrac)*0.5) * //(1+g) for x-pol, (1-g) for y-pol   
     (pol==1 ? i : COne)*InvSqrt2 * //to account for |eps_g> ~ sqrt(-eps/2)
-    CB(1, 1, Iz_b1, Iz_pi, mI_X, Iz_b1 + Iz_pi);
+    m_CB_I[Iz_b1+1][Iz_pi+1];
 
 
   if(m_ORTHOCHECK) {
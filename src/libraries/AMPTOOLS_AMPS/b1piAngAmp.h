@@ -71,6 +71,12 @@ private:
 
   vector< int > mIz;
 
+  // CB(L_X, 1, 0, l_b1; J_X, l_b1) indexed by l_b1+1 and the isospin
+  // coefficient CB(1, 1, Iz_b1, Iz_pi; I_X, Iz_b1+Iz_pi) indexed by
+  // [Iz_b1+1][Iz_pi+1], filled in the constructor
+  GDouble m_CB_X[3];
+  GDouble m_CB_I[3][3];
+
 #ifdef GPU_ACCELERATION
   
   void launchGPUKernel( dim3 dimGrid, dim3 dimBlock, GPU_AMP_PROTO ) const;
@@ -36,6 +36,22 @@
 #define S3J_MIN(a,b,c,ris)	(((a)<(b)?(ris=(a)):(ris=(b)))<(c)?ris:(ris=(c)))
 
 
+/* Factorials 0! ... (S3J_MAX_FACT-1)!, filled once when the library is
+** loaded rather than on every call to s3j. */
+static double s3j_fact[S3J_MAX_FACT];
+
+static struct s3j_fact_init {
+	s3j_fact_init() {
+		double mult=1.0;
+		s3j_fact[0]=1.0;
+		for (int k=1; k<S3J_MAX_FACT; ++k) {
+			s3j_fact[k]=s3j_fact[k-1]*mult;
+			mult+=1.0;
+		}
+	}
+} s3j_fact_init_instance;
+
+
 double s3j(double j1, double j2, double j3, 
 		   double m1, double m2, double m3) {
 	
@@ -99,15 +115,8 @@ double s3j(double j1, double j2, double j3,
 	int k, kmin, kmax;
 	int jpm1, jmm1, jpm2, jmm2, jpm3, jmm3;
 	int j1pj2mj3, j3mj2pm1, j3mj1mm2;
-	double ris, mult, f[S3J_MAX_FACT];
-	
-	f[0]=1.0;
-	mult=1.0;
-	for (k=1; k<S3J_MAX_FACT; ++k) {
-		
-		f[k]=f[k-1]*mult;
-		mult+=1.0;
-	}
+	double ris, mult;
+	const double *f=s3j_fact;
 	
 	jpm1=(int)(j1+m1);
 	if (!S3J_EQUAL(jpm1,j1+m1)) return 0.0;
@@ -18,7 +18,8 @@ wignerDSmall( GDouble aj, GDouble am, GDouble an, GDouble beta ){
   
 	double f = 8.72664625997164788e-3;    
   
-  double fcl[51] = { 0 , 0 ,
+  // log(n!) for n = 0 ... 50
+  static const double fcl[51] = { 0 , 0 ,
 		6.93147180559945309e-1 ,1.79175946922805500e00,
 		3.17805383034794562e00 ,4.78749174278204599e00,
 		6.57925121201010100e00 ,8.52516136106541430e00,
@@ -0,0 +1,116 @@
+#if !defined(BATCHGENERATOR)
+#define BATCHGENERATOR
+
+/*
+ *  BatchGenerator.h
+ *
+ *  Runs one of the event generators in this directory (GammaPToXYP,
+ *  GammaPToXYZP, GammaPToNPartP, ...) on a separate thread so that the
+ *  next batch of four-vectors is produced while the caller computes
+ *  intensities and does accept/reject on the current one.
+ *
+ *  The generators use drand48() and gRandom internally.  While a batch
+ *  is being generated the caller must not use either of them;  use a
+ *  separate erand48() stream for anything done on the calling thread.
+ *  Since batches are generated one after another in a fixed order the
+ *  output is the same as generating them all on one thread.
+ *
+ *  There is only ONE generator thread:  generation overlaps with the
+ *  caller's intensity calculation but is not itself split over several
+ *  threads.  That would need an independent random number stream in
+ *  each of the generator classes in place of the global drand48() and
+ *  gRandom, and the intensities are still calculated by the caller's
+ *  single AmpToolsInterface.
+ *
+ */
+
+#include <vector>
+#include <pthread.h>
+
+#include "IUAmpTools/Kinematics.h"
+
+using namespace std;
+
+template< class Generator >
+class BatchGenerator {
+
+public:
+
+  // starts generating the first batch right away
+  BatchGenerator( Generator& generator, int batchSize ) :
+  m_generator( generator ),
+  m_batchSize( batchSize ),
+  m_running( false ) {
+
+    start();
+  }
+
+  ~BatchGenerator(){
+
+    wait();
+    clear( m_batch );
+  }
+
+  // Waits for the batch being generated, hands it to the caller (who
+  // must delete the Kinematics objects) and, if generateNext is true,
+  // starts on the following batch.  If the previous call did not start
+  // one, the batch is generated now.
+  void nextBatch( vector< Kinematics* >& batch, bool generateNext = true ){
+
+    if( !m_running && m_batch.empty() ) start();
+    wait();
+
+    clear( batch );
+    batch.swap( m_batch );
+
+    if( generateNext ) start();
+  }
+
+private:
+
+  BatchGenerator( const BatchGenerator& );
+  BatchGenerator& operator=( const BatchGenerator& );
+
+  void start(){
+
+    m_running = ( pthread_create( &m_thread, NULL, generateBatch, this ) == 0 );
+
+    // fall back to generating on this thread
+    if( !m_running ) generateBatch( this );
+  }
+
+  void wait(){
+
+    if( m_running ) pthread_join( m_thread, NULL );
+    m_running = false;
+  }
+
+  static void clear( vector< Kinematics* >& batch ){
+
+    for( unsigned int i = 0; i < batch.size(); ++i ) delete batch[i];
+    batch.clear();
+  }
+
+  static void* generateBatch( void* arg ){
+
+    BatchGenerator* self = static_cast< BatchGenerator* >( arg );
+
+    self->m_batch.reserve( self->m_batchSize );
+    for( int i = 0; i < self->m_batchSize; ++i ){
+
+      self->m_batch.push_back( self->m_generator.generate() );
+    }
+
+    return NULL;
+  }
+
+  Generator& m_generator;
+  int m_batchSize;
+
+  vector< Kinematics* > m_batch;
+
+  pthread_t m_thread;
+  bool m_running;
+};
+
+#endif
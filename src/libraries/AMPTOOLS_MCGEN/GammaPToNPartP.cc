@@ -16,11 +16,13 @@
 GammaPToNPartP::GammaPToNPartP( float lowMass, float highMass, 
 				vector<double> &ChildMass,
 				ProductionMechanism::Type type, 
-				float tcoef, float Ebeam) : 
+				float tcoef, float Ebeam,
+				NBodyPhaseSpaceFactory::Algorithm psAlgorithm) : 
   m_prodMech( ProductionMechanism::kProton, type, tcoef ), // last arg is t dependence
   m_beam( 0, 0, Ebeam, Ebeam ),
   m_target( 0, 0, 0, ParticleMass(Proton) ),
-  m_ChildMass(ChildMass)
+  m_ChildMass(ChildMass),
+  m_psAlgorithm(psAlgorithm)
 {
   assert(Ebeam>0);
   
@@ -60,7 +62,7 @@ GammaPToNPartP::generate(){
   genWeight *= Xdecay.Generate();
   */
 
-  NBodyPhaseSpaceFactory psFactory(resonance.M(),m_ChildMass);
+  NBodyPhaseSpaceFactory psFactory(resonance.M(),m_ChildMass,m_psAlgorithm);
   vector< TLorentzVector > children = psFactory.generateDecay(false);
   genWeight *= psFactory.getLastGeneratedWeight();
 
@@ -11,6 +11,7 @@
 #include "TLorentzVector.h"
 
 #include "AMPTOOLS_MCGEN/ProductionMechanism.h"
+#include "AMPTOOLS_MCGEN/NBodyPhaseSpaceFactory.h"
 
 class Kinematics;
 class AmpVecs;
@@ -22,7 +23,9 @@ public:
   GammaPToNPartP( float lowMass, float highMass, 
 		  vector<double> &ChildMass,
 		  ProductionMechanism::Type type,
-		  float tcoef=4.0, float Ebeam=9.0/*GeV*/);
+		  float tcoef=4.0, float Ebeam=9.0/*GeV*/,
+		  NBodyPhaseSpaceFactory::Algorithm psAlgorithm=
+		  NBodyPhaseSpaceFactory::kRauboldLynch);
   
   Kinematics* generate();
   
@@ -38,6 +41,7 @@ private:
   //double m_ChildMass[12];
   vector<double> m_ChildMass;
   unsigned int m_Npart;
+  NBodyPhaseSpaceFactory::Algorithm m_psAlgorithm;
 
 };
 
@@ -12,6 +12,7 @@
 #include <cassert>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 
 #include "TLorentzVector.h"
 #include "TLorentzRotation.h"
@@ -21,9 +22,14 @@
 
 const double NBodyPhaseSpaceFactory::kPi = 3.14159;
 
-NBodyPhaseSpaceFactory::NBodyPhaseSpaceFactory( double parentMass, const vector<double>& childMass ) :
+NBodyPhaseSpaceFactory::NBodyPhaseSpaceFactory( double parentMass, const vector<double>& childMass,
+                                                Algorithm algorithm ) :
   m_parentMass( parentMass ),
-  m_childMass( childMass )
+  m_childMass( childMass ),
+  m_lastWt( 1.0 ),
+  m_algorithm( algorithm ),
+  m_nTrials( 0 ),
+  m_nAccepted( 0 )
 {
   m_Nd = (int)childMass.size();
 }
@@ -31,6 +37,7 @@ NBodyPhaseSpaceFactory::NBodyPhaseSpaceFactory( double parentMass, const vector<
 vector<TLorentzVector>
 NBodyPhaseSpaceFactory::generateDecay(bool uniformWeights) {
 	
+  if( m_algorithm == kRambo && m_Nd > 2 ) return generateRambo( uniformWeights );
 
   vector<TLorentzVector> child( m_Nd );
 
@@ -55,6 +62,7 @@ NBodyPhaseSpaceFactory::generateDecay(bool uniformWeights) {
   int irnd[m_Nd];
   rnd[0] = 0.0; rnd[m_Nd-1] = 1.0;
   do{
+    if(uniformWeights) m_nTrials++;  // weighted events are not tried
     switch( m_Nd ){
     default:
       for( n=1; n<m_Nd-1; n++){ rnd[n] = random( 0., 1. ); }
@@ -81,6 +89,7 @@ NBodyPhaseSpaceFactory::generateDecay(bool uniformWeights) {
       wt *= pd[n];
     }
   }while( uniformWeights && (random(0.0,WtMax) > wt) );
+  if(uniformWeights) m_nAccepted++;
 
   if(uniformWeights) m_lastWt = 1.0;
   else               m_lastWt = wt;
@@ -108,6 +117,111 @@ NBodyPhaseSpaceFactory::generateDecay(bool uniformWeights) {
   return child;
 }
 
+/*
+  Massive RAMBO: generate m_Nd massless momenta with a flat phase-space
+  weight, then scale them to the daughter masses.  The mass scaling
+  introduces a weight wtm <= 1 which is used for accept/reject.
+
+  For uniformWeights=false the weight returned matches the Raubold-Lynch
+  one above on average at every parent mass:  both are the phase-space
+  volume divided by the same parent-mass dependent constant, so weighted
+  samples from the two algorithms can be mixed or compared directly.
+*/
+vector<TLorentzVector>
+NBodyPhaseSpaceFactory::generateRambo(bool uniformWeights) {
+
+  vector<TLorentzVector> child( m_Nd );
+
+  double Tcm = m_parentMass;
+  int n;
+  for( n=0; n<m_Nd; n++ ){ Tcm -= m_childMass[n]; }
+  assert( Tcm > 0. );
+
+  double q[m_Nd][4];
+  double p[m_Nd][4];
+  double wtm;
+  do{
+    if(uniformWeights) m_nTrials++;  // weighted events are not tried
+
+    // massless momenta with isotropic directions and energies
+    // distributed as E exp(-E)
+    double Q[4] = { 0, 0, 0, 0 };
+    for (n=0; n<m_Nd; n++) {
+      double c = random( -1., 1. );
+      double s = sqrt( 1. - c*c );
+      double f = random( 0., 2.*TMath::Pi() );
+      q[n][0] = -log( ( 1. - random( 0., 1. ) ) * ( 1. - random( 0., 1. ) ) );
+      q[n][1] = q[n][0]*s*cos(f);
+      q[n][2] = q[n][0]*s*sin(f);
+      q[n][3] = q[n][0]*c;
+      for (int k=0; k<4; k++) Q[k] += q[n][k];
+    }
+
+    // boost and scale them to the parent rest frame and mass
+    double Mq = sqrt( Q[0]*Q[0] - Q[1]*Q[1] - Q[2]*Q[2] - Q[3]*Q[3] );
+    double b[3] = { -Q[1]/Mq, -Q[2]/Mq, -Q[3]/Mq };
+    double x = m_parentMass/Mq;
+    double g = Q[0]/Mq;
+    double a = 1./(1.+g);
+    for (n=0; n<m_Nd; n++) {
+      double bq = b[0]*q[n][1] + b[1]*q[n][2] + b[2]*q[n][3];
+      p[n][0] = x*( g*q[n][0] + bq );
+      for (int k=1; k<4; k++) p[n][k] = x*( q[n][k] + b[k-1]*( q[n][0] + a*bq ) );
+    }
+
+    // find the common scale factor xi for the momenta that gives
+    // the daughters their masses while conserving energy
+    double xi = sqrt( 1. - ( (m_parentMass-Tcm)/m_parentMass )*( (m_parentMass-Tcm)/m_parentMass ) );
+    for( int iter=0; iter<50; iter++ ){
+      double f0 = -m_parentMass, f1 = 0;
+      for (n=0; n<m_Nd; n++) {
+        double e = sqrt( m_childMass[n]*m_childMass[n] + xi*xi*p[n][0]*p[n][0] );
+        f0 += e;
+        f1 += xi*p[n][0]*p[n][0]/e;
+      }
+      double dxi = f0/f1;
+      xi -= dxi;
+      if( fabs( dxi ) < 1e-14*xi ) break;
+    }
+
+    double sumk = 0, sumk2e = 0, prodke = 1;
+    for (n=0; n<m_Nd; n++) {
+      double k = xi*p[n][0];
+      double e = sqrt( m_childMass[n]*m_childMass[n] + k*k );
+      child[n].SetPxPyPzE( xi*p[n][1], xi*p[n][2], xi*p[n][3], e );
+      sumk   += k;
+      sumk2e += k*k/e;
+      prodke *= k/e;
+    }
+    wtm = pow( sumk/m_parentMass, 2*m_Nd-3 ) * prodke * m_parentMass/sumk2e;
+
+  }while( uniformWeights && (random(0.0,1.0) > wtm) );
+  if(uniformWeights) m_nAccepted++;
+
+  if(uniformWeights){
+    m_lastWt = 1.0;
+  }
+  else{
+    // convert to the Raubold-Lynch normalization:  multiply by the
+    // massless phase-space volume (pi/2)^(N-1) M^(2N-4) / ((N-1)!(N-2)!)
+    // and divide by the Raubold-Lynch factor pi^(N-1) 2^(N-2) Tcm^(N-2) /
+    // ((N-2)! M) and its maximum weight wtRL
+    double emmax = Tcm + m_childMass[0];
+    double emmin = 0;
+    double wtRL = 1;
+    for (n=1; n<m_Nd; n++) {
+      emmin += m_childMass[n-1];
+      emmax += m_childMass[n];
+      wtRL *= pdk(emmax, emmin, m_childMass[n]);
+    }
+    double norm = pow( m_parentMass/2., 2*m_Nd-3 ) / pow( Tcm, m_Nd-2 ) / wtRL;
+    for (n=2; n<m_Nd; n++) norm /= n;
+    m_lastWt = wtm*norm;
+  }
+
+  return child;
+}
+
 double
 NBodyPhaseSpaceFactory::pdk( double a, double b, double c ) const {
 	
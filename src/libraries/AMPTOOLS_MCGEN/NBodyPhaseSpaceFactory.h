@@ -12,7 +12,23 @@ class NBodyPhaseSpaceFactory
 	
  public:
 	
-  NBodyPhaseSpaceFactory( double parentMass, const vector<double>& childMass );
+  /**
+   * Algorithms for generating the decay:
+   *  kRauboldLynch - sequential two-body decays with the intermediate
+   *                  masses sampled uniformly (the default)
+   *  kRambo        - RAMBO for massive particles (R.Kleiss, W.J.Stirling,
+   *                  S.D.Ellis, Comput.Phys.Commun. 40 (1986) 359).  The
+   *                  weights stay close to one for light daughters far
+   *                  from threshold, so accept/reject is much more
+   *                  efficient for high-multiplicity final states.
+   *
+   * Both produce the same phase-space distribution and, with
+   * uniformWeights=false, weights with the same normalization.
+   */
+  enum Algorithm { kRauboldLynch, kRambo };
+
+  NBodyPhaseSpaceFactory( double parentMass, const vector<double>& childMass,
+                          Algorithm algorithm = kRauboldLynch );
 
 
   /**
@@ -33,10 +49,19 @@ class NBodyPhaseSpaceFactory
    */
   double getLastGeneratedWeight() const {return m_lastWt;};
 
+  /**
+   * Fraction of trial events accepted by the accept/reject step in all
+   * calls to generateDecay(true) so far
+   */
+  double getEfficiency() const
+  {return m_nTrials > 0 ? (double)m_nAccepted/m_nTrials : 1.0;};
+
  private:
         
   static const double kPi;
 	
+  vector<TLorentzVector> generateRambo(bool uniformWeights);
+
   double pdk( double a, double b, double c ) const;
   double random( double low, double hi ) const;
 	
@@ -44,6 +69,9 @@ class NBodyPhaseSpaceFactory
   vector<double> m_childMass;    // vector of daughter masses
   int m_Nd;                      // number of decay products
   double m_lastWt;
+  Algorithm m_algorithm;
+  long m_nTrials;                // events tried in accept/reject
+  long m_nAccepted;              // events accepted
 
 };
 
@@ -8,6 +8,7 @@
 #include <cassert>
 #include <math.h>
 #include <map>
+#include <algorithm>
 
 #include "BCAL/DBCALHit.h"
 #include "BCAL/DBCALTDCHit.h"
@@ -83,6 +84,12 @@ jerror_t DBCALShower_factory_KLOE::init()
     m_nonlinZ_p2 = 0;
     m_nonlinZ_p3 = 0;
   }
+
+  // Nothing is hit yet (see CellRecon)
+  for (int i = 0; i < cellmax_bcal; i++){
+    cell_first_point[i] = -1;
+    cell_to_cel[i] = 0;
+  }
   
   return NOERROR;
 }
@@ -172,6 +179,145 @@ jerror_t DBCALShower_factory_KLOE::brun(JEventLoop *loop, int runnumber)
     // Now the cell information are already contained in xx and yy arrays.
     // xx and yy arrays are private members of this class
     ////////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////
+    // Cell adjacency for PreCluster()
+    //////////////////////////////////////////////////////////////////
+
+    // Which cells count as neighbors depends only on the geometry, so
+    // rather than testing every pair of hit cells in every event the
+    // neighbors of each cell are listed here once. The test is the one
+    // PreCluster() used to apply to each pair of hits.
+
+    int k=1;     // NUMBER OF NEARBY ROWS &/OR TO LOOK FOR MAX E CELL
+
+    //these values make sense as actually minima/maxima if it is implied that rowmin1=1,colmin1=1,colmin2=1
+    int   rowmax_1= bcalGeom.NBCALLAYSIN;
+    int   rowmin_2= rowmax_1+1;
+    int   rowmax_2= bcalGeom.NBCALLAYSOUT+rowmin_2-1;
+    int   colmax_1=bcalGeom.NBCALSECSIN;
+    int   colmax_2=bcalGeom.NBCALSECSOUT;
+
+    float r_middle= bcalGeom.BCALMIDRAD;
+
+    //radial size of the outermost inner layer
+    float thick_inner=bcalGeom.rSize(bcalGeom.cellId(1,bcalGeom.NBCALLAYSIN,1));
+    //radial size of the innermost outer layer
+    float thick_outer=bcalGeom.rSize(bcalGeom.cellId(1,bcalGeom.NBCALLAYSIN+1,1));
+
+    // this is the radial distance between the center of the innermost outer layer and the outermost inner layer
+    float dis_in_out=bcalGeom.r(bcalGeom.cellId(1,bcalGeom.NBCALLAYSIN+1,1))-bcalGeom.r(bcalGeom.cellId(1,bcalGeom.NBCALLAYSIN,1));
+
+    float degree_permodule=360.0/(modmax-modmin);
+    float half_degree_permodule=degree_permodule/2.0;
+
+    //roughly the width of a single cell in the outermost inner layer
+    float width_1=2.0*(r_middle-thick_inner/2.0)*
+      sin(half_degree_permodule*3.141593/180)/colmax_1;
+    //roughly the width of a single cell in the innermost outer layer
+    float width_2=2.0*(r_middle+thick_outer/2.0)*
+      sin(half_degree_permodule*3.141593/180)/colmax_2;
+
+    //disthres is roughly the azimuthal distance between the center of an outer cell and the center of the most distant inner cell bordering an adjacent outer cell (a picture would be nice wouldn't it)
+    //this value is used for determining if two cells that straddle the boundary between inner and outer layers should be considered as neighboring
+    float disthres=width_2*1.5-width_1*0.5+0.0001;
+
+    // cells that exist (module, layer and column counting from 1)
+    vector<int> mods, lyrs, cols;
+    for (int k1 = 1; k1 <= modmax; k1++){
+        for (int i1 = 1; i1 <= rowmax_2; i1++){
+            int ncol = (i1 <= rowmax_1) ? colmax_1 : colmax_2;
+            for (int j1 = 1; j1 <= ncol; j1++){
+                mods.push_back(k1);
+                lyrs.push_back(i1);
+                cols.push_back(j1);
+            }
+        }
+    }
+
+    neighbor_begin.assign(cellmax_bcal+1, 0);
+    neighbor_list.clear();
+    vector<int> first(cellmax_bcal, -1); // where each cell's neighbors start
+    vector<int> count(cellmax_bcal, 0);
+    vector<int> pairs;
+    for (unsigned int a = 0; a < mods.size(); a++){
+        int k1 = mods[a];
+        int i1 = lyrs[a];
+        int j1 = cols[a];
+        int ca = CellIndex(k1, i1, j1);
+        for (unsigned int b = 0; b < mods.size(); b++){
+            if (b == a) continue;
+            int k2 = mods[b];
+            int i2 = lyrs[b];
+            int j2 = cols[b];
+
+            int  modiff = k1-k2;
+            int amodif = abs(modiff);
+
+            //  the following if is to check module and row distance.
+            if ( !((abs(i1-i2)<=k) & ((amodif<=1) || (amodif==47))) ) continue;
+
+            bool neighbor = false;
+            if(amodif==0) {   // same module
+              //   further check col distance if both are inner layers
+              if ( (i1<=rowmax_1) & (i2<=rowmax_1) & (abs(j2-j1)<=k) ) neighbor = true;
+
+              //   further check col distance if both are outer layers
+              if ( (i1>=rowmin_2) & (i2>=rowmin_2) & (abs(j2-j1)<=k) ) neighbor = true;
+            }
+
+            if(amodif>0) {  // different module
+              if( (modiff==1) || (modiff==-47) ) {
+                if ( (i1<=rowmax_1) & (i2<=rowmax_1) ){
+                  if(abs((j1+colmax_1)-j2)<=k) neighbor = true;
+                }
+                if ( (i1>=rowmin_2) & (i2>=rowmin_2) ) {
+                  if(abs((j1+colmax_2)-j2)<=k) neighbor = true;
+                }
+              }
+
+              if ( (modiff==-1) || (modiff==47) ) {
+                if ( (i1<=rowmax_1) & (i2<=rowmax_1) ){
+                  if(abs((j2+colmax_1)-j1)<=k) neighbor = true;
+                }
+                if ( (i1>=rowmin_2) & (i2>=rowmin_2) ){
+                  if(abs((j2+colmax_2)-j1)<=k) neighbor = true;
+                }
+              }
+            }
+
+            // further check col distance if one is inner layer, another is outer
+            // so that the two may be between the boundary of two different size
+            // of cells.
+            if( ( (i1 == rowmax_1) & (i2 == rowmin_2) ) ||
+                ( (i1 == rowmin_2) & (i2 == rowmax_1) ) ) {
+
+              float delta_xx=xx[k1-1][i1-1][j1-1]-xx[k2-1][i2-1][j2-1];
+              float delta_yy=yy[k1-1][i1-1][j1-1]-yy[k2-1][i2-1][j2-1];
+
+              //distance between centers of two cells
+              float dis = sqrt( delta_xx * delta_xx + delta_yy * delta_yy );
+              //dis_in_out is the distance in radial direction, so we now isolate distance in direction perpendicular to radius
+              dis = sqrt( dis*dis - dis_in_out * dis_in_out );
+              //disthres is described above
+              if( dis < disthres ) neighbor = true;
+            }
+
+            if (neighbor){
+              pairs.push_back(ca);
+              pairs.push_back(CellIndex(k2, i2, j2));
+              count[ca]++;
+            }
+        }
+    }
+    for (int c = 0; c < cellmax_bcal; c++){
+        neighbor_begin[c+1] = neighbor_begin[c] + count[c];
+        first[c] = neighbor_begin[c];
+    }
+    neighbor_list.resize(neighbor_begin[cellmax_bcal]);
+    for (unsigned int p = 0; p < pairs.size(); p += 2){
+        neighbor_list[first[pairs[p]]++] = pairs[p+1];
+    }
     
 	 return NOERROR;
 }
@@ -347,23 +493,18 @@ void DBCALShower_factory_KLOE::FindPointsInShower(int indx, JEventLoop *loop, ve
 	// that is a DBCALHit to be added.
 
 
-	vector<const DBCALPoint*> points;
-	loop->Get(points);
-	
+	// The points in each cell were listed by CellRecon() so there is
+	// no need to search all of them for each cell.
 	int start_indx = indx;
 	do{
 		int module = narr[1][indx];
 		int layer  = narr[2][indx];
 		int sector = narr[3][indx];
 		
-		// Loop over BCAL hits, trying to find this one
-		for(unsigned int i=0; i<points.size(); i++){
-			if(points[i]->module() !=module)continue;
-			if(points[i]->layer()  !=layer)continue;
-			if(points[i]->sector() !=sector)continue;
-			pointsInShower.push_back(points[i]);
+		int c = CellIndex(module, layer, sector);
+		for(int i=cell_first_point[c]; i>=0; i=point_next[i]){
+			pointsInShower.push_back(event_points[i]);
 		}
-		
 
 		indx = next[indx];
 	}while(indx != start_indx);
@@ -395,15 +536,19 @@ void DBCALShower_factory_KLOE::CellRecon(JEventLoop *loop)
     //********************************************************************** 
     
     //First reset the arrays ecel_a,tcel_a,ecel_b,tcel_b to clear out garbage
-    //information from the previous events
-    memset( ecel_a, 0, modulemax_bcal * layermax_bcal *
-            colmax_bcal * sizeof( float ) );
-    memset( tcel_a, 0, modulemax_bcal * layermax_bcal *
-            colmax_bcal * sizeof( float ) );
-    memset( ecel_b, 0, modulemax_bcal * layermax_bcal *
-            colmax_bcal * sizeof( float ) );
-    memset( tcel_b, 0, modulemax_bcal * layermax_bcal *
-            colmax_bcal * sizeof( float ) );
+    //information from the previous events. Only the cells hit in the
+    //previous event can hold any, so only those are cleared.
+    float *ea = &ecel_a[0][0][0];
+    float *ta = &tcel_a[0][0][0];
+    float *eb = &ecel_b[0][0][0];
+    float *tb = &tcel_b[0][0][0];
+    for (unsigned int i = 0; i < cells_hit.size(); i++){
+        int c = cells_hit[i];
+        ea[c] = ta[c] = eb[c] = tb[c] = 0.;
+        cell_first_point[c] = -1;
+        cell_to_cel[c] = 0;
+    }
+    cells_hit.clear();
     //the other seven arrays will also be filled with garbage values from
     //previous events, HOWEVER
     //we don't need to zero out these arrays, as long as the ecel_a,tcel_a,ecel_b,tcel_b arrays are zeroed out
@@ -411,17 +556,29 @@ void DBCALShower_factory_KLOE::CellRecon(JEventLoop *loop)
     //and if ecel_a has been to set to a nonzero value for a particular cell
     //then the other arrays will also have been set properly and not full of garbage
     
-    vector<const DBCALPoint*> points;
+    vector<const DBCALPoint*> &points = event_points;
+    points.clear();
     loop->Get(points);
+    point_next.resize(points.size());
     if(points.size() <=0) return;
 
-    for (vector<const DBCALPoint*>::const_iterator point_iter = points.begin();
-         point_iter != points.end();
-         ++point_iter) {
-        const DBCALPoint &point = **point_iter;
+    // Go through the points backwards so that each cell's list of
+    // points ends up in the order the points were delivered. The
+    // arrays must still end up with the values of the last point in
+    // a cell so those are only filled for the first one seen here.
+    for (int ipoint = (int)points.size()-1; ipoint >= 0; ipoint--) {
+        const DBCALPoint &point = *points[ipoint];
         int module = point.module();
         int layer = point.layer();
         int sector = point.sector();
+
+        int c = CellIndex(module, layer, sector);
+        point_next[ipoint] = cell_first_point[c];
+        bool first_seen = (cell_first_point[c] == -1);
+        cell_first_point[c] = ipoint;
+        if (!first_seen) continue;
+        cells_hit.push_back(c);
+
         double r = point.r();
         double phi = point.phi();
         double x = r*cos(phi);
@@ -506,49 +663,55 @@ void DBCALShower_factory_KLOE::CeleToArray(void)
     // as described above.
     
     celtot=0;
+
+    // Only the cells hit need to be looked at. Taking them in order of
+    // CellIndex() is the same as the order of the [k][i][j] loops.
+    sort(cells_hit.begin(), cells_hit.end());
     
-    for (int k = 0; k < modulemax_bcal; k++){
-        for (int i = 0; i < layermax_bcal; i++){
-            for (int j = 0; j < colmax_bcal; j++){     
-                
-                float   ea  = ecel_a[k][i][j];
-                float   eb  = ecel_b[k][i][j];
-                float   ta  = tcel_a[k][i][j];
-                float   tb  = tcel_b[k][i][j];
-                
-                if( (min(ea,eb)>ethr_cell) & (fabs(ta-tb)<35.) & (ta!=0.) & (tb!=0.)) { 
+    for (unsigned int n = 0; n < cells_hit.size(); n++){
+        int c = cells_hit[n];
+        int k = c/(layermax_bcal*colmax_bcal);
+        int i = (c/colmax_bcal)%layermax_bcal;
+        int j = c%colmax_bcal;
+
+        float   ea  = ecel_a[k][i][j];
+        float   eb  = ecel_b[k][i][j];
+        float   ta  = tcel_a[k][i][j];
+        float   tb  = tcel_b[k][i][j];
+        
+        if( (min(ea,eb)>ethr_cell) & (fabs(ta-tb)<35.) & (ta!=0.) & (tb!=0.)) { 
 		  celtot=celtot+1;             
 		} else {
 		  continue;
-                }
-                
-                
-                if(celtot>cellmax_bcal) {
-                    break;
-                }
-                
-                narr[1][celtot]=k+1;    // these numbers will
-                narr[2][celtot]=i+1;    //  be used by preclusters
-                narr[3][celtot]=j+1;    //  which will start from index of 1
-                                        // rather than from 0.
-                                           
-                // why 0.145? -- these variables are used as weights
-                celdata[1][celtot]=ea/0.145;
-                celdata[2][celtot]=eb/0.145;
-                
-                nclus[celtot] = celtot;
-                next[celtot]  = celtot;
-                
-                e_cel[celtot] = ecel[k][i][j];
-                x_cel[celtot] = xcel[k][i][j];
-                y_cel[celtot] = ycel[k][i][j];
-                z_cel[celtot] = zcel[k][i][j];
-                t_cel[celtot] = tcel[k][i][j];
-                
-                ta_cel[celtot]=tcell_anor[k][i][j];
-                tb_cel[celtot]=tcell_bnor[k][i][j];
-            }
         }
+        
+        
+        if(celtot>cellmax_bcal) {
+            break;
+        }
+        
+        narr[1][celtot]=k+1;    // these numbers will
+        narr[2][celtot]=i+1;    //  be used by preclusters
+        narr[3][celtot]=j+1;    //  which will start from index of 1
+                                // rather than from 0.
+                                   
+        // why 0.145? -- these variables are used as weights
+        celdata[1][celtot]=ea/0.145;
+        celdata[2][celtot]=eb/0.145;
+        
+        nclus[celtot] = celtot;
+        next[celtot]  = celtot;
+        
+        e_cel[celtot] = ecel[k][i][j];
+        x_cel[celtot] = xcel[k][i][j];
+        y_cel[celtot] = ycel[k][i][j];
+        z_cel[celtot] = zcel[k][i][j];
+        t_cel[celtot] = tcel[k][i][j];
+        
+        ta_cel[celtot]=tcell_anor[k][i][j];
+        tb_cel[celtot]=tcell_bnor[k][i][j];
+
+        cell_to_cel[c] = celtot;
     }    
 }
 
@@ -563,148 +726,29 @@ void DBCALShower_factory_KLOE::PreCluster(JEventLoop *loop)
   //energy neighbor and Connect()'s the two. Two cells are neighbors if they
   //are within one column of each other and within one row. The situation is
   //slightly more complicated for two cells on opposite sides of the boundary
-  //between inner cells and outer and is described in more detail below, but
+  //between inner cells and outer and is described in more detail in brun(), but
   //essentially works out the same way. The purpose of Connect() is described
   //in that function itself.
 
-  int k=1;     // NUMBER OF NEARBY ROWS &/OR TO LOOK FOR MAX E CELL
-    
-  // extract the BCAL Geometry
-  vector<const DBCALGeometry*> bcalGeomVect;
-  loop->Get( bcalGeomVect );
-  const DBCALGeometry& bcalGeom = *(bcalGeomVect[0]);
-    
-  // calculate cell position
-    
-  int   modmin = 0;
-  int   modmax = bcalGeom.NBCALMODS;
-
-
-  //these values make sense as actually minima/maxima if it is implied that rowmin1=1,colmin1=1,colmin2=1
-  int   rowmax1= bcalGeom.NBCALLAYSIN;
-  int   rowmin2= rowmax1+1;
-  //int   rowmax2= bcalGeom.NBCALLAYSOUT+rowmin2-1;
-  int   colmax1=bcalGeom.NBCALSECSIN;
-  int   colmax2=bcalGeom.NBCALSECSOUT;
-
-  float r_middle= bcalGeom.BCALMIDRAD;
-
-  //radial size of the outermost inner layer
-  float thick_inner=bcalGeom.rSize(bcalGeom.cellId(1,bcalGeom.NBCALLAYSIN,1));
-  //radial size of the innermost outer layer
-  float thick_outer=bcalGeom.rSize(bcalGeom.cellId(1,bcalGeom.NBCALLAYSIN+1,1));
-
-  // this is the radial distance between the center of the innermost outer layer and the outermost inner layer
-  float dis_in_out=bcalGeom.r(bcalGeom.cellId(1,bcalGeom.NBCALLAYSIN+1,1))-bcalGeom.r(bcalGeom.cellId(1,bcalGeom.NBCALLAYSIN,1));
-    
-  float degree_permodule=360.0/(modmax-modmin);
-  float half_degree_permodule=degree_permodule/2.0;
-
-  //roughly the width of a single cell in the outermost inner layer
-  float width_1=2.0*(r_middle-thick_inner/2.0)*
-    sin(half_degree_permodule*3.141593/180)/colmax1;
-  //roughly the width of a single cell in the innermost outer layer
-  float width_2=2.0*(r_middle+thick_outer/2.0)*
-    sin(half_degree_permodule*3.141593/180)/colmax2;
-
-  //disthres is roughly the azimuthal distance between the center of an outer cell and the center of the most distant inner cell bordering an adjacent outer cell (a picture would be nice wouldn't it)
-  //this value is used for determining if two cells that straddle the boundary between inner and outer layers should be considered as neighboring
-  float disthres=width_2*1.5-width_1*0.5+0.0001;
+  //Which cells are neighbors is worked out once per run in brun() (see
+  //the description there), so here only the hit cells listed as
+  //neighbors of each cell need to be looked at.
     
   for (int i = 1; i < (celtot+1); i++){
         
     int maxnn=0; //cell index of the maximum energy neighbor (if one is found)
     float emin=0.; //energy of maximum energy neighbor
         
-        
-    for (int j = 1; j < (celtot+1); j++){
-      if ( (j!=i) & (nclus[j]!=nclus[i]) & (e_cel[j]>emin)) {
-                
-        int k1= narr[1][i];
-        int k2= narr[1][j];
-        int i1= narr[2][i];
-        int i2= narr[2][j];
-
-
-        int  modiff = k1-k2;
-        int amodif = abs(modiff);
-                
-        //  the following if is to check module and row distance.         
-        if ( (abs(i1-i2)<=k) & ((amodif<=1) || (amodif==47)) ) { 
-          //   further check col distance 
-          int   j1= narr[3][i];
-          int   j2= narr[3][j];
-
-          if(amodif==0) {   // same module       
-            //   further check col distance if both are inner layers
-            if ( (i1<=rowmax1) & (i2<=rowmax1) & (abs(j2-j1)<=k) ) {
-              emin=e_cel[j];
-              maxnn=j;
-            }
-
-            //   further check col distance if both are outer layers
- 
-            if ( (i1>=rowmin2) & (i2>=rowmin2) & (abs(j2-j1)<=k) ) {
-              emin=e_cel[j];
-              maxnn=j;
-            }
-          }
-
-          if(amodif>0) {  // different module          
-            if( (modiff==1) || (modiff==-47) ) {      
-              if ( (i1<=rowmax1) & (i2<=rowmax1) ){ 
-                if(abs((j1+colmax1)-j2)<=k){
-                  emin=e_cel[j];
-                  maxnn=j;
-                }
-              }
-                        
-              if ( (i1>=rowmin2) & (i2>=rowmin2) ) {
-                if(abs((j1+colmax2)-j2)<=k){
-                  emin=e_cel[j];
-                  maxnn=j;
-                }
-              }              
-            }
-
-            if ( (modiff==-1) || (modiff==47) ) {      
-
-              if ( (i1<=rowmax1) & (i2<=rowmax1) ){
-                if(abs((j2+colmax1)-j1)<=k){
-                  emin=e_cel[j];
-                  maxnn=j;
-                }
-              } 
-                        
-              if ( (i1>=rowmin2) & (i2>=rowmin2) ){
-                if(abs((j2+colmax2)-j1)<=k){
-                  emin=e_cel[j];
-                  maxnn=j;
-                }
-              }              
-            }
-          }
-                    
-          // further check col distance if one is inner layer, another is outer
-          // so that the two may be between the boundary of two different size
-          // of cells.
-          if( ( (i1 == rowmax1) & (i2 == rowmin2) ) || 
-              ( (i1 == rowmin2) & (i2 == rowmax1) ) ) {
-
-            float delta_xx=xx[k1-1][i1-1][j1-1]-xx[k2-1][i2-1][j2-1];
-            float delta_yy=yy[k1-1][i1-1][j1-1]-yy[k2-1][i2-1][j2-1];
-
-            //distance between centers of two cells
-            float dis = sqrt( delta_xx * delta_xx + delta_yy * delta_yy );
-            //dis_in_out is the distance in radial direction, so we now isolate distance in direction perpendicular to radius
-            dis = sqrt( dis*dis - dis_in_out * dis_in_out );
-            //disthres is described above
-            if( dis < disthres ){
-              emin = e_cel[j];
-              maxnn = j;
-            }
-          }                    
-        }             
+    int c = CellIndex(narr[1][i], narr[2][i], narr[3][i]);
+    for (int n = neighbor_begin[c]; n < neighbor_begin[c+1]; n++){
+      int j = cell_to_cel[neighbor_list[n]];
+      if ( (j==0) || (j==i) || (nclus[j]==nclus[i]) ) continue;
+
+      // the neighbors are listed in order of CellIndex() and so in order
+      // of j, which decides which one is kept on a tie in energy
+      if ( e_cel[j]>emin ) {
+        emin=e_cel[j];
+        maxnn=j;
       }
     }        // finish second loop
 
@@ -773,25 +817,29 @@ void DBCALShower_factory_KLOE::Connect(int n,int m)
 //------------------   
 void DBCALShower_factory_KLOE::ClusNorm(void)
 {    
-    // fast initialization of arrays:
-    memset( e_cls,  0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( x_cls,  0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( y_cls,  0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( z_cls,  0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( t_cls,  0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( ea_cls, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( eb_cls, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( ta_cls, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( tb_cls, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( tsqr_a, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( tsqr_b, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( trms_a, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( trms_b, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( e2_a,   0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( e2_b,   0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( clspoi, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( ncltot, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
-    memset( ntopol, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
+    // fast initialization of arrays: clusters are numbered by the
+    // index of one of their cells so only the first celtot+1 entries
+    // can be in use
+    int ncls = celtot + 1;
+    memset( e_cls,  0, ncls * sizeof( float ) );
+    memset( x_cls,  0, ncls * sizeof( float ) );
+    memset( y_cls,  0, ncls * sizeof( float ) );
+    memset( z_cls,  0, ncls * sizeof( float ) );
+    memset( t_cls,  0, ncls * sizeof( float ) );
+    memset( ea_cls, 0, ncls * sizeof( float ) );
+    memset( eb_cls, 0, ncls * sizeof( float ) );
+    memset( ta_cls, 0, ncls * sizeof( float ) );
+    memset( tb_cls, 0, ncls * sizeof( float ) );
+    memset( tsqr_a, 0, ncls * sizeof( float ) );
+    memset( tsqr_b, 0, ncls * sizeof( float ) );
+    memset( trms_a, 0, ncls * sizeof( float ) );
+    memset( trms_b, 0, ncls * sizeof( float ) );
+    memset( e2_a,   0, ncls * sizeof( float ) );
+    memset( e2_b,   0, ncls * sizeof( float ) );
+    memset( clspoi, 0, ncls * sizeof( float ) );
+    memset( ncltot, 0, ncls * sizeof( float ) );
+    memset( ntopol, 0, ncls * sizeof( float ) );
+    memset( clsidx, 0, ncls * sizeof( int ) );
     
     // Part of what is being done here is to further sparsify the
     // data into a list of clusters. This starts to fill arrays
@@ -811,15 +859,11 @@ void DBCALShower_factory_KLOE::ClusNorm(void)
         //----------------------------------------------------------------------
         
         int n=nclus[ix];
-        int j=0;
         
-        for (int i = 1; i < (clstot+1); i++){
-            if(n==clspoi[i]) j=i;
-        }
-        
-        if(j==0) {
+        if(clsidx[n]==0) {
             clstot=clstot+1;
             clspoi[clstot]=n;
+            clsidx[n]=clstot;
         }
         
         //----------------------------------------------------------------------
@@ -933,11 +977,42 @@ void DBCALShower_factory_KLOE::ClusAnalysis()
     // merge clusters likely to be from the same shower
     //----------------------------------------------------------------------       
 
+    // Clusters more than MERGE_THRESH_ZDIST apart in z are never
+    // merged, so each cluster is only compared with those close to it
+    // in z. Clusters sorted by z are used to find these, but the pairs
+    // are still taken in the order of the full double loop as the order
+    // of the Connect() calls decides the order of cells in the chains.
+    vector< pair<float,int> > zsorted;
+    vector<int> zpos(clstot+1, -1);
+    for (int i = 1; i < (clstot+1); i++){
+        int ix=clspoi[i];
+        if( (e_cls[ix]>0.0) && (z_cls[ix]==z_cls[ix]) )
+            zsorted.push_back( pair<float,int>(z_cls[ix], i) );
+    }
+    sort(zsorted.begin(), zsorted.end());
+    for (unsigned int k = 0; k < zsorted.size(); k++)
+        zpos[zsorted[k].second] = k;
+    float zwindow = MERGE_THRESH_ZDIST + 1.0;
+    vector<int> candidates;
+
     int icls[3];
     for (int i = 1; i < clstot; i++){
         icls[1]=0;
         icls[2]=0;
-        for (int j = (i+1); j < (clstot+1); j++){
+
+        candidates.clear();
+        int k = zpos[i];
+        if( k >= 0 ){
+            float zi = zsorted[k].first;
+            for (int kk = k-1; kk >= 0 && zi-zsorted[kk].first <= zwindow; kk--)
+                if( zsorted[kk].second > i ) candidates.push_back(zsorted[kk].second);
+            for (unsigned int kk = k+1; kk < zsorted.size() && zsorted[kk].first-zi <= zwindow; kk++)
+                if( zsorted[kk].second > i ) candidates.push_back(zsorted[kk].second);
+            sort(candidates.begin(), candidates.end());
+        }
+
+        for (unsigned int jc = 0; jc < candidates.size(); jc++){
+            int j = candidates[jc];
             
             int ix=clspoi[i];
             int iy=clspoi[j];
@@ -1092,6 +1167,13 @@ void DBCALShower_factory_KLOE::Clus_Break(int nclust)
     // If successful, divide cluster chain into the new cluster chains
     //----------------------------------------------------------------------
     
+    // Cells can only leave the cluster below, so the cells that need to
+    // be looked at for each seed are found once.
+    vector<int> members;
+    for (int j =1; j < (celtot+1); j++){
+        if (nclus[j]==nclust) members.push_back(j);
+    }
+
     for (int i =1; i < 5; i++){
         
         if(nseed[i]>0) {
@@ -1099,7 +1181,8 @@ void DBCALShower_factory_KLOE::Clus_Break(int nclust)
             nclus[nseed[i]]=nseed[i];
             next[nseed[i]]=nseed[i];
 
-            for (int j =1; j < (celtot+1); j++){
+            for (unsigned int jm =0; jm < members.size(); jm++){
+              int j = members[jm];
 	      if ( (nclus[j]==nclust) & (j!=nseed[i]) ){
                     if(selcel[j]==i) {
                         nclus[j]=j;
@@ -1125,13 +1208,26 @@ void DBCALShower_factory_KLOE::Trakfit( void )
  
     float emin=0.0001;
 
-    memset( clslyr, 0, ( clsmax_bcal + 1 ) * 
-            ( layermax_bcal + 1 ) * 6 * sizeof( float ) );
+    // only clusters numbered up to celtot can be in use
+    int ncls = celtot + 1;
+    if( ncls < clsmax_bcal ){
+        for (int a = 0; a < 6; a++){
+            for (int l = 0; l < ( layermax_bcal + 1 ); l++){
+                memset( clslyr[a][l], 0, ncls * sizeof( float ) );
+            }
+        }
+    }
+    else{
+        memset( clslyr, 0, ( clsmax_bcal + 1 ) * 
+                ( layermax_bcal + 1 ) * 6 * sizeof( float ) );
+    }
     
-    memset( apx,   0, ( clsmax_bcal + 1 ) * 4 * sizeof( float ) );
-    memset( eapx,  0, ( clsmax_bcal + 1 ) * 4 * sizeof( float ) );
-    memset( ctrk,  0, ( clsmax_bcal + 1 ) * 4 * sizeof( float ) );
-    memset( ectrk, 0, ( clsmax_bcal + 1 ) * 4 * sizeof( float ) );
+    for (int a = 0; a < 4; a++){
+        memset( apx[a],   0, ncls * sizeof( float ) );
+        memset( eapx[a],  0, ncls * sizeof( float ) );
+        memset( ctrk[a],  0, ncls * sizeof( float ) );
+        memset( ectrk[a], 0, ncls * sizeof( float ) );
+    }
     
     for (int ix = 1; ix < (celtot+1); ix++){
         
@@ -1164,7 +1260,7 @@ void DBCALShower_factory_KLOE::Trakfit( void )
         //        write(*,*)' slopes done'
     }
 
-    memset( nlrtot, 0, ( clsmax_bcal + 1 ) * sizeof( float ) );
+    memset( nlrtot, 0, ncls * sizeof( int ) );
 
     for (int n = 1; n < ( clstot + 1 ); n++){
 
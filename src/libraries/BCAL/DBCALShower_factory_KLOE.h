@@ -72,6 +72,12 @@ private:
 #define colmax_bcal 4
 #define cellmax_bcal modulemax_bcal*layermax_bcal*colmax_bcal
 #define clsmax_bcal modulemax_bcal*layermax_bcal*colmax_bcal
+
+    // index of a cell in the [module][layer][column] arrays below
+    // with all three counting from 1
+    int CellIndex(int module, int layer, int sector) const {
+        return ((module-1)*layermax_bcal + (layer-1))*colmax_bcal + (sector-1);
+    }
     
     // the following data member are used bu function CellRecon()
     
@@ -100,6 +106,23 @@ private:
     float  tcell_anor[modulemax_bcal][layermax_bcal][colmax_bcal];   
     float  tcell_bnor[modulemax_bcal][layermax_bcal][colmax_bcal]; 
     // The above data members are used by function CellRecon()
+
+    // Only the cells hit in an event are set in the arrays above and
+    // only those are cleared again at the start of the next event.
+    // CellIndex() of each of them is kept in cells_hit. The points
+    // in each cell are kept as a list (in the order they were
+    // delivered) starting at cell_first_point[CellIndex] and linked
+    // through point_next.
+    vector<int> cells_hit;
+    int cell_first_point[cellmax_bcal];
+    vector<int> point_next;
+    vector<const DBCALPoint*> event_points;
+
+    // Cell adjacency used by PreCluster(), filled in brun(). The cells
+    // PreCluster() may connect to the cell with CellIndex c are
+    // neighbor_list[neighbor_begin[c]] ... neighbor_list[neighbor_begin[c+1]-1]
+    vector<int> neighbor_begin;
+    vector<int> neighbor_list;
     
     
     // The following data are used by function CeleToArray();
@@ -113,6 +136,7 @@ private:
                  //         3 = Col    number
                  //--------------------------------------------------------------------
     int narr[4][cellmax_bcal+1]; 
+    int   cell_to_cel[cellmax_bcal]; // 1D array index of a CellIndex (0 for none)
     int   nclus[cellmax_bcal+1];  
     int   next[cellmax_bcal+1];
     float e_cel[cellmax_bcal+1];
@@ -156,6 +180,7 @@ private:
     float  e2_b[clsmax_bcal+1];   //--<E^2> OF SIDE B OF CLUSTER -
     
     int clspoi[clsmax_bcal+1];  //---POINTER TO FIRST CELL OF CLUSTER CHAIN 
+    int clsidx[clsmax_bcal+1];  //---INDEX IN CLSPOI OF A CLUSTER (0 IF NONE)
     int ncltot[clsmax_bcal+1];    //---- TOTAL NUMBER OF CELLS INCLUSTER -
     int ntopol[clsmax_bcal+1];
     
@@ -279,7 +279,7 @@ jerror_t DCDCHit_factory::fini(void)
 void DCDCHit_factory::CalcNstraws(jana::JEventLoop *eventLoop, int runnumber, vector<unsigned int> &Nstraws)
 {
     DGeometry *dgeom;
-    vector<vector<DCDCWire *> >cdcwires;
+    vector<vector<const DCDCWire *> >cdcwires;
 
     // Get pointer to DGeometry object
     DApplication* dapp=dynamic_cast<DApplication*>(eventLoop->GetJApplication());
@@ -296,14 +296,6 @@ void DCDCHit_factory::CalcNstraws(jana::JEventLoop *eventLoop, int runnumber, ve
         Nstraws.push_back( cdcwires[i].size() );
         maxChannels += cdcwires[i].size();
     }
-
-    // clear up all of the wire information
-    for (unsigned int i=0; i<cdcwires.size(); i++) {
-        for (unsigned int j=0; j<cdcwires[i].size(); j++) {
-            delete cdcwires[i][j];
-        }
-    }    
-    cdcwires.clear();
 }
 
 
@@ -16,13 +16,7 @@ using namespace std;
 #include <TRACKING/DMCTrackHit.h>
  
 DCDCTrackHit_factory::~DCDCTrackHit_factory(){
-  if (cdcwires.size()){
-    for (unsigned int i=0;i<cdcwires.size();i++){
-      for (unsigned int j=0;j<cdcwires[i].size();j++){
-	delete cdcwires[i][j];
-      }
-    }    
-  }
+
 }
 
 //------------------
@@ -87,13 +81,6 @@ jerror_t DCDCTrackHit_factory::brun(JEventLoop *loop, int runnumber)
 }
 
 jerror_t DCDCTrackHit_factory::erun(void){
-  if (cdcwires.size()){
-    for (unsigned int i=0;i<cdcwires.size();i++){
-      for (unsigned int j=0;j<cdcwires[i].size();j++){
-	delete cdcwires[i][j];
-      }
-    }    
-  }
   cdcwires.clear();
   return NOERROR;
 }
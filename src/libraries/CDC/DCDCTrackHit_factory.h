@@ -36,7 +36,7 @@ class DCDCTrackHit_factory:public JFactory<DCDCTrackHit>{
 
 
 		DGeometry *dgeom;
-		vector<vector<DCDCWire *> >cdcwires;
+		vector<vector<const DCDCWire *> >cdcwires; // owned by DGeometry
 		int Nstraws[CDC_MAX_RINGS];
 		bool MATCH_TRUTH_HITS;
 		double CDC_DRIFT_BSCALE_PAR1;
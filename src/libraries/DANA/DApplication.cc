@@ -14,6 +14,7 @@ using std::string;
 #include "DApplication.h"
 #include <HDDM/DEventSourceHDDMGenerator.h>
 #include <HDDM/DEventSourceRESTGenerator.h>
+#include <HDDM/DEventSourceRESTColumnsGenerator.h>
 #include <DAQ/JEventSourceGenerator_EVIO.h>
 #include <HDGEOMETRY/DMagneticFieldMapCalibDB.h>
 #include <HDGEOMETRY/DMagneticFieldMapFineMesh.h>
@@ -64,6 +65,10 @@ DApplication::DApplication(int narg, char* argv[]):JApplication(narg, argv)
 	bfield = NULL;
 	lorentz_def = NULL;
 	RootGeom = NULL;
+	for(unsigned int i=0; i<kGeometryRegistrySize; i++){
+		geometry_registry[i].run_number = 0;
+		geometry_registry[i].dgeom = NULL;
+	}
 	
 	// Since we defer reading in some tables until they are requested
 	// (likely while processing the first event) that time gets counted
@@ -86,6 +91,7 @@ DApplication::DApplication(int narg, char* argv[]):JApplication(narg, argv)
 		event_source_generator = new DEventSourceHDDMGenerator();
 		AddEventSourceGenerator(event_source_generator);
 		AddEventSourceGenerator(new DEventSourceRESTGenerator());
+		AddEventSourceGenerator(new DEventSourceRESTColumnsGenerator());
 		AddEventSourceGenerator(new JEventSourceGenerator_EVIO());
 	}
 	factory_generator = new DFactoryGenerator();
@@ -216,12 +222,15 @@ DGeometry* DApplication::GetDGeometry(unsigned int run_number)
 	/// a new DGeometry object will be created and added to the
 	/// internal list before returning a pointer to it.
 	///
-	/// Note that since this method can change internal data
-	/// members, a mutex is locked to ensure integrity. This
-	/// means that it is <b>NOT</b> efficient to call this
-	/// method for every event. The pointer should be obtained
-	/// in a brun() method and kept in a local variable if
-	/// needed outside of brun().
+	/// Note that the first call for a run locks a mutex since it
+	/// may change internal data members. Later calls for the same
+	/// run find the object in a lock-free table. It is still best
+	/// to obtain the pointer in a brun() method and keep it in a
+	/// local variable if needed outside of brun().
+
+	// Fast path for runs we have seen before
+	DGeometry *registered = FindRegisteredGeometry(run_number);
+	if(registered) return registered;
 
 	// At this point in time, only simulation exists with geometry coming
 	// from a JGeometryXML object. The run range for these objects is 
@@ -234,8 +243,10 @@ DGeometry* DApplication::GetDGeometry(unsigned int run_number)
 	// a single set of geometry files.
 	Lock();
 	if(geometries.size()==1 && string("JGeometryXML")==geometries[0]->GetJGeometry()->className()){
+		DGeometry *dgeom = geometries[0];
+		RegisterGeometry(run_number, dgeom);
 		Unlock();
-		return geometries[0];
+		return dgeom;
 	}
 	Unlock();
 	
@@ -262,6 +273,7 @@ DGeometry* DApplication::GetDGeometry(unsigned int run_number)
 	for(unsigned int i=0; i<geometries.size(); i++){
 		if(geometries[i]->GetJGeometry() == jgeom){
 			DGeometry *dgeom = geometries[i];
+			RegisterGeometry(run_number, dgeom);
 			Unlock();
 			return dgeom;
 		}
@@ -277,12 +289,52 @@ DGeometry* DApplication::GetDGeometry(unsigned int run_number)
 	// Create one and add it to the list.
 	DGeometry *dgeom = new DGeometry(jgeom, this, run_number);
 	geometries.push_back(dgeom);
+	RegisterGeometry(run_number, dgeom);
 	
 	Unlock();
 	
 	return dgeom;
 }
 
+//---------------------------------
+// FindRegisteredGeometry
+//---------------------------------
+DGeometry* DApplication::FindRegisteredGeometry(unsigned int run_number) const
+{
+	/// Look up the DGeometry for a run in the registry without
+	/// locking. Returns NULL if the run has not been registered.
+	for(unsigned int i=0; i<kGeometryRegistrySize; i++){
+		const geometry_entry_t &entry = geometry_registry[(run_number+i)%kGeometryRegistrySize];
+		DGeometry *dgeom = ReadPublished(entry.dgeom);
+		if(!dgeom) return NULL; // empty slot ends the search
+		if(entry.run_number == run_number) return dgeom;
+	}
+	
+	return NULL;
+}
+
+//---------------------------------
+// RegisterGeometry
+//---------------------------------
+void DApplication::RegisterGeometry(unsigned int run_number, DGeometry *dgeom)
+{
+	/// Add a run to the registry. Must be called with the
+	/// JApplication lock held. The run number of an entry is
+	/// written before its DGeometry pointer is published so
+	/// readers never see a partially filled entry.
+	for(unsigned int i=0; i<kGeometryRegistrySize; i++){
+		geometry_entry_t &entry = geometry_registry[(run_number+i)%kGeometryRegistrySize];
+		if(entry.dgeom == NULL){
+			entry.run_number = run_number;
+			Publish(entry.dgeom, dgeom);
+			return;
+		}
+		if(entry.run_number == run_number) return;
+	}
+	
+	// Registry is full. Later calls for this run take the slow path.
+}
+
 
 //---------------------------------
 // GetBfield
@@ -298,9 +350,13 @@ DMagneticFieldMap* DApplication::GetBfield(unsigned int run_number)
 		" or\n"
 		"   -PBFIELD_TYPE=NoField\n";
 	
+	// If field map already exists, return it immediately
+	DMagneticFieldMap *locBfield = ReadPublished(bfield);
+	if(locBfield) return locBfield;
+
 	pthread_mutex_lock(&mutex);
 
-	// If field map already exists, return it immediately
+	// Check again now that we hold the lock
 	if(bfield){
 		pthread_mutex_unlock(&mutex);
 		return bfield;
@@ -318,7 +374,7 @@ DMagneticFieldMap* DApplication::GetBfield(unsigned int run_number)
 	if(bfield_type=="CalibDB"|| bfield_type=="FineMesh"){
 		// if the magnetic field map got passed in on the command line, then use that value instead of the CCDB values
 		if( bfield_map != "" )  { 
-			bfield = new DMagneticFieldMapFineMesh(this,run_number,bfield_map);
+			locBfield = new DMagneticFieldMapFineMesh(this,run_number,bfield_map);
 		} else {
 			// otherwise, we load some default map
 			// see if we can load the name of the magnetic field map to use from the calib DB
@@ -331,9 +387,9 @@ DMagneticFieldMap* DApplication::GetBfield(unsigned int run_number)
 			} else {
 				if( bfield_map_name.find("map_name") != bfield_map_name.end() ) {
 					if( bfield_map_name["map_name"] == "NoField" )     // special case for no magnetic field
-						bfield = new DMagneticFieldMapNoField(this);
+						locBfield = new DMagneticFieldMapNoField(this);
 					else  
-						bfield = new DMagneticFieldMapFineMesh(this,run_number,bfield_map_name["map_name"]);  // pass along the name of the magnetic field map to load
+						locBfield = new DMagneticFieldMapFineMesh(this,run_number,bfield_map_name["map_name"]);  // pass along the name of the magnetic field map to load
 				} else {
 					// if we can't find information in the CCDB, then quit with an error message
 					jerr << ccdb_help << endl;
@@ -342,11 +398,11 @@ DMagneticFieldMap* DApplication::GetBfield(unsigned int run_number)
 			}
 		}
 		string subclass = "<none>";
-		if(dynamic_cast<DMagneticFieldMapFineMesh*>(bfield)) subclass = "DMagneticFieldMapFineMesh";
-		if(dynamic_cast<DMagneticFieldMapNoField*>(bfield)) subclass = "DMagneticFieldMapNoField";
+		if(dynamic_cast<DMagneticFieldMapFineMesh*>(locBfield)) subclass = "DMagneticFieldMapFineMesh";
+		if(dynamic_cast<DMagneticFieldMapNoField*>(locBfield)) subclass = "DMagneticFieldMapNoField";
 		jout<<"Created Magnetic field map of type " << subclass <<endl;
 	}else if(bfield_type=="Const"){
-		bfield = new DMagneticFieldMapConst(0.0, 0.0, 1.9);
+		locBfield = new DMagneticFieldMapConst(0.0, 0.0, 1.9);
 		jout<<"Created Magnetic field map of type DMagneticFieldMapConst."<<endl;
 	//}else if(bfield_type=="Spoiled"){
 	// bfield = new DMagneticFieldMapSpoiled(this);
@@ -356,16 +412,17 @@ DMagneticFieldMap* DApplication::GetBfield(unsigned int run_number)
 	// jout<<"Created Magnetic field map of type DMagneticFieldMapParameterized."<<endl;
 	//}
 	}else if (bfield_type=="NoField"){
-	  bfield = new DMagneticFieldMapNoField(this);
+	  locBfield = new DMagneticFieldMapNoField(this);
 	  jout << "Created Magnetic field map with B=(0,0,0) everywhere." <<endl;
 	}else{
 		_DBG_<<" Unknown DMagneticFieldMap subclass \"DMagneticFieldMap"<<bfield_type<<"\" !!"<<endl;
 		exit(-1);
 	}
 	
+	Publish(bfield, locBfield);
 	pthread_mutex_unlock(&mutex);
 	
-	return bfield;
+	return locBfield;
 }
 
 //---------------------------------
@@ -373,20 +430,25 @@ DMagneticFieldMap* DApplication::GetBfield(unsigned int run_number)
 //---------------------------------
 DLorentzDeflections* DApplication::GetLorentzDeflections(unsigned int run_number)
 {
+	// If the Lorentz deflection object already exists, return it immediately
+	DLorentzDeflections *locLorentzDef = ReadPublished(lorentz_def);
+	if(locLorentzDef) return locLorentzDef;
+
 	pthread_mutex_lock(&mutex);
 
-	// If field map already exists, return it immediately
+	// Check again now that we hold the lock
 	if(lorentz_def){
 		pthread_mutex_unlock(&mutex);
 		return lorentz_def;
 	}
 
 	// Create Lorentz deflection object
-	lorentz_def= new DLorentzMapCalibDB(this, run_number);
+	locLorentzDef = new DLorentzMapCalibDB(this, run_number);
+	Publish(lorentz_def, locLorentzDef);
 	
 	pthread_mutex_unlock(&mutex);
 	
-	return lorentz_def;
+	return locLorentzDef;
 }
 
 //---------------------------------
@@ -394,9 +456,13 @@ DLorentzDeflections* DApplication::GetLorentzDeflections(unsigned int run_number
 //---------------------------------
 DRootGeom* DApplication::GetRootGeom(unsigned int run_number)
 {
+	// If the ROOT geometry already exists, return it immediately
+	DRootGeom *locRootGeom = ReadPublished(RootGeom);
+	if(locRootGeom) return locRootGeom;
+
 	pthread_mutex_lock(&mutex);
 
-	// If field map already exists, return it immediately
+	// Check again now that we hold the lock
 	if(RootGeom){
 		pthread_mutex_unlock(&mutex);
 		return RootGeom;
@@ -404,10 +470,11 @@ DRootGeom* DApplication::GetRootGeom(unsigned int run_number)
 	
 	// Create map of material properties
 	//material = new DMaterialMapCalibDB(this);
-	RootGeom = new DRootGeom(this, run_number);
+	locRootGeom = new DRootGeom(this, run_number);
+	Publish(RootGeom, locRootGeom);
 
 	pthread_mutex_unlock(&mutex);
 	
-	return RootGeom;
+	return locRootGeom;
 }
 
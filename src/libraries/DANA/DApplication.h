@@ -45,14 +45,44 @@ class DApplication:public JApplication{
 
 	protected:
 	
-		DMagneticFieldMap *bfield;
-		DLorentzDeflections *lorentz_def;
+		// The run-level objects below are created at most once, under
+		// the mutex, and their pointers are only set after the object is
+		// fully constructed (see Publish()). Once set, they never change
+		// so the Get methods return them without locking.
+		DMagneticFieldMap * volatile bfield;
+		DLorentzDeflections * volatile lorentz_def;
 		JEventSourceGenerator *event_source_generator;
 		JFactoryGenerator *factory_generator;
-	 	DRootGeom *RootGeom;	
+	 	DRootGeom * volatile RootGeom;	
 		vector<DGeometry*> geometries;
 
 		pthread_mutex_t mutex;
+
+		// Run number -> DGeometry lookup table for GetDGeometry(). Entries
+		// are only ever added (with the JApplication lock held) and never
+		// changed, so it can be searched without locking. Runs that do
+		// not fit in the table are still found the slow way.
+		enum{kGeometryRegistrySize=256};
+		typedef struct{
+			unsigned int run_number;
+			DGeometry * volatile dgeom;
+		}geometry_entry_t;
+		geometry_entry_t geometry_registry[kGeometryRegistrySize];
+		DGeometry* FindRegisteredGeometry(unsigned int run_number) const;
+		void RegisterGeometry(unsigned int run_number, DGeometry *dgeom);
+
+		/// Make ptr point to obj only after everything obj's constructor
+		/// wrote is visible to other threads.
+		template<class T> static void Publish(T * volatile &ptr, T *obj){
+			__sync_synchronize();
+			ptr = obj;
+		}
+		/// Read a pointer set with Publish() (NULL if not yet set)
+		template<class T> static T* ReadPublished(T * const volatile &ptr){
+			T *obj = ptr;
+			__sync_synchronize();
+			return obj;
+		}
 		
 	private:
 
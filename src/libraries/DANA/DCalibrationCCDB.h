@@ -6,10 +6,18 @@
 #include <vector>
 #include <map>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
 #include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <JANA/jerror.h>
 #include <JANA/JCalibration.h>
+#include <JANA/JParameterManager.h>
 #include <JANA/JStreamLog.h>
 #include <CCDB/Calibration.h>
 
@@ -58,6 +66,14 @@ namespace jana
 		    mCalibration = calib;
 		    pthread_mutex_init(&mutex, NULL);
 
+		    // Optional local snapshot of the tables used for this run
+		    mUrl = url;
+		    mRun = run;
+		    mContext = context;
+		    string snapshot_dir = "";
+		    if(gPARMS) gPARMS->SetDefaultParameter("CCDB:SNAPSHOT_DIR", snapshot_dir, "Directory for per-run snapshots of the calibration tables used by a job. Later jobs on the same run read the tables from the snapshot instead of CCDB as long as the database file is unchanged. Only supported for SQLite connections. Empty to disable.");
+		    if(snapshot_dir != "") LoadSnapshot(snapshot_dir);
+
 			//>oO CCDB debug output
 			#ifdef CCDB_DEBUG_OUTPUT
 			jout<<"CCDB::janaccdb created DCalibrationCCDB with connection string:" << calib->GetConnectionString()<< " run:"<<run<< " context:"<<context<<endl;
@@ -69,6 +85,8 @@ namespace jana
          */
         virtual ~DCalibrationCCDB()
         {
+            if(!mNewEntries.empty()) SaveSnapshot();
+
             if(mCalibration!=NULL){
                pthread_mutex_lock(&mutex);
                delete mCalibration;
@@ -102,6 +120,9 @@ namespace jana
          */
         bool GetCalib(string namepath, map<string, string> &svals, int event_number=0)
         {
+            // Tables found in the snapshot need neither CCDB nor the lock
+            if(GetFromSnapshot(namepath, svals)) return false;
+
             // Lock mutex for exclusive use of underlying Calibration object
             pthread_mutex_lock(&mutex);
 		
@@ -115,6 +136,7 @@ namespace jana
                 #endif  //>end of  CCDB debug output
                  
                 bool result = mCalibration->GetCalib(svals, namepath);
+                if(result) AddToSnapshot(namepath, svals);
 
                 //>oO CCDB debug output
                 #ifdef CCDB_DEBUG_OUTPUT
@@ -157,6 +179,9 @@ namespace jana
          */
         bool GetCalib(string namepath, vector<string> &svals, int event_number=0)
         {
+            // Tables found in the snapshot need neither CCDB nor the lock
+            if(GetFromSnapshot(namepath, svals)) return false;
+
             // Lock mutex for exclusive use of underlying Calibration object
             pthread_mutex_lock(&mutex);
 		
@@ -170,6 +195,7 @@ namespace jana
                 #endif  //>end of  CCDB debug output
                  
                 bool result = mCalibration->GetCalib(svals, namepath);
+                if(result) AddToSnapshot(namepath, svals);
 
                 //>oO CCDB debug output
                 #ifdef CCDB_DEBUG_OUTPUT
@@ -212,6 +238,9 @@ namespace jana
          */
         bool GetCalib(string namepath, vector< map<string, string> > &vsvals, int event_number=0)
         {
+            // Tables found in the snapshot need neither CCDB nor the lock
+            if(GetFromSnapshot(namepath, vsvals)) return false;
+
             // Lock mutex for exclusive use of underlying Calibration object
             pthread_mutex_lock(&mutex);
 
@@ -225,6 +254,7 @@ namespace jana
                  #endif  //end of CCDB debug output
                  
                  bool result = mCalibration->GetCalib(vsvals, namepath);
+                 if(result) AddToSnapshot(namepath, vsvals);
 
                  //>oO CCDB debug output
                  #ifdef CCDB_DEBUG_OUTPUT
@@ -270,6 +300,9 @@ namespace jana
          */
         bool GetCalib(string namepath, vector< vector<string> > &vsvals, int event_number=0)
         {
+            // Tables found in the snapshot need neither CCDB nor the lock
+            if(GetFromSnapshot(namepath, vsvals)) return false;
+
             // Lock mutex for exclusive use of underlying Calibration object
             pthread_mutex_lock(&mutex);
 
@@ -283,6 +316,7 @@ namespace jana
                  #endif  //end of CCDB debug output
                  
                  bool result = mCalibration->GetCalib(vsvals, namepath);
+                 if(result) AddToSnapshot(namepath, vsvals);
 
                  //>oO CCDB debug output
                  #ifdef CCDB_DEBUG_OUTPUT
@@ -353,6 +387,277 @@ namespace jana
         DCalibrationCCDB();					// prevent use of default constructor
         ccdb::Calibration * mCalibration;	///Underlaying CCDB user api class 
         pthread_mutex_t mutex;
+
+        /*
+         * Snapshot of the tables used for a run.
+         *
+         * If CCDB:SNAPSHOT_DIR is set, every table successfully read from
+         * CCDB is also recorded and, when this object is deleted at the
+         * end of the job, written together with the tables already in
+         * the snapshot to a file named after the connection string,
+         * context and run. Later jobs read that file once in the
+         * constructor. The tables loaded from it are never modified
+         * afterwards, so they are handed out without taking the mutex.
+         * Tables not in the snapshot (including ones CCDB failed to
+         * provide, which are never recorded) are still read from CCDB.
+         *
+         * Snapshots are only made for SQLite connections. The size and
+         * modification time of the database file are stored in the
+         * snapshot and it is ignored if the file has changed. Other
+         * connections give no way to tell whether the constants have
+         * changed since the snapshot was made, so none is used.
+         *
+         * Each table is kept as rows of strings; maps are stored as
+         * alternating keys and values.
+         */
+        typedef vector< vector<string> > snapshot_table_t;
+
+        string mUrl;
+        int mRun;
+        string mContext;
+        string mSnapshotId;
+        string mSnapshotFile;
+        string mSnapshotStamp;
+        map<string, snapshot_table_t> mSnapshot;    ///< read only after the constructor
+        map<string, snapshot_table_t> mNewEntries;  ///< guarded by mutex
+
+        static void ToTable(const map<string, string> &vals, snapshot_table_t &t)
+        {
+            t.resize(1);
+            for(map<string, string>::const_iterator it=vals.begin(); it!=vals.end(); it++){
+                t[0].push_back(it->first);
+                t[0].push_back(it->second);
+            }
+        }
+        static void FromTable(const snapshot_table_t &t, map<string, string> &vals)
+        {
+            vals.clear();
+            if(t.empty()) return;
+            for(unsigned int i=0; i+1<t[0].size(); i+=2) vals[t[0][i]] = t[0][i+1];
+        }
+        static void ToTable(const vector<string> &vals, snapshot_table_t &t)
+        {
+            t.resize(1);
+            t[0] = vals;
+        }
+        static void FromTable(const snapshot_table_t &t, vector<string> &vals)
+        {
+            if(t.empty()) vals.clear();
+            else vals = t[0];
+        }
+        static void ToTable(const vector< map<string, string> > &vals, snapshot_table_t &t)
+        {
+            t.resize(vals.size());
+            for(unsigned int i=0; i<vals.size(); i++){
+                snapshot_table_t row;
+                ToTable(vals[i], row);
+                t[i].swap(row[0]);
+            }
+        }
+        static void FromTable(const snapshot_table_t &t, vector< map<string, string> > &vals)
+        {
+            vals.resize(t.size());
+            for(unsigned int i=0; i<t.size(); i++){
+                vals[i].clear();
+                for(unsigned int j=0; j+1<t[i].size(); j+=2) vals[i][t[i][j]] = t[i][j+1];
+            }
+        }
+        static void ToTable(const vector< vector<string> > &vals, snapshot_table_t &t)
+        {
+            t = vals;
+        }
+        static void FromTable(const snapshot_table_t &t, vector< vector<string> > &vals)
+        {
+            vals = t;
+        }
+
+        // Key of a table in the snapshot. The same namepath can be asked
+        // for in different shapes so the shape is part of the key.
+        static string SnapshotKey(const string &namepath, const map<string, string>*){return "m:"+namepath;}
+        static string SnapshotKey(const string &namepath, const vector<string>*){return "v:"+namepath;}
+        static string SnapshotKey(const string &namepath, const vector< map<string, string> >*){return "M:"+namepath;}
+        static string SnapshotKey(const string &namepath, const vector< vector<string> >*){return "V:"+namepath;}
+
+        template<class T>
+        bool GetFromSnapshot(const string &namepath, T &vals)
+        {
+            if(mSnapshot.empty()) return false;
+            map<string, snapshot_table_t>::const_iterator it = mSnapshot.find(SnapshotKey(namepath, &vals));
+            if(it == mSnapshot.end()) return false;
+            FromTable(it->second, vals);
+            return true;
+        }
+
+        // Called with mutex locked
+        template<class T>
+        void AddToSnapshot(const string &namepath, const T &vals)
+        {
+            if(mSnapshotFile == "") return;
+            ToTable(vals, mNewEntries[SnapshotKey(namepath, &vals)]);
+        }
+
+        static uint64_t SnapshotChecksum(const char *p, size_t len)
+        {
+            uint64_t h = 1469598103934665603ULL;
+            for(size_t i=0; i<len; i++) h = (h ^ (unsigned char)p[i])*1099511628211ULL;
+            return h;
+        }
+
+        static void WriteString(string &buff, const string &str)
+        {
+            uint32_t len = str.size();
+            buff.append((const char*)&len, sizeof(len));
+            buff.append(str);
+        }
+        static bool ReadString(const vector<char> &buff, size_t &pos, size_t end, string &str)
+        {
+            uint32_t len;
+            if(pos+sizeof(len) > end) return false;
+            memcpy(&len, &buff[pos], sizeof(len));
+            pos += sizeof(len);
+            if(len > end-pos) return false;
+            str.assign(&buff[pos], len);
+            pos += len;
+            return true;
+        }
+        static bool ReadUInt(const vector<char> &buff, size_t &pos, size_t end, uint32_t &val)
+        {
+            if(pos+sizeof(val) > end) return false;
+            memcpy(&val, &buff[pos], sizeof(val));
+            pos += sizeof(val);
+            return true;
+        }
+
+        static const uint32_t SNAPSHOT_VERSION = 1;
+
+        /// Set the snapshot file name and read the file if it exists and
+        /// is still valid.
+        void LoadSnapshot(const string &snapshot_dir)
+        {
+            // Name the file after everything that selects the constants
+            // (the connection string itself is not stored as it may
+            // contain a password)
+            string id = mUrl + "|" + mContext;
+            stringstream ssid;
+            ssid << hex << SnapshotChecksum(id.c_str(), id.size());
+            mSnapshotId = ssid.str();
+            stringstream ss;
+            ss << snapshot_dir << "/ccdb_" << mSnapshotId << "_run" << mRun << ".snapshot";
+            mSnapshotFile = ss.str();
+
+            // Remember which version of the SQLite file we read from.
+            // Without that the snapshot could never be invalidated.
+            struct stat st;
+            if(mUrl.find("sqlite://") != 0 || stat(mUrl.substr(9).c_str(), &st) != 0){
+                jout << "CCDB:SNAPSHOT_DIR is only supported for SQLite files. No calibration snapshot will be used." << endl;
+                mSnapshotFile = "";
+                return;
+            }
+            stringstream sst;
+            sst << st.st_size << ":" << st.st_mtime;
+            mSnapshotStamp = sst.str();
+
+            // Read the whole file at once
+            ifstream ifs(mSnapshotFile.c_str(), ios::binary);
+            if(!ifs.is_open()) return;
+            ifs.seekg(0, ios::end);
+            streamoff size = ifs.tellg();
+            ifs.seekg(0, ios::beg);
+            if(size < (streamoff)(8+sizeof(uint64_t))) return;
+            vector<char> buff(size);
+            ifs.read(&buff[0], size);
+            if(!ifs.good()) return;
+
+            // The file ends with a checksum of everything before it
+            size_t end = buff.size() - sizeof(uint64_t);
+            uint64_t checksum;
+            memcpy(&checksum, &buff[end], sizeof(checksum));
+            if(memcmp(&buff[0], "CCDBSNAP", 8)!=0 || checksum != SnapshotChecksum(&buff[0], end)){
+                jout << "Ignoring damaged calibration snapshot " << mSnapshotFile << endl;
+                return;
+            }
+
+            size_t pos = 8;
+            uint32_t version, run, Nentries;
+            string file_id, stamp;
+            if(!ReadUInt(buff, pos, end, version) || version != SNAPSHOT_VERSION) return;
+            if(!ReadString(buff, pos, end, file_id) || file_id != mSnapshotId) return;
+            if(!ReadUInt(buff, pos, end, run) || (int)run != mRun) return;
+            if(!ReadString(buff, pos, end, stamp)) return;
+            if(stamp != mSnapshotStamp){
+                jout << "Calibration snapshot " << mSnapshotFile << " is out of date. It will be remade." << endl;
+                return;
+            }
+            if(!ReadUInt(buff, pos, end, Nentries)) return;
+
+            map<string, snapshot_table_t> entries;
+            for(uint32_t i=0; i<Nentries; i++){
+                string key;
+                uint32_t Nrows;
+                if(!ReadString(buff, pos, end, key) || !ReadUInt(buff, pos, end, Nrows)) return;
+                snapshot_table_t &t = entries[key];
+                t.resize(Nrows);
+                for(uint32_t j=0; j<Nrows; j++){
+                    uint32_t Ncols;
+                    if(!ReadUInt(buff, pos, end, Ncols)) return;
+                    t[j].resize(Ncols);
+                    for(uint32_t k=0; k<Ncols; k++){
+                        if(!ReadString(buff, pos, end, t[j][k])) return;
+                    }
+                }
+            }
+            mSnapshot.swap(entries);
+
+            jout << "Read " << mSnapshot.size() << " calibration tables from " << mSnapshotFile << " (made from " << mUrl.substr(9) << " " << mSnapshotStamp << ")" << endl;
+        }
+
+        /// Write the tables of the snapshot plus any new ones read from
+        /// CCDB in this job. The file is written under a temporary name
+        /// and renamed so concurrent jobs never see a partial file.
+        void SaveSnapshot(void)
+        {
+            map<string, snapshot_table_t> entries = mSnapshot;
+            for(map<string, snapshot_table_t>::iterator it=mNewEntries.begin(); it!=mNewEntries.end(); it++){
+                entries[it->first] = it->second;
+            }
+
+            string buff("CCDBSNAP");
+            uint32_t version = SNAPSHOT_VERSION;
+            uint32_t run = mRun;
+            uint32_t Nentries = entries.size();
+            buff.append((const char*)&version, sizeof(version));
+            WriteString(buff, mSnapshotId);
+            buff.append((const char*)&run, sizeof(run));
+            WriteString(buff, mSnapshotStamp);
+            buff.append((const char*)&Nentries, sizeof(Nentries));
+            for(map<string, snapshot_table_t>::iterator it=entries.begin(); it!=entries.end(); it++){
+                WriteString(buff, it->first);
+                uint32_t Nrows = it->second.size();
+                buff.append((const char*)&Nrows, sizeof(Nrows));
+                for(uint32_t j=0; j<Nrows; j++){
+                    uint32_t Ncols = it->second[j].size();
+                    buff.append((const char*)&Ncols, sizeof(Ncols));
+                    for(uint32_t k=0; k<Ncols; k++) WriteString(buff, it->second[j][k]);
+                }
+            }
+            uint64_t checksum = SnapshotChecksum(buff.data(), buff.size());
+            buff.append((const char*)&checksum, sizeof(checksum));
+
+            stringstream ss;
+            ss << mSnapshotFile << ".tmp." << getpid();
+            string tmpFile = ss.str();
+            ofstream ofs(tmpFile.c_str(), ios::binary);
+            if(ofs.is_open()){
+                ofs.write(buff.data(), buff.size());
+                ofs.close();
+                if(ofs.good() && rename(tmpFile.c_str(), mSnapshotFile.c_str())==0){
+                    jout << "Wrote " << entries.size() << " calibration tables to " << mSnapshotFile << endl;
+                    return;
+                }
+                unlink(tmpFile.c_str());
+            }
+            jout << "Unable to write calibration snapshot " << mSnapshotFile << endl;
+        }
         
     };
 
@@ -31,6 +31,9 @@ DFCALCluster::DFCALCluster( const int nhits )
       fHitf = new double[ nhits ];
       fEallowed = new double[ nhits ];
       fEexpected = new double[ nhits ];
+      for ( int ih = 0; ih < nhits; ih++ ) {
+         fEallowed[ih] = fEexpected[ih] = 0;
+      }
    }
    else {
       fHit = 0;
@@ -103,8 +106,36 @@ void DFCALCluster::resetClusterHits()
    }
 }
 
+void DFCALCluster::hitgrid_t::fill( const userhits_t* const hitList )
+{
+   for ( int row = 0; row < DFCALGeometry::kBlocksTall; row++ ) {
+      for ( int col = 0; col < DFCALGeometry::kBlocksWide; col++ ) {
+         first[row][col] = -1;
+      }
+   }
+   next.resize( hitList->nhits );
+
+   // go backwards so the hits of a block are listed in order
+   for ( int ih = hitList->nhits-1; ih >= 0; ih-- ) {
+      int row = block( hitList->hit[ih].y );
+      int col = block( hitList->hit[ih].x );
+      next[ih] = first[row][col];
+      first[row][col] = ih;
+   }
+}
+
+int DFCALCluster::hitgrid_t::block( float pos )
+{
+   // same as DFCALGeometry::row() and DFCALGeometry::column()
+   int b = static_cast<int>( pos / DFCALGeometry::blockSize() + 
+                             DFCALGeometry::kMidBlock + 0.5 );
+   if ( b < 0 ) return 0;
+   if ( b >= DFCALGeometry::kBlocksWide ) return DFCALGeometry::kBlocksWide-1;
+   return b;
+}
+
 bool DFCALCluster::update( const userhits_t* const hitList,
-			   double fcalFaceZ )
+			   double fcalFaceZ, const hitgrid_t* const grid )
 {
 
    double energy = 0;
@@ -247,9 +278,38 @@ bool DFCALCluster::update( const userhits_t* const hitList,
       fRMS_u = sqrt(energy*MOM2u - SQR(MOM1u))/(energy);
       fRMS_v = sqrt(energy*MOM2v - SQR(MOM1v))/(energy);
 
-      for (int ih = 0; ih < hitList->nhits; ih++) {
-	shower_profile( hitList, ih,fEallowed[ih],fEexpected[ih],
-			fcalFaceZ+0.5*DFCALGeometry::blockLength());
+      for (unsigned int i = 0; i < fProfileHits.size(); i++) {
+         fEallowed[fProfileHits[i]] = fEexpected[fProfileHits[i]] = 0;
+      }
+      fProfileHits.clear();
+
+      if (grid == 0) {
+         for (int ih = 0; ih < hitList->nhits; ih++) {
+	   shower_profile( hitList, ih,fEallowed[ih],fEexpected[ih],
+			   fcalFaceZ+0.5*DFCALGeometry::blockLength());
+	   if (fEallowed[ih] != 0 || fEexpected[ih] != 0)
+	      fProfileHits.push_back(ih);
+         }
+      }
+      else if (fEnergy != 0) {
+         // The profile is zero beyond MAX_SHOWER_RADIUS from the centroid
+         // so only the blocks within that (and a little more, for
+         // rounding) need to be looked at.
+         double reach = MAX_SHOWER_RADIUS + 1.0;
+         int rowMin = hitgrid_t::block( fCentroid.y()-reach );
+         int rowMax = hitgrid_t::block( fCentroid.y()+reach );
+         int colMin = hitgrid_t::block( fCentroid.x()-reach );
+         int colMax = hitgrid_t::block( fCentroid.x()+reach );
+         for (int row = rowMin; row <= rowMax; row++) {
+            for (int col = colMin; col <= colMax; col++) {
+               for (int ih = grid->first[row][col]; ih >= 0; ih = grid->next[ih]) {
+                  shower_profile( hitList, ih,fEallowed[ih],fEexpected[ih],
+                                  fcalFaceZ+0.5*DFCALGeometry::blockLength());
+                  if (fEallowed[ih] != 0 || fEexpected[ih] != 0)
+                     fProfileHits.push_back(ih);
+               }
+            }
+         }
       }
    }
 
@@ -8,8 +8,10 @@
 #ifndef _DFCALCluster_
 #define _DFCALCluster_
 
+#include <vector>
 #include <DVector3.h>
 #include "DFCALHit.h"
+#include "DFCALGeometry.h"
 using namespace std;
 
 #include <JANA/JObject.h>
@@ -54,6 +56,20 @@ class DFCALCluster : public JObject {
       float intOverPeak;
    } DFCALClusterHit_t;
 
+   // the hits of an event sorted into the FCAL blocks their positions
+   // fall in, so that the hits near a cluster can be found without
+   // looking at all of them
+   class hitgrid_t {
+      public:
+         void fill( const userhits_t* const hitList );
+         // row (from y) or column (from x) of a position, clamped to the
+         // edges of the calorimeter
+         static int block( float pos );
+
+         int first[DFCALGeometry::kBlocksTall][DFCALGeometry::kBlocksWide]; // first hit in block or -1
+         vector<int> next;  // next hit in the same block or -1
+   };
+
    void saveHits( const userhits_t* const hit );
 
    double getEexpected(const int ihit) const;
@@ -77,7 +93,13 @@ class DFCALCluster : public JObject {
    int getHits() const; // get number of hits owned by a cluster
    int addHit(const int ihit, const double frac);
    void resetClusterHits();
-   bool update( const userhits_t* const hitList, double fcalFaceZ );
+   // If a hit grid is given, the expected and allowed energies are only
+   // evaluated for the hits close enough to the centroid for them not
+   // to be zero.
+   bool update( const userhits_t* const hitList, double fcalFaceZ,
+                const hitgrid_t* const grid = 0 );
+   // hits with non-zero expected or allowed energy for this cluster
+   const vector<int>& getProfileHits() const { return fProfileHits; }
 
 // get hits that form a cluster after clustering is finished
    inline const vector<DFCALClusterHit_t> GetHits() const { return my_hits; }
@@ -127,6 +149,7 @@ class DFCALCluster : public JObject {
    double *fHitf;         // list of hit fractions owned by this cluster
    double *fEexpected;    // expected energy of hit by cluster (GeV)
    double *fEallowed;     // allowed energy of hit by cluster (GeV)
+   vector<int> fProfileHits; // hits for which the two above are non-zero
 
    // container for hits that form a cluster to be used after clustering is done
    vector<DFCALClusterHit_t> my_hits; 
@@ -118,9 +118,18 @@ jerror_t DFCALCluster_factory::evnt(JEventLoop *eventLoop, int eventnumber)
         for ( int i = 0; i < nhits; i++ ) {
 	  hitUsed[i] = 0; 
 	}
+
+	// The shower profile of a cluster only reaches the hits within
+	// MAX_SHOWER_RADIUS of it. The hits are put in a grid of the FCAL
+	// blocks so each cluster only evaluates its profile for those,
+	// and for each hit the clusters that reach it are listed
+	// (in order of the clusters) so that the sums over clusters
+	// below skip the ones that would only add zero.
+	DFCALCluster::hitgrid_t grid;
+	grid.fill( hits );
+	vector< vector<unsigned int> > hitClusters( nhits );
  
-        const unsigned int max = 999;
-	DFCALCluster* clusterList[max];
+	vector<DFCALCluster*> clusterList;
 	unsigned int clusterCount = 0;
 	int iter;
 	for ( iter=0; iter < 99; iter++ ) {
@@ -131,8 +140,17 @@ jerror_t DFCALCluster_factory::evnt(JEventLoop *eventLoop, int eventnumber)
 	   bool something_changed = false;
 	   for ( unsigned int c = 0; c < clusterCount; c++ ) {
               //cout << " --------- Update iteration " << iter << endl;
-	     something_changed |= clusterList[c]->update( hits, fcalFaceZ_TargetIsZeq0 );
+	     something_changed |= clusterList[c]->update( hits, fcalFaceZ_TargetIsZeq0, &grid );
            }
+
+	   for ( int h = 0; h < nhits; h++ ) hitClusters[h].clear();
+	   for ( unsigned int c = 0; c < clusterCount; c++ ) {
+	      const vector<int> &profileHits = clusterList[c]->getProfileHits();
+	      for ( unsigned int i = 0; i < profileHits.size(); i++ ) {
+	         hitClusters[ profileHits[i] ].push_back( c );
+	      }
+	   }
+
       	   if (something_changed) {
               for ( unsigned int c = 0; c < clusterCount; c++ ) {
                   clusterList[c]->resetClusterHits();
@@ -152,21 +170,30 @@ jerror_t DFCALCluster_factory::evnt(JEventLoop *eventLoop, int eventnumber)
               //cout << "hit: " << ih <<  " E: " << energy << endl;
 	      if (energy < MIN_CLUSTER_SEED_ENERGY)
 		 break;
+	      const vector<unsigned int> &near = hitClusters[ih];
 	      double totalAllowed = 0;
-	      for ( unsigned int c = 0; c < clusterCount; c++ ) {
-		 totalAllowed += clusterList[c]->getEallowed(ih);
-                 //cout << " totalAlowed from clust " << c <<  " is " << totalAllowed << endl;
+	      for ( unsigned int i = 0; i < near.size(); i++ ) {
+		 totalAllowed += clusterList[near[i]]->getEallowed(ih);
+                 //cout << " totalAlowed from clust " << near[i] <<  " is " << totalAllowed << endl;
                  
 	      }
 	      if (energy > totalAllowed) {
-		 clusterList[clusterCount] = new DFCALCluster( hits->nhits );
+		 DFCALCluster *cluster = new DFCALCluster( hits->nhits );
                  hitUsed[ih] = -1;
-		 clusterList[clusterCount]->addHit(ih,1.);
-		 clusterList[clusterCount]->update( hits, fcalFaceZ_TargetIsZeq0 );
+		 cluster->addHit(ih,1.);
+		 cluster->update( hits, fcalFaceZ_TargetIsZeq0, &grid );
+		 clusterList.push_back( cluster );
+		 const vector<int> &profileHits = cluster->getProfileHits();
+		 for ( unsigned int i = 0; i < profileHits.size(); i++ ) {
+		    hitClusters[ profileHits[i] ].push_back( clusterCount );
+		 }
 		 ++clusterCount;
 	      }
 	      else if (iter > 0) {
-		 for ( unsigned int c = 0; c < clusterCount; c++ ) {
+		 // a cluster out of reach of this hit has no energy
+		 // allowed in it and so cannot take it
+		 for ( unsigned int i = 0; i < near.size(); i++ ) {
+		    unsigned int c = near[i];
                     int nh_clust = clusterList[c]->getHits();
                     //cout << " Nhits " << nh_clust << " from clust " << c << " ? " << endl;
 		    if ( nh_clust )
@@ -194,17 +221,19 @@ jerror_t DFCALCluster_factory::evnt(JEventLoop *eventLoop, int eventnumber)
 	   for ( int ih = 0; ih < hits->nhits; ih++ ) {
               if ( hitUsed[ih]  < 0) // cannot share seed 
 		 continue;
+	      const vector<unsigned int> &near = hitClusters[ih];
 	      double totalExpected = 0;
               //cout << " Share hit: " << ih <<  " E: " << hits->hit[ih].E 
 	      //   << " ch: " << hits->hit[ih].ch << " t: " << hits->hit[ih].t
 	      //	   << endl;
-	      for ( unsigned int c = 0; c < clusterCount; c++ ) {
-		 if (clusterList[c]->getHits() > 0) {
-		    totalExpected += clusterList[c]->getEexpected(ih);
+	      for ( unsigned int i = 0; i < near.size(); i++ ) {
+		 if (clusterList[near[i]]->getHits() > 0) {
+		    totalExpected += clusterList[near[i]]->getEexpected(ih);
 		 }
 	      }
               //cout << " totExpected " << totalExpected ;
-	      for ( unsigned int c = 0; c < clusterCount; c++ ) {
+	      for ( unsigned int i = 0; i < near.size(); i++ ) {
+		 unsigned int c = near[i];
 		 if (clusterList[c]->getHits() > 0) {
 		    double expected = clusterList[c]->getEexpected(ih);
                     //cout << " expected " << expected ;
@@ -92,7 +92,6 @@ jerror_t DFDCCathodeCluster_factory::evnt(JEventLoop *eventLoop, int eventNo) {
   vector<const DFDCHit*> allHits;
   vector<const DFDCHit*> uHits;
   vector<const DFDCHit*> vHits;
-  vector<vector<const DFDCHit*> >thisLayer;
   
   try {
     eventLoop->Get(allHits);
@@ -112,77 +111,29 @@ jerror_t DFDCCathodeCluster_factory::evnt(JEventLoop *eventLoop, int eventNo) {
 	}
       }  
     	
-      // Layer by layer, create clusters of U hits.
-      if (uHits.size()>0){
-	thisLayer.clear();
-	vector<const DFDCHit*>::iterator i = uHits.begin();
-	for (int iLayer=1;iLayer<25;iLayer++){
-	  if (i==uHits.end()) break;
-	  
-	  vector<const DFDCHit*> hits;	
-	  float old_time=(*i)->t;
-	  while((i!=uHits.end()) && ((*i)->gLayer == iLayer)){ 
-	    // Look for hits falling within a time slice
-	    if (fabs((*i)->t-old_time)>TIME_SLICE){
-	      // Sort hits by element number
-	      sort(hits.begin(),hits.end(),DFDCHit_element_cmp);
-	      // put into the vector
-	      thisLayer.push_back(hits);
-	      hits.clear();
-	      old_time=(*i)->t;
-	    }
-	    hits.push_back(*i);
-	    
-	    i++;
-	  }
-	  // Sort hits by element number
-	  sort(hits.begin(),hits.end(),DFDCHit_element_cmp);
-	  // add the last vector of hits
-	  thisLayer.push_back(hits);
-	  
-	  // Create clusters from these lists of hits
-	  for (unsigned int k=0;k<thisLayer.size();k++) pique(thisLayer[k]);
-	  
-	  // Clear the hits and layer vectors for the next ones
-	  thisLayer.clear();	
-	  hits.clear();
-	}
+      // Each cathode plane is clustered on its own into its own list.
+      // The lists are then added to _data, U planes first, in the
+      // same order the planes used to be processed in one after the
+      // other.
+      vector<DFDCCathodeCluster*> planeClusters[2][24];
+      vector<const DFDCHit*>::iterator i = uHits.begin();
+      for (int iLayer=1;iLayer<25;iLayer++){
+	if (i==uHits.end()) break;
+	vector<const DFDCHit*>::iterator begin=i;
+	while((i!=uHits.end()) && ((*i)->gLayer == iLayer)) i++;
+	MakeClusters(begin,i,planeClusters[0][iLayer-1]);
       }
-
-      // Layer by layer, create clusters of V hits.
-      if (vHits.size()>0){
-	thisLayer.clear();
-	vector<const DFDCHit*>::iterator i = vHits.begin();
+      i = vHits.begin();
+      for (int iLayer=1;iLayer<25;iLayer++){
+	if (i==vHits.end()) break;
+	vector<const DFDCHit*>::iterator begin=i;
+	while((i!=vHits.end()) && ((*i)->gLayer == iLayer)) i++;
+	MakeClusters(begin,i,planeClusters[1][iLayer-1]);
+      }
+      for (int view=0;view<2;view++){
 	for (int iLayer=1;iLayer<25;iLayer++){
-	  if (i==vHits.end()) break;
-	  
-	  vector<const DFDCHit*> hits;
-	  float old_time=(*i)->t;
-	  while((i!=vHits.end()) && ((*i)->gLayer == iLayer)){
-	    // Look for hits falling within a time slice
-	    if (fabs((*i)->t-old_time)>TIME_SLICE){
-	      // Sort hits by element number
-	      sort(hits.begin(),hits.end(),DFDCHit_element_cmp);
-	      // put into the vector
-	      thisLayer.push_back(hits);
-	      hits.clear();
-	      old_time=(*i)->t;
-	    }
-	    hits.push_back(*i);
-	    
-	    i++;
-	  }
-	  // Sort hits by element number
-	  sort(hits.begin(),hits.end(),DFDCHit_element_cmp);
-	  // add the last vector of hits
-	  thisLayer.push_back(hits);
-	  
-	  // Create clusters from these lists of hits	  		
-	  for (unsigned int k=0;k<thisLayer.size();k++) pique(thisLayer[k]);
-	  
-	  // Clear the hits and layer vectors for the next ones
-	  thisLayer.clear();
-	  hits.clear();
+	  vector<DFDCCathodeCluster*> &clusters=planeClusters[view][iLayer-1];
+	  _data.insert(_data.end(),clusters.begin(),clusters.end());
 	}
       }
       
@@ -200,13 +151,52 @@ jerror_t DFDCCathodeCluster_factory::evnt(JEventLoop *eventLoop, int eventNo) {
   return NOERROR;	
 }			
 
+///
+/// DFDCCathodeCluster_factory::MakeClusters():
+/// makes the clusters of a single cathode plane from its hits, given
+/// in order of time, and adds them to clusters. The hits are split
+/// into slices of TIME_SLICE and each slice is passed to pique().
+///
+void DFDCCathodeCluster_factory::MakeClusters(vector<const DFDCHit*>::iterator begin,
+					      vector<const DFDCHit*>::iterator end,
+					      vector<DFDCCathodeCluster*> &clusters) {
+  vector<vector<const DFDCHit*> >thisLayer;
+  vector<const DFDCHit*> hits;
+  if (begin==end){
+    thisLayer.push_back(hits);
+  }
+  else{
+    float old_time=(*begin)->t;
+    for (vector<const DFDCHit*>::iterator i=begin;i!=end;i++){
+      // Look for hits falling within a time slice
+      if (fabs((*i)->t-old_time)>TIME_SLICE){
+	// Sort hits by element number
+	sort(hits.begin(),hits.end(),DFDCHit_element_cmp);
+	// put into the vector
+	thisLayer.push_back(hits);
+	hits.clear();
+	old_time=(*i)->t;
+      }
+      hits.push_back(*i);
+    }
+    // Sort hits by element number
+    sort(hits.begin(),hits.end(),DFDCHit_element_cmp);
+    // add the last vector of hits
+    thisLayer.push_back(hits);
+  }
+  
+  // Create clusters from these lists of hits
+  for (unsigned int k=0;k<thisLayer.size();k++) pique(thisLayer[k],clusters);
+}
+
 ///
 /// DFDCCathodeCluster_factory::pique():
 /// takes a single layer's worth of cathode hits and attempts to create 
 /// DFDCCathodeClusters by grouping together hits with consecutive strip 
 /// numbers.
 ///
-void DFDCCathodeCluster_factory::pique(vector<const DFDCHit*>& H) {
+void DFDCCathodeCluster_factory::pique(vector<const DFDCHit*>& H,
+				       vector<DFDCCathodeCluster*> &clusters) {
   int width(1);
   float q_tot(0.0);
  
@@ -236,7 +226,7 @@ void DFDCCathodeCluster_factory::pique(vector<const DFDCHit*>& H) {
 	     j <=i ; ++j){
 	  newCluster->members.push_back(*j);
 	}
-	_data.push_back(newCluster);
+	clusters.push_back(newCluster);
       }
       width 		= 1;
       q_tot 		= 0.0;
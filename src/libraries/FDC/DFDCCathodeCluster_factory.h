@@ -43,8 +43,20 @@ class DFDCCathodeCluster_factory : public JFactory<DFDCCathodeCluster> {
 		/// takes a single layer's worth of cathode hits and attempts to 
 		/// create DFDCCathodeClusters
 		/// by grouping together hits with consecutive strip numbers.
+		/// The new clusters are added to clusters.
 		///
-		void pique(vector<const DFDCHit*>& h);
+		void pique(vector<const DFDCHit*>& h,
+			   vector<DFDCCathodeCluster*> &clusters);
+
+		///
+		/// DFDCCathodeCluster_factory::MakeClusters():
+		/// makes the clusters of one cathode plane from its hits (in
+		/// order of time) by splitting them into time slices and
+		/// passing each to pique().
+		///
+		void MakeClusters(vector<const DFDCHit*>::iterator begin,
+				  vector<const DFDCHit*>::iterator end,
+				  vector<DFDCCathodeCluster*> &clusters);
 			
 	protected:
 		///
@@ -34,7 +34,7 @@ class DFDCIntersection_factory:public JFactory<DFDCIntersection>{
 		vector<vector<vector<const DFDCHit*> > > fdchits_by_package; ///< fdchits_by_package[package][layer][hit]
 		double MAX_DIST2;
 
-	vector<vector<DFDCWire*> >fdcwires;
+	vector<vector<const DFDCWire*> >fdcwires; // owned by DGeometry
 	bool USE_FDC, DEBUG_LEVEL;
 
 };
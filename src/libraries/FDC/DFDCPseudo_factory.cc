@@ -66,20 +66,6 @@ DFDCPseudo_factory::DFDCPseudo_factory() {
 /// default destructor -- closes log file
 ///
 DFDCPseudo_factory::~DFDCPseudo_factory() {
-  if (fdcwires.size()){
-    for (unsigned int i=0;i<fdcwires.size();i++){
-      for (unsigned int j=0;j<fdcwires[i].size();j++){
-	delete fdcwires[i][j];
-      }
-    }    
-  }
-  if (fdccathodes.size()){
-    for (unsigned int i=0;i<fdccathodes.size();i++){
-      for (unsigned int j=0;j<fdccathodes[i].size();j++){
-	delete fdccathodes[i][j];
-      }
-    }    
-  }
   //delete _log;
 }
 
@@ -208,21 +194,7 @@ jerror_t DFDCPseudo_factory::brun(JEventLoop *loop, int runnumber)
 }
 
 jerror_t DFDCPseudo_factory::erun(void){
-  if (fdcwires.size()){
-    for (unsigned int i=0;i<fdcwires.size();i++){
-      for (unsigned int j=0;j<fdcwires[i].size();j++){
-	delete fdcwires[i][j];
-      }
-    }    
-  }
   fdcwires.clear();
-  if (fdccathodes.size()){
-    for (unsigned int i=0;i<fdccathodes.size();i++){
-      for (unsigned int j=0;j<fdccathodes[i].size();j++){
-	delete fdccathodes[i][j];
-      }
-    }    
-  }
   fdccathodes.clear();
 
 
@@ -284,22 +256,31 @@ jerror_t DFDCPseudo_factory::evnt(JEventLoop* eventLoop, int eventNo) {
 	vector<const DFDCHit*>::iterator xIt = xHits.begin();
 	
 	// For each layer, get its sets of V, X, and U hits, and then pass them to the geometrical
-	// organization routine, DFDCPseudo_factory::makePseudo()
-	vector<const DFDCCathodeCluster*> oneLayerU;
-	vector<const DFDCCathodeCluster*> oneLayerV;
-	vector<const DFDCHit*> oneLayerX;
+	// organization routine, DFDCPseudo_factory::makePseudo(). The layers
+	// are independent of each other: each one gets its own input and
+	// output lists and the outputs are added to _data in layer order.
+	vector<const DFDCCathodeCluster*> oneLayerU[24];
+	vector<const DFDCCathodeCluster*> oneLayerV[24];
+	vector<const DFDCHit*> oneLayerX[24];
 	for (int iLayer=1; iLayer <= 24; iLayer++) {
 	  for (; ((uIt != uClus.end() && (*uIt)->gLayer == iLayer)); uIt++)
-	    oneLayerU.push_back(*uIt);
+	    oneLayerU[iLayer-1].push_back(*uIt);
 	  for (; ((vIt != vClus.end() && (*vIt)->gLayer == iLayer)); vIt++)
-	    oneLayerV.push_back(*vIt);
+	    oneLayerV[iLayer-1].push_back(*vIt);
 	  for (; ((xIt != xHits.end() && (*xIt)->gLayer == iLayer)); xIt++)
-	    oneLayerX.push_back(*xIt);
-	  if (oneLayerU.size()>0 && oneLayerV.size()>0 && oneLayerX.size()>0)
-	    makePseudo(oneLayerX, oneLayerU, oneLayerV,iLayer, mctrackhits);
-	  oneLayerU.clear();
-	  oneLayerV.clear();
-	  oneLayerX.clear();
+	    oneLayerX[iLayer-1].push_back(*xIt);
+	}
+	vector<DFDCPseudo*> oneLayerPseudos[24];
+	for (int iLayer=1; iLayer <= 24; iLayer++) {
+	  if (oneLayerU[iLayer-1].size()>0 && oneLayerV[iLayer-1].size()>0 
+	      && oneLayerX[iLayer-1].size()>0)
+	    makePseudo(oneLayerX[iLayer-1], oneLayerU[iLayer-1], 
+		       oneLayerV[iLayer-1], iLayer, mctrackhits,
+		       oneLayerPseudos[iLayer-1]);
+	}
+	for (int iLayer=1; iLayer <= 24; iLayer++) {
+	  _data.insert(_data.end(),oneLayerPseudos[iLayer-1].begin(),
+		       oneLayerPseudos[iLayer-1].end());
 	}
 	// Make sure the data are both time- and z-ordered
 	std::sort(_data.begin(),_data.end(),DFDCPseudo_cmp);
@@ -315,9 +296,9 @@ void DFDCPseudo_factory::makePseudo(vector<const DFDCHit*>& x,
 				    vector<const DFDCCathodeCluster*>& u,
 				    vector<const DFDCCathodeCluster*>& v,
 				    int layer,
-				    vector<const DMCTrackHit*> &mctrackhits)
+				    vector<const DMCTrackHit*> &mctrackhits,
+				    vector<DFDCPseudo*> &pseudos)
 {
-  vector<const DFDCHit*>::iterator xIt;
   vector<centroid_t>upeaks;
   vector<centroid_t>vpeaks;
 
@@ -358,143 +339,204 @@ void DFDCPseudo_factory::makePseudo(vector<const DFDCHit*>& x,
     float phi_u=fdccathodes[ind][0]->angle;
     float phi_v=fdccathodes[ind+1][0]->angle;
 
+    // Wires with hits in this layer in order of their position (u),
+    // as (u, index in x). A hit on the same wire as the hit before it
+    // is skipped.
+    vector<pair<double,unsigned int> >wires;
+    int old_wire_num=-1;
+    for (unsigned int k=0;k<x.size();k++){
+      if (x[k]->element<=WIRES_PER_PLANE && x[k]->element>0){
+	if (old_wire_num==x[k]->element) continue;
+	old_wire_num=x[k]->element;
+	wires.push_back(make_pair(fdcwires[ilay][x[k]->element-1]->u,k));
+      } else _DBG_ << "Bad wire " << x[k]->element <<endl;
+    }
+    if (wires.size()==0) return;
+    sort(wires.begin(),wires.end());
+
+    // v centroids in order of position, as (pos, index in vpeaks)
+    vector<pair<double,unsigned int> >vsorted;
+    for (unsigned int j=0;j<vpeaks.size();j++){
+      if (vpeaks[j].pos==vpeaks[j].pos) // skip NaN
+	vsorted.push_back(make_pair(vpeaks[j].pos,j));
+    }
+    sort(vsorted.begin(),vsorted.end());
+
+    // For a given u, the x coordinate from the strips is linear in v.
+    // Only the v centroids for which it lands within the span of the
+    // hit wires (with some margin for rounding) can be matched.
+    double sinPhiU=sin(phi_u);
+    double sinPhiV=sin(phi_v);
+    double denom=cos(phi_v)*sinPhiU-cos(phi_u)*sinPhiV;
+    double x_lo=wires.front().first-WIRE_SPACING;
+    double x_hi=wires.back().first+WIRE_SPACING;
+    vector<unsigned int>vcand;
+    vector<unsigned int>xcand;
+
     //Loop over all u and v centroids looking for matches with wires
-    for (unsigned int i=0;i<upeaks.size();i++){  
-      for (unsigned int j=0;j<vpeaks.size();j++){
+    for (unsigned int i=0;i<upeaks.size();i++){
+      vcand.clear();
+      if (fabs(sinPhiU)>1e-3){
+	double v1=(upeaks[i].pos*sinPhiV-x_lo*denom)/sinPhiU;
+	double v2=(upeaks[i].pos*sinPhiV-x_hi*denom)/sinPhiU;
+	double v_lo=(v1<v2?v1:v2)-STRIP_SPACING;
+	double v_hi=(v1<v2?v2:v1)+STRIP_SPACING;
+	if (!(v_lo<=v_hi)) continue; // NaN
+	vector<pair<double,unsigned int> >::iterator vIt
+	  =lower_bound(vsorted.begin(),vsorted.end(),
+		       make_pair(v_lo,(unsigned int)0));
+	for (;vIt!=vsorted.end() && vIt->first<=v_hi;vIt++){
+	  vcand.push_back(vIt->second);
+	}
+	// Keep the order of the v centroids
+	sort(vcand.begin(),vcand.end());
+      }
+      else{
+	for (unsigned int j=0;j<vpeaks.size();j++) vcand.push_back(j);
+      }
+
+      for (unsigned int jc=0;jc<vcand.size();jc++){
+	unsigned int j=vcand[jc];
 	// In the layer local coordinate system, wires are quantized 
 	// in the x-direction and y is along the wire.
 	double x_from_strips=DFDCGeometry::getXLocalStrips(upeaks[i].pos,phi_u,
 							   vpeaks[j].pos,phi_v);
 	double y_from_strips=DFDCGeometry::getYLocalStrips(upeaks[i].pos,phi_u,
 							   vpeaks[j].pos,phi_v);
-	int old_wire_num=-1;
-	for(xIt=x.begin();xIt!=x.end();xIt++){
-	  if ((*xIt)->element<=WIRES_PER_PLANE && (*xIt)->element>0){
-	    const DFDCWire *wire=fdcwires[layer-1][(*xIt)->element-1];
-	    double x_from_wire=wire->u;
-	    
-	    //printf("xs %f xw %f\n",x_from_strips,x_from_wire);
-
-	    // Test radial value for checking whether or not the hit is within
-	    // the fiducial region of the detector
-	    double r2test=x_from_wire*x_from_wire+y_from_strips*y_from_strips;
-	    double delta_x=x_from_wire-x_from_strips;
-	 
-	    if (old_wire_num==(*xIt)->element) continue;
-	    old_wire_num=(*xIt)->element;
-
-	    if (fabs(delta_x)<0.5*WIRE_SPACING && r2test<r2_out
-		&& r2test>r2_in){
-	      double dt1 = (*xIt)->t - upeaks[i].t;
-	      double dt2 = (*xIt)->t - vpeaks[j].t;
-
-	      //printf("dt1 %f dt2 %f\n",dt1,dt2);
-
-	      if (DEBUG_HISTS){
-		if (layer==1){
-		  dtv_vs_dtu->Fill(dt1,dt2);
-		  tv_vs_tu->Fill(upeaks[i].t, vpeaks[j].t);
-		  u_wire_dt_vs_wire->Fill((*xIt)->element,(*xIt)->t-upeaks[i].t);
-		  v_wire_dt_vs_wire->Fill((*xIt)->element,(*xIt)->t-vpeaks[j].t);
-
-		  
-
-		  int uid=u[upeaks[i].cluster]->members[1]->element;
-		  int vid=v[vpeaks[j].cluster]->members[1]->element;
-
-		  const DFDCCathodeDigiHit *vdigihit;
-		  v[vpeaks[j].cluster]->members[1]->GetSingle(vdigihit);
-		  const DFDCCathodeDigiHit *udigihit;
-		  u[upeaks[i].cluster]->members[1]->GetSingle(udigihit);
-		  if (vdigihit!=NULL && udigihit!=NULL){
-		    int dt=udigihit->pulse_time-vdigihit->pulse_time;
-		    // printf("%d %d\n",udigihit->pulse_time,vdigihit->pulse_time);
-		    uv_dt_vs_u->Fill(uid,dt);
-		    uv_dt_vs_v->Fill(vid,dt);
-		    v_vs_u->Fill(uid,vid);
-		    ut_vs_u->Fill(uid,udigihit->pulse_time);
-		    vt_vs_v->Fill(vid,udigihit->pulse_time);
-		  }
-		  //  Hxy->Fill(x_from_strips,y_from_strips);
+
+	// Hits on wires close to x_from_strips, in their original order
+	xcand.clear();
+	vector<pair<double,unsigned int> >::iterator wIt
+	  =lower_bound(wires.begin(),wires.end(),
+		       make_pair(x_from_strips-WIRE_SPACING,(unsigned int)0));
+	for (;wIt!=wires.end() && wIt->first<=x_from_strips+WIRE_SPACING;wIt++){
+	  xcand.push_back(wIt->second);
+	}
+	sort(xcand.begin(),xcand.end());
+
+	for (unsigned int k=0;k<xcand.size();k++){
+	  const DFDCHit *xhit=x[xcand[k]];
+	  const DFDCWire *wire=fdcwires[layer-1][xhit->element-1];
+	  double x_from_wire=wire->u;
+
+	  //printf("xs %f xw %f\n",x_from_strips,x_from_wire);
+
+	  // Test radial value for checking whether or not the hit is within
+	  // the fiducial region of the detector
+	  double r2test=x_from_wire*x_from_wire+y_from_strips*y_from_strips;
+	  double delta_x=x_from_wire-x_from_strips;
+
+	  if (fabs(delta_x)<0.5*WIRE_SPACING && r2test<r2_out
+	      && r2test>r2_in){
+	    double dt1 = xhit->t - upeaks[i].t;
+	    double dt2 = xhit->t - vpeaks[j].t;
+
+	    //printf("dt1 %f dt2 %f\n",dt1,dt2);
+
+	    if (DEBUG_HISTS){
+	      if (layer==1){
+		dtv_vs_dtu->Fill(dt1,dt2);
+		tv_vs_tu->Fill(upeaks[i].t, vpeaks[j].t);
+		u_wire_dt_vs_wire->Fill(xhit->element,xhit->t-upeaks[i].t);
+		v_wire_dt_vs_wire->Fill(xhit->element,xhit->t-vpeaks[j].t);
+
+
+
+		int uid=u[upeaks[i].cluster]->members[1]->element;
+		int vid=v[vpeaks[j].cluster]->members[1]->element;
+
+		const DFDCCathodeDigiHit *vdigihit;
+		v[vpeaks[j].cluster]->members[1]->GetSingle(vdigihit);
+		const DFDCCathodeDigiHit *udigihit;
+		u[upeaks[i].cluster]->members[1]->GetSingle(udigihit);
+		if (vdigihit!=NULL && udigihit!=NULL){
+		  int dt=udigihit->pulse_time-vdigihit->pulse_time;
+		  // printf("%d %d\n",udigihit->pulse_time,vdigihit->pulse_time);
+		  uv_dt_vs_u->Fill(uid,dt);
+		  uv_dt_vs_v->Fill(vid,dt);
+		  v_vs_u->Fill(uid,vid);
+		  ut_vs_u->Fill(uid,udigihit->pulse_time);
+		  vt_vs_v->Fill(vid,udigihit->pulse_time);
 		}
+		//  Hxy->Fill(x_from_strips,y_from_strips);
 	      }
-	      //	      if (sqrt(dt1*dt1+dt2*dt2)>STRIP_ANODE_TIME_CUT) continue;
-
-	      // Temporary cut until TDC timing is worked out
-	      if (fabs(vpeaks[j].t-upeaks[i].t)>STRIP_ANODE_TIME_CUT) continue;
-
-	      // Charge and energy loss
-	      double q_cathodes=0.5*(upeaks[i].q+vpeaks[j].q);
-	      double charge_to_energy=W_EFF/(GAS_GAIN*ELECTRON_CHARGE);
-	      double dE=charge_to_energy*q_cathodes;
-	      double q_from_pulse_height=5.0e-4*(upeaks[i].q_from_pulse_height
-					      +vpeaks[j].q_from_pulse_height);
-      
-	      if (DEBUG_HISTS){
-		qv_vs_qu->Fill(upeaks[i].q,vpeaks[j].q);
-	      }
-	      
-	      int status=upeaks[i].numstrips+vpeaks[j].numstrips;
-	      //double xres=WIRE_SPACING/2./sqrt(12.);
-	   
-	      DFDCPseudo* newPseu = new DFDCPseudo;     
-	      newPseu->phi_u=phi_u;
-	      newPseu->phi_v=phi_v;
-	      newPseu->u = upeaks[i].pos;
-	      newPseu->v = vpeaks[j].pos;
-	      newPseu->w      = x_from_wire-xshifts[ilay];
-	      newPseu->dw     = 0.; // place holder
-	      newPseu->w_c    = x_from_strips-xshifts[ilay];
-	      newPseu->s      = y_from_strips-yshifts[ilay];
-	      newPseu->ds = FDC_RES_PAR1/q_from_pulse_height+FDC_RES_PAR2;
-	      //newPseu->ds=0.011/q_from_pulse_height+5e-3+2.14e-10*pow(q_from_pulse_height,6);
-	      newPseu->wire   = wire;
-	      //newPseu->time   = (*xIt)->t;
-	      newPseu->time=0.5*(upeaks[i].t+vpeaks[j].t);
-	      newPseu->status = status;
-	      newPseu->itrack = (*xIt)->itrack;
-
-	      newPseu->AddAssociatedObject(v[vpeaks[j].cluster]);
-	      newPseu->AddAssociatedObject(u[upeaks[i].cluster]);
-	      
-	      newPseu->dE = dE;
-	      newPseu->q = q_cathodes;
-	    
-	      // It can occur (although rarely) that newPseu->wire is NULL
-	      // which causes us to crash below. In these cases, we can't really
-	      // make a psuedo point so we delete the current object
-	      // and just go on to the next one.
-	      if(newPseu->wire==NULL){
-		_DBG_<<"newPseu->wire=NULL! This shouldn't happen. Complain to staylor@jlab.org"<<endl;
-		delete newPseu;
-		continue;
-	      }
-	      double sinangle=newPseu->wire->udir(0);
-	      double cosangle=newPseu->wire->udir(1);
-
-	      newPseu->xy.Set((newPseu->w)*cosangle+(newPseu->s)*sinangle,
-			      -(newPseu->w)*sinangle+(newPseu->s)*cosangle);
-
-	      double sigx2=HALF_CELL*HALF_CELL/3.;
-	      double sigy2=MAX_DEFLECTION*MAX_DEFLECTION/3.;
-	      newPseu->covxx=sigx2*cosangle*cosangle+sigy2*sinangle*sinangle;
-	      newPseu->covyy=sigx2*sinangle*sinangle+sigy2*cosangle*cosangle;
-	      newPseu->covxy=(sigy2-sigx2)*sinangle*cosangle;
-									
-	      // Try matching truth hit with this "real" hit.
+	    }
+	    //	      if (sqrt(dt1*dt1+dt2*dt2)>STRIP_ANODE_TIME_CUT) continue;
+
+	    // Temporary cut until TDC timing is worked out
+	    if (fabs(vpeaks[j].t-upeaks[i].t)>STRIP_ANODE_TIME_CUT) continue;
+
+	    // Charge and energy loss
+	    double q_cathodes=0.5*(upeaks[i].q+vpeaks[j].q);
+	    double charge_to_energy=W_EFF/(GAS_GAIN*ELECTRON_CHARGE);
+	    double dE=charge_to_energy*q_cathodes;
+	    double q_from_pulse_height=5.0e-4*(upeaks[i].q_from_pulse_height
+				      +vpeaks[j].q_from_pulse_height);
+
+	    if (DEBUG_HISTS){
+	      qv_vs_qu->Fill(upeaks[i].q,vpeaks[j].q);
+	    }
+
+	    int status=upeaks[i].numstrips+vpeaks[j].numstrips;
+	    //double xres=WIRE_SPACING/2./sqrt(12.);
+
+	    DFDCPseudo* newPseu = new DFDCPseudo;     
+	    newPseu->phi_u=phi_u;
+	    newPseu->phi_v=phi_v;
+	    newPseu->u = upeaks[i].pos;
+	    newPseu->v = vpeaks[j].pos;
+	    newPseu->w      = x_from_wire-xshifts[ilay];
+	    newPseu->dw     = 0.; // place holder
+	    newPseu->w_c    = x_from_strips-xshifts[ilay];
+	    newPseu->s      = y_from_strips-yshifts[ilay];
+	    newPseu->ds = FDC_RES_PAR1/q_from_pulse_height+FDC_RES_PAR2;
+	    //newPseu->ds=0.011/q_from_pulse_height+5e-3+2.14e-10*pow(q_from_pulse_height,6);
+	    newPseu->wire   = wire;
+	    //newPseu->time   = xhit->t;
+	    newPseu->time=0.5*(upeaks[i].t+vpeaks[j].t);
+	    newPseu->status = status;
+	    newPseu->itrack = xhit->itrack;
+
+	    newPseu->AddAssociatedObject(v[vpeaks[j].cluster]);
+	    newPseu->AddAssociatedObject(u[upeaks[i].cluster]);
+
+	    newPseu->dE = dE;
+	    newPseu->q = q_cathodes;
+
+	    // It can occur (although rarely) that newPseu->wire is NULL
+	    // which causes us to crash below. In these cases, we can't really
+	    // make a psuedo point so we delete the current object
+	    // and just go on to the next one.
+	    if(newPseu->wire==NULL){
+	      _DBG_<<"newPseu->wire=NULL! This shouldn't happen. Complain to staylor@jlab.org"<<endl;
+	      delete newPseu;
+	      continue;
+	    }
+	    double sinangle=newPseu->wire->udir(0);
+	    double cosangle=newPseu->wire->udir(1);
+
+	    newPseu->xy.Set((newPseu->w)*cosangle+(newPseu->s)*sinangle,
+		      -(newPseu->w)*sinangle+(newPseu->s)*cosangle);
+
+	    double sigx2=HALF_CELL*HALF_CELL/3.;
+	    double sigy2=MAX_DEFLECTION*MAX_DEFLECTION/3.;
+	    newPseu->covxx=sigx2*cosangle*cosangle+sigy2*sinangle*sinangle;
+	    newPseu->covyy=sigx2*sinangle*sinangle+sigy2*cosangle*cosangle;
+	    newPseu->covxy=(sigy2-sigx2)*sinangle*cosangle;
+
+	    // Try matching truth hit with this "real" hit.
 			const DMCTrackHit *mctrackhit = DTrackHitSelectorTHROWN::GetMCTrackHit(newPseu->wire, DRIFT_SPEED*newPseu->time, mctrackhits);
 			if(mctrackhit)newPseu->AddAssociatedObject(mctrackhit);
 
-	      _data.push_back(newPseu);
+	    pseudos.push_back(newPseu);
 
-	      if (DEBUG_HISTS){
-		Hxy[ilay]->Fill(newPseu->w_c,newPseu->s);
-		if (ilay==6) dx_vs_dE->Fill(q_from_pulse_height,0.2588*delta_x);
-	      }
+	    if (DEBUG_HISTS){
+	      Hxy[ilay]->Fill(newPseu->w_c,newPseu->s);
+	      if (ilay==6) dx_vs_dE->Fill(q_from_pulse_height,0.2588*delta_x);
+	    }
 
-	    } // match in x
-	  } else _DBG_ << "Bad wire " << (*xIt)->element <<endl;
-	} // xIt loop
+	  } // match in x
+	} // xcand loop
       } // vpeaks loop
     } // upeaks loop
   } // if we have peaks in both u and v views
@@ -78,13 +78,15 @@ class DFDCPseudo_factory : public JFactory<DFDCPseudo> {
 
 		/// 
 		/// DFDCPseudo_factory::makePseudo():
-		/// performs UV+X matching to create pseudopoints
+		/// performs UV+X matching to create pseudopoints for one
+		/// layer, adding them to pseudos
 		///
 		void makePseudo( vector<const DFDCHit*>& x,
 				 vector<const DFDCCathodeCluster*>& u,
 				 vector<const DFDCCathodeCluster*>& v,
 				 int layer,
-				 vector<const DMCTrackHit*> &mctrackhits);
+				 vector<const DMCTrackHit*> &mctrackhits,
+				 vector<DFDCPseudo*> &pseudos);
 		
 		///
 		/// DFDCPseudo_factory::CalcMeanTime()
@@ -108,8 +110,8 @@ class DFDCPseudo_factory : public JFactory<DFDCPseudo> {
 					DMatrix3x1 &newpar);
  		
 	private:		
-		vector<vector<DFDCWire*> >fdcwires;
-		vector<vector<DFDCCathode*> >fdccathodes;
+		vector<vector<const DFDCWire*> >fdcwires; // owned by DGeometry
+		vector<vector<const DFDCCathode*> >fdccathodes; // owned by DGeometry
 		vector<double>xshifts;
 		vector<double>yshifts;
 
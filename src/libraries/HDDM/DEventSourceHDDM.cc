@@ -110,6 +110,10 @@ jerror_t DEventSourceHDDM::GetEvent(JEvent &event)
    hddm_s::HDDM *record = new hddm_s::HDDM();
    *fin >> *record;
 
+   pthread_mutex_lock(&rt_mutex);
+   seq_by_event[record] = Nevents_read;
+   pthread_mutex_unlock(&rt_mutex);
+
    int event_number = -1;
    int run_number = -1;
    
@@ -133,10 +137,12 @@ jerror_t DEventSourceHDDM::GetEvent(JEvent &event)
 void DEventSourceHDDM::FreeEvent(JEvent &event)
 {
    hddm_s::HDDM *record = (hddm_s::HDDM*)event.GetRef();
-   delete record;
 
-   // Check for DReferenceTrajectory objects we need to delete
+   // Check for DReferenceTrajectory objects we need to delete. The
+   // record is only deleted once its entries are gone so its address
+   // can't be handed out again by GetEvent while they still exist.
    pthread_mutex_lock(&rt_mutex);
+   seq_by_event.erase(record);
    map<hddm_s::HDDM*, vector<DReferenceTrajectory*> >::iterator iter =
                                               rt_by_event.find(record);
    if(iter != rt_by_event.end()){
@@ -146,6 +152,70 @@ void DEventSourceHDDM::FreeEvent(JEvent &event)
       rt_by_event.erase(iter);
    }
    pthread_mutex_unlock(&rt_mutex);
+
+   delete record;
+}
+
+//----------------
+// GetEventSequence
+//----------------
+unsigned long DEventSourceHDDM::GetEventSequence(hddm_s::HDDM *record)
+{
+   /// Return the position (starting from 1) of the given record in the
+   /// input stream. Programs that process events on several threads
+   /// can use this to write them out again in their original order.
+   /// Returns 0 if the record was not read by this source or has
+   /// already been freed.
+
+   unsigned long seq = 0;
+   pthread_mutex_lock(&rt_mutex);
+   map<hddm_s::HDDM*, unsigned long>::iterator iter = seq_by_event.find(record);
+   if (iter != seq_by_event.end())
+      seq = iter->second;
+   pthread_mutex_unlock(&rt_mutex);
+   return seq;
+}
+
+//----------------
+// ReleaseEventSequence
+//----------------
+void DEventSourceHDDM::ReleaseEventSequence(unsigned long seq)
+{
+   /// Forget the sequence number of a record that will never be freed,
+   /// e.g. because the thread processing it was killed, so that it no
+   /// longer holds back GetOldestLiveSequence. The record itself is
+   /// left alone since the dead thread may still have been using it.
+
+   pthread_mutex_lock(&rt_mutex);
+   map<hddm_s::HDDM*, unsigned long>::iterator iter = seq_by_event.begin();
+   for (; iter != seq_by_event.end(); ++iter) {
+      if (iter->second == seq) {
+         seq_by_event.erase(iter);
+         break;
+      }
+   }
+   pthread_mutex_unlock(&rt_mutex);
+}
+
+//----------------
+// GetOldestLiveSequence
+//----------------
+unsigned long DEventSourceHDDM::GetOldestLiveSequence(void)
+{
+   /// Return the lowest sequence number (see GetEventSequence) of any
+   /// record that has been read but not yet freed. Any record with a
+   /// lower sequence number is guaranteed to be finished with. Returns
+   /// 0 if no records are currently live.
+
+   unsigned long oldest = 0;
+   pthread_mutex_lock(&rt_mutex);
+   map<hddm_s::HDDM*, unsigned long>::iterator iter = seq_by_event.begin();
+   for (; iter != seq_by_event.end(); ++iter) {
+      if (oldest == 0 || iter->second < oldest)
+         oldest = iter->second;
+   }
+   pthread_mutex_unlock(&rt_mutex);
+   return oldest;
 }
 
 //----------------
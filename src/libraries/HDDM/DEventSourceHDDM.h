@@ -78,6 +78,9 @@ class DEventSourceHDDM:public JEventSource
       jerror_t GetEvent(JEvent &event);
       void FreeEvent(JEvent &event);
       jerror_t GetObjects(JEvent &event, JFactory_base *factory);
+      unsigned long GetEventSequence(hddm_s::HDDM *record);
+      unsigned long GetOldestLiveSequence(void);
+      void ReleaseEventSequence(unsigned long seq);
       
       jerror_t Extract_DMCTrackHit(hddm_s::HDDM *record, JFactory<DMCTrackHit> *factory, string tag);
       jerror_t GetCDCTruthHits(hddm_s::HDDM *record, vector<DMCTrackHit*>& data);
@@ -155,6 +158,7 @@ class DEventSourceHDDM:public JEventSource
       pthread_mutex_t rt_mutex;
       map<hddm_s::HDDM*, vector<DReferenceTrajectory*> > rt_by_event;
       list<DReferenceTrajectory*> rt_pool;
+      map<hddm_s::HDDM*, unsigned long> seq_by_event; // order records were read in
 
       map<unsigned int, double> dTargetCenterZMap; //unsigned int is run number
       map<unsigned int, double> dRFBunchPeriodMap; //unsigned int is run number
@@ -17,6 +17,71 @@
 #include <DVector2.h>
 #include <DEventSourceREST.h>
 
+// Factories whose NOT_OBJECT_OWNER flag was set for pooled objects. A
+// JEventLoop always runs on the same thread so this is kept per thread.
+// It is shared by all REST sources so that the flag is cleared no
+// matter which REST file the next event comes from.
+static pthread_key_t flagged_factories_key;
+static pthread_once_t flagged_factories_once = PTHREAD_ONCE_INIT;
+
+static void DeleteFlaggedFactories(void *ptr)
+{
+   delete (std::set<JFactory_base*>*)ptr;
+}
+
+static void MakeFlaggedFactoriesKey(void)
+{
+   pthread_key_create(&flagged_factories_key, DeleteFlaggedFactories);
+}
+
+static std::set<JFactory_base*> &GetFlaggedFactories(void)
+{
+   pthread_once(&flagged_factories_once, MakeFlaggedFactoriesKey);
+   std::set<JFactory_base*> *flagged =
+      (std::set<JFactory_base*>*)pthread_getspecific(flagged_factories_key);
+   if (flagged == NULL) {
+      flagged = new std::set<JFactory_base*>;
+      pthread_setspecific(flagged_factories_key, flagged);
+   }
+   return *flagged;
+}
+
+//----------------
+// DRESTObjectPools
+//----------------
+DRESTObjectPools::DRESTObjectPools(bool enabled)
+{
+   mcreactions.enabled = enabled;
+   rftimes.enabled = enabled;
+   beamphotons.enabled = enabled;
+   mcthrowns.enabled = enabled;
+   schits.enabled = enabled;
+   tofpoints.enabled = enabled;
+   fcalshowers.enabled = enabled;
+   bcalshowers.enabled = enabled;
+   tracks.enabled = enabled;
+   triggers.enabled = enabled;
+   detectormatches.enabled = enabled;
+}
+
+//----------------
+// DRESTObjectPools::Recycle
+//----------------
+void DRESTObjectPools::Recycle(void)
+{
+   mcreactions.Recycle();
+   rftimes.Recycle();
+   beamphotons.Recycle();
+   mcthrowns.Recycle();
+   schits.Recycle();
+   tofpoints.Recycle();
+   fcalshowers.Recycle();
+   bcalshowers.Recycle();
+   tracks.Recycle();
+   triggers.Recycle();
+   detectormatches.Recycle();
+}
+
 //----------------
 // Constructor
 //----------------
@@ -24,6 +89,18 @@ DEventSourceREST::DEventSourceREST(const char* source_name)
  : JEventSource(source_name)
 {
    /// Constructor for DEventSourceREST object
+   POOL_OBJECTS = false;
+   if (gPARMS) {
+      gPARMS->SetDefaultParameter("REST:POOL_OBJECTS", POOL_OBJECTS,
+         "Recycle the objects made from REST records through per-thread"
+         " pools rather than allocating them for every event (default 0)."
+         " The objects are then owned by the source and reused for later"
+         " events, so only set to 1 if no code keeps pointers to them"
+         " beyond the end of the event.");
+   }
+   pthread_key_create(&pools_key, NULL);
+   pthread_mutex_init(&pools_mutex, NULL);
+
    ifs = new std::ifstream(source_name);
    if (ifs && ifs->is_open()) {
       // hddm_r::istream constructor can throw a std::runtime_error
@@ -48,6 +125,50 @@ DEventSourceREST::~DEventSourceREST()
   if (ifs) {
     delete ifs;
   }
+  for (unsigned int i=0; i < all_pools.size(); i++) {
+    delete all_pools[i];
+  }
+  for (unsigned int i=0; i < record_pool.size(); i++) {
+    delete record_pool[i];
+  }
+  pthread_key_delete(pools_key);
+  pthread_mutex_destroy(&pools_mutex);
+}
+
+//----------------
+// GetPools
+//----------------
+DRESTObjectPools *DEventSourceREST::GetPools(void)
+{
+   /// Return the object pools of the calling thread. Each JEventLoop
+   /// processes one event at a time and frees it from the same thread
+   /// so no locking is needed to use them.
+   DRESTObjectPools *pools = (DRESTObjectPools*)pthread_getspecific(pools_key);
+   if (pools == NULL) {
+      pools = new DRESTObjectPools(POOL_OBJECTS);
+      pthread_setspecific(pools_key, pools);
+      pthread_mutex_lock(&pools_mutex);
+      all_pools.push_back(pools);
+      pthread_mutex_unlock(&pools_mutex);
+   }
+   return pools;
+}
+
+//----------------
+// CopyToFactory
+//----------------
+template<class T>
+void DEventSourceREST::CopyToFactory(vector<T*> &data, JFactory<T> *factory)
+{
+   /// Hand the objects to the factory. Pooled objects belong to the
+   /// pool so the factory is told not to delete them. The flag is
+   /// cleared again in GetObjects should this factory ever have to
+   /// make its own objects.
+   if (POOL_OBJECTS && !factory->TestFactoryFlag(JFactory_base::NOT_OBJECT_OWNER)) {
+      factory->SetFactoryFlag(JFactory_base::NOT_OBJECT_OWNER);
+      GetFlaggedFactories().insert(factory);
+   }
+   factory->CopyTo(data);
 }
 
 //----------------
@@ -72,7 +193,18 @@ jerror_t DEventSourceREST::GetEvent(JEvent &event)
       return NO_MORE_EVENTS_IN_SOURCE;
    }
 
-   hddm_r::HDDM *record = new hddm_r::HDDM();
+   // Reuse a record from an event already freed if possible
+   hddm_r::HDDM *record = NULL;
+   pthread_mutex_lock(&pools_mutex);
+   if (!record_pool.empty()) {
+      record = record_pool.back();
+      record_pool.pop_back();
+   }
+   pthread_mutex_unlock(&pools_mutex);
+   if (record == NULL) {
+      record = new hddm_r::HDDM();
+   }
+
    try{
       *fin >> *record;
    }catch(std::runtime_error &e){
@@ -122,7 +254,15 @@ jerror_t DEventSourceREST::GetEvent(JEvent &event)
 void DEventSourceREST::FreeEvent(JEvent &event)
 {
    hddm_r::HDDM *record = (hddm_r::HDDM*)event.GetRef();
-   delete record;
+   if (record) {
+      record->clear();
+      pthread_mutex_lock(&pools_mutex);
+      record_pool.push_back(record);
+      pthread_mutex_unlock(&pools_mutex);
+   }
+
+   // All of the objects made for this thread's event can be reused
+   GetPools()->Recycle();
 }
 
 //----------------
@@ -148,6 +288,12 @@ jerror_t DEventSourceREST::GetObjects(JEvent &event, JFactory_base *factory)
 
    JEventLoop* locEventLoop = event.GetJEventLoop();
    string dataClassName = factory->GetDataClassName();
+
+   // If we took ownership of this factory's objects in an earlier event,
+   // give it back in case it ends up making its own this time.
+   if (POOL_OBJECTS && GetFlaggedFactories().erase(factory) > 0) {
+      factory->ClearFactoryFlag(JFactory_base::NOT_OBJECT_OWNER);
+   }
    
 	//Get target center
 		//multiple reader threads can access this object: need lock
@@ -259,7 +405,7 @@ jerror_t DEventSourceREST::Extract_DMCReaction(hddm_r::HDDM *record,
       if (iter->getJtag() != tag) {
          continue;
       }
-      DMCReaction *mcreaction = new DMCReaction;
+      DMCReaction *mcreaction = GetPools()->mcreactions.Get();
       dmcreactions.push_back(mcreaction);
       mcreaction->type = iter->getType();
       mcreaction->weight = iter->getWeight();
@@ -292,7 +438,7 @@ jerror_t DEventSourceREST::Extract_DMCReaction(hddm_r::HDDM *record,
    }
    
    // Copy into factories
-   factory->CopyTo(dmcreactions);
+   CopyToFactory(dmcreactions, factory);
 
    return NOERROR;
 }
@@ -316,7 +462,7 @@ jerror_t DEventSourceREST::Extract_DRFTime(hddm_r::HDDM *record,
    {
       if (iter->getJtag() != tag)
          continue;
-      DRFTime *locRFTime = new DRFTime;
+      DRFTime *locRFTime = GetPools()->rftimes.Get();
       locRFTime->dTime = iter->getTsync();
       locRFTime->dTimeVariance = 0.0; //SET ME!!
       locRFTimes.push_back(locRFTime);
@@ -325,7 +471,7 @@ jerror_t DEventSourceREST::Extract_DRFTime(hddm_r::HDDM *record,
 	if(!locRFTimes.empty())
 	{
 		//found in the file, copy into factory and return
-		factory->CopyTo(locRFTimes);
+		CopyToFactory(locRFTimes, factory);
 		return NOERROR;
 	}
 
@@ -344,7 +490,7 @@ jerror_t DEventSourceREST::Extract_DRFTime(hddm_r::HDDM *record,
 
 	if(tag == "TRUTH")
 	{
-		DRFTime *locRFTime = new DRFTime;
+		DRFTime *locRFTime = GetPools()->rftimes.Get();
 		locRFTime->dTime = locMCGENPhotons[0]->time();
 		locRFTime->dTimeVariance = 0.0;
 		locRFTimes.push_back(locRFTime);
@@ -368,14 +514,14 @@ jerror_t DEventSourceREST::Extract_DRFTime(hddm_r::HDDM *record,
 		while(locTime < -0.5*locRFBunchPeriod)
 			locTime += locRFBunchPeriod;
 
-		DRFTime *locRFTime = new DRFTime;
+		DRFTime *locRFTime = GetPools()->rftimes.Get();
 		locRFTime->dTime = locTime;
 		locRFTime->dTimeVariance = 0.0;
 		locRFTimes.push_back(locRFTime);
 	}
 
    // Copy into factories
-   factory->CopyTo(locRFTimes);
+   CopyToFactory(locRFTimes, factory);
 
    return NOERROR;
 }
@@ -404,13 +550,13 @@ jerror_t DEventSourceREST::Extract_DBeamPhoton(hddm_r::HDDM *record,
 
 		for(size_t loc_i = 0; loc_i < dmcreactions.size(); ++loc_i)
 		{
-		   DBeamPhoton *beamphoton = new DBeamPhoton;
+		   DBeamPhoton *beamphoton = GetPools()->beamphotons.Get();
 		   *(DKinematicData*)beamphoton = dmcreactions[loc_i]->beam;
 		   dbeam_photons.push_back(beamphoton);
 		}
 
 		// Copy into factories
-		factory->CopyTo(dbeam_photons);
+		CopyToFactory(dbeam_photons, factory);
 
 	   return NOERROR;
 	}
@@ -447,7 +593,7 @@ jerror_t DEventSourceREST::Extract_DBeamPhoton(hddm_r::HDDM *record,
       if (iter->getJtag() != tag)
          continue;
 
-      DBeamPhoton* gamma = new DBeamPhoton();
+      DBeamPhoton* gamma = GetPools()->beamphotons.Get();
 
 		DVector3 mom(0.0, 0.0, iter->getE());
 		gamma->setPID(Gamma);
@@ -476,7 +622,7 @@ jerror_t DEventSourceREST::Extract_DBeamPhoton(hddm_r::HDDM *record,
       if (locTAGMiter->getJtag() != tag)
          continue;
 
-      DBeamPhoton* gamma = new DBeamPhoton();
+      DBeamPhoton* gamma = GetPools()->beamphotons.Get();
 
 		DVector3 mom(0.0, 0.0, locTAGMiter->getE());
 		gamma->setPID(Gamma);
@@ -501,7 +647,7 @@ jerror_t DEventSourceREST::Extract_DBeamPhoton(hddm_r::HDDM *record,
       if (locTAGHiter->getJtag() != tag)
          continue;
 
-      DBeamPhoton* gamma = new DBeamPhoton();
+      DBeamPhoton* gamma = GetPools()->beamphotons.Get();
 
 		DVector3 mom(0.0, 0.0, locTAGHiter->getE());
 		gamma->setPID(Gamma);
@@ -520,7 +666,7 @@ jerror_t DEventSourceREST::Extract_DBeamPhoton(hddm_r::HDDM *record,
 
 
 	// Copy into factories
-	factory->CopyTo(dbeam_photons);
+	CopyToFactory(dbeam_photons, factory);
 
    return NOERROR;
 }
@@ -565,7 +711,7 @@ jerror_t DEventSourceREST::Extract_DMCThrown(hddm_r::HDDM *record,
          if (!isfinite(mass)) {
             mass = 0.0;
          }
-         DMCThrown *mcthrown = new DMCThrown;
+         DMCThrown *mcthrown = GetPools()->mcthrowns.Get();
          int pdgtype = piter->getPdgtype();
          Particle_t ptype = PDGtoPType(pdgtype);
          mcthrown->type = ptype;
@@ -585,7 +731,7 @@ jerror_t DEventSourceREST::Extract_DMCThrown(hddm_r::HDDM *record,
    }
 
    // Copy into factory
-   factory->CopyTo(data);
+   CopyToFactory(data, factory);
 
    return NOERROR;
 }
@@ -614,7 +760,7 @@ jerror_t DEventSourceREST::Extract_DTOFPoint(hddm_r::HDDM *record,
       if (iter->getJtag() != tag) {
          continue;
       }
-      DTOFPoint *tofpoint = new DTOFPoint();
+      DTOFPoint *tofpoint = GetPools()->tofpoints.Get();
       tofpoint->pos = DVector3(iter->getX(),iter->getY(),iter->getZ());
       tofpoint->t = iter->getT();
       tofpoint->dE = iter->getDE();
@@ -648,7 +794,7 @@ jerror_t DEventSourceREST::Extract_DTOFPoint(hddm_r::HDDM *record,
    }
 
    // Copy into factory
-   factory->CopyTo(data);
+   CopyToFactory(data, factory);
 
    return NOERROR;
 }
@@ -677,7 +823,7 @@ jerror_t DEventSourceREST::Extract_DSCHit(hddm_r::HDDM *record,
       if (iter->getJtag() != tag) {
          continue;
       }
-      DSCHit *start = new DSCHit();
+      DSCHit *start = GetPools()->schits.Get();
       start->sector = iter->getSector();
       start->dE = iter->getDE();
       start->t = iter->getT();
@@ -685,7 +831,7 @@ jerror_t DEventSourceREST::Extract_DSCHit(hddm_r::HDDM *record,
    }
 
    // Copy into factory
-   factory->CopyTo(data);
+   CopyToFactory(data, factory);
 
    return NOERROR;
 }
@@ -716,7 +862,7 @@ jerror_t DEventSourceREST::Extract_DFCALShower(hddm_r::HDDM *record,
       if (iter->getJtag() != tag)
          continue;
 
-      DFCALShower *shower = new DFCALShower();
+      DFCALShower *shower = GetPools()->fcalshowers.Get();
       shower->setPosition(DVector3(iter->getX(),iter->getY(),iter->getZ()));
       shower->setPosError(iter->getXerr(),iter->getYerr(),iter->getZerr());
       shower->setEnergy(iter->getE());
@@ -725,7 +871,7 @@ jerror_t DEventSourceREST::Extract_DFCALShower(hddm_r::HDDM *record,
    }
 
    // Copy into factory
-   factory->CopyTo(data);
+   CopyToFactory(data, factory);
 
    return NOERROR;
 }
@@ -755,7 +901,7 @@ jerror_t DEventSourceREST::Extract_DBCALShower(hddm_r::HDDM *record,
       if (iter->getJtag() != tag)
          continue;
 
-      DBCALShower *shower = new DBCALShower();
+      DBCALShower *shower = GetPools()->bcalshowers.Get();
       shower->E = iter->getE();
       shower->E_raw = -1;
       shower->x = iter->getX();
@@ -786,7 +932,7 @@ jerror_t DEventSourceREST::Extract_DBCALShower(hddm_r::HDDM *record,
    }
 
    // Copy into factory
-   factory->CopyTo(data);
+   CopyToFactory(data, factory);
 
    return NOERROR;
 }
@@ -819,7 +965,7 @@ jerror_t DEventSourceREST::Extract_DTrackTimeBased(hddm_r::HDDM *record,
       if (iter->getJtag() != tag) {
          continue;
       }
-      DTrackTimeBased *tra = new DTrackTimeBased();
+      DTrackTimeBased *tra = GetPools()->tracks.Get();
       tra->trackid = 0;
       tra->candidateid = iter->getCandidateId();
       Particle_t ptype = iter->getPtype();
@@ -837,23 +983,23 @@ jerror_t DEventSourceREST::Extract_DTrackTimeBased(hddm_r::HDDM *record,
       DVector3 track_mom(fit.getPx(),fit.getPy(),fit.getPz());
       tra->setPosition(track_pos);
       tra->setMomentum(track_mom);
-      DMatrixDSym mat(5);
-      mat(0,0) = fit.getE11();
-      mat(0,1) = mat(1,0) = fit.getE12();
-      mat(0,2) = mat(2,0) = fit.getE13();
-      mat(0,3) = mat(3,0) = fit.getE14();
-      mat(0,4) = mat(4,0) = fit.getE15();
-      mat(1,1) = fit.getE22();
-      mat(1,2) = mat(2,1) = fit.getE23();
-      mat(1,3) = mat(3,1) = fit.getE24();
-      mat(1,4) = mat(4,1) = fit.getE25();
-      mat(2,2) = fit.getE33();
-      mat(2,3) = mat(3,2) = fit.getE34();
-      mat(2,4) = mat(4,2) = fit.getE35();
-      mat(3,3) = fit.getE44();
-      mat(3,4) = mat(4,3) = fit.getE45();
-      mat(4,4) = fit.getE55();
-      tra->setTrackingErrorMatrix(mat);
+      double C5x5[5][5];
+      C5x5[0][0] = fit.getE11();
+      C5x5[0][1] = C5x5[1][0] = fit.getE12();
+      C5x5[0][2] = C5x5[2][0] = fit.getE13();
+      C5x5[0][3] = C5x5[3][0] = fit.getE14();
+      C5x5[0][4] = C5x5[4][0] = fit.getE15();
+      C5x5[1][1] = fit.getE22();
+      C5x5[1][2] = C5x5[2][1] = fit.getE23();
+      C5x5[1][3] = C5x5[3][1] = fit.getE24();
+      C5x5[1][4] = C5x5[4][1] = fit.getE25();
+      C5x5[2][2] = fit.getE33();
+      C5x5[2][3] = C5x5[3][2] = fit.getE34();
+      C5x5[2][4] = C5x5[4][2] = fit.getE35();
+      C5x5[3][3] = fit.getE44();
+      C5x5[3][4] = C5x5[4][3] = fit.getE45();
+      C5x5[4][4] = fit.getE55();
+      tra->setTrackingErrorMatrix(DMatrixDSym(5, &C5x5[0][0]));
 
       // Convert from cartesian coordinates to the 5x1 state vector corresponding to the tracking error matrix.
       double vect[5];
@@ -870,7 +1016,7 @@ jerror_t DEventSourceREST::Extract_DTrackTimeBased(hddm_r::HDDM *record,
       tra->setTrackingStateVector(vect[0], vect[1], vect[2], vect[3], vect[4]);
 
       // Set the 7x7 covariance matrix.
-      tra->setErrorMatrix(Get7x7ErrorMatrix(tra->mass(), vect, mat));
+      tra->setErrorMatrix(Get7x7ErrorMatrix(tra->mass(), vect, C5x5));
 
 		// Hit layers
       const hddm_r::HitlayersList& locHitlayersList = iter->getHitlayerses();
@@ -932,7 +1078,7 @@ jerror_t DEventSourceREST::Extract_DTrackTimeBased(hddm_r::HDDM *record,
    }
 
    // Copy into factory
-   factory->CopyTo(data);
+   CopyToFactory(data, factory);
 
    return NOERROR;
 }
@@ -962,7 +1108,7 @@ jerror_t DEventSourceREST::Extract_DMCTrigger(hddm_r::HDDM *record,
       if (iter->getJtag() != tag) {
          continue;
       }
-      DMCTrigger *trigger = new DMCTrigger();
+      DMCTrigger *trigger = GetPools()->triggers.Get();
       trigger->L1a_fired = iter->getL1a();
       trigger->L1b_fired = iter->getL1b();
       trigger->L1c_fired = iter->getL1c();
@@ -970,7 +1116,7 @@ jerror_t DEventSourceREST::Extract_DMCTrigger(hddm_r::HDDM *record,
    }
 
    // Copy data to factory
-   factory->CopyTo(data);
+   CopyToFactory(data, factory);
 
    return NOERROR;
 }
@@ -1014,7 +1160,7 @@ jerror_t DEventSourceREST::Extract_DDetectorMatches(JEventLoop* locEventLoop, hd
       if(iter->getJtag() != tag)
          continue;
 
-      DDetectorMatches *locDetectorMatches = new DDetectorMatches();
+      DDetectorMatches *locDetectorMatches = GetPools()->detectormatches.Get();
 
       const hddm_r::BcalMatchParams_v2List &bcalList_v2 = iter->getBcalMatchParams_v2s();
       hddm_r::BcalMatchParams_v2List::iterator bcalIter_v2 = bcalList_v2.begin();
@@ -1192,7 +1338,7 @@ jerror_t DEventSourceREST::Extract_DDetectorMatches(JEventLoop* locEventLoop, hd
    }
 
    // Copy data to factory
-   factory->CopyTo(data);
+   CopyToFactory(data, factory);
 
    return NOERROR;
 }
@@ -1200,10 +1346,11 @@ jerror_t DEventSourceREST::Extract_DDetectorMatches(JEventLoop* locEventLoop, hd
 // Transform the 5x5 tracking error matrix into a 7x7 error matrix in cartesian
 // coordinates.
 // This was copied and transformed from DKinFit.cc
-DMatrixDSym DEventSourceREST::Get7x7ErrorMatrix(double mass, const double vec[5], const DMatrixDSym& C5x5)
+// The similarity transform C' = JCJ^T is done with plain fixed-size arrays
+// so that the only matrix allocated is the one returned.
+DMatrixDSym DEventSourceREST::Get7x7ErrorMatrix(double mass, const double vec[5], const double C5x5[5][5])
 {
-  DMatrixDSym C7x7(7);
-  DMatrix J(7,5);
+  double J[7][5] = {{0.0}};
 
   // State vector
   double q_over_pt=vec[0];
@@ -1217,27 +1364,41 @@ DMatrixDSym DEventSourceREST::Get7x7ErrorMatrix(double mass, const double vec[5]
   double sinphi=sin(phi);
   double q=(q_over_pt>0)?1.:-1.;
 
-  J(0, 0)=-q*pt_sq*cosphi;
-  J(0, 1)=-pt*sinphi;
+  J[0][0]=-q*pt_sq*cosphi;
+  J[0][1]=-pt*sinphi;
   
-  J(1, 0)=-q*pt_sq*sinphi;
-  J(1, 1)=pt*cosphi;
+  J[1][0]=-q*pt_sq*sinphi;
+  J[1][1]=pt*cosphi;
   
-  J(2, 0)=-q*pt_sq*tanl;
-  J(2, 2)=pt;
+  J[2][0]=-q*pt_sq*tanl;
+  J[2][2]=pt;
   
-  J(3, 1)=-D*cosphi;
-  J(3, 3)=-sinphi;
+  J[3][1]=-D*cosphi;
+  J[3][3]=-sinphi;
   
-  J(4, 1)=-D*sinphi;
-  J(4, 3)=cosphi;
+  J[4][1]=-D*sinphi;
+  J[4][3]=cosphi;
   
-  J(5, 4)=1.;
+  J[5][4]=1.;
 
   // C'= JCJ^T
-  DMatrixDSym locTempMatrix = C5x5;
-  C7x7=locTempMatrix.Similarity(J);
+  double JC[7][5];
+  for (int i=0; i<7; i++) {
+    for (int k=0; k<5; k++) {
+      double sum=0.;
+      for (int l=0; l<5; l++) sum+=J[i][l]*C5x5[l][k];
+      JC[i][k]=sum;
+    }
+  }
+  double C7x7[7][7];
+  for (int i=0; i<7; i++) {
+    for (int j=i; j<7; j++) {
+      double sum=0.;
+      for (int k=0; k<5; k++) sum+=JC[i][k]*J[j][k];
+      C7x7[i][j]=C7x7[j][i]=sum;
+    }
+  }
   
-  return C7x7;
+  return DMatrixDSym(7, &C7x7[0][0]);
 }
 
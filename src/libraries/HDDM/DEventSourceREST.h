@@ -10,6 +10,8 @@
 
 #include <vector>
 #include <string>
+#include <set>
+#include <new>
 
 #include <pthread.h>
 
@@ -37,6 +39,64 @@
 #include <DMatrix.h>
 #include <TMath.h>
 
+/// Pool of objects of one type handed out to the factories of a
+/// single processing thread. All of them are given back at once when
+/// the thread's event is freed (see DEventSourceREST::FreeEvent) and
+/// each is reconstructed in place when it is handed out again, so
+/// nothing is allocated once the pool has grown to the size of the
+/// largest event seen.
+template<class T>
+class DRESTObjectPool
+{
+ public:
+   DRESTObjectPool() : enabled(true) {}
+   ~DRESTObjectPool() {
+      for (unsigned int i=0; i < all.size(); i++)
+         delete all[i];
+   }
+
+   T *Get(void) {
+      if (!enabled)
+         return new T();
+      if (available.empty()) {
+         all.push_back(new T());
+         return all.back();
+      }
+      T *obj = available.back();
+      available.pop_back();
+      obj->~T();
+      return new(obj) T();
+   }
+   void Recycle(void) {
+      available.assign(all.begin(), all.end());
+   }
+
+   bool enabled;
+
+ private:
+   std::vector<T*> all;
+   std::vector<T*> available;
+};
+
+class DRESTObjectPools
+{
+ public:
+   DRESTObjectPools(bool enabled);
+   void Recycle(void);
+
+   DRESTObjectPool<DMCReaction> mcreactions;
+   DRESTObjectPool<DRFTime> rftimes;
+   DRESTObjectPool<DBeamPhoton> beamphotons;
+   DRESTObjectPool<DMCThrown> mcthrowns;
+   DRESTObjectPool<DSCHit> schits;
+   DRESTObjectPool<DTOFPoint> tofpoints;
+   DRESTObjectPool<DFCALShower> fcalshowers;
+   DRESTObjectPool<DBCALShower> bcalshowers;
+   DRESTObjectPool<DTrackTimeBased> tracks;
+   DRESTObjectPool<DMCTrigger> triggers;
+   DRESTObjectPool<DDetectorMatches> detectormatches;
+};
+
 class DEventSourceREST:public JEventSource
 {
  public:
@@ -81,11 +141,24 @@ class DEventSourceREST:public JEventSource
                     JFactory<DRFTime>* factory);
 #endif
 
-   DMatrixDSym Get7x7ErrorMatrix(double mass, const double vec[5], const DMatrixDSym& C5x5);
+   static DMatrixDSym Get7x7ErrorMatrix(double mass, const double vec[5], const double C5x5[5][5]);
  private:
    // Warning: Class JEventSource methods must be re-entrant, so do not
    // store any data here that might change from event to event.
 
+   // Objects are recycled through per-thread pools if the
+   // REST:POOL_OBJECTS parameter is set to 1. The hddm_r records
+   // are kept for reuse either way.
+   DRESTObjectPools *GetPools(void);
+   template<class T>
+   void CopyToFactory(std::vector<T*> &data, JFactory<T> *factory);
+
+   bool POOL_OBJECTS;
+   pthread_key_t pools_key;
+   pthread_mutex_t pools_mutex;
+   std::vector<DRESTObjectPools*> all_pools;
+   std::vector<hddm_r::HDDM*> record_pool;
+
 	map<unsigned int, double> dTargetCenterZMap; //unsigned int is run number
 	map<unsigned int, double> dRFBunchPeriodMap; //unsigned int is run number
 
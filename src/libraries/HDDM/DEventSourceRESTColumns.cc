@@ -0,0 +1,871 @@
+//
+// DEventSourceRESTColumns methods
+//
+
+#include <iostream>
+
+#include <JANA/JFactory_base.h>
+#include <JANA/JEventLoop.h>
+#include <JANA/JEvent.h>
+
+#include <DANA/DApplication.h>
+#include <TAGGER/DTAGMGeometry.h>
+#include <TAGGER/DTAGHGeometry.h>
+#include <DMatrix.h>
+#include <TMath.h>
+
+#include "DEventSourceRESTColumns.h"
+#include "DEventSourceREST.h"
+
+using namespace DRESTColumns;
+
+//----------------
+// Constructor
+//----------------
+DEventSourceRESTColumns::DEventSourceRESTColumns(const char* source_name)
+ : JEventSource(source_name),
+   next_chunk(0),
+   next_index(0)
+{
+   /// Constructor for DEventSourceRESTColumns object
+   pthread_mutex_init(&read_mutex, NULL);
+
+   file = new DRESTColumnFile(source_name);
+   if (!file->IsOpen()) {
+      cerr << "DEventSourceRESTColumns: " << file->GetError() << endl;
+   }
+
+   // Columns missing from the file are simply left empty
+   for (int i=0; i < kNcolumns; i++) {
+      columns[i] = file->FindColumn(COLUMNS[i].name);
+   }
+   run_column = file->FindColumn("event.run");
+   event_column = file->FindColumn("event.number");
+}
+
+//----------------
+// Destructor
+//----------------
+DEventSourceRESTColumns::~DEventSourceRESTColumns()
+{
+   delete file;
+   pthread_mutex_destroy(&read_mutex);
+}
+
+//----------------
+// GetEvent
+//----------------
+jerror_t DEventSourceRESTColumns::GetEvent(JEvent &event)
+{
+   /// Implementation of JEventSource virtual function. Nothing is
+   /// read here apart from the run and event numbers.
+
+   if (!file->IsOpen()) {
+      return EVENT_SOURCE_NOT_OPEN;
+   }
+
+   event_ref_t *ref = new event_ref_t;
+   pthread_mutex_lock(&read_mutex);
+   while (next_chunk < file->GetNchunks() &&
+          next_index >= file->GetNevents(next_chunk))
+   {
+      next_chunk++;
+      next_index = 0;
+   }
+   if (next_chunk >= file->GetNchunks()) {
+      pthread_mutex_unlock(&read_mutex);
+      delete ref;
+      return NO_MORE_EVENTS_IN_SOURCE;
+   }
+   ref->chunk = next_chunk;
+   ref->index = next_index++;
+   pthread_mutex_unlock(&read_mutex);
+
+   uint32_t Nrun, Nevt;
+   const int32_t *run = file->GetColumn<int32_t>(ref->chunk, run_column, Nrun);
+   const int32_t *evt = file->GetColumn<int32_t>(ref->chunk, event_column, Nevt);
+   event.SetEventNumber((evt && ref->index < Nevt)? evt[ref->index] : 0);
+   event.SetRunNumber((run && ref->index < Nrun)? run[ref->index] : 0);
+   event.SetJEventSource(this);
+   event.SetRef(ref);
+   ++Nevents_read;
+
+   return NOERROR;
+}
+
+//----------------
+// FreeEvent
+//----------------
+void DEventSourceRESTColumns::FreeEvent(JEvent &event)
+{
+   event_ref_t *ref = (event_ref_t*)event.GetRef();
+   delete ref;
+}
+
+//----------------
+// GetRows
+//----------------
+bool DEventSourceRESTColumns::GetRows(const event_ref_t *ref,
+                                      column_id_t offsets,
+                                      unsigned int &begin, unsigned int &end)
+{
+   uint32_t Nentries;
+   const uint32_t *off = file->GetColumn<uint32_t>(ref->chunk,
+                                                   columns[offsets], Nentries);
+   if (off == NULL) {
+      begin = end = 0;
+      return false;
+   }
+   if (Nentries < ref->index + 2) {
+      Corrupt(ref, string(COLUMNS[offsets].name) + " is too short");
+   }
+   begin = off[ref->index];
+   end = off[ref->index + 1];
+   if (begin > end) {
+      Corrupt(ref, string(COLUMNS[offsets].name) + " is out of order");
+   }
+   return true;
+}
+
+//----------------
+// Corrupt
+//----------------
+void DEventSourceRESTColumns::Corrupt(const event_ref_t *ref,
+                                      const string &what)
+{
+   /// A row or match index in the file points outside of the data it
+   /// refers to. This only happens if the file is truncated or damaged
+   /// so give up on the event rather than read past the end.
+   cerr << "DEventSourceRESTColumns: " << source_name << " is corrupt"
+        << " (chunk " << ref->chunk << ", event " << ref->index << "): "
+        << what << endl;
+   throw VALUE_OUT_OF_RANGE;
+}
+
+//----------------
+// GetObjects
+//----------------
+jerror_t DEventSourceRESTColumns::GetObjects(JEvent &event, JFactory_base *factory)
+{
+   /// This gets called through the virtual method of the
+   /// JEventSource base class. It creates the objects of the type
+   /// on which factory is based from the columns of the event
+   /// kept in the ref field of the JEvent object passed.
+
+   // We must have a factory to hold the data
+   if (!factory) {
+      throw RESOURCE_UNAVAILABLE;
+   }
+
+   const event_ref_t *ref = (const event_ref_t*)event.GetRef();
+   if (!ref) {
+      throw RESOURCE_UNAVAILABLE;
+   }
+
+   // Only the untagged objects are stored in the column files
+   string tag = (factory->Tag())? factory->Tag() : "";
+   if (tag != "") {
+      return OBJECT_NOT_AVAILABLE;
+   }
+
+   JEventLoop* locEventLoop = event.GetJEventLoop();
+   string dataClassName = factory->GetDataClassName();
+
+   if (dataClassName =="DRFTime") {
+      return Extract_DRFTime(ref,
+                     dynamic_cast<JFactory<DRFTime>*>(factory));
+   }
+   if (dataClassName =="DBeamPhoton") {
+      return Extract_DBeamPhoton(ref,
+                     dynamic_cast<JFactory<DBeamPhoton>*>(factory),
+                     locEventLoop);
+   }
+   if (dataClassName =="DTOFPoint") {
+      return Extract_DTOFPoint(ref,
+                     dynamic_cast<JFactory<DTOFPoint>*>(factory));
+   }
+   if (dataClassName =="DSCHit") {
+      return Extract_DSCHit(ref,
+                     dynamic_cast<JFactory<DSCHit>*>(factory));
+   }
+   if (dataClassName =="DFCALShower") {
+      return Extract_DFCALShower(ref,
+                     dynamic_cast<JFactory<DFCALShower>*>(factory));
+   }
+   if (dataClassName =="DBCALShower") {
+      return Extract_DBCALShower(ref,
+                     dynamic_cast<JFactory<DBCALShower>*>(factory));
+   }
+   if (dataClassName =="DTrackTimeBased") {
+      return Extract_DTrackTimeBased(ref,
+                     dynamic_cast<JFactory<DTrackTimeBased>*>(factory));
+   }
+   if (dataClassName =="DMCTrigger") {
+      return Extract_DMCTrigger(ref,
+                     dynamic_cast<JFactory<DMCTrigger>*>(factory));
+   }
+   if (dataClassName =="DDetectorMatches") {
+      return Extract_DDetectorMatches(ref,
+                     dynamic_cast<JFactory<DDetectorMatches>*>(factory),
+                     locEventLoop);
+   }
+
+   return OBJECT_NOT_AVAILABLE;
+}
+
+//------------------
+// Extract_DRFTime
+//------------------
+jerror_t DEventSourceRESTColumns::Extract_DRFTime(const event_ref_t *ref,
+                                   JFactory<DRFTime> *factory)
+{
+   if (factory==NULL)
+      return OBJECT_NOT_AVAILABLE;
+
+   unsigned int begin, end;
+   GetRows(ref, kRFOffsets, begin, end);
+   if (begin == end) {
+      // The REST source makes one from the generated beam photon
+      // for simulated data but that is not kept in these files.
+      return OBJECT_NOT_AVAILABLE;
+   }
+   const float *tsync = Column<float>(ref, kRFTsync, begin, end);
+
+   vector<DRFTime*> data;
+   for (unsigned int i=begin; i < end; i++) {
+      DRFTime *locRFTime = new DRFTime;
+      locRFTime->dTime = tsync[i];
+      locRFTime->dTimeVariance = 0.0; //SET ME!!
+      data.push_back(locRFTime);
+   }
+
+   // Copy into factory
+   factory->CopyTo(data);
+
+   return NOERROR;
+}
+
+//------------------
+// Extract_DBeamPhoton
+//------------------
+jerror_t DEventSourceRESTColumns::Extract_DBeamPhoton(const event_ref_t *ref,
+                                   JFactory<DBeamPhoton> *factory,
+                                   JEventLoop *eventLoop)
+{
+   if (factory==NULL)
+      return OBJECT_NOT_AVAILABLE;
+
+   vector<DBeamPhoton*> data;
+
+   unsigned int begin, end;
+   GetRows(ref, kTaggerOffsets, begin, end);
+   if (begin == end) {
+      factory->CopyTo(data);
+      return NOERROR;
+   }
+   const float *E = Column<float>(ref, kTaggerE, begin, end);
+   const float *t = Column<float>(ref, kTaggerT, begin, end);
+   const int32_t *system = Column<int32_t>(ref, kTaggerSystem, begin, end);
+
+   // Target center, looked up once per run. Multiple reader
+   // threads can access the map so it needs the lock.
+   unsigned int locRunNumber = eventLoop->GetJEvent().GetRunNumber();
+   double locTargetCenterZ = 0.0;
+   bool locNewRunNumber = false;
+   LockRead();
+   {
+      std::map<unsigned int, double>::iterator iter = dTargetCenterZMap.find(locRunNumber);
+      locNewRunNumber = (iter == dTargetCenterZMap.end());
+      if (!locNewRunNumber)
+         locTargetCenterZ = iter->second;
+   }
+   UnlockRead();
+   if (locNewRunNumber) {
+      DApplication* dapp = dynamic_cast<DApplication*>(eventLoop->GetJApplication());
+      DGeometry* locGeometry = dapp->GetDGeometry(locRunNumber);
+      locGeometry->GetTargetZ(locTargetCenterZ);
+      LockRead();
+      {
+         dTargetCenterZMap[locRunNumber] = locTargetCenterZ;
+      }
+      UnlockRead();
+   }
+   DVector3 pos(0.0, 0.0, locTargetCenterZ);
+
+   // The old taggerHit elements did not say which tagger they came
+   // from so that has to be worked out from the energy.
+   const DTAGMGeometry* tagmGeom = NULL;
+   for (unsigned int i=begin; i < end; i++) {
+      if (system[i] == 0) {
+         vector<const DTAGMGeometry*> tagmGeomVect;
+         eventLoop->Get(tagmGeomVect, "mc");
+         if (tagmGeomVect.size() < 1)
+            return OBJECT_NOT_AVAILABLE;
+         tagmGeom = tagmGeomVect[0];
+         break;
+      }
+   }
+
+   for (unsigned int i=begin; i < end; i++) {
+      DBeamPhoton *gamma = new DBeamPhoton;
+
+      DVector3 mom(0.0, 0.0, E[i]);
+      gamma->setPID(Gamma);
+      gamma->setMomentum(mom);
+      gamma->setPosition(pos);
+      gamma->setCharge(0);
+      gamma->setMass(0);
+      gamma->setTime(t[i]);
+
+      bool is_tagm = (system[i] == 1);
+      if (system[i] == 0) {
+         unsigned int locCounter = 0;
+         is_tagm = tagmGeom->E_to_column(E[i], locCounter);
+      }
+      if (is_tagm)
+         gamma->setT0(t[i], 0.200, SYS_TAGM);
+      else
+         gamma->setT0(t[i], 0.350, SYS_TAGH);
+
+      data.push_back(gamma);
+   }
+
+   // Copy into factory
+   factory->CopyTo(data);
+
+   return NOERROR;
+}
+
+//------------------
+// Extract_DTOFPoint
+//------------------
+jerror_t DEventSourceRESTColumns::Extract_DTOFPoint(const event_ref_t *ref,
+                                   JFactory<DTOFPoint>* factory)
+{
+   if (factory==NULL) {
+      return OBJECT_NOT_AVAILABLE;
+   }
+
+   vector<DTOFPoint*> data;
+
+   unsigned int begin, end;
+   GetRows(ref, kTOFOffsets, begin, end);
+   const float *x = Column<float>(ref, kTOFX, begin, end);
+   const float *y = Column<float>(ref, kTOFY, begin, end);
+   const float *z = Column<float>(ref, kTOFZ, begin, end);
+   const float *t = Column<float>(ref, kTOFT, begin, end);
+   const float *dE = Column<float>(ref, kTOFdE, begin, end);
+   const float *terr = Column<float>(ref, kTOFTerr, begin, end);
+   const int32_t *status = Column<int32_t>(ref, kTOFStatus, begin, end);
+   for (unsigned int i=begin; i < end; i++) {
+      DTOFPoint *tofpoint = new DTOFPoint;
+      tofpoint->pos = DVector3(x[i], y[i], z[i]);
+      tofpoint->t = t[i];
+      tofpoint->dE = dE[i];
+      tofpoint->tErr = terr[i];
+
+      // status = horizontal_bar + 45*vertical_bar + 45*45*horizontal_status + 45*45*4*vertical_status
+      int locStatus = status[i];
+      if (locStatus < 0) {
+         tofpoint->dHorizontalBar = 0;
+         tofpoint->dVerticalBar = 0;
+         tofpoint->dHorizontalBarStatus = 3;
+         tofpoint->dVerticalBarStatus = 3;
+      }
+      else {
+         tofpoint->dVerticalBarStatus = locStatus/(45*45*4);
+         locStatus %= 45*45*4;
+         tofpoint->dHorizontalBarStatus = locStatus/(45*45);
+         locStatus %= 45*45;
+         tofpoint->dVerticalBar = locStatus/45;
+         tofpoint->dHorizontalBar = locStatus % 45;
+      }
+
+      data.push_back(tofpoint);
+   }
+
+   // Copy into factory
+   factory->CopyTo(data);
+
+   return NOERROR;
+}
+
+//------------------
+// Extract_DSCHit
+//------------------
+jerror_t DEventSourceRESTColumns::Extract_DSCHit(const event_ref_t *ref,
+                                   JFactory<DSCHit>* factory)
+{
+   if (factory==NULL) {
+      return OBJECT_NOT_AVAILABLE;
+   }
+
+   vector<DSCHit*> data;
+
+   unsigned int begin, end;
+   GetRows(ref, kSCOffsets, begin, end);
+   const int32_t *sector = Column<int32_t>(ref, kSCSector, begin, end);
+   const float *dE = Column<float>(ref, kSCdE, begin, end);
+   const float *t = Column<float>(ref, kSCT, begin, end);
+   for (unsigned int i=begin; i < end; i++) {
+      DSCHit *start = new DSCHit;
+      start->sector = sector[i];
+      start->dE = dE[i];
+      start->t = t[i];
+      data.push_back(start);
+   }
+
+   // Copy into factory
+   factory->CopyTo(data);
+
+   return NOERROR;
+}
+
+//-----------------------
+// Extract_DFCALShower
+//-----------------------
+jerror_t DEventSourceRESTColumns::Extract_DFCALShower(const event_ref_t *ref,
+                                   JFactory<DFCALShower>* factory)
+{
+   if (factory==NULL) {
+      return OBJECT_NOT_AVAILABLE;
+   }
+
+   vector<DFCALShower*> data;
+
+   unsigned int begin, end;
+   GetRows(ref, kFCALOffsets, begin, end);
+   const float *x = Column<float>(ref, kFCALX, begin, end);
+   const float *y = Column<float>(ref, kFCALY, begin, end);
+   const float *z = Column<float>(ref, kFCALZ, begin, end);
+   const float *t = Column<float>(ref, kFCALT, begin, end);
+   const float *E = Column<float>(ref, kFCALE, begin, end);
+   const float *xerr = Column<float>(ref, kFCALXerr, begin, end);
+   const float *yerr = Column<float>(ref, kFCALYerr, begin, end);
+   const float *zerr = Column<float>(ref, kFCALZerr, begin, end);
+   for (unsigned int i=begin; i < end; i++) {
+      DFCALShower *shower = new DFCALShower;
+      shower->setPosition(DVector3(x[i], y[i], z[i]));
+      shower->setPosError(xerr[i], yerr[i], zerr[i]);
+      shower->setEnergy(E[i]);
+      shower->setTime(t[i]);
+      data.push_back(shower);
+   }
+
+   // Copy into factory
+   factory->CopyTo(data);
+
+   return NOERROR;
+}
+
+//-----------------------
+// Extract_DBCALShower
+//-----------------------
+jerror_t DEventSourceRESTColumns::Extract_DBCALShower(const event_ref_t *ref,
+                                   JFactory<DBCALShower>* factory)
+{
+   if (factory==NULL) {
+      return OBJECT_NOT_AVAILABLE;
+   }
+
+   vector<DBCALShower*> data;
+
+   unsigned int begin, end;
+   GetRows(ref, kBCALOffsets, begin, end);
+   const float *x = Column<float>(ref, kBCALX, begin, end);
+   const float *y = Column<float>(ref, kBCALY, begin, end);
+   const float *z = Column<float>(ref, kBCALZ, begin, end);
+   const float *t = Column<float>(ref, kBCALT, begin, end);
+   const float *E = Column<float>(ref, kBCALE, begin, end);
+   const float *xerr = Column<float>(ref, kBCALXerr, begin, end);
+   const float *yerr = Column<float>(ref, kBCALYerr, begin, end);
+   const float *zerr = Column<float>(ref, kBCALZerr, begin, end);
+   const float *terr = Column<float>(ref, kBCALTerr, begin, end);
+   const int32_t *ncell = Column<int32_t>(ref, kBCALNcell, begin, end);
+   for (unsigned int i=begin; i < end; i++) {
+      DBCALShower *shower = new DBCALShower;
+      shower->E = E[i];
+      shower->E_raw = -1;
+      shower->x = x[i];
+      shower->y = y[i];
+      shower->z = z[i];
+      shower->t = t[i];
+      shower->xErr = xerr[i];
+      shower->yErr = yerr[i];
+      shower->zErr = zerr[i];
+      shower->tErr = terr[i];
+      shower->N_cell = ncell[i];
+      data.push_back(shower);
+   }
+
+   // Copy into factory
+   factory->CopyTo(data);
+
+   return NOERROR;
+}
+
+//--------------------------------
+// Extract_DTrackTimeBased
+//--------------------------------
+jerror_t DEventSourceRESTColumns::Extract_DTrackTimeBased(const event_ref_t *ref,
+                                   JFactory<DTrackTimeBased>* factory)
+{
+   if (factory==NULL) {
+      return OBJECT_NOT_AVAILABLE;
+   }
+
+   vector<DTrackTimeBased*> data;
+
+   unsigned int begin, end;
+   GetRows(ref, kTrackOffsets, begin, end);
+   if (begin == end) {
+      factory->CopyTo(data);
+      return NOERROR;
+   }
+   const int32_t *candidateId = Column<int32_t>(ref, kTrackCandidateId, begin, end);
+   const int32_t *ptype = Column<int32_t>(ref, kTrackPtype, begin, end);
+   const int32_t *Ndof = Column<int32_t>(ref, kTrackNdof, begin, end);
+   const float *chisq = Column<float>(ref, kTrackChisq, begin, end);
+   const float *x0 = Column<float>(ref, kTrackX0, begin, end);
+   const float *y0 = Column<float>(ref, kTrackY0, begin, end);
+   const float *z0 = Column<float>(ref, kTrackZ0, begin, end);
+   const float *px = Column<float>(ref, kTrackPx, begin, end);
+   const float *py = Column<float>(ref, kTrackPy, begin, end);
+   const float *pz = Column<float>(ref, kTrackPz, begin, end);
+   const float *t0 = Column<float>(ref, kTrackT0, begin, end);
+   const float *t0err = Column<float>(ref, kTrackT0err, begin, end);
+   const int32_t *t0det = Column<int32_t>(ref, kTrackT0det, begin, end);
+   const int32_t *CDCrings = Column<int32_t>(ref, kTrackCDCrings, begin, end);
+   const int32_t *FDCplanes = Column<int32_t>(ref, kTrackFDCplanes, begin, end);
+   const int32_t *mcmatch = Column<int32_t>(ref, kTrackMcmatch, begin, end);
+   const int32_t *ithrown = Column<int32_t>(ref, kTrackIthrown, begin, end);
+   const int32_t *numhitsmatch = Column<int32_t>(ref, kTrackNumhitsmatch, begin, end);
+   const int32_t *NsampleFDC = Column<int32_t>(ref, kTrackNsampleFDC, begin, end);
+   const float *dxFDC = Column<float>(ref, kTrackDxFDC, begin, end);
+   const float *dEdxFDC = Column<float>(ref, kTrackDEdxFDC, begin, end);
+   const int32_t *NsampleCDC = Column<int32_t>(ref, kTrackNsampleCDC, begin, end);
+   const float *dxCDC = Column<float>(ref, kTrackDxCDC, begin, end);
+   const float *dEdxCDC = Column<float>(ref, kTrackDEdxCDC, begin, end);
+
+   // The 15 independent elements of the covariance matrix are
+   // stored as consecutive columns e11, e12, ... e55.
+   const float *e[15];
+   for (int k=0; k < 15; k++) {
+      e[k] = Column<float>(ref, (column_id_t)(kTrackE11 + k), begin, end);
+   }
+
+   for (unsigned int i=begin; i < end; i++) {
+      DTrackTimeBased *tra = new DTrackTimeBased;
+      tra->trackid = 0;
+      tra->candidateid = candidateId[i];
+      Particle_t locPID = (Particle_t)ptype[i];
+      tra->setMass(ParticleMass(locPID));
+      tra->setCharge(ParticleCharge(locPID));
+      tra->setPID(locPID);
+
+      tra->Ndof = Ndof[i];
+      tra->chisq = chisq[i];
+      tra->FOM = TMath::Prob(tra->chisq, tra->Ndof);
+      tra->setT0(t0[i], t0err[i], (DetectorSystem_t)t0det[i]);
+      tra->setTime(t0[i]);
+      DVector3 track_pos(x0[i], y0[i], z0[i]);
+      DVector3 track_mom(px[i], py[i], pz[i]);
+      tra->setPosition(track_pos);
+      tra->setMomentum(track_mom);
+
+      double C5x5[5][5];
+      int k = 0;
+      for (int row=0; row < 5; row++) {
+         for (int col=row; col < 5; col++, k++) {
+            C5x5[row][col] = C5x5[col][row] = e[k][i];
+         }
+      }
+      tra->setTrackingErrorMatrix(DMatrixDSym(5, &C5x5[0][0]));
+
+      // Convert from cartesian coordinates to the 5x1 state vector corresponding to the tracking error matrix.
+      double vect[5];
+      vect[2]=tan(M_PI_2 - track_mom.Theta());
+      vect[1]=track_mom.Phi();
+      double sinphi=sin(vect[1]);
+      double cosphi=cos(vect[1]);
+      vect[0]=tra->charge()/track_mom.Perp();
+      vect[4]=track_pos.Z();
+      vect[3]=track_pos.Perp();
+
+      if ((track_pos.X() > 0 && sinphi>0) || (track_pos.Y() <0 && cosphi>0) || (track_pos.Y() >0 && cosphi<0) || (track_pos.X() <0 && sinphi<0))
+        vect[3] *= -1.;
+      tra->setTrackingStateVector(vect[0], vect[1], vect[2], vect[3], vect[4]);
+
+      // Set the 7x7 covariance matrix.
+      tra->setErrorMatrix(DEventSourceREST::Get7x7ErrorMatrix(tra->mass(), vect, C5x5));
+
+      // Hit layers
+      tra->dCDCRings = CDCrings[i];
+      tra->dFDCPlanes = FDCplanes[i];
+
+      // MC match hit info
+      if (mcmatch[i]) {
+         tra->dMCThrownMatchMyID = ithrown[i];
+         tra->dNumHitsMatchedToThrown = numhitsmatch[i];
+      }
+
+      // drift chamber dE/dx information
+      tra->dNumHitsUsedFordEdx_FDC = NsampleFDC[i];
+      tra->dNumHitsUsedFordEdx_CDC = NsampleCDC[i];
+      tra->ddEdx_FDC = dEdxFDC[i];
+      tra->ddEdx_CDC = dEdxCDC[i];
+      tra->ddx_FDC = dxFDC[i];
+      tra->ddx_CDC = dxCDC[i];
+      tra->setdEdx((tra->dNumHitsUsedFordEdx_CDC >= tra->dNumHitsUsedFordEdx_FDC) ? tra->ddEdx_CDC : tra->ddEdx_FDC);
+
+      data.push_back(tra);
+   }
+
+   // Copy into factory
+   factory->CopyTo(data);
+
+   return NOERROR;
+}
+
+//--------------------------------
+// Extract_DMCTrigger
+//--------------------------------
+jerror_t DEventSourceRESTColumns::Extract_DMCTrigger(const event_ref_t *ref,
+                                   JFactory<DMCTrigger>* factory)
+{
+   if (factory == NULL) {
+     return OBJECT_NOT_AVAILABLE;
+   }
+
+   vector<DMCTrigger*> data;
+
+   unsigned int begin, end;
+   GetRows(ref, kTriggerOffsets, begin, end);
+   const int32_t *L1a = Column<int32_t>(ref, kTriggerL1a, begin, end);
+   const int32_t *L1b = Column<int32_t>(ref, kTriggerL1b, begin, end);
+   const int32_t *L1c = Column<int32_t>(ref, kTriggerL1c, begin, end);
+   for (unsigned int i=begin; i < end; i++) {
+      DMCTrigger *trigger = new DMCTrigger;
+      trigger->L1a_fired = L1a[i];
+      trigger->L1b_fired = L1b[i];
+      trigger->L1c_fired = L1c[i];
+      data.push_back(trigger);
+   }
+
+   // Copy data to factory
+   factory->CopyTo(data);
+
+   return NOERROR;
+}
+
+//--------------------------------
+// Extract_DDetectorMatches
+//--------------------------------
+jerror_t DEventSourceRESTColumns::Extract_DDetectorMatches(const event_ref_t *ref,
+                                   JFactory<DDetectorMatches>* factory,
+                                   JEventLoop *locEventLoop)
+{
+   if (factory==NULL)
+     return OBJECT_NOT_AVAILABLE;
+
+   vector<DDetectorMatches*> data;
+
+   unsigned int begin, end;
+   GetRows(ref, kMatchesOffsets, begin, end);
+   if (begin == end) {
+      factory->CopyTo(data);
+      return NOERROR;
+   }
+
+   vector<const DTrackTimeBased*> locTrackTimeBasedVector;
+   locEventLoop->Get(locTrackTimeBasedVector);
+
+   vector<const DSCHit*> locSCHits;
+   locEventLoop->Get(locSCHits);
+
+   vector<const DTOFPoint*> locTOFPoints;
+   locEventLoop->Get(locTOFPoints);
+
+   vector<const DBCALShower*> locBCALShowers;
+   locEventLoop->Get(locBCALShowers);
+
+   vector<const DFCALShower*> locFCALShowers;
+   locEventLoop->Get(locFCALShowers);
+
+   DDetectorMatches *locDetectorMatches = new DDetectorMatches;
+
+   // The file is checked while the matches are filled in so don't
+   // leave them behind if it turns out to be damaged.
+   try {
+      GetRows(ref, kBCALMatchOffsets, begin, end);
+      if (begin < end) {
+         const int32_t *track = Column<int32_t>(ref, kBCALMatchTrack, begin, end);
+         const int32_t *shower = Column<int32_t>(ref, kBCALMatchShower, begin, end);
+         const float *dx = Column<float>(ref, kBCALMatchDx, begin, end);
+         const float *deltaphi = Column<float>(ref, kBCALMatchDeltaphi, begin, end);
+         const float *deltaz = Column<float>(ref, kBCALMatchDeltaz, begin, end);
+         const float *pathlength = Column<float>(ref, kBCALMatchPathlength, begin, end);
+         const float *tflight = Column<float>(ref, kBCALMatchTflight, begin, end);
+         const float *tflightvar = Column<float>(ref, kBCALMatchTflightvar, begin, end);
+         for (unsigned int i=begin; i < end; i++) {
+            CheckIndex(ref, track[i], locTrackTimeBasedVector.size(), kBCALMatchTrack);
+            CheckIndex(ref, shower[i], locBCALShowers.size(), kBCALMatchShower);
+            const DTrackTimeBased *locTrack = locTrackTimeBasedVector[track[i]];
+            const DBCALShower *locShower = locBCALShowers[shower[i]];
+
+            DBCALShowerMatchParams locShowerMatchParams;
+            locShowerMatchParams.dTrack = locTrack;
+            locShowerMatchParams.dBCALShower = locShower;
+            locShowerMatchParams.dx = dx[i];
+            locShowerMatchParams.dFlightTime = tflight[i];
+            locShowerMatchParams.dFlightTimeVariance = tflightvar[i];
+            locShowerMatchParams.dPathLength = pathlength[i];
+            locShowerMatchParams.dDeltaPhiToShower = deltaphi[i];
+            locShowerMatchParams.dDeltaZToShower = deltaz[i];
+
+            locDetectorMatches->Add_Match(locTrack, locShower, locShowerMatchParams);
+         }
+      }
+
+      GetRows(ref, kFCALMatchOffsets, begin, end);
+      if (begin < end) {
+         const int32_t *track = Column<int32_t>(ref, kFCALMatchTrack, begin, end);
+         const int32_t *shower = Column<int32_t>(ref, kFCALMatchShower, begin, end);
+         const float *dx = Column<float>(ref, kFCALMatchDx, begin, end);
+         const float *doca = Column<float>(ref, kFCALMatchDoca, begin, end);
+         const float *pathlength = Column<float>(ref, kFCALMatchPathlength, begin, end);
+         const float *tflight = Column<float>(ref, kFCALMatchTflight, begin, end);
+         const float *tflightvar = Column<float>(ref, kFCALMatchTflightvar, begin, end);
+         for (unsigned int i=begin; i < end; i++) {
+            CheckIndex(ref, track[i], locTrackTimeBasedVector.size(), kFCALMatchTrack);
+            CheckIndex(ref, shower[i], locFCALShowers.size(), kFCALMatchShower);
+            const DTrackTimeBased *locTrack = locTrackTimeBasedVector[track[i]];
+            const DFCALShower *locShower = locFCALShowers[shower[i]];
+
+            DFCALShowerMatchParams locShowerMatchParams;
+            locShowerMatchParams.dTrack = locTrack;
+            locShowerMatchParams.dFCALShower = locShower;
+            locShowerMatchParams.dx = dx[i];
+            locShowerMatchParams.dFlightTime = tflight[i];
+            locShowerMatchParams.dFlightTimeVariance = tflightvar[i];
+            locShowerMatchParams.dPathLength = pathlength[i];
+            locShowerMatchParams.dDOCAToShower = doca[i];
+
+            locDetectorMatches->Add_Match(locTrack, locShower, locShowerMatchParams);
+         }
+      }
+
+      GetRows(ref, kSCMatchOffsets, begin, end);
+      if (begin < end) {
+         const int32_t *track = Column<int32_t>(ref, kSCMatchTrack, begin, end);
+         const int32_t *hit = Column<int32_t>(ref, kSCMatchHit, begin, end);
+         const float *dEdx = Column<float>(ref, kSCMatchDEdx, begin, end);
+         const float *thit = Column<float>(ref, kSCMatchThit, begin, end);
+         const float *thitvar = Column<float>(ref, kSCMatchThitvar, begin, end);
+         const float *ehit = Column<float>(ref, kSCMatchEhit, begin, end);
+         const float *pathlength = Column<float>(ref, kSCMatchPathlength, begin, end);
+         const float *tflight = Column<float>(ref, kSCMatchTflight, begin, end);
+         const float *tflightvar = Column<float>(ref, kSCMatchTflightvar, begin, end);
+         const float *deltaphi = Column<float>(ref, kSCMatchDeltaphi, begin, end);
+         for (unsigned int i=begin; i < end; i++) {
+            CheckIndex(ref, track[i], locTrackTimeBasedVector.size(), kSCMatchTrack);
+            CheckIndex(ref, hit[i], locSCHits.size(), kSCMatchHit);
+            const DTrackTimeBased *locTrack = locTrackTimeBasedVector[track[i]];
+            const DSCHit *locSCHit = locSCHits[hit[i]];
+
+            DSCHitMatchParams locSCHitMatchParams;
+            locSCHitMatchParams.dTrack = locTrack;
+            locSCHitMatchParams.dSCHit = locSCHit;
+            locSCHitMatchParams.dEdx = dEdx[i];
+            locSCHitMatchParams.dHitTime = thit[i];
+            locSCHitMatchParams.dHitTimeVariance = thitvar[i];
+            locSCHitMatchParams.dHitEnergy = ehit[i];
+            locSCHitMatchParams.dFlightTime = tflight[i];
+            locSCHitMatchParams.dFlightTimeVariance = tflightvar[i];
+            locSCHitMatchParams.dPathLength = pathlength[i];
+            locSCHitMatchParams.dDeltaPhiToHit = deltaphi[i];
+
+            locDetectorMatches->Add_Match(locTrack, locSCHit, locSCHitMatchParams);
+         }
+      }
+
+      GetRows(ref, kTOFMatchOffsets, begin, end);
+      if (begin < end) {
+         const int32_t *track = Column<int32_t>(ref, kTOFMatchTrack, begin, end);
+         const int32_t *hit = Column<int32_t>(ref, kTOFMatchHit, begin, end);
+         const float *dEdx = Column<float>(ref, kTOFMatchDEdx, begin, end);
+         const float *thit = Column<float>(ref, kTOFMatchThit, begin, end);
+         const float *thitvar = Column<float>(ref, kTOFMatchThitvar, begin, end);
+         const float *ehit = Column<float>(ref, kTOFMatchEhit, begin, end);
+         const float *deltax = Column<float>(ref, kTOFMatchDeltax, begin, end);
+         const float *deltay = Column<float>(ref, kTOFMatchDeltay, begin, end);
+         const float *pathlength = Column<float>(ref, kTOFMatchPathlength, begin, end);
+         const float *tflight = Column<float>(ref, kTOFMatchTflight, begin, end);
+         const float *tflightvar = Column<float>(ref, kTOFMatchTflightvar, begin, end);
+         for (unsigned int i=begin; i < end; i++) {
+            CheckIndex(ref, track[i], locTrackTimeBasedVector.size(), kTOFMatchTrack);
+            CheckIndex(ref, hit[i], locTOFPoints.size(), kTOFMatchHit);
+            const DTrackTimeBased *locTrack = locTrackTimeBasedVector[track[i]];
+            const DTOFPoint *locTOFPoint = locTOFPoints[hit[i]];
+
+            DTOFHitMatchParams locTOFHitMatchParams;
+            locTOFHitMatchParams.dTrack = locTrack;
+            locTOFHitMatchParams.dTOFPoint = locTOFPoint;
+            locTOFHitMatchParams.dHitTime = thit[i];
+            locTOFHitMatchParams.dHitTimeVariance = thitvar[i];
+            locTOFHitMatchParams.dHitEnergy = ehit[i];
+            locTOFHitMatchParams.dEdx = dEdx[i];
+            locTOFHitMatchParams.dFlightTime = tflight[i];
+            locTOFHitMatchParams.dFlightTimeVariance = tflightvar[i];
+            locTOFHitMatchParams.dPathLength = pathlength[i];
+            locTOFHitMatchParams.dDeltaXToHit = deltax[i];
+            locTOFHitMatchParams.dDeltaYToHit = deltay[i];
+
+            locDetectorMatches->Add_Match(locTrack, locTOFPoint, locTOFHitMatchParams);
+         }
+      }
+
+      GetRows(ref, kBCALDocaOffsets, begin, end);
+      if (begin < end) {
+         const int32_t *shower = Column<int32_t>(ref, kBCALDocaShower, begin, end);
+         const float *deltaphi = Column<float>(ref, kBCALDocaDeltaphi, begin, end);
+         const float *deltaz = Column<float>(ref, kBCALDocaDeltaz, begin, end);
+         for (unsigned int i=begin; i < end; i++) {
+            CheckIndex(ref, shower[i], locBCALShowers.size(), kBCALDocaShower);
+            locDetectorMatches->Set_DistanceToNearestTrack(locBCALShowers[shower[i]], deltaphi[i], deltaz[i]);
+         }
+      }
+
+      GetRows(ref, kFCALDocaOffsets, begin, end);
+      if (begin < end) {
+         const int32_t *shower = Column<int32_t>(ref, kFCALDocaShower, begin, end);
+         const float *doca = Column<float>(ref, kFCALDocaDoca, begin, end);
+         for (unsigned int i=begin; i < end; i++) {
+            CheckIndex(ref, shower[i], locFCALShowers.size(), kFCALDocaShower);
+            locDetectorMatches->Set_DistanceToNearestTrack(locFCALShowers[shower[i]], doca[i]);
+         }
+      }
+
+      GetRows(ref, kTflightPCorrOffsets, begin, end);
+      if (begin < end) {
+         const int32_t *track = Column<int32_t>(ref, kTflightPCorrTrack, begin, end);
+         const int32_t *system = Column<int32_t>(ref, kTflightPCorrSystem, begin, end);
+         const float *correlation = Column<float>(ref, kTflightPCorrCorrelation, begin, end);
+         for (unsigned int i=begin; i < end; i++) {
+            CheckIndex(ref, track[i], locTrackTimeBasedVector.size(), kTflightPCorrTrack);
+            locDetectorMatches->Set_FlightTimePCorrelation(locTrackTimeBasedVector[track[i]], (DetectorSystem_t)system[i], correlation[i]);
+         }
+      }
+   }
+   catch (...) {
+      delete locDetectorMatches;
+      throw;
+   }
+
+   data.push_back(locDetectorMatches);
+
+   // Copy data to factory
+   factory->CopyTo(data);
+
+   return NOERROR;
+}
@@ -0,0 +1,121 @@
+//
+// DEventSourceRESTColumns
+//
+/// Implements JEventSource for the columnar REST files written by
+/// rest2columns (see DRESTColumns.h). The file is mapped into memory
+/// and objects are made only from the columns belonging to the
+/// classes actually requested for an event, so a job that looks at
+/// e.g. only the showers never touches the track columns.
+///
+/// Only the untagged REST objects are available from these files and
+/// they carry no Monte Carlo truth (DMCReaction, DMCThrown).
+
+#ifndef _DEventSourceRESTColumns_
+#define _DEventSourceRESTColumns_
+
+#include <vector>
+#include <string>
+#include <map>
+
+#include <pthread.h>
+
+#include <JANA/JEventSource.h>
+#include <JANA/jerror.h>
+
+#include <PID/DBeamPhoton.h>
+#include <PID/DDetectorMatches.h>
+#include <TRACKING/DTrackTimeBased.h>
+#include <FCAL/DFCALShower.h>
+#include <BCAL/DBCALShower.h>
+#include <START_COUNTER/DSCHit.h>
+#include <TOF/DTOFPoint.h>
+#include <TRIGGER/DMCTrigger.h>
+#include <RF/DRFTime.h>
+
+#include "DRESTColumns.h"
+
+class DEventSourceRESTColumns:public JEventSource
+{
+ public:
+   DEventSourceRESTColumns(const char* source_name);
+   virtual ~DEventSourceRESTColumns();
+   virtual const char* className(void) {
+      return DEventSourceRESTColumns::static_className();
+   }
+   static const char* static_className(void) {
+      return "DEventSourceRESTColumns";
+   }
+
+   jerror_t GetEvent(JEvent &event);
+   void FreeEvent(JEvent &event);
+   jerror_t GetObjects(JEvent &event, JFactory_base *factory);
+
+ private:
+   // Position of an event in the file, kept in the JEvent ref
+   typedef struct {
+      unsigned int chunk;
+      unsigned int index;
+   } event_ref_t;
+
+   /// Rows of a group belonging to one event. Returns false if the
+   /// group is not in the file.
+   bool GetRows(const event_ref_t *ref, DRESTColumns::column_id_t offsets,
+                unsigned int &begin, unsigned int &end);
+   /// Start of a column within the chunk of an event. The column must
+   /// hold the rows begin to end of the event.
+   template<class T>
+   const T *Column(const event_ref_t *ref, DRESTColumns::column_id_t id,
+                   unsigned int begin, unsigned int end) {
+      uint32_t Nentries;
+      const T *col = file->GetColumn<T>(ref->chunk, columns[id], Nentries);
+      if (end > begin && (col == NULL || Nentries < end))
+         Corrupt(ref, std::string(DRESTColumns::COLUMNS[id].name) +
+                      " is missing or too short");
+      return col;
+   }
+   /// Check an index stored in the file against the size of the
+   /// vector it refers to
+   void CheckIndex(const event_ref_t *ref, int32_t index, size_t size,
+                   DRESTColumns::column_id_t id) {
+      if (index < 0 || (size_t)index >= size)
+         Corrupt(ref, std::string(DRESTColumns::COLUMNS[id].name) +
+                      " is out of range");
+   }
+   /// Report a damaged file and fail the event
+   void Corrupt(const event_ref_t *ref, const std::string &what);
+
+   jerror_t Extract_DRFTime(const event_ref_t *ref,
+                    JFactory<DRFTime> *factory);
+   jerror_t Extract_DBeamPhoton(const event_ref_t *ref,
+                    JFactory<DBeamPhoton> *factory,
+                    JEventLoop *eventLoop);
+   jerror_t Extract_DSCHit(const event_ref_t *ref,
+                    JFactory<DSCHit>* factory);
+   jerror_t Extract_DTOFPoint(const event_ref_t *ref,
+                    JFactory<DTOFPoint>* factory);
+   jerror_t Extract_DFCALShower(const event_ref_t *ref,
+                    JFactory<DFCALShower>* factory);
+   jerror_t Extract_DBCALShower(const event_ref_t *ref,
+                    JFactory<DBCALShower>* factory);
+   jerror_t Extract_DTrackTimeBased(const event_ref_t *ref,
+                    JFactory<DTrackTimeBased>* factory);
+   jerror_t Extract_DMCTrigger(const event_ref_t *ref,
+                    JFactory<DMCTrigger>* factory);
+   jerror_t Extract_DDetectorMatches(const event_ref_t *ref,
+                    JFactory<DDetectorMatches>* factory,
+                    JEventLoop *eventLoop);
+
+   DRESTColumnFile *file;
+   int columns[DRESTColumns::kNcolumns];
+   int run_column;
+   int event_column;
+
+   // Next event to be read, guarded by read_mutex
+   pthread_mutex_t read_mutex;
+   unsigned int next_chunk;
+   unsigned int next_index;
+
+   std::map<unsigned int, double> dTargetCenterZMap; //unsigned int is run number
+};
+
+#endif // _DEventSourceRESTColumns_
@@ -0,0 +1,40 @@
+//
+// DEventSourceRESTColumnsGenerator methods
+//
+
+#include <string>
+using std::string;
+
+#include "DEventSourceRESTColumnsGenerator.h"
+#include "DEventSourceRESTColumns.h"
+#include "DRESTColumns.h"
+
+//---------------------------------
+// Description
+//---------------------------------
+const char* DEventSourceRESTColumnsGenerator::Description(void)
+{
+   return "REST columns";
+}
+
+//---------------------------------
+// CheckOpenable
+//---------------------------------
+double DEventSourceRESTColumnsGenerator::CheckOpenable(std::string source)
+{
+   // Column files are never read from a pipe (they have to be mapped
+   // into memory) so it is safe to look at the header here.
+   string suffix = ".rcol";
+   if(source.length() < suffix.length()) return 0.0;
+   if(source.substr(source.length() - suffix.length()) != suffix) return 0.0;
+
+   return DRESTColumnFile::IsColumnFile(source)? 0.95 : 0.0;
+}
+
+//---------------------------------
+// MakeJEventSource
+//---------------------------------
+JEventSource* DEventSourceRESTColumnsGenerator::MakeJEventSource(std::string source)
+{
+   return new DEventSourceRESTColumns(source.c_str());
+}
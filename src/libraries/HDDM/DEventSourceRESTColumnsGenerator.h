@@ -0,0 +1,29 @@
+//
+// DEventSourceRESTColumnsGenerator.h
+//
+/// Implements JEventSourceGenerator for columnar REST files
+
+#ifndef _DEventSourceRESTColumnsGenerator_
+#define _DEventSourceRESTColumnsGenerator_
+
+#include <JANA/JEventSourceGenerator.h>
+
+class DEventSourceRESTColumnsGenerator:public jana::JEventSourceGenerator
+{
+ public:
+   DEventSourceRESTColumnsGenerator() {}
+   ~DEventSourceRESTColumnsGenerator() {}
+   const char* className(void) {
+      return static_className();
+   }
+   static const char* static_className(void) {
+      return "DEventSourceRESTColumnsGenerator";
+   }
+
+   const char* Description(void);
+   double CheckOpenable(std::string source);
+   jana::JEventSource* MakeJEventSource(std::string source);
+};
+
+#endif // _DEventSourceRESTColumnsGenerator_
+
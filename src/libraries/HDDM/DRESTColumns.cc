@@ -0,0 +1,550 @@
+//
+// DRESTColumns.cc
+//
+// DRESTColumnWriter and DRESTColumnFile methods
+//
+
+#include <iostream>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "DRESTColumns.h"
+
+using namespace std;
+using namespace DRESTColumns;
+
+// Must be kept in the order of DRESTColumns::column_id_t
+const column_def_t DRESTColumns::COLUMNS[kNcolumns] = {
+   {"rf.offsets",                kOffset},
+   {"rf.tsync",                  kFloat},
+   {"tagger.offsets",            kOffset},
+   {"tagger.E",                  kFloat},
+   {"tagger.t",                  kFloat},
+   {"tagger.system",             kInt},
+   {"sc.offsets",                kOffset},
+   {"sc.sector",                 kInt},
+   {"sc.dE",                     kFloat},
+   {"sc.t",                      kFloat},
+   {"tof.offsets",               kOffset},
+   {"tof.x",                     kFloat},
+   {"tof.y",                     kFloat},
+   {"tof.z",                     kFloat},
+   {"tof.t",                     kFloat},
+   {"tof.dE",                    kFloat},
+   {"tof.terr",                  kFloat},
+   {"tof.status",                kInt},
+   {"fcal.offsets",              kOffset},
+   {"fcal.x",                    kFloat},
+   {"fcal.y",                    kFloat},
+   {"fcal.z",                    kFloat},
+   {"fcal.t",                    kFloat},
+   {"fcal.E",                    kFloat},
+   {"fcal.xerr",                 kFloat},
+   {"fcal.yerr",                 kFloat},
+   {"fcal.zerr",                 kFloat},
+   {"bcal.offsets",              kOffset},
+   {"bcal.x",                    kFloat},
+   {"bcal.y",                    kFloat},
+   {"bcal.z",                    kFloat},
+   {"bcal.t",                    kFloat},
+   {"bcal.E",                    kFloat},
+   {"bcal.xerr",                 kFloat},
+   {"bcal.yerr",                 kFloat},
+   {"bcal.zerr",                 kFloat},
+   {"bcal.terr",                 kFloat},
+   {"bcal.ncell",                kInt},
+   {"track.offsets",             kOffset},
+   {"track.candidateId",         kInt},
+   {"track.ptype",               kInt},
+   {"track.Ndof",                kInt},
+   {"track.chisq",               kFloat},
+   {"track.x0",                  kFloat},
+   {"track.y0",                  kFloat},
+   {"track.z0",                  kFloat},
+   {"track.px",                  kFloat},
+   {"track.py",                  kFloat},
+   {"track.pz",                  kFloat},
+   {"track.t0",                  kFloat},
+   {"track.t0err",               kFloat},
+   {"track.t0det",               kInt},
+   {"track.e11",                 kFloat},
+   {"track.e12",                 kFloat},
+   {"track.e13",                 kFloat},
+   {"track.e14",                 kFloat},
+   {"track.e15",                 kFloat},
+   {"track.e22",                 kFloat},
+   {"track.e23",                 kFloat},
+   {"track.e24",                 kFloat},
+   {"track.e25",                 kFloat},
+   {"track.e33",                 kFloat},
+   {"track.e34",                 kFloat},
+   {"track.e35",                 kFloat},
+   {"track.e44",                 kFloat},
+   {"track.e45",                 kFloat},
+   {"track.e55",                 kFloat},
+   {"track.CDCrings",            kInt},
+   {"track.FDCplanes",           kInt},
+   {"track.mcmatch",             kInt},
+   {"track.ithrown",             kInt},
+   {"track.numhitsmatch",        kInt},
+   {"track.NsampleFDC",          kInt},
+   {"track.dxFDC",               kFloat},
+   {"track.dEdxFDC",             kFloat},
+   {"track.NsampleCDC",          kInt},
+   {"track.dxCDC",               kFloat},
+   {"track.dEdxCDC",             kFloat},
+   {"trigger.offsets",           kOffset},
+   {"trigger.L1a",               kInt},
+   {"trigger.L1b",               kInt},
+   {"trigger.L1c",               kInt},
+   {"matches.offsets",           kOffset},
+   {"bcalmatch.offsets",         kOffset},
+   {"bcalmatch.track",           kInt},
+   {"bcalmatch.shower",          kInt},
+   {"bcalmatch.dx",              kFloat},
+   {"bcalmatch.deltaphi",        kFloat},
+   {"bcalmatch.deltaz",          kFloat},
+   {"bcalmatch.pathlength",      kFloat},
+   {"bcalmatch.tflight",         kFloat},
+   {"bcalmatch.tflightvar",      kFloat},
+   {"fcalmatch.offsets",         kOffset},
+   {"fcalmatch.track",           kInt},
+   {"fcalmatch.shower",          kInt},
+   {"fcalmatch.dx",              kFloat},
+   {"fcalmatch.doca",            kFloat},
+   {"fcalmatch.pathlength",      kFloat},
+   {"fcalmatch.tflight",         kFloat},
+   {"fcalmatch.tflightvar",      kFloat},
+   {"scmatch.offsets",           kOffset},
+   {"scmatch.track",             kInt},
+   {"scmatch.hit",               kInt},
+   {"scmatch.dEdx",              kFloat},
+   {"scmatch.thit",              kFloat},
+   {"scmatch.thitvar",           kFloat},
+   {"scmatch.ehit",              kFloat},
+   {"scmatch.pathlength",        kFloat},
+   {"scmatch.tflight",           kFloat},
+   {"scmatch.tflightvar",        kFloat},
+   {"scmatch.deltaphi",          kFloat},
+   {"tofmatch.offsets",          kOffset},
+   {"tofmatch.track",            kInt},
+   {"tofmatch.hit",              kInt},
+   {"tofmatch.dEdx",             kFloat},
+   {"tofmatch.thit",             kFloat},
+   {"tofmatch.thitvar",          kFloat},
+   {"tofmatch.ehit",             kFloat},
+   {"tofmatch.deltax",           kFloat},
+   {"tofmatch.deltay",           kFloat},
+   {"tofmatch.pathlength",       kFloat},
+   {"tofmatch.tflight",          kFloat},
+   {"tofmatch.tflightvar",       kFloat},
+   {"bcaldoca.offsets",          kOffset},
+   {"bcaldoca.shower",           kInt},
+   {"bcaldoca.deltaphi",         kFloat},
+   {"bcaldoca.deltaz",           kFloat},
+   {"fcaldoca.offsets",          kOffset},
+   {"fcaldoca.shower",           kInt},
+   {"fcaldoca.doca",             kFloat},
+   {"tflightpcorr.offsets",      kOffset},
+   {"tflightpcorr.track",        kInt},
+   {"tflightpcorr.system",       kInt},
+   {"tflightpcorr.correlation",  kFloat}
+};
+
+//----------------
+// DRESTColumnWriter (Constructor)
+//----------------
+DRESTColumnWriter::DRESTColumnWriter(const string &filename,
+                                     unsigned int events_per_chunk)
+ : ofs(filename.c_str(), ios::out | ios::binary | ios::trunc),
+   events_per_chunk(events_per_chunk),
+   Nevents_chunk(0),
+   Nevents(0),
+   in_event(false)
+{
+   if (this->events_per_chunk == 0) {
+      this->events_per_chunk = 1;
+   }
+
+   // The header is rewritten with the final values by Close()
+   header_t header;
+   memset(&header, 0, sizeof(header));
+   ofs.write((const char*)&header, sizeof(header));
+
+   // The event group has one row per event and no offsets column
+   group_t event_group;
+   event_group.name = "event";
+   event_group.Nrows = 0;
+   groups.push_back(event_group);
+   run_column = AddColumn(0, "run", kInt);
+   event_column = AddColumn(0, "number", kInt);
+}
+
+//----------------
+// ~DRESTColumnWriter (Destructor)
+//----------------
+DRESTColumnWriter::~DRESTColumnWriter()
+{
+   if (ofs.is_open()) {
+      Close();
+   }
+}
+
+//----------------
+// AddGroup
+//----------------
+unsigned int DRESTColumnWriter::AddGroup(const string &group)
+{
+   group_t g;
+   g.name = group;
+   g.offsets.push_back(0);
+   g.Nrows = 0;
+   groups.push_back(g);
+   unsigned int igroup = groups.size() - 1;
+
+   // Offsets are written from groups[igroup].offsets when the chunk
+   // is flushed so nothing is ever filled into this column directly.
+   column_t c;
+   c.name = group + ".offsets";
+   c.type = kOffset;
+   c.group = igroup;
+   columns.push_back(c);
+
+   return igroup;
+}
+
+//----------------
+// AddColumn
+//----------------
+unsigned int DRESTColumnWriter::AddColumn(unsigned int group,
+                                          const string &field,
+                                          column_type_t type)
+{
+   column_t c;
+   c.name = groups[group].name + "." + field;
+   c.type = type;
+   c.group = group;
+   columns.push_back(c);
+
+   return columns.size() - 1;
+}
+
+//----------------
+// StartEvent
+//----------------
+void DRESTColumnWriter::StartEvent(int run, int event)
+{
+   in_event = true;
+   groups[0].Nrows++;
+   Fill(run_column, run);
+   Fill(event_column, event);
+}
+
+//----------------
+// EndEvent
+//----------------
+bool DRESTColumnWriter::EndEvent(void)
+{
+   /// Close the rows of all groups for this event. Returns false if
+   /// some column was not filled exactly once for each row of its group.
+
+   if (!in_event) {
+      return false;
+   }
+   in_event = false;
+
+   for (unsigned int i=1; i < groups.size(); i++) {
+      groups[i].offsets.push_back(groups[i].Nrows);
+   }
+   bool ok = true;
+   for (unsigned int i=0; i < columns.size(); i++) {
+      if (columns[i].type == kOffset) {
+         continue;
+      }
+      if (columns[i].data.size() != 4*groups[columns[i].group].Nrows) {
+         cerr << "DRESTColumnWriter: column " << columns[i].name
+              << " has " << columns[i].data.size()/4 << " entries but "
+              << groups[columns[i].group].Nrows << " rows" << endl;
+         ok = false;
+      }
+   }
+
+   Nevents_chunk++;
+   Nevents++;
+   if (Nevents_chunk >= events_per_chunk) {
+      ok = FlushChunk() && ok;
+   }
+
+   return ok;
+}
+
+//----------------
+// WriteBlock
+//----------------
+bool DRESTColumnWriter::WriteBlock(const void *data, uint32_t Nentries,
+                                   chunk_entry_t &entry)
+{
+   // Keep every block 8-byte aligned relative to the start of
+   // the file (and so of the mapping made by DRESTColumnFile).
+   static const char zeros[8] = {0};
+   uint64_t pos = ofs.tellp();
+   if (pos % 8) {
+      ofs.write(zeros, 8 - pos%8);
+      pos += 8 - pos%8;
+   }
+   entry.offset = pos;
+   entry.Nentries = Nentries;
+   if (Nentries > 0) {
+      ofs.write((const char*)data, 4*(size_t)Nentries);
+   }
+
+   return ofs.good();
+}
+
+//----------------
+// FlushChunk
+//----------------
+bool DRESTColumnWriter::FlushChunk(void)
+{
+   vector<chunk_entry_t> entries(columns.size());
+   bool ok = true;
+   for (unsigned int i=0; i < columns.size(); i++) {
+      column_t &c = columns[i];
+      if (c.type == kOffset) {
+         vector<uint32_t> &offsets = groups[c.group].offsets;
+         ok = WriteBlock(&offsets[0], offsets.size(), entries[i]) && ok;
+      }
+      else {
+         const char *data = c.data.empty()? NULL : &c.data[0];
+         ok = WriteBlock(data, c.data.size()/4, entries[i]) && ok;
+      }
+      c.data.clear();
+   }
+   chunk_Nevents.push_back(Nevents_chunk);
+   chunk_entries.push_back(entries);
+
+   for (unsigned int i=0; i < groups.size(); i++) {
+      groups[i].Nrows = 0;
+      if (i > 0) {
+         groups[i].offsets.assign(1, 0);
+      }
+   }
+   Nevents_chunk = 0;
+
+   return ok;
+}
+
+//----------------
+// Close
+//----------------
+bool DRESTColumnWriter::Close(void)
+{
+   if (!ofs.is_open()) {
+      return false;
+   }
+   bool ok = true;
+   if (Nevents_chunk > 0) {
+      ok = FlushChunk();
+   }
+
+   // Directory
+   static const char zeros[8] = {0};
+   uint64_t pos = ofs.tellp();
+   if (pos % 8) {
+      ofs.write(zeros, 8 - pos%8);
+      pos += 8 - pos%8;
+   }
+   uint32_t Ncolumns = columns.size();
+   ofs.write((const char*)&Ncolumns, sizeof(Ncolumns));
+   for (unsigned int i=0; i < columns.size(); i++) {
+      uint32_t len = columns[i].name.size();
+      ofs.write(&columns[i].type, 1);
+      ofs.write((const char*)&len, sizeof(len));
+      ofs.write(columns[i].name.data(), len);
+   }
+   uint32_t Nchunks = chunk_Nevents.size();
+   ofs.write((const char*)&Nchunks, sizeof(Nchunks));
+   for (unsigned int i=0; i < chunk_Nevents.size(); i++) {
+      ofs.write((const char*)&chunk_Nevents[i], sizeof(uint32_t));
+      for (unsigned int j=0; j < columns.size(); j++) {
+         ofs.write((const char*)&chunk_entries[i][j].offset, sizeof(uint64_t));
+         ofs.write((const char*)&chunk_entries[i][j].Nentries, sizeof(uint32_t));
+      }
+   }
+   uint64_t end = ofs.tellp();
+
+   header_t header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, MAGIC, sizeof(header.magic));
+   header.byte_order = BYTE_ORDER_WORD;
+   header.version = VERSION;
+   header.Nevents = Nevents;
+   header.directory_offset = pos;
+   header.directory_size = end - pos;
+   ofs.seekp(0);
+   ofs.write((const char*)&header, sizeof(header));
+   ok = ofs.good() && ok;
+   ofs.close();
+
+   return ok;
+}
+
+//----------------
+// DRESTColumnFile (Constructor)
+//----------------
+DRESTColumnFile::DRESTColumnFile(const string &filename)
+ : base(NULL),
+   length(0),
+   Nevents(0)
+{
+   if (!Map(filename) && base != NULL) {
+      munmap((void*)base, length);
+      base = NULL;
+   }
+}
+
+//----------------
+// ~DRESTColumnFile (Destructor)
+//----------------
+DRESTColumnFile::~DRESTColumnFile()
+{
+   if (base != NULL) {
+      munmap((void*)base, length);
+   }
+}
+
+//----------------
+// IsColumnFile
+//----------------
+bool DRESTColumnFile::IsColumnFile(const string &filename)
+{
+   ifstream ifs(filename.c_str(), ios::in | ios::binary);
+   char magic[8];
+   if (!ifs.read(magic, sizeof(magic))) {
+      return false;
+   }
+   return memcmp(magic, MAGIC, sizeof(magic)) == 0;
+}
+
+//----------------
+// FindColumn
+//----------------
+int DRESTColumnFile::FindColumn(const string &name) const
+{
+   map<string, int>::const_iterator iter = column_index.find(name);
+   return (iter == column_index.end())? -1 : iter->second;
+}
+
+//----------------
+// Map
+//----------------
+bool DRESTColumnFile::Map(const string &filename)
+{
+   int fd = open(filename.c_str(), O_RDONLY);
+   if (fd < 0) {
+      error = "unable to open " + filename;
+      return false;
+   }
+   struct stat st;
+   if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(header_t)) {
+      close(fd);
+      error = filename + " is too short to be a REST column file";
+      return false;
+   }
+   length = st.st_size;
+   void *addr = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if (addr == MAP_FAILED) {
+      error = "unable to map " + filename + " into memory";
+      return false;
+   }
+   base = (const char*)addr;
+
+   header_t header;
+   memcpy(&header, base, sizeof(header));
+   if (memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0) {
+      error = filename + " is not a REST column file";
+      return false;
+   }
+   if (header.byte_order != BYTE_ORDER_WORD) {
+      error = filename + " was written on a machine of different byte order";
+      return false;
+   }
+   if (header.version != VERSION) {
+      error = filename + " has an unsupported format version";
+      return false;
+   }
+   if (header.directory_offset == 0 ||
+       header.directory_offset + header.directory_size > length)
+   {
+      error = filename + " is incomplete (was the converter interrupted?)";
+      return false;
+   }
+   Nevents = header.Nevents;
+
+   // Walk the directory. It is only byte aligned so everything
+   // is copied out of it rather than read in place.
+   const char *p = base + header.directory_offset;
+   const char *end = p + header.directory_size;
+   uint32_t Ncolumns;
+   if (p + sizeof(Ncolumns) > end) {
+      error = filename + " has a corrupt directory";
+      return false;
+   }
+   memcpy(&Ncolumns, p, sizeof(Ncolumns));
+   p += sizeof(Ncolumns);
+   for (unsigned int i=0; i < Ncolumns; i++) {
+      uint32_t len;
+      if (p + 1 + sizeof(len) > end) {
+         error = filename + " has a corrupt directory";
+         return false;
+      }
+      column_types.push_back(*p++);
+      memcpy(&len, p, sizeof(len));
+      p += sizeof(len);
+      if (p + len > end) {
+         error = filename + " has a corrupt directory";
+         return false;
+      }
+      column_index[string(p, len)] = i;
+      p += len;
+   }
+   uint32_t Nchunks;
+   if (p + sizeof(Nchunks) > end) {
+      error = filename + " has a corrupt directory";
+      return false;
+   }
+   memcpy(&Nchunks, p, sizeof(Nchunks));
+   p += sizeof(Nchunks);
+   size_t chunk_size = sizeof(uint32_t) +
+                       Ncolumns*(sizeof(uint64_t) + sizeof(uint32_t));
+   if (p + Nchunks*chunk_size > end) {
+      error = filename + " has a corrupt directory";
+      return false;
+   }
+   chunk_Nevents.resize(Nchunks);
+   chunk_entries.resize(Nchunks);
+   for (unsigned int i=0; i < Nchunks; i++) {
+      memcpy(&chunk_Nevents[i], p, sizeof(uint32_t));
+      p += sizeof(uint32_t);
+      chunk_entries[i].resize(Ncolumns);
+      for (unsigned int j=0; j < Ncolumns; j++) {
+         entry_t &e = chunk_entries[i][j];
+         memcpy(&e.offset, p, sizeof(uint64_t));
+         p += sizeof(uint64_t);
+         memcpy(&e.Nentries, p, sizeof(uint32_t));
+         p += sizeof(uint32_t);
+         if (e.offset + 4*(uint64_t)e.Nentries > header.directory_offset) {
+            error = filename + " has a column outside of the data area";
+            return false;
+         }
+      }
+   }
+
+   return true;
+}
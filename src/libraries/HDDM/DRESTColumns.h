@@ -0,0 +1,244 @@
+//
+// DRESTColumns.h
+//
+/// Column-oriented companion format for REST files.
+///
+/// A REST file is a compressed stream of records that has to be
+/// decoded in full, event by event, on every pass. The columnar file
+/// holds the same content with every attribute of every REST element
+/// stored as its own contiguous array ("column") so that a reader can
+/// map the file into memory and touch only the columns it needs.
+///
+/// Events are stored in chunks of a fixed number of events. Within
+/// a chunk, each repeated element (track, shower, ...) is a "group"
+/// with an offsets column of Nevents+1 entries giving, for each event,
+/// the range of rows belonging to it. The group's fields are columns
+/// named "<group>.<field>" with one entry per row. Event level values
+/// (run and event number) are columns in the "event" group which has
+/// exactly one row per event and no offsets column.
+///
+/// All column entries are 4 bytes (int32, float or uint32 for
+/// offsets) in the byte order of the machine that wrote the file.
+/// The layout is:
+///
+///   header            magic, byte order word, version, Nevents and
+///                     the position of the directory
+///   column data       one block per column per chunk, 8-byte aligned
+///   directory         column names and types followed, for each
+///                     chunk, by its event count and the position and
+///                     length of each of its columns
+///
+/// DRESTColumnWriter is used by the rest2columns converter and
+/// DRESTColumnFile by DEventSourceRESTColumns.
+
+#ifndef _DRESTColumns_
+#define _DRESTColumns_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <stdint.h>
+
+namespace DRESTColumns {
+   static const char MAGIC[8] = {'H','D','R','E','S','T','C','\0'};
+   static const uint32_t BYTE_ORDER_WORD = 0x01020304;
+   static const uint32_t VERSION = 1;
+
+   enum column_type_t {
+      kInt    = 'i',
+      kFloat  = 'f',
+      kOffset = 'u'
+   };
+
+   /// The columns made from a REST record by rest2columns. Each group
+   /// starts with its offsets column. Entries for an element that is
+   /// optional in rest.xml hold a default when the element is absent
+   /// (-1 for track.ithrown, tof.status and bcal.ncell, zero otherwise).
+   /// track.mcmatch is 1 if the track had an mcmatch element and 0 if not.
+   /// tagger.system is 0 for taggerHit, 1 for tagmBeamPhoton and 2 for
+   /// taghBeamPhoton elements. matches has one row per detectorMatches
+   /// element and the rows of the match groups all belong to it.
+   enum column_id_t {
+      kRFOffsets, kRFTsync,
+      kTaggerOffsets, kTaggerE, kTaggerT, kTaggerSystem,
+      kSCOffsets, kSCSector, kSCdE, kSCT,
+      kTOFOffsets, kTOFX, kTOFY, kTOFZ, kTOFT, kTOFdE, kTOFTerr, kTOFStatus,
+      kFCALOffsets, kFCALX, kFCALY, kFCALZ, kFCALT, kFCALE,
+      kFCALXerr, kFCALYerr, kFCALZerr,
+      kBCALOffsets, kBCALX, kBCALY, kBCALZ, kBCALT, kBCALE,
+      kBCALXerr, kBCALYerr, kBCALZerr, kBCALTerr, kBCALNcell,
+      kTrackOffsets, kTrackCandidateId, kTrackPtype, kTrackNdof, kTrackChisq,
+      kTrackX0, kTrackY0, kTrackZ0, kTrackPx, kTrackPy, kTrackPz,
+      kTrackT0, kTrackT0err, kTrackT0det,
+      kTrackE11, kTrackE12, kTrackE13, kTrackE14, kTrackE15,
+      kTrackE22, kTrackE23, kTrackE24, kTrackE25,
+      kTrackE33, kTrackE34, kTrackE35,
+      kTrackE44, kTrackE45,
+      kTrackE55,
+      kTrackCDCrings, kTrackFDCplanes,
+      kTrackMcmatch, kTrackIthrown, kTrackNumhitsmatch,
+      kTrackNsampleFDC, kTrackDxFDC, kTrackDEdxFDC,
+      kTrackNsampleCDC, kTrackDxCDC, kTrackDEdxCDC,
+      kTriggerOffsets, kTriggerL1a, kTriggerL1b, kTriggerL1c,
+      kMatchesOffsets,
+      kBCALMatchOffsets, kBCALMatchTrack, kBCALMatchShower, kBCALMatchDx,
+      kBCALMatchDeltaphi, kBCALMatchDeltaz, kBCALMatchPathlength,
+      kBCALMatchTflight, kBCALMatchTflightvar,
+      kFCALMatchOffsets, kFCALMatchTrack, kFCALMatchShower, kFCALMatchDx,
+      kFCALMatchDoca, kFCALMatchPathlength,
+      kFCALMatchTflight, kFCALMatchTflightvar,
+      kSCMatchOffsets, kSCMatchTrack, kSCMatchHit, kSCMatchDEdx,
+      kSCMatchThit, kSCMatchThitvar, kSCMatchEhit, kSCMatchPathlength,
+      kSCMatchTflight, kSCMatchTflightvar, kSCMatchDeltaphi,
+      kTOFMatchOffsets, kTOFMatchTrack, kTOFMatchHit, kTOFMatchDEdx,
+      kTOFMatchThit, kTOFMatchThitvar, kTOFMatchEhit,
+      kTOFMatchDeltax, kTOFMatchDeltay, kTOFMatchPathlength,
+      kTOFMatchTflight, kTOFMatchTflightvar,
+      kBCALDocaOffsets, kBCALDocaShower, kBCALDocaDeltaphi, kBCALDocaDeltaz,
+      kFCALDocaOffsets, kFCALDocaShower, kFCALDocaDoca,
+      kTflightPCorrOffsets, kTflightPCorrTrack, kTflightPCorrSystem,
+      kTflightPCorrCorrelation,
+      kNcolumns
+   };
+
+   typedef struct {
+      const char *name;
+      column_type_t type;
+   } column_def_t;
+
+   extern const column_def_t COLUMNS[kNcolumns];
+
+   typedef struct {
+      char magic[8];
+      uint32_t byte_order;
+      uint32_t version;
+      uint64_t Nevents;
+      uint64_t directory_offset;
+      uint64_t directory_size;
+      uint64_t reserved[3];
+   } header_t;
+}
+
+class DRESTColumnWriter
+{
+ public:
+   DRESTColumnWriter(const std::string &filename,
+                     unsigned int events_per_chunk=10000);
+   ~DRESTColumnWriter();
+
+   bool IsOpen(void) const { return ofs.is_open() && ofs.good(); }
+
+   /// Declare a group of rows and the columns of its fields. This
+   /// must be done before the first event. The returned values are
+   /// the handles passed to NewRow() and Fill().
+   unsigned int AddGroup(const std::string &group);
+   unsigned int AddColumn(unsigned int group, const std::string &field,
+                          DRESTColumns::column_type_t type);
+
+   void StartEvent(int run, int event);
+   void NewRow(unsigned int group) { groups[group].Nrows++; }
+   void Fill(unsigned int column, int val) { Append(column, &val); }
+   void Fill(unsigned int column, float val) { Append(column, &val); }
+   bool EndEvent(void);
+
+   bool Close(void);
+
+   uint64_t GetNevents(void) const { return Nevents; }
+
+ private:
+   class group_t {
+    public:
+      std::string name;
+      std::vector<uint32_t> offsets;
+      uint32_t Nrows;
+   };
+   class column_t {
+    public:
+      std::string name;
+      char type;
+      unsigned int group;
+      std::vector<char> data;
+   };
+   class chunk_entry_t {
+    public:
+      uint64_t offset;
+      uint32_t Nentries;
+   };
+
+   void Append(unsigned int column, const void *val) {
+      std::vector<char> &d = columns[column].data;
+      const char *p = (const char*)val;
+      d.insert(d.end(), p, p+4);
+   }
+   bool FlushChunk(void);
+   bool WriteBlock(const void *data, uint32_t Nentries, chunk_entry_t &entry);
+
+   std::ofstream ofs;
+   unsigned int events_per_chunk;
+   std::vector<group_t> groups;
+   std::vector<column_t> columns;
+   unsigned int run_column;
+   unsigned int event_column;
+   uint32_t Nevents_chunk;
+   uint64_t Nevents;
+   bool in_event;
+   std::vector<uint32_t> chunk_Nevents;
+   std::vector<std::vector<chunk_entry_t> > chunk_entries;
+};
+
+class DRESTColumnFile
+{
+ public:
+   DRESTColumnFile(const std::string &filename);
+   ~DRESTColumnFile();
+
+   bool IsOpen(void) const { return base != NULL; }
+   const std::string &GetError(void) const { return error; }
+
+   uint64_t GetNevents(void) const { return Nevents; }
+   unsigned int GetNchunks(void) const { return chunk_Nevents.size(); }
+   unsigned int GetNevents(unsigned int chunk) const {
+      return chunk_Nevents[chunk];
+   }
+
+   /// Index of the named column or -1 if the file does not have it
+   int FindColumn(const std::string &name) const;
+
+   /// Pointer to the entries of a column within one chunk. Returns
+   /// NULL (and Nentries=0) if column is -1.
+   template<class T>
+   const T *GetColumn(unsigned int chunk, int column,
+                      uint32_t &Nentries) const {
+      if (column < 0) {
+         Nentries = 0;
+         return NULL;
+      }
+      const entry_t &e = chunk_entries[chunk][column];
+      Nentries = e.Nentries;
+      return (const T*)(base + e.offset);
+   }
+
+   /// Quick check of the header of a file without mapping it
+   static bool IsColumnFile(const std::string &filename);
+
+ private:
+   class entry_t {
+    public:
+      uint64_t offset;
+      uint32_t Nentries;
+   };
+
+   bool Map(const std::string &filename);
+
+   std::string error;
+   const char *base;
+   size_t length;
+   uint64_t Nevents;
+   std::map<std::string, int> column_index;
+   std::vector<char> column_types;
+   std::vector<uint32_t> chunk_Nevents;
+   std::vector<std::vector<entry_t> > chunk_entries;
+};
+
+#endif // _DRESTColumns_
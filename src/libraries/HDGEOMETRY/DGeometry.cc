@@ -31,10 +31,15 @@ DGeometry::DGeometry(JGeometry *jgeom, DApplication *dapp, unsigned int runnumbe
 	this->runnumber = runnumber;
 	this->materialmaps_read = false;
 	this->materials_read = false;
+	this->cdcwires_read = this->fdcwires_read = false;
+	this->fdccathodes_read = this->sc_geom_read = false;
+	this->cdcwires_ok = this->fdcwires_ok = false;
+	this->fdccathodes_ok = this->sc_geom_ok = false;
 	
 	pthread_mutex_init(&bfield_mutex, NULL);
 	pthread_mutex_init(&materialmap_mutex, NULL);
 	pthread_mutex_init(&materials_mutex, NULL);
+	pthread_mutex_init(&wire_tables_mutex, NULL);
 
 	
 }
@@ -53,6 +58,18 @@ DGeometry::~DGeometry()
 	for(unsigned int i=0; i<materialmaps.size(); i++)delete materialmaps[i];
 	materialmaps.clear();
 	pthread_mutex_unlock(&materialmap_mutex);
+
+	pthread_mutex_lock(&wire_tables_mutex);
+	for(unsigned int i=0; i<cdcwires_table.size(); i++)
+		for(unsigned int j=0; j<cdcwires_table[i].size(); j++)delete cdcwires_table[i][j];
+	for(unsigned int i=0; i<fdcwires_table.size(); i++)
+		for(unsigned int j=0; j<fdcwires_table[i].size(); j++)delete fdcwires_table[i][j];
+	for(unsigned int i=0; i<fdccathodes_table.size(); i++)
+		for(unsigned int j=0; j<fdccathodes_table[i].size(); j++)delete fdccathodes_table[i][j];
+	cdcwires_table.clear();
+	fdcwires_table.clear();
+	fdccathodes_table.clear();
+	pthread_mutex_unlock(&wire_tables_mutex);
 }
 
 //---------------------------------
@@ -746,6 +763,42 @@ bool DGeometry::GetCDCAxialWires(unsigned int ring,unsigned int ncopy,
 // GetCDCWires
 //---------------------------------
 bool DGeometry::GetCDCWires(vector<vector<DCDCWire *> >&cdcwires) const{
+  vector<vector<const DCDCWire *> >table;
+  if (!GetCDCWires(table)) return false;
+  for (unsigned int i=0;i<table.size();i++){
+    vector<DCDCWire*>straws;
+    for (unsigned int j=0;j<table[i].size();j++){
+      straws.push_back(new DCDCWire(*table[i][j]));
+    }
+    cdcwires.push_back(straws);
+  }
+  return true;
+}
+
+//---------------------------------
+// GetCDCWires
+//---------------------------------
+bool DGeometry::GetCDCWires(vector<vector<const DCDCWire *> >&cdcwires) const{
+  pthread_mutex_lock(&wire_tables_mutex);
+  if (!cdcwires_read){
+    cdcwires_ok=ReadCDCWires(cdcwires_table);
+    cdcwires_read=true;
+  }
+  pthread_mutex_unlock(&wire_tables_mutex);
+
+  cdcwires.clear();
+  if (!cdcwires_ok) return false;
+  for (unsigned int i=0;i<cdcwires_table.size();i++){
+    cdcwires.push_back(vector<const DCDCWire*>(cdcwires_table[i].begin(),
+					       cdcwires_table[i].end()));
+  }
+  return true;
+}
+
+//---------------------------------
+// ReadCDCWires
+//---------------------------------
+bool DGeometry::ReadCDCWires(vector<vector<DCDCWire *> >&cdcwires) const{
   // Get nominal geometry from XML
   vector<double>cdc_origin;
   vector<double>cdc_length;
@@ -915,6 +968,42 @@ bool DGeometry::GetCDCWires(vector<vector<DCDCWire *> >&cdcwires) const{
 // GetFDCCathodes
 //---------------------------------
 bool DGeometry::GetFDCCathodes(vector<vector<DFDCCathode *> >&fdccathodes) const{
+  vector<vector<const DFDCCathode *> >table;
+  if (!GetFDCCathodes(table)) return false;
+  for (unsigned int i=0;i<table.size();i++){
+    vector<DFDCCathode *>temp;
+    for (unsigned int j=0;j<table[i].size();j++){
+      temp.push_back(new DFDCCathode(*table[i][j]));
+    }
+    fdccathodes.push_back(temp);
+  }
+  return true;
+}
+
+//---------------------------------
+// GetFDCCathodes
+//---------------------------------
+bool DGeometry::GetFDCCathodes(vector<vector<const DFDCCathode *> >&fdccathodes) const{
+  pthread_mutex_lock(&wire_tables_mutex);
+  if (!fdccathodes_read){
+    fdccathodes_ok=ReadFDCCathodes(fdccathodes_table);
+    fdccathodes_read=true;
+  }
+  pthread_mutex_unlock(&wire_tables_mutex);
+
+  fdccathodes.clear();
+  if (!fdccathodes_ok) return false;
+  for (unsigned int i=0;i<fdccathodes_table.size();i++){
+    fdccathodes.push_back(vector<const DFDCCathode*>(fdccathodes_table[i].begin(),
+						     fdccathodes_table[i].end()));
+  }
+  return true;
+}
+
+//---------------------------------
+// ReadFDCCathodes
+//---------------------------------
+bool DGeometry::ReadFDCCathodes(vector<vector<DFDCCathode *> >&fdccathodes) const{
   // Get offsets tweaking nominal geometry from calibration database
   JCalibration * jcalib = dapp->GetJCalibration(runnumber);
   vector<map<string,double> >vals;
@@ -984,6 +1073,42 @@ bool DGeometry::GetFDCCathodes(vector<vector<DFDCCathode *> >&fdccathodes) const
 // GetFDCWires
 //---------------------------------
 bool DGeometry::GetFDCWires(vector<vector<DFDCWire *> >&fdcwires) const{
+  vector<vector<const DFDCWire *> >table;
+  if (!GetFDCWires(table)) return false;
+  for (unsigned int i=0;i<table.size();i++){
+    vector<DFDCWire *>temp;
+    for (unsigned int j=0;j<table[i].size();j++){
+      temp.push_back(new DFDCWire(*table[i][j]));
+    }
+    fdcwires.push_back(temp);
+  }
+  return true;
+}
+
+//---------------------------------
+// GetFDCWires
+//---------------------------------
+bool DGeometry::GetFDCWires(vector<vector<const DFDCWire *> >&fdcwires) const{
+  pthread_mutex_lock(&wire_tables_mutex);
+  if (!fdcwires_read){
+    fdcwires_ok=ReadFDCWires(fdcwires_table);
+    fdcwires_read=true;
+  }
+  pthread_mutex_unlock(&wire_tables_mutex);
+
+  fdcwires.clear();
+  if (!fdcwires_ok) return false;
+  for (unsigned int i=0;i<fdcwires_table.size();i++){
+    fdcwires.push_back(vector<const DFDCWire*>(fdcwires_table[i].begin(),
+					       fdcwires_table[i].end()));
+  }
+  return true;
+}
+
+//---------------------------------
+// ReadFDCWires
+//---------------------------------
+bool DGeometry::ReadFDCWires(vector<vector<DFDCWire *> >&fdcwires) const{
   // Get geometrical information from database
   vector<double>z_wires;
   vector<double>stereo_angles;
@@ -1488,6 +1613,23 @@ bool DGeometry::GetTargetLength(double &target_length) const
 bool DGeometry::GetStartCounterGeom(vector<vector<DVector3> >&pos,
 				    vector<vector<DVector3> >&norm
 				    ) const{
+  pthread_mutex_lock(&wire_tables_mutex);
+  if (!sc_geom_read){
+    sc_geom_ok=ReadStartCounterGeom(sc_pos_table,sc_norm_table);
+    sc_geom_read=true;
+  }
+  pthread_mutex_unlock(&wire_tables_mutex);
+
+  if (!sc_geom_ok) return false;
+  pos.insert(pos.end(),sc_pos_table.begin(),sc_pos_table.end());
+  norm.insert(norm.end(),sc_norm_table.begin(),sc_norm_table.end());
+  return true;
+}
+
+// Read the start counter geometry from the XML
+bool DGeometry::ReadStartCounterGeom(vector<vector<DVector3> >&pos,
+				     vector<vector<DVector3> >&norm
+				     ) const{
 
   // Check if Start Counter geometry is present
   vector<double> sc_origin;
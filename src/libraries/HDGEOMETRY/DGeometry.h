@@ -108,14 +108,22 @@ class DGeometry{
 		// Convenience methods
 		const DMaterial* GetDMaterial(string name) const;
 
+		// The wire and cathode tables are built once per DGeometry object
+		// and kept. The versions taking non-const pointers return new
+		// copies that the caller owns and must delete. The versions
+		// taking const pointers return the shared tables, which must not
+		// be deleted and stay valid for the lifetime of this object.
 		bool GetFDCWires(vector<vector<DFDCWire *> >&fdcwires) const;
+		bool GetFDCWires(vector<vector<const DFDCWire *> >&fdcwires) const;
 		bool GetFDCCathodes(vector<vector<DFDCCathode *> >&fdccathodes) const;
+		bool GetFDCCathodes(vector<vector<const DFDCCathode *> >&fdccathodes) const;
 		bool GetFDCZ(vector<double> &z_wires) const; ///< z-locations for each of the FDC wire planes in cm
 		bool GetFDCStereo(vector<double> &stereo_angles) const; ///< stereo angles of each of the FDC wire layers
 		bool GetFDCRmin(vector<double> &rmin_packages) const; ///< beam hole size for each FDC package in cm
 		bool GetFDCRmax(double &rmax_active_fdc) const; ///< outer radius of FDC active area in cm
 		
 		bool GetCDCWires(vector<vector<DCDCWire *> >&cdcwires) const;
+		bool GetCDCWires(vector<vector<const DCDCWire *> >&cdcwires) const;
 		bool GetCDCOption(string &cdc_option) const; ///< get the centralDC_option-X string
 		bool GetCDCCenterZ(double &cdc_center_z) const; ///< z-location of center of CDC wires in cm
 		bool GetCDCAxialLength(double &cdc_axial_length) const; ///< length of CDC axial wires in cm
@@ -165,6 +173,11 @@ class DGeometry{
 		void ReadMaterialMaps(void) const;
 		void GetMaterials(void) const;
 		bool GetCompositeMaterial(const string &name, double &density, double &radlen) const;
+		bool ReadCDCWires(vector<vector<DCDCWire *> >&cdcwires) const;
+		bool ReadFDCWires(vector<vector<DFDCWire *> >&fdcwires) const;
+		bool ReadFDCCathodes(vector<vector<DFDCCathode *> >&fdccathodes) const;
+		bool ReadStartCounterGeom(vector<vector<DVector3> >&pos,
+					  vector<vector<DVector3> >&norm) const;
 	
 	private:
 		JGeometry *jgeom;
@@ -176,9 +189,20 @@ class DGeometry{
 		mutable bool materialmaps_read;
 		mutable bool materials_read;
 
+		// Wire, cathode and start counter tables built from the XML and
+		// the alignment constants the first time each is asked for
+		mutable bool cdcwires_read, fdcwires_read, fdccathodes_read, sc_geom_read;
+		mutable bool cdcwires_ok, fdcwires_ok, fdccathodes_ok, sc_geom_ok;
+		mutable vector<vector<DCDCWire *> > cdcwires_table;
+		mutable vector<vector<DFDCWire *> > fdcwires_table;
+		mutable vector<vector<DFDCCathode *> > fdccathodes_table;
+		mutable vector<vector<DVector3> > sc_pos_table;
+		mutable vector<vector<DVector3> > sc_norm_table;
+
 		mutable pthread_mutex_t bfield_mutex;
 		mutable pthread_mutex_t materialmap_mutex;
 		mutable pthread_mutex_t materials_mutex;
+		mutable pthread_mutex_t wire_tables_mutex;
 
 		
 };
@@ -24,13 +24,12 @@ static void locate(const double *xx,int n,double x,int *j){
 
 // Polynomial interpolation on a grid.
 // Adapted from Numerical Recipes in C (2nd Edition), pp. 121-122.
+// n may not be larger than PACKAGE_Z_POINTS.
 static void polint(const double *xa, const double *ya,int n,double x, double *y,
 	    double *dy){
   int i,m,ns=0;
   double den,dif,dift,ho,hp,w;
-
-  double *c=(double *)calloc(n,sizeof(double));
-  double *d=(double *)calloc(n,sizeof(double));
+  double c[PACKAGE_Z_POINTS],d[PACKAGE_Z_POINTS];
 
   dif=fabs(x-xa[0]);
   for (i=0;i<n;i++){
@@ -49,8 +48,6 @@ static void polint(const double *xa, const double *ya,int n,double x, double *y,
       hp=xa[i+m-1]-x;
       w=c[i+1-1]-d[i-1];
       if ((den=ho-hp)==0.0){
-	free(c);
-	free(d);
 	return;
       }
       den=w/den;
@@ -61,43 +58,171 @@ static void polint(const double *xa, const double *ya,int n,double x, double *y,
     
     *y+=(*dy=(2*ns<(n-m) ?c[ns+1]:d[ns--]));
   }
-  free(c);
-  free(d);
 }
 
-// Obtain slope parameters describing Lorentz deflection by interpolating 
-// on the Lorentz deflection table
-jerror_t DLorentzDeflections::GetLorentzCorrectionParameters(double x,
-							     double y,double z,
-							     double &tanz, 
-							     double &tanr) const{
-  int imin,ind,ind2;
-  double r=sqrt(x*x+y*y);
- 
-   // Locate positions in x and z arrays given r and z
-  locate(lorentz_x,LORENTZ_X_POINTS,r,&ind);
-  locate(lorentz_z,LORENTZ_Z_POINTS,z,&ind2);
-  
-  // First do interpolation in z direction 
-  imin=PACKAGE_Z_POINTS*(ind2/PACKAGE_Z_POINTS); // Integer division...
-  double ytemp[LORENTZ_X_POINTS],ytemp2[LORENTZ_X_POINTS],dy;
+// Interpolate the deflection data in z for each of the x points, using the
+// package starting at index imin
+void DLorentzDeflections::InterpolateInZ(int imin,double z,double *ytemp,
+					 double *ytemp2) const{
+  double dy;
   for (int j=0;j<LORENTZ_X_POINTS;j++){
     polint(&lorentz_z[imin],&lorentz_nx[j][imin],PACKAGE_Z_POINTS,z,
 	   &ytemp[j],&dy);
     polint(&lorentz_z[imin],&lorentz_nz[j][imin],PACKAGE_Z_POINTS,z,
 	   &ytemp2[j],&dy);
   }
-  // Then do final interpolation in x direction 
+}
+
+// Interpolate the output of InterpolateInZ in r
+void DLorentzDeflections::InterpolateInR(const double *ytemp,
+					 const double *ytemp2,double r,
+					 double &tanz,double &tanr) const{
+  int ind,imin;
+  double dy;
+  locate(lorentz_x,LORENTZ_X_POINTS,r,&ind);
   if (ind>0){
     imin=((ind+3)>LORENTZ_X_POINTS)?(LORENTZ_X_POINTS-4):(ind-1);
   }
   else imin=0;
   polint(&lorentz_x[imin],&ytemp[imin],4,r,&tanr,&dy);
   polint(&lorentz_x[imin],&ytemp2[imin],4,r,&tanz,&dy);
+}
+
+// Obtain slope parameters describing Lorentz deflection by interpolating 
+// on the Lorentz deflection table
+jerror_t DLorentzDeflections::GetLorentzCorrectionParametersExact(double x,
+							     double y,double z,
+							     double &tanz, 
+							     double &tanr) const{
+  int imin,ind2;
+  double r=sqrt(x*x+y*y);
+ 
+   // Locate position in z array
+  locate(lorentz_z,LORENTZ_Z_POINTS,z,&ind2);
+  
+  // First do interpolation in z direction 
+  imin=PACKAGE_Z_POINTS*(ind2/PACKAGE_Z_POINTS); // Integer division...
+  double ytemp[LORENTZ_X_POINTS],ytemp2[LORENTZ_X_POINTS];
+  InterpolateInZ(imin,z,ytemp,ytemp2);
+
+  // Then do final interpolation in x direction 
+  InterpolateInR(ytemp,ytemp2,r,tanz,tanr);
   
   return NOERROR;
 }
 
+// Fill the regular grid from the deflection data. Each package gets its
+// own z grid running from its first to its last point. Between packages
+// the polynomial interpolation extrapolates and is used as is.
+double DLorentzDeflections::BuildLorentzTable(void){
+  table_ok=false;
+
+  // The grid is only set up for data in increasing order
+  for (int i=1;i<LORENTZ_X_POINTS;i++){
+    if (!(lorentz_x[i]>lorentz_x[i-1])) return HUGE_VAL;
+  }
+  for (int i=1;i<LORENTZ_Z_POINTS;i++){
+    if (!(lorentz_z[i]>lorentz_z[i-1])) return HUGE_VAL;
+  }
+
+  table_r0=lorentz_x[0];
+  table_r_end=lorentz_x[LORENTZ_X_POINTS-1];
+  double dr=(table_r_end-table_r0)/LORENTZ_TABLE_R_CELLS;
+  table_one_over_dr=1./dr;
+
+  double ytemp[LORENTZ_X_POINTS],ytemp2[LORENTZ_X_POINTS];
+  for (int p=0;p<LORENTZ_PACKAGES;p++){
+    int imin=p*PACKAGE_Z_POINTS;
+    double z0=lorentz_z[imin];
+    double z1=lorentz_z[imin+PACKAGE_Z_POINTS-1];
+    double dz=(z1-z0)/LORENTZ_TABLE_Z_CELLS;
+    table_z0[p]=z0;
+    table_z_end[p]=z1;
+    table_one_over_dz[p]=1./dz;
+
+    for (int iz=0;iz<LORENTZ_TABLE_Z_NODES;iz++){
+      double z=z0+iz*dz;
+      InterpolateInZ(imin,z,ytemp,ytemp2);
+      for (int ir=0;ir<LORENTZ_TABLE_R_NODES;ir++){
+	double tanz=0.,tanr=0.;
+	InterpolateInR(ytemp,ytemp2,table_r0+ir*dr,tanz,tanr);
+	table_tanr[p][iz][ir]=tanr;
+	table_tanz[p][iz][ir]=tanz;
+      }
+    }
+  }
+  table_ok=true;
+
+  // Compare with the polynomial interpolation at the cell centers where
+  // the bilinear interpolation is least accurate
+  double max_diff=0.;
+  for (int p=0;p<LORENTZ_PACKAGES;p++){
+    double dz=1./table_one_over_dz[p];
+    for (int iz=0;iz<LORENTZ_TABLE_Z_CELLS;iz++){
+      double z=table_z0[p]+(iz+0.5)*dz;
+      for (int ir=0;ir<LORENTZ_TABLE_R_CELLS;ir++){
+	double r=table_r0+(ir+0.5)*dr;
+	double tanz,tanr,tanz_exact,tanr_exact;
+	GetLorentzCorrectionParameters(r,0.,z,tanz,tanr);
+	GetLorentzCorrectionParametersExact(r,0.,z,tanz_exact,tanr_exact);
+	double diff=fabs(tanz-tanz_exact);
+	if (diff>max_diff) max_diff=diff;
+	diff=fabs(tanr-tanr_exact);
+	if (diff>max_diff) max_diff=diff;
+      }
+    }
+  }
+  if (!(max_diff<=LORENTZ_TABLE_TOLERANCE)) table_ok=false;
+
+  return max_diff;
+}
+
+// Find the package and z cell of the grid containing z. Returns false if
+// z is not within one of the packages.
+bool DLorentzDeflections::LocateInTable(double z,int &package,int &iz,
+					double &fz) const{
+  if (!table_ok) return false;
+
+  for (package=0;package<LORENTZ_PACKAGES;package++){
+    if (z<=table_z_end[package]) break;
+  }
+  if (package==LORENTZ_PACKAGES || !(z>=table_z0[package])) return false;
+
+  double u=(z-table_z0[package])*table_one_over_dz[package];
+  iz=int(u);
+  if (iz>LORENTZ_TABLE_Z_CELLS-1) iz=LORENTZ_TABLE_Z_CELLS-1;
+  fz=u-iz;
+
+  return true;
+}
+
+// Obtain slope parameters describing Lorentz deflection, using the regular
+// grid where possible
+jerror_t DLorentzDeflections::GetLorentzCorrectionParameters(double x,
+							     double y,double z,
+							     double &tanz, 
+							     double &tanr) const{
+  int p,iz;
+  double fz;
+  double r=sqrt(x*x+y*y);
+  if (!LocateInTable(z,p,iz,fz) || !(r>=table_r0 && r<=table_r_end)){
+    return GetLorentzCorrectionParametersExact(x,y,z,tanz,tanr);
+  }
+
+  double u=(r-table_r0)*table_one_over_dr;
+  int ir=int(u);
+  if (ir>LORENTZ_TABLE_R_CELLS-1) ir=LORENTZ_TABLE_R_CELLS-1;
+  double fr=u-ir;
+  const float *tr0=&table_tanr[p][iz][ir];
+  const float *tr1=&table_tanr[p][iz+1][ir];
+  const float *tz0=&table_tanz[p][iz][ir];
+  const float *tz1=&table_tanz[p][iz+1][ir];
+  tanr=(1.-fz)*((1.-fr)*tr0[0]+fr*tr0[1])+fz*((1.-fr)*tr1[0]+fr*tr1[1]);
+  tanz=(1.-fz)*((1.-fr)*tz0[0]+fr*tz0[1])+fz*((1.-fr)*tz1[0]+fr*tz1[1]);
+
+  return NOERROR;
+}
+
 // Obtain deflection of avalanche along wire due to Lorentz force
 double DLorentzDeflections::GetLorentzCorrection(double x,double y,double z,
 						 double alpha,double dx) const
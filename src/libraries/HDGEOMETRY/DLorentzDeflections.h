@@ -7,25 +7,60 @@
 #define PACKAGE_Z_POINTS 10
 #define LORENTZ_X_POINTS 21
 #define LORENTZ_Z_POINTS (4*PACKAGE_Z_POINTS)
+#define LORENTZ_PACKAGES (LORENTZ_Z_POINTS/PACKAGE_Z_POINTS)
+
+/* Regular grid the deflection data are tabulated on for fast lookup. The
+   r range of the data is split into LORENTZ_TABLE_R_CELLS cells and the z
+   range of each package into LORENTZ_TABLE_Z_CELLS cells. */
+#define LORENTZ_TABLE_R_CELLS 160
+#define LORENTZ_TABLE_Z_CELLS 64
+#define LORENTZ_TABLE_R_NODES (LORENTZ_TABLE_R_CELLS+1)
+#define LORENTZ_TABLE_Z_NODES (LORENTZ_TABLE_Z_CELLS+1)
+#define LORENTZ_TABLE_TOLERANCE 1.0e-4
 
 class DLorentzDeflections{
  public:
-  
-  DLorentzDeflections(){};
+
+  DLorentzDeflections():table_ok(false){};
   virtual ~DLorentzDeflections(){};
   jerror_t GetLorentzCorrectionParameters(double x,double y,double z,
 				double &tanz, double &tanr) const;
   double GetLorentzCorrection(double x,double y,double z,double alpha,
 			      double dx) const;
-  
+
+  // Direct polynomial interpolation on the deflection data, bypassing
+  // the regular grid
+  jerror_t GetLorentzCorrectionParametersExact(double x,double y,double z,
+					double &tanz,double &tanr) const;
+
  protected:
-  // Variables for implementing lorentz effect (deflections of avalanche 
+  // Fill the regular grid from the deflection data and check it against
+  // the polynomial interpolation. Returns the largest difference seen.
+  // The grid is used only if this is within LORENTZ_TABLE_TOLERANCE.
+  double BuildLorentzTable(void);
+
+  // Variables for implementing lorentz effect (deflections of avalanche
   // position due to the magnetic field).
   double lorentz_x[LORENTZ_X_POINTS];
   double lorentz_z[LORENTZ_Z_POINTS];
   double lorentz_nx[LORENTZ_X_POINTS][LORENTZ_Z_POINTS];
   double lorentz_nz[LORENTZ_X_POINTS][LORENTZ_Z_POINTS];
-  
+
+ private:
+  void InterpolateInZ(int imin,double z,double *ytemp,double *ytemp2) const;
+  void InterpolateInR(const double *ytemp,const double *ytemp2,double r,
+		      double &tanz,double &tanr) const;
+  bool LocateInTable(double z,int &package,int &iz,double &fz) const;
+
+  // Regular grid, stored as separate tanr and tanz arrays indexed
+  // [package][z node][r node] so that a plane is one contiguous block
+  bool table_ok;
+  double table_r0,table_r_end,table_one_over_dr;
+  double table_z0[LORENTZ_PACKAGES],table_z_end[LORENTZ_PACKAGES];
+  double table_one_over_dz[LORENTZ_PACKAGES];
+  float table_tanr[LORENTZ_PACKAGES][LORENTZ_TABLE_Z_NODES][LORENTZ_TABLE_R_NODES];
+  float table_tanz[LORENTZ_PACKAGES][LORENTZ_TABLE_Z_NODES][LORENTZ_TABLE_R_NODES];
+
 };
 
 #endif // _DLorentzDeflections_
@@ -81,5 +81,14 @@ unsigned int DLorentzMapCalibDB::GetLorentzDeflections(void){
     lorentz_nx[xindex][zindex] = row["nx"];
     lorentz_nz[xindex][zindex] = row["nz"];
   }
+
+  // Tabulate on a regular grid for fast lookup
+  double max_diff=BuildLorentzTable();
+  if (max_diff<=LORENTZ_TABLE_TOLERANCE){
+    jout<<"Lorentz deflections tabulated on "<<LORENTZ_TABLE_R_NODES<<"x"<<LORENTZ_TABLE_Z_NODES<<" grid per package (max. difference "<<max_diff<<")"<<endl;
+  }else{
+    jout<<"Lorentz deflection grid differs from interpolation by "<<max_diff<<". Using interpolation."<<endl;
+  }
+
   return tvals.size();
 }
@@ -3,7 +3,14 @@
 //    File: DMagneticFieldMapFineMesh.cc
 
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 using namespace std;
 #ifdef HAVE_EVIO
 #include <evioFileChannel.hxx>
@@ -20,11 +27,20 @@ using namespace evio;
 //---------------------------------
 DMagneticFieldMapFineMesh::DMagneticFieldMapFineMesh(JApplication *japp, unsigned int runnumber, string namepath)
 {
+	Init();
 	jcalib = japp->GetJCalibration(runnumber);
 	jresman = japp->GetJResourceManager(runnumber);
 
 	JParameterManager *jparms = japp->GetJParameterManager();
 	jparms->SetDefaultParameter("BFIELD_MAP", namepath);
+	string cache_dir = "";
+	jparms->SetDefaultParameter("BFIELD_MAP_CACHE", cache_dir, "Directory for the binary cache of the derived solenoid field tables. Empty to keep it next to the field map resource, \"none\" to disable the cache.");
+
+	// Use the cached tables if they were made from the same map
+	uint64_t source_checksum = 0;
+	string cacheFileName = "";
+	if(cache_dir != "none") cacheFileName = GetCacheFileName(namepath, cache_dir, source_checksum);
+	if(cacheFileName != "" && ReadCache(cacheFileName, source_checksum)) return;
 	
 	int Npoints = ReadMap(namepath, runnumber); 
 	if(Npoints==0){
@@ -33,6 +49,15 @@ DMagneticFieldMapFineMesh::DMagneticFieldMapFineMesh(JApplication *japp, unsigne
 	}
 	
 	GetFineMeshMap(namepath,runnumber);
+
+	// Save the tables for the next process. If that worked, switch to
+	// the mapped copy so that this process shares it too.
+	if(cacheFileName != "" && WriteCache(cacheFileName, source_checksum)){
+	  if(ReadCache(cacheFileName, source_checksum)){
+	    vector<DBfieldPoint_t>().swap(BtableStorage);
+	    vector<DBfieldCylindrical_t>().swap(mBfineStorage);
+	  }
+	}
 }
 
 //---------------------------------
@@ -40,6 +65,7 @@ DMagneticFieldMapFineMesh::DMagneticFieldMapFineMesh(JApplication *japp, unsigne
 //---------------------------------
 DMagneticFieldMapFineMesh::DMagneticFieldMapFineMesh(JCalibration *jcalib, string namepath,int runnumber)
 {
+	Init();
 	this->jcalib = jcalib;
 	GetFineMeshMap(namepath,runnumber);
 }
@@ -49,7 +75,288 @@ DMagneticFieldMapFineMesh::DMagneticFieldMapFineMesh(JCalibration *jcalib, strin
 //---------------------------------
 DMagneticFieldMapFineMesh::~DMagneticFieldMapFineMesh()
 {
+	if(cache_map) munmap(cache_map, cache_map_length);
+}
+
+//---------------------------------
+// Init
+//---------------------------------
+void DMagneticFieldMapFineMesh::Init(void)
+{
+	jcalib = NULL;
+	jresman = NULL;
+	Btable = NULL;
+	mBfine = NULL;
+	Nx = Ny = Nz = 0;
+	NrFine = NzFine = 0;
+	cache_map = NULL;
+	cache_map_length = 0;
+}
+
+//---------------------------------
+// Field table cache
+//---------------------------------
+// The coarse table (including the gradients) and the fine mesh are
+// written to a binary file the first time a map is used and mapped
+// read-only by later processes. All processes on a host using the
+// same map then share one copy of the tables in memory and skip
+// parsing the map and building the fine mesh.
+//
+// The file is a header followed by the two tables, each starting on
+// a 64-byte boundary, stored exactly as they are in memory (native
+// byte order). The header holds a checksum of the ASCII map and
+// fine-mesh files it was made from, so the cache is rebuilt when
+// either changes, and a checksum of the tables, so a damaged file
+// is never used. Files
+// are written under a temporary name and renamed into place so that
+// a process never sees a partially written cache.
+namespace{
+	const char BFIELD_CACHE_MAGIC[8] = {'H','D','B','F','M','A','P','\0'};
+	const uint32_t BFIELD_CACHE_BYTE_ORDER = 0x01020304;
+	const uint32_t BFIELD_CACHE_VERSION = 1;
+
+	typedef struct{
+		char magic[8];
+		uint32_t byte_order;
+		uint32_t version;
+		uint32_t sizeof_point;
+		uint32_t sizeof_cylindrical;
+		uint64_t source_checksum;
+		uint64_t data_checksum;
+		uint64_t file_size;
+		uint64_t Btable_offset;
+		uint64_t mBfine_offset;
+		int32_t Nx, Ny, Nz;
+		uint32_t NrFine, NzFine;
+		float xmin, xmax, ymin, ymax, zmin, zmax;
+		double dx, dy, dz;
+		double rminFine, rmaxFine, drFine, zminFine, zmaxFine, dzFine;
+	}bfield_cache_header_t;
+
+	// Simple 64-bit checksum of a block of memory, folding in 8 bytes
+	// at a time.
+	uint64_t BfieldChecksum(const void *data, size_t len, uint64_t h=1469598103934665603ULL)
+	{
+		const char *p = (const char*)data;
+		size_t Nwords = len/8;
+		for(size_t i=0; i<Nwords; i++, p+=8){
+			uint64_t w;
+			memcpy(&w, p, 8);
+			h = (h ^ w)*1099511628211ULL;
+			h ^= h>>29;
+		}
+		for(size_t i=Nwords*8; i<len; i++, p++){
+			h = (h ^ (unsigned char)*p)*1099511628211ULL;
+		}
+		return h;
+	}
+
+	// Fold the contents of a file into a checksum. Returns false if
+	// the file can't be opened.
+	bool BfieldFileChecksum(string fname, uint64_t &h)
+	{
+		ifstream ifs(fname.c_str(), ios::binary);
+		if(!ifs.is_open()) return false;
+		vector<char> buff(1<<20);
+		while(ifs.good()){
+			ifs.read(&buff[0], buff.size());
+			h = BfieldChecksum(&buff[0], ifs.gcount(), h);
+		}
+		return true;
+	}
+
+	uint64_t BfieldCacheAlign(uint64_t pos){ return (pos+63) & ~(uint64_t)63; }
+}
+
+//---------------------------------
+// GetCacheFileName
+//---------------------------------
+string DMagneticFieldMapFineMesh::GetCacheFileName(string namepath, string cache_dir, uint64_t &source_checksum)
+{
+	/// Return the name of the cache file for the given map and the
+	/// checksum of the files the tables are made from: the map file
+	/// and, if there is one, the fine-mesh evio file. Returns an empty
+	/// string if the map is not available as a local resource file
+	/// (e.g. the old maps stored directly in the calibration DB), in
+	/// which case no cache is used.
+	if(!jresman) return "";
+	string fname;
+	try{
+		fname = jresman->GetResource(namepath);
+	}catch(...){
+		return "";
+	}
+	
+	source_checksum = BfieldChecksum(namepath.c_str(), namepath.size());
+	if(!BfieldFileChecksum(fname, source_checksum)) return "";
+
+	// A fine mesh generated from the map adds nothing to the checksum
+	string evioFileNameToWrite;
+	string evioFileName = GetFineMeshFileName(namepath, evioFileNameToWrite);
+	if(evioFileName != "" && !BfieldFileChecksum(evioFileName, source_checksum)) return "";
+	
+	if(cache_dir == "") return fname + ".bfcache";
+	size_t ipos = fname.rfind("/");
+	string base = (ipos==string::npos) ? fname : fname.substr(ipos+1);
+	return cache_dir + "/" + base + ".bfcache";
+}
+
+//---------------------------------
+// ReadCache
+//---------------------------------
+bool DMagneticFieldMapFineMesh::ReadCache(string cacheFileName, uint64_t source_checksum)
+{
+	/// Map the cache file and point the tables into it. Returns false
+	/// (leaving the tables untouched) if the file does not exist or
+	/// does not belong to this map and build.
+	int fd = open(cacheFileName.c_str(), O_RDONLY);
+	if(fd < 0) return false;
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(bfield_cache_header_t)){
+		close(fd);
+		return false;
+	}
+	size_t length = st.st_size;
+	void *addr = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED) return false;
+
+	const bfield_cache_header_t *h = (const bfield_cache_header_t*)addr;
+	const char *base = (const char*)addr;
+	uint64_t Npoints = (uint64_t)h->Nx*h->Ny*h->Nz;
+	uint64_t NpointsFine = (uint64_t)h->NrFine*h->NzFine;
+	bool ok = memcmp(h->magic, BFIELD_CACHE_MAGIC, sizeof(h->magic))==0
+		&& h->byte_order == BFIELD_CACHE_BYTE_ORDER
+		&& h->version == BFIELD_CACHE_VERSION
+		&& h->sizeof_point == sizeof(DBfieldPoint_t)
+		&& h->sizeof_cylindrical == sizeof(DBfieldCylindrical_t)
+		&& h->source_checksum == source_checksum
+		&& h->file_size == length
+		&& h->Nx>0 && h->Ny>0 && h->Nz>0
+		&& h->Btable_offset >= sizeof(bfield_cache_header_t)
+		&& h->Btable_offset + Npoints*sizeof(DBfieldPoint_t) <= h->mBfine_offset
+		&& h->mBfine_offset + NpointsFine*sizeof(DBfieldCylindrical_t) <= length;
+	if(ok){
+		uint64_t data_checksum = BfieldChecksum(base + h->Btable_offset, Npoints*sizeof(DBfieldPoint_t));
+		data_checksum = BfieldChecksum(base + h->mBfine_offset, NpointsFine*sizeof(DBfieldCylindrical_t), data_checksum);
+		ok = (data_checksum == h->data_checksum);
+	}
+	if(!ok){
+		jout<<"Ignoring out of date or damaged B-field cache "<<cacheFileName<<endl;
+		munmap(addr, length);
+		return false;
+	}
+
+	if(cache_map) munmap(cache_map, cache_map_length);
+	cache_map = addr;
+	cache_map_length = length;
+
+	Nx = h->Nx;
+	Ny = h->Ny;
+	Nz = h->Nz;
+	xmin = h->xmin;
+	xmax = h->xmax;
+	ymin = h->ymin;
+	ymax = h->ymax;
+	zmin = h->zmin;
+	zmax = h->zmax;
+	dx = h->dx;
+	dy = h->dy;
+	dz = h->dz;
+	one_over_dx=1./dx;
+	one_over_dz=1./dz;
+	Btable = (const DBfieldPoint_t*)(base + h->Btable_offset);
+
+	NrFine = h->NrFine;
+	NzFine = h->NzFine;
+	rminFine = h->rminFine;
+	rmaxFine = h->rmaxFine;
+	drFine = h->drFine;
+	zminFine = h->zminFine;
+	zmaxFine = h->zmaxFine;
+	dzFine = h->dzFine;
+	zscale=1./dzFine;
+	rscale=1./drFine;
+	mBfine = (const DBfieldCylindrical_t*)(base + h->mBfine_offset);
+
+	jout<<"Mapped magnetic field tables from "<<cacheFileName<<" (Nx="<<Nx<<" Nz="<<Nz
+	    <<" NrFine="<<NrFine<<" NzFine="<<NzFine<<")"<<endl;
+
+	return true;
+}
+
+//---------------------------------
+// WriteCache
+//---------------------------------
+bool DMagneticFieldMapFineMesh::WriteCache(string cacheFileName, uint64_t source_checksum)
+{
+	/// Write the current tables to the cache file. Failure (e.g. a
+	/// read-only resource directory) is not an error; the tables are
+	/// simply rebuilt by the next process.
+	if(!Btable || !mBfine) return false;
+
+	uint64_t Npoints = (uint64_t)Nx*Ny*Nz;
+	uint64_t NpointsFine = (uint64_t)NrFine*NzFine;
+
+	bfield_cache_header_t h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, BFIELD_CACHE_MAGIC, sizeof(h.magic));
+	h.byte_order = BFIELD_CACHE_BYTE_ORDER;
+	h.version = BFIELD_CACHE_VERSION;
+	h.sizeof_point = sizeof(DBfieldPoint_t);
+	h.sizeof_cylindrical = sizeof(DBfieldCylindrical_t);
+	h.source_checksum = source_checksum;
+	h.Btable_offset = BfieldCacheAlign(sizeof(h));
+	h.mBfine_offset = BfieldCacheAlign(h.Btable_offset + Npoints*sizeof(DBfieldPoint_t));
+	h.file_size = h.mBfine_offset + NpointsFine*sizeof(DBfieldCylindrical_t);
+	h.Nx = Nx;
+	h.Ny = Ny;
+	h.Nz = Nz;
+	h.NrFine = NrFine;
+	h.NzFine = NzFine;
+	h.xmin = xmin;
+	h.xmax = xmax;
+	h.ymin = ymin;
+	h.ymax = ymax;
+	h.zmin = zmin;
+	h.zmax = zmax;
+	h.dx = dx;
+	h.dy = dy;
+	h.dz = dz;
+	h.rminFine = rminFine;
+	h.rmaxFine = rmaxFine;
+	h.drFine = drFine;
+	h.zminFine = zminFine;
+	h.zmaxFine = zmaxFine;
+	h.dzFine = dzFine;
+	h.data_checksum = BfieldChecksum(Btable, Npoints*sizeof(DBfieldPoint_t));
+	h.data_checksum = BfieldChecksum(mBfine, NpointsFine*sizeof(DBfieldCylindrical_t), h.data_checksum);
+
+	stringstream ss;
+	ss << cacheFileName << ".tmp." << getpid();
+	string tmpFileName = ss.str();
+	ofstream ofs(tmpFileName.c_str(), ios::binary);
+	if(!ofs.is_open()){
+		jout<<"Unable to write B-field cache "<<cacheFileName<<" (continuing without it)"<<endl;
+		return false;
+	}
+	
+	static const char zeros[64] = {0};
+	ofs.write((const char*)&h, sizeof(h));
+	ofs.write(zeros, h.Btable_offset - sizeof(h));
+	ofs.write((const char*)Btable, Npoints*sizeof(DBfieldPoint_t));
+	ofs.write(zeros, h.mBfine_offset - (h.Btable_offset + Npoints*sizeof(DBfieldPoint_t)));
+	ofs.write((const char*)mBfine, NpointsFine*sizeof(DBfieldCylindrical_t));
+	ofs.close();
+	if(!ofs.good() || rename(tmpFileName.c_str(), cacheFileName.c_str())!=0){
+		jout<<"Unable to write B-field cache "<<cacheFileName<<" (continuing without it)"<<endl;
+		unlink(tmpFileName.c_str());
+		return false;
+	}
+	
+	jout<<"Wrote magnetic field tables to "<<cacheFileName<<endl;
 
+	return true;
 }
 
 //---------------------------------
@@ -150,11 +457,10 @@ int DMagneticFieldMapFineMesh::ReadMap(string namepath, int runnumber, string co
   cout<<" Nz="<<Nz;
   cout<<" )  at 0x"<<hex<<(unsigned long)this<<dec<<endl;
   
-  // Create 3D vector so we can index the values by [x][y][z]
-  vector<DBfieldPoint_t> zvec(Nz);
-  vector< vector<DBfieldPoint_t> > yvec;
-  for(int i=0; i<Ny; i++)yvec.push_back(zvec);
-  for(int i=0; i<Nx; i++)Btable.push_back(yvec);
+  // Create the table so we can index the values by [x][y][z]
+  BtableStorage.clear();
+  BtableStorage.resize(Nx*Ny*Nz);
+  Btable=BtableStorage.empty() ? NULL:&BtableStorage[0];
 	
   // Distance between map points for r and z
   dx = (xmax-xmin)/(double)(Nx-1);
@@ -170,7 +476,7 @@ int DMagneticFieldMapFineMesh::ReadMap(string namepath, int runnumber, string co
     int xindex = (int)floor((a[0]-xmin+dx/2.0)/dx); // the +dx/2.0 guarantees against round-off errors
     int yindex = (int)(Ny<2 ? 0:floor((a[1]-ymin+dy/2.0)/dy));
     int zindex = (int)floor((a[2]-zmin+dz/2.0)/dz);
-    DBfieldPoint_t *b = &Btable[xindex][yindex][zindex];
+    DBfieldPoint_t *b = &BtableStorage[(xindex*Ny+yindex)*Nz+zindex];
     b->x = a[0];
     b->y = a[1];
     b->z = a[2];
@@ -210,14 +516,14 @@ int DMagneticFieldMapFineMesh::ReadMap(string namepath, int runnumber, string co
 	double d_index_x=double(index_x1-index_x0);
 	double d_index_z=double(index_z1-index_z0); 
 
-	DBfieldPoint_t *Bx0 = &Btable[index_x0][index_y][index_z];
-	DBfieldPoint_t *Bx1 = &Btable[index_x1][index_y][index_z];
+	const DBfieldPoint_t *Bx0 = GetPoint(index_x0,index_y,index_z);
+	const DBfieldPoint_t *Bx1 = GetPoint(index_x1,index_y,index_z);
 	//DBfieldPoint_t *By0 = &Btable[index_x][index_y0][index_z];
 	//DBfieldPoint_t *By1 = &Btable[index_x][index_y1][index_z];
-	DBfieldPoint_t *Bz0 = &Btable[index_x][index_y][index_z0];
-	DBfieldPoint_t *Bz1 = &Btable[index_x][index_y][index_z1];
+	const DBfieldPoint_t *Bz0 = GetPoint(index_x,index_y,index_z0);
+	const DBfieldPoint_t *Bz1 = GetPoint(index_x,index_y,index_z1);
 	
-	DBfieldPoint_t *g = &Btable[index_x][index_y][index_z];
+	DBfieldPoint_t *g = &BtableStorage[(index_x*Ny+index_y)*Nz+index_z];
 	g->dBxdx = (Bx1->Bx - Bx0->Bx)/d_index_x;
 	//g->dBxdy = (By1->Bx - By0->Bx)/(double)(index_y1-index_y0);
 	g->dBxdz = (Bz1->Bx - Bz0->Bx)/d_index_z;
@@ -230,10 +536,10 @@ int DMagneticFieldMapFineMesh::ReadMap(string namepath, int runnumber, string co
 	//g->dBzdy = (By1->Bz - By0->Bz)/(double)(index_y1-index_y0);
 	g->dBzdz = (Bz1->Bz - Bz0->Bz)/d_index_z;
 
-	DBfieldPoint_t *B11 = &Btable[index_x1][index_y][index_z1];
-	DBfieldPoint_t *B01 = &Btable[index_x0][index_y][index_z1];	
-	DBfieldPoint_t *B10 = &Btable[index_x1][index_y][index_z0];
-	DBfieldPoint_t *B00 = &Btable[index_x0][index_y][index_z0];
+	const DBfieldPoint_t *B11 = GetPoint(index_x1,index_y,index_z1);
+	const DBfieldPoint_t *B01 = GetPoint(index_x0,index_y,index_z1);	
+	const DBfieldPoint_t *B10 = GetPoint(index_x1,index_y,index_z0);
+	const DBfieldPoint_t *B00 = GetPoint(index_x0,index_y,index_z0);
 	
 	g->dBxdxdz=(B11->Bx - B01->Bx - B10->Bx + B00->Bx)/d_index_x/d_index_z;
 	g->dBzdxdz=(B11->Bz - B01->Bz - B10->Bz + B00->Bz)/d_index_x/d_index_z;
@@ -293,10 +599,10 @@ void DMagneticFieldMapFineMesh::GetFieldBicubic(double x,double y,double z,
     int index_z1 = index_z + (index_z<Nz-1 ? 1:0);
     
     // Pointers to magnetic field structure
-    const DBfieldPoint_t *B00 = &Btable[index_x][index_y][index_z];
-    const DBfieldPoint_t *B01 = &Btable[index_x][index_y][index_z1];
-    const DBfieldPoint_t *B11 = &Btable[index_x1][index_y][index_z1]; 
-    const DBfieldPoint_t *B10 = &Btable[index_x1][index_y][index_z];
+    const DBfieldPoint_t *B00 = GetPoint(index_x,index_y,index_z);
+    const DBfieldPoint_t *B01 = GetPoint(index_x,index_y,index_z1);
+    const DBfieldPoint_t *B11 = GetPoint(index_x1,index_y,index_z1); 
+    const DBfieldPoint_t *B10 = GetPoint(index_x1,index_y,index_z);
     
     // First compute the interpolation for Br
     temp[0]=B00->Bx;
@@ -372,8 +678,8 @@ void DMagneticFieldMapFineMesh::GetFieldBicubic(double x,double y,double z,
     unsigned int indr=(unsigned int)floor((r-rminFine)*rscale);
     unsigned int indz=(unsigned int)floor((z-zminFine)*zscale);
     
-    Bz_=mBfine[indr][indz].Bz;
-    Br_=mBfine[indr][indz].Br;
+    Bz_=GetFinePoint(indr,indz)->Bz;
+    Br_=GetFinePoint(indr,indz)->Br;
     //	  printf("Bz Br %f %f\n",Bz,Br);
   }
 
@@ -430,10 +736,10 @@ void DMagneticFieldMapFineMesh::InterpolateField(double r,double z,double &Br,
   int index_z1 = index_z + (index_z<Nz-1 ? 1:0);
   
   // Pointers to magnetic field structure
-  const DBfieldPoint_t *B00 = &Btable[index_x][index_y][index_z];
-  const DBfieldPoint_t *B01 = &Btable[index_x][index_y][index_z1];
-  const DBfieldPoint_t *B11 = &Btable[index_x1][index_y][index_z1]; 
-  const DBfieldPoint_t *B10 = &Btable[index_x1][index_y][index_z];
+  const DBfieldPoint_t *B00 = GetPoint(index_x,index_y,index_z);
+  const DBfieldPoint_t *B01 = GetPoint(index_x,index_y,index_z1);
+  const DBfieldPoint_t *B11 = GetPoint(index_x1,index_y,index_z1); 
+  const DBfieldPoint_t *B10 = GetPoint(index_x1,index_y,index_z);
     
   // First compute the interpolation for Br
   temp[0]=B00->Bx;
@@ -556,7 +862,7 @@ void DMagneticFieldMapFineMesh::GetFieldAndGradient(double x,double y,double z,
   int index_y = 0;
   
   if(index_x<Nx && index_z>=0 && index_z<Nz){
-    const DBfieldPoint_t *B = &Btable[index_x][index_y][index_z];
+    const DBfieldPoint_t *B = GetPoint(index_x,index_y,index_z);
     
     // Fractional distance between map points.
     double ur = (r - B->x)*one_over_dx;
@@ -574,7 +880,7 @@ void DMagneticFieldMapFineMesh::GetFieldAndGradient(double x,double y,double z,
   else{ // otherwise do a simple lookup in the fine-mesh table
     unsigned int indr=static_cast<unsigned int>(r*rscale);
     unsigned int indz=static_cast<unsigned int>((z-zminFine)*zscale);
-    const DBfieldCylindrical_t *field=&mBfine[indr][indz];
+    const DBfieldCylindrical_t *field=GetFinePoint(indr,indz);
 
     Bz_=field->Bz;
     Br_=field->Br;
@@ -635,7 +941,7 @@ void DMagneticFieldMapFineMesh::GetFieldGradient(double x, double y, double z,
 	
 	int index_y = 0;
 
-	const DBfieldPoint_t *B = &Btable[index_x][index_y][index_z];
+	const DBfieldPoint_t *B = GetPoint(index_x,index_y,index_z);
 
 	// Convert r back to x,y components
 	double cos_theta = x/r;
@@ -708,7 +1014,7 @@ void DMagneticFieldMapFineMesh::GetField(double x, double y, double z, double &B
 	  
 	  int index_y = 0;
 	  
-	  const DBfieldPoint_t *B = &Btable[index_x][index_y][index_z];
+	  const DBfieldPoint_t *B = GetPoint(index_x,index_y,index_z);
 	  
 	  // Fractional distance between map points.
 	  double ur = (r - B->x)*one_over_dx;
@@ -721,7 +1027,7 @@ void DMagneticFieldMapFineMesh::GetField(double x, double y, double z, double &B
         else{ // otherwise do a simple lookup in the fine-mesh table
 	  unsigned int indr=static_cast<unsigned int>(r*rscale);
 	  unsigned int indz=static_cast<unsigned int>((z-zminFine)*zscale);
-	  const DBfieldCylindrical_t *field=&mBfine[indr][indz];
+	  const DBfieldCylindrical_t *field=GetFinePoint(indr,indz);
 
 	  Bz=field->Bz;
 	  Br=field->Br;
@@ -778,7 +1084,7 @@ void DMagneticFieldMapFineMesh::GetField(const DVector3 &pos,DVector3 &Bout) con
 	  
 	  int index_y = 0;
 	  
-	  const DBfieldPoint_t *B = &Btable[index_x][index_y][index_z];
+	  const DBfieldPoint_t *B = GetPoint(index_x,index_y,index_z);
 	  
 	  // Fractional distance between map points.
 	  double ur = (r - B->x)*one_over_dx;
@@ -791,7 +1097,7 @@ void DMagneticFieldMapFineMesh::GetField(const DVector3 &pos,DVector3 &Bout) con
         else{ // otherwise do a simple lookup in the fine-mesh table
 	  unsigned int indr=static_cast<unsigned int>(r*rscale);
 	  unsigned int indz=static_cast<unsigned int>((z-zminFine)*zscale);
-	  const DBfieldCylindrical_t *field=&mBfine[indr][indz];
+	  const DBfieldCylindrical_t *field=GetFinePoint(indr,indz);
 
 	  Bz=field->Bz;
 	  Br=field->Br;
@@ -826,7 +1132,7 @@ double DMagneticFieldMapFineMesh::GetBz(double x, double y, double z) const{
     
     int index_y = 0;
     
-    const DBfieldPoint_t *B = &Btable[index_x][index_y][index_z];
+    const DBfieldPoint_t *B = GetPoint(index_x,index_y,index_z);
     
     // Fractional distance between map points.
     double ur = (r - B->x)*one_over_dx;
@@ -840,20 +1146,48 @@ double DMagneticFieldMapFineMesh::GetBz(double x, double y, double z) const{
   unsigned int indr=static_cast<unsigned int>(r*rscale);
   unsigned int indz=static_cast<unsigned int>((z-zminFine)*zscale);
   
-  return mBfine[indr][indz].Bz;
+  return GetFinePoint(indr,indz)->Bz;
 }
 
 // Read a fine-mesh B-field map from an evio file
 void DMagneticFieldMapFineMesh::GetFineMeshMap(string namepath,int runnumber){ 
+#ifdef HAVE_EVIO
+    if(namepath.rfind("/") == string::npos)
+        throw JException("Could not parse field map: "+namepath);
+    string evioFileNameToWrite = "";
+    string evioFileName = GetFineMeshFileName(namepath, evioFileNameToWrite);
+
+    if(evioFileName != "") {
+        ReadEvioFile(evioFileName);
+    } else{
+#endif  
+    cout << "Fine-mesh evio file does not exist." <<endl;
+    cout << "Constructing the fine-mesh B-field map..." << endl;    
+    GenerateFineMesh();
+#ifdef HAVE_EVIO
+    WriteEvioFile(evioFileNameToWrite);
+  }
+#endif
+  cout << " rmin: " << rminFine << " rmax: " << rmaxFine 
+       << " dr: " << drFine << " zmin: " << zminFine << " zmax: "
+       << zmaxFine << " dz: " << dzFine <<endl;  
+  cout << " Number of points in z = " <<NzFine <<endl;
+  cout << " Number of points in r = " << NrFine << endl;
+}
+
+// Find the fine-mesh evio file for a map. Returns an empty string if
+// there is none, in which case evioFileNameToWrite is set to the local
+// file a generated fine mesh should be saved to.
+string DMagneticFieldMapFineMesh::GetFineMeshFileName(string namepath,
+						      string &evioFileNameToWrite){
+  evioFileNameToWrite = "";
 #ifdef HAVE_EVIO
     // The solenoid field map files are stored in CCDB as /Magnets/Solenoid/BFIELD_MAP_NAME
     // The fine-mesh files are now stored as /Magnets/Solenoid/finemeshes/BFIELD_MAP_NAME
     size_t ipos = namepath.rfind("/");
-    if(ipos == string::npos)
-        throw JException("Could not parse field map: "+namepath);
+    if(ipos == string::npos) return "";
     string finemesh_namepath = namepath.substr(0,ipos) + "/finemeshes" + namepath.substr(ipos);
     string evioFileName = "";
-    string evioFileNameToWrite = "";
     // see if we can get the EVIO file as a resource
     try {
         evioFileName = jresman->GetResource(finemesh_namepath);
@@ -870,23 +1204,10 @@ void DMagneticFieldMapFineMesh::GetFineMeshMap(string namepath,int runnumber){
             evioFileName = "";
         }
     }
-
-    if(evioFileName != "") {
-        ReadEvioFile(evioFileName);
-    } else{
-#endif  
-    cout << "Fine-mesh evio file does not exist." <<endl;
-    cout << "Constructing the fine-mesh B-field map..." << endl;    
-    GenerateFineMesh();
-#ifdef HAVE_EVIO
-    WriteEvioFile(evioFileNameToWrite);
-  }
+    return evioFileName;
+#else
+    return "";
 #endif
-  cout << " rmin: " << rminFine << " rmax: " << rmaxFine 
-       << " dr: " << drFine << " zmin: " << zminFine << " zmax: "
-       << zmaxFine << " dz: " << dzFine <<endl;  
-  cout << " Number of points in z = " <<NzFine <<endl;
-  cout << " Number of points in r = " << NrFine << endl;
 }
 
 void DMagneticFieldMapFineMesh::GenerateFineMesh(void){
@@ -901,18 +1222,17 @@ void DMagneticFieldMapFineMesh::GenerateFineMesh(void){
   NrFine=(unsigned int)floor((rmaxFine-rminFine)/drFine+0.5);
   NzFine=(unsigned int)floor((zmaxFine-zminFine)/dzFine+0.5);
 
-  vector<DBfieldCylindrical_t>zrow;
+  mBfineStorage.clear();
+  mBfineStorage.resize(NrFine*NzFine);
+  mBfine=mBfineStorage.empty() ? NULL:&mBfineStorage[0];
   for (unsigned int i=0;i<NrFine;i++){
     double x=rminFine+drFine*double(i);
     for (unsigned int j=0;j<NzFine;j++){
       double z=zminFine+dzFine*double(j);
-      DBfieldCylindrical_t temp;
+      DBfieldCylindrical_t &temp=mBfineStorage[i*NzFine+j];
       InterpolateField(x,z,temp.Br,temp.Bz,temp.dBrdr,temp.dBrdz,temp.dBzdr,
 		       temp.dBzdz);
-      zrow.push_back(temp);
     }
-    mBfine.push_back(zrow);
-    zrow.clear();
   }
 }
 
@@ -929,12 +1249,12 @@ void DMagneticFieldMapFineMesh::WriteEvioFile(string evioFileName){
   vector<float>dBzdz_;
   for (unsigned int i=0;i<NrFine;i++){
     for (unsigned int j=0;j<NzFine;j++){
-      Br_.push_back(mBfine[i][j].Br);  
-      Bz_.push_back(mBfine[i][j].Bz); 
-      dBrdr_.push_back(mBfine[i][j].dBrdr);   
-      dBrdz_.push_back(mBfine[i][j].dBrdz);  
-      dBzdr_.push_back(mBfine[i][j].dBzdr);
-      dBzdz_.push_back(mBfine[i][j].dBzdz);
+      Br_.push_back(GetFinePoint(i,j)->Br);  
+      Bz_.push_back(GetFinePoint(i,j)->Bz); 
+      dBrdr_.push_back(GetFinePoint(i,j)->dBrdr);   
+      dBrdz_.push_back(GetFinePoint(i,j)->dBrdz);  
+      dBzdr_.push_back(GetFinePoint(i,j)->dBzdr);
+      dBzdz_.push_back(GetFinePoint(i,j)->dBzdz);
     }
   }
 
@@ -992,11 +1312,9 @@ void DMagneticFieldMapFineMesh::ReadEvioFile(string evioFileName){
 	  NrFine=(unsigned int)floor((rmaxFine-rminFine)/drFine+0.5);
 	  NzFine=(unsigned int)floor((zmaxFine-zminFine)/dzFine+0.5);
 	  
-	  vector<DBfieldCylindrical_t> temp(NzFine);
-	  
-	  for (unsigned int m=0;m<NrFine;m++){
-	    mBfine.push_back(temp);
-	  }
+	  mBfineStorage.clear();
+	  mBfineStorage.resize(NrFine*NzFine);
+	  mBfine=mBfineStorage.empty() ? NULL:&mBfineStorage[0];
 	}
 	else if (np->tag==3){// actual B-field data
 	  switch(np->num){
@@ -1005,7 +1323,7 @@ void DMagneticFieldMapFineMesh::ReadEvioFile(string evioFileName){
 	      unsigned int indr=k/NzFine;
 	      unsigned int indz=k%NzFine;
 	      
-	      mBfine[indr][indz].Br=(*vec)[k];
+	      mBfineStorage[indr*NzFine+indz].Br=(*vec)[k];
 	    }
 	    break;
 	  case 1: // Bz
@@ -1013,7 +1331,7 @@ void DMagneticFieldMapFineMesh::ReadEvioFile(string evioFileName){
 	      unsigned int indr=k/NzFine;
 	      unsigned int indz=k%NzFine;
 	      
-	      mBfine[indr][indz].Bz=(*vec)[k];
+	      mBfineStorage[indr*NzFine+indz].Bz=(*vec)[k];
 	    }
 	    break;
 	  case 2: // dBrdr
@@ -1021,7 +1339,7 @@ void DMagneticFieldMapFineMesh::ReadEvioFile(string evioFileName){
 	      unsigned int indr=k/NzFine;
 	      unsigned int indz=k%NzFine;
 	      
-	      mBfine[indr][indz].dBrdr=(*vec)[k];
+	      mBfineStorage[indr*NzFine+indz].dBrdr=(*vec)[k];
 	    }
 	    break;
 	  case 3: // dBrdz
@@ -1029,7 +1347,7 @@ void DMagneticFieldMapFineMesh::ReadEvioFile(string evioFileName){
 	      unsigned int indr=k/NzFine;
 	      unsigned int indz=k%NzFine;
 	      
-	      mBfine[indr][indz].dBrdz=(*vec)[k];
+	      mBfineStorage[indr*NzFine+indz].dBrdz=(*vec)[k];
 	    }
 	    break;	  
 	  case 4: // dBzdr
@@ -1037,7 +1355,7 @@ void DMagneticFieldMapFineMesh::ReadEvioFile(string evioFileName){
 	      unsigned int indr=k/NzFine;
 	      unsigned int indz=k%NzFine;
 	      
-	      mBfine[indr][indz].dBzdr=(*vec)[k];
+	      mBfineStorage[indr*NzFine+indz].dBzdr=(*vec)[k];
 	    }
 	    break;
 	  case 5: // dBzdz
@@ -1045,7 +1363,7 @@ void DMagneticFieldMapFineMesh::ReadEvioFile(string evioFileName){
 	      unsigned int indr=k/NzFine;
 		unsigned int indz=k%NzFine;
 		
-		mBfine[indr][indz].dBzdz=(*vec)[k];
+		mBfineStorage[indr*NzFine+indz].dBzdz=(*vec)[k];
 	    }
 	    break;
 	  default:
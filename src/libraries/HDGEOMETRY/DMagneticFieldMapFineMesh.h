@@ -11,6 +11,7 @@
 
 #include <vector>
 #include <string>
+#include <stdint.h>
 using std::vector;
 using std::string;
 
@@ -48,9 +49,15 @@ class DMagneticFieldMapFineMesh:public DMagneticFieldMap{
 			   double &dBzdx, double &dBzdy,
 			   double &dBzdz) const;
   void GetFineMeshMap(string namepath,int runnumber);
+  string GetFineMeshFileName(string namepath,string &evioFileNameToWrite);
   void WriteEvioFile(string evioFileName);	
   void ReadEvioFile(string evioFileName);
   void GenerateFineMesh(void);
+
+  // Binary cache of the derived coarse and fine-mesh tables. See
+  // DMagneticFieldMapFineMesh.cc for the file layout.
+  bool ReadCache(string cacheFileName,uint64_t source_checksum);
+  bool WriteCache(string cacheFileName,uint64_t source_checksum);
   
   typedef struct{
     float x,y,z,Bx,By,Bz;
@@ -72,19 +79,38 @@ class DMagneticFieldMapFineMesh:public DMagneticFieldMap{
   JCalibration *jcalib;
   JResourceManager *jresman;
 
-  vector< vector< vector<DBfieldPoint_t> > > Btable;
+  // Coarse map, Nx*Ny*Nz points with z running fastest. Btable points
+  // either into BtableStorage or into the mapped cache file.
+  const DBfieldPoint_t *Btable;
+  vector<DBfieldPoint_t> BtableStorage;
+  const DBfieldPoint_t *GetPoint(int ix,int iy,int iz) const{
+    return &Btable[(ix*Ny+iy)*Nz+iz];
+  }
   
   float xmin, xmax, ymin, ymax, zmin, zmax;
   int Nx, Ny, Nz;
   double dx, dy,dz;
   double one_over_dx,one_over_dz;
   
-  vector<vector<DBfieldCylindrical_t> >mBfine;
+  // Fine mesh, NrFine*NzFine points with z running fastest. mBfine
+  // points either into mBfineStorage or into the mapped cache file.
+  const DBfieldCylindrical_t *mBfine;
+  vector<DBfieldCylindrical_t> mBfineStorage;
+  const DBfieldCylindrical_t *GetFinePoint(unsigned int ir,unsigned int iz) const{
+    return &mBfine[ir*NzFine+iz];
+  }
   double zminFine,rminFine,zmaxFine,rmaxFine,drFine,dzFine;
   unsigned int NrFine,NzFine;  
   double zscale,rscale;
+
+  // Memory mapped cache file (NULL if the tables are on the heap)
+  void *cache_map;
+  size_t cache_map_length;
  
  private:
+  void Init(void);
+  string GetCacheFileName(string namepath,string cache_dir,
+			  uint64_t &source_checksum);
   void InterpolateField(double r,double z,double &Br,double &Bz,double &dBrdr,
 			double &dBrdz,double &dBzdr,double &dBzdz) const;
 };
@@ -0,0 +1,74 @@
+// Storage containers used by DTrackFitterKalmanSIMD for the hits and the
+// reference trajectories. Both keep the memory they have allocated when
+// they are emptied so that after the first few fits done by a fitter
+// object (one per thread) no more allocations are needed.
+
+#ifndef _DKalmanSIMDStorage_
+#define _DKalmanSIMDStorage_
+
+#include <vector>
+
+// Fixed-size objects handed out by pointer. The objects are allocated in
+// blocks so pointers stay valid as the pool grows. Reset() makes all
+// objects available again without freeing them.
+template<class T,unsigned int BLOCK_SIZE=64>
+class DKalmanSIMDObjectPool{
+ public:
+  DKalmanSIMDObjectPool():used(0){}
+  ~DKalmanSIMDObjectPool(){
+    for (unsigned int i=0;i<blocks.size();i++) delete [] blocks[i];
+  }
+
+  T *Get(void){
+    unsigned int block=used/BLOCK_SIZE;
+    if (block==blocks.size()) blocks.push_back(new T[BLOCK_SIZE]);
+    T *obj=&blocks[block][used%BLOCK_SIZE];
+    used++;
+    *obj=T();
+    return obj;
+  }
+  void Reset(void){used=0;}
+
+ private:
+  DKalmanSIMDObjectPool(const DKalmanSIMDObjectPool &); // not copyable
+  DKalmanSIMDObjectPool &operator=(const DKalmanSIMDObjectPool &);
+
+  std::vector<T *>blocks;
+  unsigned int used;
+};
+
+// Replacement for the deque holding a reference trajectory. The trajectory
+// is built by adding steps at the front, so the elements are kept at the
+// end of one contiguous array with the free space in front of them.
+// clear() keeps the array.
+template<class T>
+class DKalmanSIMDTrajectory{
+ public:
+  DKalmanSIMDTrajectory():first(0){}
+
+  unsigned int size(void) const {return data.size()-first;}
+  T &operator[](unsigned int i){return data[first+i];}
+  const T &operator[](unsigned int i) const {return data[first+i];}
+
+  void push_front(const T &step){
+    if (first==0) Grow();
+    data[--first]=step;
+  }
+  void pop_front(void){first++;}
+  void clear(void){first=data.size();}
+
+ private:
+  void Grow(void){
+    unsigned int n=size();
+    unsigned int capacity=data.size()<64?128:2*data.size();
+    std::vector<T>bigger(capacity);
+    for (unsigned int i=0;i<n;i++) bigger[capacity-n+i]=data[first+i];
+    data.swap(bigger);
+    first=capacity-n;
+  }
+
+  std::vector<T>data;
+  unsigned int first;
+};
+
+#endif // _DKalmanSIMDStorage_
@@ -64,11 +64,13 @@ DReferenceTrajectory::DReferenceTrajectory(const DMagneticFieldMap *bfield
 	MIN_STEP_SIZE = 0.1;	// cm
 	MAX_STEP_SIZE = 3.0;		// cm
 	int MAX_SWIM_STEPS = 2500;
+	FAST_MATERIAL_STEPPING = false;
 	
 	gPARMS->SetDefaultParameter("TRK:BOUNDARY_STEP_FRACTION" , BOUNDARY_STEP_FRACTION, "Fraction of estimated distance to boundary to use as step size");
 	gPARMS->SetDefaultParameter("TRK:MIN_STEP_SIZE" , MIN_STEP_SIZE, "Minimum step size in cm to take when swimming a track with adaptive step sizes");
 	gPARMS->SetDefaultParameter("TRK:MAX_STEP_SIZE" , MAX_STEP_SIZE, "Maximum step size in cm to take when swimming a track with adaptive step sizes");
 	gPARMS->SetDefaultParameter("TRK:MAX_SWIM_STEPS" , MAX_SWIM_STEPS, "Number of swim steps for DReferenceTrajectory to allocate memory for (when not using external buffer)");
+	gPARMS->SetDefaultParameter("TRK:FAST_MATERIAL_STEPPING" , FAST_MATERIAL_STEPPING, "EXPERIMENTAL: reuse material properties while swimming until the estimated distance to the next material boundary is used up and limit steps to BOUNDARY_STEP_FRACTION of that distance (effect on fit quality not yet checked)");
 
 	// It turns out that the greatest bottleneck in speed here comes from
 	// allocating/deallocating the large block of memory required to hold
@@ -114,6 +116,7 @@ DReferenceTrajectory::DReferenceTrajectory(const DReferenceTrajectory& rt)
 	this->BOUNDARY_STEP_FRACTION = rt.GetBoundaryStepFraction();
 	this->MIN_STEP_SIZE = rt.GetMinStepSize();
 	this->MAX_STEP_SIZE = rt.GetMaxStepSize();
+	this->FAST_MATERIAL_STEPPING = rt.GetFastMaterialStepping();
 	this->debug_level=rt.debug_level;
 	this->zmin_track_boundary = -100.0;  // boundary at which to stop swimming
 	this->zmax_track_boundary = 670.0;   // boundary at which to stop swimming
@@ -177,6 +180,7 @@ DReferenceTrajectory& DReferenceTrajectory::operator=(const DReferenceTrajectory
 	this->BOUNDARY_STEP_FRACTION = rt.GetBoundaryStepFraction();
 	this->MIN_STEP_SIZE = rt.GetMinStepSize();
 	this->MAX_STEP_SIZE = rt.GetMaxStepSize();
+	this->FAST_MATERIAL_STEPPING = rt.GetFastMaterialStepping();
 
 	// Allocate memory if needed
 	if(swim_steps==NULL)this->swim_steps = new swim_step_t[this->max_swim_steps];
@@ -516,6 +520,14 @@ void DReferenceTrajectory::Swim(const DVector3 &pos, const DVector3 &mom, double
 	double X0sum=0.0;
 	swim_step_t *last_step=NULL;
 	double old_radius=10000.;
+
+	// Material from the last lookup in the fast material stepping mode.
+	// It is reused until the track has gone the estimated distance to the
+	// next boundary from the point it was found at.
+	bool material_valid=false;
+	double material_s=0.0,material_s_to_boundary=0.0;
+	double material_KrhoZ_overA=0.0,material_rhoZ_overA=0.0;
+	double material_LogI=0.0,material_X0=0.0;
 	
 	DMatrixDSym mycov(7);
 	if (cov!=NULL){
@@ -597,6 +609,24 @@ void DReferenceTrajectory::Swim(const DVector3 &pos, const DVector3 &mom, double
 						    X0);
 			  KrhoZ_overA=0.1535e-3*rhoZ_overA;
 			  LogI=rhoZ_overA_logI/rhoZ_overA;
+			}else if(FAST_MATERIAL_STEPPING){
+				if(material_valid && fabs(s-material_s)<material_s_to_boundary){
+					KrhoZ_overA = material_KrhoZ_overA;
+					rhoZ_overA = material_rhoZ_overA;
+					LogI = material_LogI;
+					X0 = material_X0;
+					s_to_boundary = material_s_to_boundary-fabs(s-material_s);
+					err = NOERROR;
+				}else{
+					err = geom->FindMatALT1(swim_step->origin, swim_step->mom, KrhoZ_overA, rhoZ_overA,LogI, X0, &s_to_boundary);
+					material_valid = (err==NOERROR);
+					material_s = s;
+					material_s_to_boundary = s_to_boundary;
+					material_KrhoZ_overA = KrhoZ_overA;
+					material_rhoZ_overA = rhoZ_overA;
+					material_LogI = LogI;
+					material_X0 = X0;
+				}
 			}else{
 				if(check_material_boundaries){
 					err = geom->FindMatALT1(swim_step->origin, swim_step->mom, KrhoZ_overA, rhoZ_overA,LogI, X0, &s_to_boundary);
@@ -676,6 +706,12 @@ void DReferenceTrajectory::Swim(const DVector3 &pos, const DVector3 &mom, double
 			double step_size_to_boundary = BOUNDARY_STEP_FRACTION*s_to_boundary;
 			if(step_size_to_boundary < my_step_size)my_step_size = step_size_to_boundary;
 			*/
+			// This is done in the fast material stepping mode since there the
+			// material is not looked up again until the boundary is reached.
+			if(FAST_MATERIAL_STEPPING){
+				double step_size_to_boundary = BOUNDARY_STEP_FRACTION*s_to_boundary;
+				if(step_size_to_boundary < my_step_size)my_step_size = step_size_to_boundary;
+			}
 
 			if(my_step_size>MAX_STEP_SIZE)my_step_size=MAX_STEP_SIZE; // maximum step size in cm
 			if(my_step_size<MIN_STEP_SIZE)my_step_size=MIN_STEP_SIZE; // minimum step size in cm
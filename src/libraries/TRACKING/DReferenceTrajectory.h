@@ -140,6 +140,8 @@ class DReferenceTrajectory{
 		bool GetCheckMaterialBoundaries(void) const {return check_material_boundaries;}
 		direction_t GetPLossDirection(void) const {return ploss_direction;}
 		double GetBoundaryStepFraction(void) const {return BOUNDARY_STEP_FRACTION;}
+		void SetFastMaterialStepping(bool fast_material_stepping){this->FAST_MATERIAL_STEPPING = fast_material_stepping;}
+		bool GetFastMaterialStepping(void) const {return FAST_MATERIAL_STEPPING;}
 		double GetMinStepSize(void) const {return MIN_STEP_SIZE;}
 		double GetMaxStepSize(void) const {return MAX_STEP_SIZE;}
 		inline double dPdx_from_A_Z_rho(double ptot, double A, double Z, double density) const;
@@ -206,6 +208,7 @@ class DReferenceTrajectory{
 		double BOUNDARY_STEP_FRACTION;
 		double MIN_STEP_SIZE;
 		double MAX_STEP_SIZE;
+		bool FAST_MATERIAL_STEPPING;
 	
 	private:
 		DReferenceTrajectory(){} // force use of constructor with arguments.
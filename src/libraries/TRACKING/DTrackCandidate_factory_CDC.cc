@@ -193,18 +193,11 @@ jerror_t DTrackCandidate_factory_CDC::brun(JEventLoop *locEventLoop, int runnumb
 	}
 
 	// Get the CDC wire table from the XML
-	vector<vector<DCDCWire*> > locCDCWires;
+	vector<vector<const DCDCWire*> > locCDCWires;
 	locGeometry->GetCDCWires(locCDCWires);
 	for(size_t loc_i = 0; loc_i < locCDCWires.size(); ++loc_i)
 		dNumStrawsPerRing[loc_i] = locCDCWires[loc_i].size();
 
-	// Clean up after using wire map
-	for (size_t i=0;i<locCDCWires.size();i++){
-	  for (size_t j=0;j<locCDCWires[i].size();j++){
-	    delete locCDCWires[i][j];
-	  }
-	}
-
 	return NOERROR;
 }
 
@@ -258,6 +258,12 @@ DTrackFitterKalmanSIMD::DTrackFitterKalmanSIMD(JEventLoop *loop):DTrackFitter(lo
     gPARMS->SetDefaultParameter("GEOM:ENABLE_BOUNDARY_CHECK",
             ENABLE_BOUNDARY_CHECK);
 
+    FAST_MATERIAL_STEPPING=false;
+    gPARMS->SetDefaultParameter("KALMAN:FAST_MATERIAL_STEPPING",
+            FAST_MATERIAL_STEPPING,
+            "EXPERIMENTAL: reuse material properties along the reference trajectory until the estimated distance to the next material boundary is used up (effect on fit quality not yet checked)");
+    material_cache.valid=false;
+
     USE_MULS_COVARIANCE=true;
     gPARMS->SetDefaultParameter("TRKFIT:USE_MULS_COVARIANCE",
             USE_MULS_COVARIANCE);  
@@ -497,13 +503,10 @@ DTrackFitterKalmanSIMD::DTrackFitterKalmanSIMD(JEventLoop *loop):DTrackFitter(lo
 void DTrackFitterKalmanSIMD::ResetKalmanSIMD(void)
 {
     last_material_map=0;
+    material_cache.valid=false;
 
-    for (unsigned int i=0;i<my_cdchits.size();i++){
-        delete my_cdchits[i];
-    } 
-    for (unsigned int i=0;i<my_fdchits.size();i++){
-        delete my_fdchits[i];
-    }
+    cdchit_pool.Reset();
+    fdchit_pool.Reset();
     central_traj.clear();
     forward_traj.clear();
     my_fdchits.clear();
@@ -850,7 +853,7 @@ inline void DTrackFitterKalmanSIMD::GetPosition(DVector3 &pos){
 
 // Add FDC hits
 jerror_t DTrackFitterKalmanSIMD::AddFDCHit(const DFDCPseudo *fdchit){
-    DKalmanSIMDFDCHit_t *hit= new DKalmanSIMDFDCHit_t;
+    DKalmanSIMDFDCHit_t *hit=fdchit_pool.Get();
 
     hit->package=fdchit->wire->layer/6;
     hit->t=fdchit->time;
@@ -874,7 +877,7 @@ jerror_t DTrackFitterKalmanSIMD::AddFDCHit(const DFDCPseudo *fdchit){
 
 //  Add CDC hits
 jerror_t DTrackFitterKalmanSIMD::AddCDCHit (const DCDCTrackHit *cdchit){
-    DKalmanSIMDCDCHit_t *hit= new DKalmanSIMDCDCHit_t;
+    DKalmanSIMDCDCHit_t *hit=cdchit_pool.Get();
 
     hit->hit=cdchit;
     hit->status=good_hit;
@@ -1060,6 +1063,71 @@ jerror_t DTrackFitterKalmanSIMD::SetCDCForwardReferenceTrajectory(DMatrix5x1 &S)
     return NOERROR;
 }
 
+// Get the material properties at pos for a track heading in the direction of
+// mom for the reference trajectory. s_to_boundary is only changed from the
+// value passed in if the distance to the next material boundary is known.
+// In the fast material stepping mode the properties found by the last full
+// lookup are reused as long as the track has not gone further than the
+// estimated distance to the next boundary from that point, so the lookup
+// is only repeated near boundaries.
+jerror_t DTrackFitterKalmanSIMD::FindMaterial(const DVector3 &pos,
+        const DVector3 &mom,
+        double &K_rho_Z_over_A,
+        double &rho_Z_over_A,double &LnI,
+        double &chi2c_factor,
+        double &chi2a_factor,
+        double &chi2a_corr,
+        double &s_to_boundary){
+    if (FAST_MATERIAL_STEPPING){
+        DVector3 dir=(1./mom.Mag())*mom;
+        if (material_cache.valid && dir.Dot(material_cache.dir)>0.99){
+            // Only reuse the material for points ahead of the lookup point 
+            // along the direction used to estimate the boundary distance
+            DVector3 diff=pos-material_cache.pos;
+            double s=diff.Mag();
+            if (diff.Dot(material_cache.dir)>=0. 
+                    && s<material_cache.s_to_boundary){
+                K_rho_Z_over_A=material_cache.K_rho_Z_over_A;
+                rho_Z_over_A=material_cache.rho_Z_over_A;
+                LnI=material_cache.LnI;
+                chi2c_factor=material_cache.chi2c_factor;
+                chi2a_factor=material_cache.chi2a_factor;
+                chi2a_corr=material_cache.chi2a_corr;
+                s_to_boundary=material_cache.s_to_boundary-s;
+
+                return NOERROR;
+            }
+        }
+        material_cache.valid=false;
+        if (geom->FindMatKalman(pos,mom,K_rho_Z_over_A,rho_Z_over_A,LnI,
+                    chi2c_factor,chi2a_factor,chi2a_corr,
+                    last_material_map,&s_to_boundary)!=NOERROR){
+            return UNRECOVERABLE_ERROR;
+        }
+        material_cache.valid=true;
+        material_cache.pos=pos;
+        material_cache.dir=dir;
+        material_cache.s_to_boundary=s_to_boundary;
+        material_cache.K_rho_Z_over_A=K_rho_Z_over_A;
+        material_cache.rho_Z_over_A=rho_Z_over_A;
+        material_cache.LnI=LnI;
+        material_cache.chi2c_factor=chi2c_factor;
+        material_cache.chi2a_factor=chi2a_factor;
+        material_cache.chi2a_corr=chi2a_corr;
+
+        return NOERROR;
+    }
+
+    if (ENABLE_BOUNDARY_CHECK && fit_type==kTimeBased){
+        return geom->FindMatKalman(pos,mom,K_rho_Z_over_A,rho_Z_over_A,LnI,
+                chi2c_factor,chi2a_factor,chi2a_corr,
+                last_material_map,&s_to_boundary);
+    }
+    return geom->FindMatKalman(pos,K_rho_Z_over_A,rho_Z_over_A,LnI,
+            chi2c_factor,chi2a_factor,chi2a_corr,
+            last_material_map);
+}
+
 // Routine that extracts the state vector propagation part out of the reference
 // trajectory loop
 jerror_t DTrackFitterKalmanSIMD::PropagateForwardCDC(int length,int &index,
@@ -1093,26 +1161,12 @@ jerror_t DTrackFitterKalmanSIMD::PropagateForwardCDC(int length,int &index,
     if (one_over_beta2>BIG) one_over_beta2=BIG;
 
     // get material properties from the Root Geometry
-    if (ENABLE_BOUNDARY_CHECK && fit_type==kTimeBased){
-        DVector3 mom(S(state_tx),S(state_ty),1.);
-        if(geom->FindMatKalman(pos,mom,temp.K_rho_Z_over_A,
-                    temp.rho_Z_over_A,temp.LnI,
-                    temp.chi2c_factor,temp.chi2a_factor,
-                    temp.chi2a_corr,
-                    last_material_map,
-                    &s_to_boundary)!=NOERROR){
-            return UNRECOVERABLE_ERROR;
-        }
-    }
-    else
-    {
-        if(geom->FindMatKalman(pos,temp.K_rho_Z_over_A,
-                    temp.rho_Z_over_A,temp.LnI,
-                    temp.chi2c_factor,temp.chi2a_factor,
-                    temp.chi2a_corr,
-                    last_material_map)!=NOERROR){
-            return UNRECOVERABLE_ERROR;
-        }
+    DVector3 mom(S(state_tx),S(state_ty),1.);
+    if(FindMaterial(pos,mom,temp.K_rho_Z_over_A,
+                temp.rho_Z_over_A,temp.LnI,
+                temp.chi2c_factor,temp.chi2a_factor,
+                temp.chi2a_corr,s_to_boundary)!=NOERROR){
+        return UNRECOVERABLE_ERROR;
     }
 
     // Get dEdx for the upcoming step
@@ -1197,12 +1251,10 @@ jerror_t DTrackFitterKalmanSIMD::PropagateForwardCDC(int length,int &index,
         forward_traj[my_i].B=temp.B;
         forward_traj[my_i].Q=Q;
         forward_traj[my_i].J=J;
-        forward_traj[my_i].JT=J.Transpose();
     }
     else{	
         temp.Q=Q;
         temp.J=J;
-        temp.JT=J.Transpose();
         temp.Ckk=Zero5x5;
         temp.Skk=Zero5x1;
         forward_traj.push_front(temp);    
@@ -1250,23 +1302,11 @@ jerror_t DTrackFitterKalmanSIMD::PropagateCentral(int length, int &index,
 
     // get material properties from the Root Geometry
     DVector3 pos3d(my_xy.X(),my_xy.Y(),Sc(state_z));
-    if (ENABLE_BOUNDARY_CHECK && fit_type==kTimeBased){
-        DVector3 mom(cos(Sc(state_phi)),sin(Sc(state_phi)),Sc(state_tanl));
-        if(geom->FindMatKalman(pos3d,mom,temp.K_rho_Z_over_A,
-                    temp.rho_Z_over_A,temp.LnI,
-                    temp.chi2c_factor,temp.chi2a_factor,
-                    temp.chi2a_corr,
-                    last_material_map,
-                    &s_to_boundary)
-                !=NOERROR){
-            return UNRECOVERABLE_ERROR;
-        }
-    }
-    else if(geom->FindMatKalman(pos3d,temp.K_rho_Z_over_A,
+    DVector3 mom(cos(Sc(state_phi)),sin(Sc(state_phi)),Sc(state_tanl));
+    if(FindMaterial(pos3d,mom,temp.K_rho_Z_over_A,
                 temp.rho_Z_over_A,temp.LnI,
                 temp.chi2c_factor,temp.chi2a_factor,
-                temp.chi2a_corr,
-                last_material_map)!=NOERROR){
+                temp.chi2a_corr,s_to_boundary)!=NOERROR){
         return UNRECOVERABLE_ERROR;
     }
 
@@ -1351,12 +1391,10 @@ jerror_t DTrackFitterKalmanSIMD::PropagateCentral(int length, int &index,
     if (index<=length){
         central_traj[my_i].Q=Q;
         central_traj[my_i].J=J;
-        central_traj[my_i].JT=J.Transpose();
     }
     else{
         temp.Q=Q;
         temp.J=J;
-        temp.JT=J.Transpose();
         temp.Ckk=Zero5x5;
         temp.Skk=Zero5x1;
         central_traj.push_front(temp);    
@@ -1529,27 +1567,12 @@ jerror_t DTrackFitterKalmanSIMD::PropagateForward(int length,int &i,
     if (one_over_beta2>BIG) one_over_beta2=BIG;
 
     // get material properties from the Root Geometry
-    if (ENABLE_BOUNDARY_CHECK && fit_type==kTimeBased){
-        DVector3 mom(S(state_tx),S(state_ty),1.);
-        if (geom->FindMatKalman(pos,mom,temp.K_rho_Z_over_A,
-                    temp.rho_Z_over_A,temp.LnI,
-                    temp.chi2c_factor,temp.chi2a_factor,
-                    temp.chi2a_corr,
-                    last_material_map,
-                    &s_to_boundary)
-                !=NOERROR){
-            return UNRECOVERABLE_ERROR;      
-        }  
-    }
-    else
-    {
-        if (geom->FindMatKalman(pos,temp.K_rho_Z_over_A,
-                    temp.rho_Z_over_A,temp.LnI,
-                    temp.chi2c_factor,temp.chi2a_factor,
-                    temp.chi2a_corr,
-                    last_material_map)!=NOERROR){
-            return UNRECOVERABLE_ERROR;      
-        }       
+    DVector3 mom(S(state_tx),S(state_ty),1.);
+    if (FindMaterial(pos,mom,temp.K_rho_Z_over_A,
+                temp.rho_Z_over_A,temp.LnI,
+                temp.chi2c_factor,temp.chi2a_factor,
+                temp.chi2a_corr,s_to_boundary)!=NOERROR){
+        return UNRECOVERABLE_ERROR;      
     }
     // Get dEdx for the upcoming step
     double dEdx=0.;
@@ -1648,12 +1671,10 @@ jerror_t DTrackFitterKalmanSIMD::PropagateForward(int length,int &i,
         forward_traj[my_i].B=temp.B;
         forward_traj[my_i].Q=Q;
         forward_traj[my_i].J=J;
-        forward_traj[my_i].JT=J.Transpose();
     }
     else{
         temp.Q=Q;
         temp.J=J;
-        temp.JT=J.Transpose();
         temp.Ckk=Zero5x5;
         temp.Skk=Zero5x1;
         forward_traj.push_front(temp);
@@ -1786,7 +1807,7 @@ jerror_t DTrackFitterKalmanSIMD::SetReferenceTrajectory(DMatrix5x1 &S){
         temp.Skk=Zero5x1;
 
         // Jacobian matrices 
-        temp.JT=temp.J=I5x5;
+        temp.J=I5x5;
 
         forward_traj.push_front(temp);
     }
@@ -3711,8 +3732,10 @@ kalman_error_t DTrackFitterKalmanSIMD::KalmanCentral(double anneal_factor,
     DVector2 wirexy=origin+(Sc(state_z)-z0w)*dir;
 
     // Save the starting values for C and S in the deque
-    central_traj[break_point_step_index].Skk=Sc;
-    central_traj[break_point_step_index].Ckk=Cc;
+    if (fit_type==kTimeBased){ // only needed for smoothing
+        central_traj[break_point_step_index].Skk=Sc;
+        central_traj[break_point_step_index].Ckk=Cc;
+    }
 
     // doca variables
     double doca2,old_doca2=(xy-wirexy).Mod2();
@@ -3789,8 +3812,10 @@ kalman_error_t DTrackFitterKalmanSIMD::KalmanCentral(double anneal_factor,
         S0_=S0;
 
         // Save the current state and covariance matrix in the deque
-        central_traj[k].Skk=Sc;
-        central_traj[k].Ckk=Cc;
+        if (fit_type==kTimeBased){ // only needed for smoothing
+            central_traj[k].Skk=Sc;
+            central_traj[k].Ckk=Cc;
+        }
 
         // new wire position
 	wirexy=origin;
@@ -4228,8 +4253,10 @@ kalman_error_t DTrackFitterKalmanSIMD::KalmanForward(double anneal_factor,
     DMatrix2x2 InvV; // Inverse of error matrix
 
     // Save the starting values for C and S in the deque
-    forward_traj[0].Skk=S;
-    forward_traj[0].Ckk=C;
+    if (fit_type==kTimeBased){ // only needed for smoothing
+        forward_traj[0].Skk=S;
+        forward_traj[0].Ckk=C;
+    }
 
     // Initialize chi squared
     chisq=0;
@@ -4294,8 +4321,10 @@ kalman_error_t DTrackFitterKalmanSIMD::KalmanForward(double anneal_factor,
         C=Q.AddSym(C.SandwichMultiply(J));
 
         // Save the current state and covariance matrix in the deque
-        forward_traj[k].Skk=S;
-        forward_traj[k].Ckk=C;
+        if (fit_type==kTimeBased){ // only needed for smoothing
+            forward_traj[k].Skk=S;
+            forward_traj[k].Ckk=C;
+        }
 
         // Save the current state of the reference trajectory
         S0_=S0;
@@ -4907,8 +4936,10 @@ kalman_error_t DTrackFitterKalmanSIMD::KalmanForwardCDC(double anneal,DMatrix5x1
     double chi2cut=my_anneal*var_cut;
 
     // Save the starting values for C and S in the deque
-    forward_traj[break_point_step_index].Skk=S;
-    forward_traj[break_point_step_index].Ckk=C;
+    if (fit_type==kTimeBased){ // only needed for smoothing
+        forward_traj[break_point_step_index].Skk=S;
+        forward_traj[break_point_step_index].Ckk=C;
+    }
 
     // z-position
     double z=forward_traj[break_point_step_index].z;
@@ -5408,8 +5439,10 @@ kalman_error_t DTrackFitterKalmanSIMD::KalmanForwardCDC(double anneal,DMatrix5x1
         old_doca2=doca2;
 
         // Save the current state and covariance matrix in the deque
-        forward_traj[k].Skk=S;
-        forward_traj[k].Ckk=C;
+        if (fit_type==kTimeBased){ // only needed for smoothing
+            forward_traj[k].Skk=S;
+            forward_traj[k].Ckk=C;
+        }
 
     }
 
@@ -7437,7 +7470,7 @@ jerror_t DTrackFitterKalmanSIMD::SmoothForward(void){
     unsigned int max=forward_traj.size()-1;
     DMatrix5x1 S=(forward_traj[max].Skk);
     DMatrix5x5 C=(forward_traj[max].Ckk);
-    DMatrix5x5 JT=(forward_traj[max].JT);
+    DMatrix5x5 JT=forward_traj[max].J.Transpose();
     DMatrix5x1 Ss=S;
     DMatrix5x5 Cs=C;
     DMatrix5x5 A;
@@ -7471,7 +7504,7 @@ jerror_t DTrackFitterKalmanSIMD::SmoothForward(void){
 
         S=forward_traj[m].Skk;
         C=forward_traj[m].Ckk;
-        JT=forward_traj[m].JT;
+        JT=forward_traj[m].J.Transpose();
     }
     A=forward_traj[0].Ckk*JT*C.InvertSym();
     Ss=forward_traj[0].Skk+A*(Ss-S);
@@ -7489,7 +7522,7 @@ jerror_t DTrackFitterKalmanSIMD::SmoothCentral(void){
     unsigned int max=central_traj.size()-1;
     DMatrix5x1 S=(central_traj[max].Skk);
     DMatrix5x5 C=(central_traj[max].Ckk);
-    DMatrix5x5 JT=(central_traj[max].JT);
+    DMatrix5x5 JT=central_traj[max].J.Transpose();
     DMatrix5x1 Ss=S;
     DMatrix5x5 Cs=C;
     DMatrix5x5 A,AT,dC;
@@ -7566,7 +7599,7 @@ jerror_t DTrackFitterKalmanSIMD::SmoothCentral(void){
         }
         S=central_traj[m].Skk;
         C=central_traj[m].Ckk;
-        JT=(central_traj[m].JT);
+        JT=central_traj[m].J.Transpose();
     }
 
     // ... last entries?
@@ -7586,7 +7619,7 @@ jerror_t DTrackFitterKalmanSIMD::SmoothForwardCDC(void){
     unsigned int max=forward_traj.size()-1;
     DMatrix5x1 S=(forward_traj[max].Skk);
     DMatrix5x5 C=(forward_traj[max].Ckk);
-    DMatrix5x5 JT=(forward_traj[max].JT);
+    DMatrix5x5 JT=forward_traj[max].J.Transpose();
     DMatrix5x1 Ss=S;
     DMatrix5x5 Cs=C;
     DMatrix5x5 A;
@@ -7616,7 +7649,7 @@ jerror_t DTrackFitterKalmanSIMD::SmoothForwardCDC(void){
 
         S=forward_traj[m].Skk;
         C=forward_traj[m].Ckk;
-        JT=forward_traj[m].JT;
+        JT=forward_traj[m].J.Transpose();
     }
     A=forward_traj[0].Ckk*JT*C.InvertSym();
     Ss=forward_traj[0].Skk+A*(Ss-S);
@@ -7,6 +7,7 @@
 #include <DMatrixSIMD.h>
 #include <DVector3.h>
 #include <TRACKING/DTrackFitter.h>
+#include <TRACKING/DKalmanSIMDStorage.h>
 #include "HDGEOMETRY/DMagneticFieldMap.h"
 #include "HDGEOMETRY/DGeometry.h"
 #include "HDGEOMETRY/DLorentzDeflections.h"
@@ -122,7 +123,7 @@ typedef struct{
 }DKalmanSIMDFDCHit_t;
 
 typedef struct{
-  DMatrix5x5 J,JT,Q,Ckk;
+  DMatrix5x5 J,Q,Ckk;
   DMatrix5x1 S,Skk;
   DVector2 xy;  
   double s,t,B;
@@ -132,7 +133,7 @@ typedef struct{
 }DKalmanCentralTrajectory_t;
 
 typedef struct{
- DMatrix5x5 J,JT,Q,Ckk;
+ DMatrix5x5 J,Q,Ckk;
  DMatrix5x1 S,Skk;
  double z,s,t,B;
  double rho_Z_over_A,K_rho_Z_over_A,LnI;
@@ -160,16 +161,6 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
 //  };
   DTrackFitterKalmanSIMD(JEventLoop *loop);
   ~DTrackFitterKalmanSIMD(){
-    for (unsigned int i=0;i<my_cdchits.size();i++){
-      delete my_cdchits[i];
-    } 
-    for (unsigned int i=0;i<my_fdchits.size();i++){
-      delete my_fdchits[i];
-    }
-    my_fdchits.clear();
-    my_cdchits.clear();
-    central_traj.clear();
-    forward_traj.clear();
     used_cdc_indices.clear();
     used_fdc_indices.clear();
     cov.clear();
@@ -338,6 +329,11 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
 			    bool &stepped_to_boundary);
   jerror_t PropagateCentral(int length, int &index,DVector2 &my_xy,
 			    DMatrix5x1 &Sc,bool &stepped_to_boundary);
+  jerror_t FindMaterial(const DVector3 &pos,const DVector3 &mom,
+			double &K_rho_Z_over_A,double &rho_Z_over_A,
+			double &LnI,double &chi2c_factor,
+			double &chi2a_factor,double &chi2a_corr,
+			double &s_to_boundary);
 
   DMatrixDSym Get7x7ErrorMatrix(DMatrixDSym C); 
   DMatrixDSym Get7x7ErrorMatrixForward(DMatrixDSym C);
@@ -383,7 +379,10 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
  
   // list of hits on track
   vector<DKalmanSIMDCDCHit_t *>my_cdchits;
-  vector<DKalmanSIMDFDCHit_t *>my_fdchits;  
+  vector<DKalmanSIMDFDCHit_t *>my_fdchits;
+  // Storage for the hits above, reused from fit to fit
+  DKalmanSIMDObjectPool<DKalmanSIMDCDCHit_t>cdchit_pool;
+  DKalmanSIMDObjectPool<DKalmanSIMDFDCHit_t>fdchit_pool;  
   
   // list of indices of hits used in the fit
   vector<unsigned int>used_fdc_indices;
@@ -407,8 +406,8 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
   vector< vector <double> > fcov;
   
   // Lists containing state, covariance, and jacobian at each step
-  deque<DKalmanCentralTrajectory_t>central_traj;
-  deque<DKalmanForwardTrajectory_t>forward_traj;
+  DKalmanSIMDTrajectory<DKalmanCentralTrajectory_t>central_traj;
+  DKalmanSIMDTrajectory<DKalmanForwardTrajectory_t>forward_traj;
 
   // lists containing updated state vector and covariance at measurement point
   vector<DKalmanUpdate_t>fdc_updates;
@@ -461,6 +460,7 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
 
   bool DEBUG_HISTS;
   bool ENABLE_BOUNDARY_CHECK;
+  bool FAST_MATERIAL_STEPPING;
   int DEBUG_LEVEL;
   bool USE_T0_FROM_WIRES;
   bool ESTIMATE_T0_TB;
@@ -508,6 +508,17 @@ class DTrackFitterKalmanSIMD: public DTrackFitter{
  private:
   unsigned int last_material_map;
 
+  // Material found by the last full lookup in the fast material stepping
+  // mode, valid until the track has gone s_to_boundary past pos
+  typedef struct{
+    bool valid;
+    DVector3 pos,dir;
+    double s_to_boundary;
+    double K_rho_Z_over_A,rho_Z_over_A,LnI;
+    double chi2c_factor,chi2a_factor,chi2a_corr;
+  }material_cache_t;
+  material_cache_t material_cache;
+
   TH2F *Hstepsize,*HstepsizeDenom;
   TH2F *fdc_t0,*fdc_t0_vs_theta,*fdc_t0_timebased,*fdc_t0_timebased_vs_theta;
   TH2F *cdc_drift,*fdc_drift,*fdc_yres_vs_dE;
@@ -39,8 +39,10 @@ kalman_error_t DTrackFitterKalmanSIMD_ALT1::KalmanForward(double fdc_anneal_fact
   }
   
   // Save the starting values for C and S in the deque
-  forward_traj[break_point_step_index].Skk=S;
-  forward_traj[break_point_step_index].Ckk=C;
+  if (fit_type==kTimeBased){ // only needed for smoothing
+    forward_traj[break_point_step_index].Skk=S;
+    forward_traj[break_point_step_index].Ckk=C;
+  }
 
   // Initialize chi squared
   chisq=0;
@@ -117,8 +119,10 @@ kalman_error_t DTrackFitterKalmanSIMD_ALT1::KalmanForward(double fdc_anneal_fact
     C=Q.AddSym(C.SandwichMultiply(J));
 
     // Save the current state and covariance matrix in the deque
-    forward_traj[k].Skk=S;
-    forward_traj[k].Ckk=C;
+    if (fit_type==kTimeBased){ // only needed for smoothing
+        forward_traj[k].Skk=S;
+        forward_traj[k].Ckk=C;
+    }
     
     // Save the current state of the reference trajectory
     S0_=S0;
@@ -967,7 +971,7 @@ jerror_t DTrackFitterKalmanSIMD_ALT1::SmoothForward(void){
   unsigned int max=forward_traj.size()-1;
   DMatrix5x1 S=(forward_traj[max].Skk);
   DMatrix5x5 C=(forward_traj[max].Ckk);
-  DMatrix5x5 JT=(forward_traj[max].JT);
+  DMatrix5x5 JT=forward_traj[max].J.Transpose();
   DMatrix5x1 Ss=S;
   DMatrix5x5 Cs=C;
   DMatrix5x5 A,dC;
@@ -1080,7 +1084,7 @@ jerror_t DTrackFitterKalmanSIMD_ALT1::SmoothForward(void){
     
     S=forward_traj[m].Skk;
     C=forward_traj[m].Ckk;
-    JT=forward_traj[m].JT;
+    JT=forward_traj[m].J.Transpose();
   }
 
   return NOERROR;
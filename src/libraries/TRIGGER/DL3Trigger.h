@@ -71,12 +71,43 @@ class DL3Trigger:public jana::JObject{
 			kDISCARD_EVENT
 		};
 		
+		/// Stage of the staged algorithm (algorithm=0x2) that made the
+		/// decision. The stages are run in this order, cheapest first, and
+		/// the first one to fail discards the event. Bit n of "status" is
+		/// set if stage n was run and passed.
+		enum L3_stage_t{
+			kSTAGE_HIT_MULTIPLICITY,
+			kSTAGE_CALORIMETER_ENERGY,
+			kSTAGE_START_COUNTER,
+			kSTAGE_TRACK_CANDIDATES,
+			kSTAGE_ALL_PASSED,     // event passed every stage
+			kSTAGE_LATENCY,        // latency budget used up before all stages were run
+			kSTAGE_NONE,           // decision not made by a stage (e.g. pass-through)
+			kNSTAGES
+		};
+		
 		DL3Trigger(L3_decision_t L3_decision=kNO_DECISION, uint64_t status=0L, uint32_t algorithm=0)
-			:L3_decision(L3_decision),status(status),algorithm(algorithm){}
+			:L3_decision(L3_decision),status(status),algorithm(algorithm),stage(kSTAGE_NONE),time_ms(0.0){}
 		
 		L3_decision_t L3_decision;  // keep event or not?
 		uint64_t status;            // algorithm specific status bits
 		uint32_t algorithm;         // unique identifier for this algorithm
+		L3_stage_t stage;           // stage that made the decision
+		double time_ms;             // wall time spent making the decision
+		
+		static const char* StageName(L3_stage_t stage){
+			switch(stage){
+				case kSTAGE_HIT_MULTIPLICITY:   return "hits";
+				case kSTAGE_CALORIMETER_ENERGY: return "Ecal";
+				case kSTAGE_START_COUNTER:      return "SC";
+				case kSTAGE_TRACK_CANDIDATES:   return "candidates";
+				case kSTAGE_ALL_PASSED:         return "passed";
+				case kSTAGE_LATENCY:            return "latency";
+				case kSTAGE_NONE:               return "none";
+				default:                        break;
+			}
+			return "unknown";
+		}
 		
 		
 		// This method is used primarily for pretty printing
@@ -85,6 +116,8 @@ class DL3Trigger:public jana::JObject{
 			AddString(items, "L3_decision", "%d", L3_decision);
 			AddString(items, "status", "0x%16x", status);
 			AddString(items, "algorithm", "0x%8x", algorithm);
+			AddString(items, "stage", "%s", StageName(stage));
+			AddString(items, "time(ms)", "%5.3f", time_ms);
 		}
 		
 };
@@ -8,19 +8,46 @@
 
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
 using namespace std;
 
+#include <JANA/JApplication.h>
 #include "DL3Trigger_factory.h"
 using namespace jana;
 
+#include <CDC/DCDCHit.h>
+#include <FDC/DFDCHit.h>
+#include <BCAL/DBCALHit.h>
+#include <FCAL/DFCALHit.h>
+#include <START_COUNTER/DSCHit.h>
+#include <TOF/DTOFHit.h>
+#include <TRACKING/DTrackCandidate.h>
+
 //------------------
 // init
 //------------------
 jerror_t DL3Trigger_factory::init(void)
 {
 	FRACTION_TO_KEEP = 1.0;
+	STAGED = false; // opt-in until the thresholds are tuned
+	MIN_HITS = 10;
+	MIN_CAL_ESUM = 0.5;
+	MIN_SC_HITS = 1;
+	SC_WINDOW = 10.0;
+	MIN_TRACK_CANDIDATES = 1;
+	LATENCY_BUDGET = 0.0;
+	KEEP_ON_TIMEOUT = true;
 
 	gPARMS->SetDefaultParameter("L3:FRACTION_TO_KEEP", FRACTION_TO_KEEP ,"Random Fraction of event L3 should keep. (Only used for debugging).");
+	gPARMS->SetDefaultParameter("L3:STAGED", STAGED, "Use the staged L3 algorithm. If 0 (default), all events are kept (pass-through)");
+	gPARMS->SetDefaultParameter("L3:MIN_HITS", MIN_HITS, "Minimum total number of CDC, FDC, BCAL, FCAL, SC and TOF hits (0=skip stage)");
+	gPARMS->SetDefaultParameter("L3:MIN_CAL_ESUM", MIN_CAL_ESUM, "Minimum BCAL + 4*FCAL energy sum in GeV (0=skip stage)");
+	gPARMS->SetDefaultParameter("L3:MIN_SC_HITS", MIN_SC_HITS, "Minimum number of start counter sectors hit in coincidence (0=skip stage)");
+	gPARMS->SetDefaultParameter("L3:SC_WINDOW", SC_WINDOW, "Start counter coincidence window in ns");
+	gPARMS->SetDefaultParameter("L3:MIN_TRACK_CANDIDATES", MIN_TRACK_CANDIDATES, "Minimum number of track candidates (0=skip stage)");
+	gPARMS->SetDefaultParameter("L3:LATENCY_BUDGET", LATENCY_BUDGET, "Time in ms after which no more stages are started for an event (0=no limit)");
+	gPARMS->SetDefaultParameter("L3:KEEP_ON_TIMEOUT", KEEP_ON_TIMEOUT, "Keep events for which the latency budget was used up");
 
 	return NOERROR;
 }
@@ -30,6 +57,11 @@ jerror_t DL3Trigger_factory::init(void)
 //------------------
 jerror_t DL3Trigger_factory::brun(jana::JEventLoop *eventLoop, int runnumber)
 {
+	// Get attenuation parameters (see DMCTrigger_factory)
+	double L_over_2 = DBCALGeometry::BCALFIBERLENGTH/2.0;
+	double Xo = DBCALGeometry::ATTEN_LENGTH;
+	unattenuate_to_center = exp(+L_over_2/Xo);
+
 	return NOERROR;
 }
 
@@ -38,20 +70,172 @@ jerror_t DL3Trigger_factory::brun(jana::JEventLoop *eventLoop, int runnumber)
 //------------------
 jerror_t DL3Trigger_factory::evnt(JEventLoop *loop, int eventnumber)
 {
-	// Simple pass-through L3 trigger
-	// algorithm = 0x1
+	struct timeval start;
+	gettimeofday(&start, NULL);
+
+	DL3Trigger *l3trig;
+	if(!STAGED){
+		// Simple pass-through L3 trigger
+		// algorithm = 0x1
+		l3trig = new DL3Trigger(DL3Trigger::kKEEP_EVENT, 0x0L, 0x1);
+	}else{
+		// Staged L3 trigger (see DL3Trigger_factory.h)
+		// algorithm = 0x2
+		l3trig = new DL3Trigger(DL3Trigger::kKEEP_EVENT, 0x0L, 0x2);
+		l3trig->stage = DL3Trigger::kSTAGE_ALL_PASSED;
+
+		for(int stage=0; stage<DL3Trigger::kSTAGE_ALL_PASSED; stage++){
+
+			// Don't start another stage if we are out of time
+			if(LATENCY_BUDGET>0.0 && stage>0 && ElapsedTime(start)>LATENCY_BUDGET){
+				l3trig->stage = DL3Trigger::kSTAGE_LATENCY;
+				if(!KEEP_ON_TIMEOUT) l3trig->L3_decision = DL3Trigger::kDISCARD_EVENT;
+				break;
+			}
+
+			bool pass = true;
+			switch(stage){
+				case DL3Trigger::kSTAGE_HIT_MULTIPLICITY:
+					if(MIN_HITS==0) continue;
+					pass = PassHitMultiplicity(loop);
+					break;
+				case DL3Trigger::kSTAGE_CALORIMETER_ENERGY:
+					if(MIN_CAL_ESUM<=0.0) continue;
+					pass = PassCalorimeterEnergy(loop);
+					break;
+				case DL3Trigger::kSTAGE_START_COUNTER:
+					if(MIN_SC_HITS==0) continue;
+					pass = PassStartCounter(loop);
+					break;
+				case DL3Trigger::kSTAGE_TRACK_CANDIDATES:
+					if(MIN_TRACK_CANDIDATES==0) continue;
+					pass = PassTrackCandidates(loop);
+					break;
+			}
 
-	DL3Trigger *l3trig = new DL3Trigger(DL3Trigger::kKEEP_EVENT, 0x0L, 0x1);
+			if(!pass){
+				l3trig->L3_decision = DL3Trigger::kDISCARD_EVENT;
+				l3trig->stage = (DL3Trigger::L3_stage_t)stage;
+				break;
+			}
+			l3trig->status |= (0x1L<<stage);
+		}
+	}
 	_data.push_back(l3trig);
 
-	if(FRACTION_TO_KEEP!=1.0){
+	if(FRACTION_TO_KEEP!=1.0 && l3trig->L3_decision==DL3Trigger::kKEEP_EVENT){
 		double r = (double)random()/(double)RAND_MAX;
 		if(r > FRACTION_TO_KEEP) l3trig->L3_decision = DL3Trigger::kDISCARD_EVENT;
 	}
 
+	l3trig->time_ms = ElapsedTime(start);
+
 	return NOERROR;
 }
 
+//------------------
+// PassHitMultiplicity
+//------------------
+bool DL3Trigger_factory::PassHitMultiplicity(JEventLoop *loop)
+{
+	vector<const DCDCHit*> cdchits;
+	vector<const DFDCHit*> fdchits;
+	vector<const DBCALHit*> bcalhits;
+	vector<const DFCALHit*> fcalhits;
+	vector<const DSCHit*> schits;
+	vector<const DTOFHit*> tofhits;
+	loop->Get(cdchits);
+	loop->Get(fdchits);
+	loop->Get(bcalhits);
+	loop->Get(fcalhits);
+	loop->Get(schits);
+	loop->Get(tofhits);
+
+	unsigned int Nhits = cdchits.size() + fdchits.size() + bcalhits.size()
+	                   + fcalhits.size() + schits.size() + tofhits.size();
+
+	return Nhits >= MIN_HITS;
+}
+
+//------------------
+// PassCalorimeterEnergy
+//------------------
+bool DL3Trigger_factory::PassCalorimeterEnergy(JEventLoop *loop)
+{
+	vector<const DBCALHit*> bcalhits;
+	vector<const DFCALHit*> fcalhits;
+	loop->Get(bcalhits);
+	loop->Get(fcalhits);
+
+	// BCAL "energy" is the average of the two ends scaled to the
+	// center of the module. FCAL energy is a straight sum.
+	double Ebcal = 0.0;
+	for(unsigned int i=0; i<bcalhits.size(); i++) Ebcal += bcalhits[i]->E;
+	Ebcal *= unattenuate_to_center/2.0;
+
+	double Efcal = 0.0;
+	for(unsigned int i=0; i<fcalhits.size(); i++) Efcal += fcalhits[i]->E;
+
+	return (Ebcal + 4.0*Efcal) >= MIN_CAL_ESUM;
+}
+
+//------------------
+// PassStartCounter
+//------------------
+bool DL3Trigger_factory::PassStartCounter(JEventLoop *loop)
+{
+	vector<const DSCHit*> schits;
+	loop->Get(schits);
+	if(schits.size() < MIN_SC_HITS) return false;
+
+	// Find the largest number of different sectors hit within SC_WINDOW
+	// of each other by sliding a window over the time-ordered hits.
+	vector<pair<float,int> > hits;
+	for(unsigned int i=0; i<schits.size(); i++){
+		int sector = schits[i]->sector;
+		if(sector<1 || sector>30) continue;
+		hits.push_back(pair<float,int>(schits[i]->t, sector));
+	}
+	sort(hits.begin(), hits.end());
+
+	unsigned int Nhits_in_sector[31] = {0};
+	unsigned int Nsectors = 0;
+	unsigned int ifirst = 0;
+	for(unsigned int i=0; i<hits.size(); i++){
+		if(Nhits_in_sector[hits[i].second]++ == 0) Nsectors++;
+		while(hits[i].first - hits[ifirst].first > SC_WINDOW){
+			if(--Nhits_in_sector[hits[ifirst].second] == 0) Nsectors--;
+			ifirst++;
+		}
+		if(Nsectors >= MIN_SC_HITS) return true;
+	}
+
+	return false;
+}
+
+//------------------
+// PassTrackCandidates
+//------------------
+bool DL3Trigger_factory::PassTrackCandidates(JEventLoop *loop)
+{
+	vector<const DTrackCandidate*> candidates;
+	loop->Get(candidates);
+
+	return candidates.size() >= MIN_TRACK_CANDIDATES;
+}
+
+//------------------
+// ElapsedTime
+//------------------
+double DL3Trigger_factory::ElapsedTime(const struct timeval &start)
+{
+	/// Wall time in ms since start
+	struct timeval now;
+	gettimeofday(&now, NULL);
+
+	return 1000.0*(double)(now.tv_sec - start.tv_sec) + (double)(now.tv_usec - start.tv_usec)/1000.0;
+}
+
 //------------------
 // erun
 //------------------
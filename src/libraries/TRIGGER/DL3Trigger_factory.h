@@ -8,9 +8,37 @@
 #ifndef _DL3Trigger_factory_
 #define _DL3Trigger_factory_
 
+#include <sys/time.h>
+
 #include <JANA/JFactory.h>
 #include "DL3Trigger.h"
 
+/// By default all events are kept (pass-through, algorithm=0x1).
+///
+/// Setting L3:STAGED=1 selects the staged algorithm (algorithm=0x2),
+/// a cascade of stages ordered from cheapest to most expensive:
+///
+///   1. hit multiplicity   - total number of CDC, FDC, BCAL, FCAL, SC
+///                           and TOF hits (L3:MIN_HITS)
+///   2. calorimeter energy - BCAL + 4*FCAL energy sum from the hits, with
+///                           the BCAL corrected for attenuation the same
+///                           way as in DMCTrigger (L3:MIN_CAL_ESUM)
+///   3. start counter      - number of SC sectors hit within a window of
+///                           L3:SC_WINDOW ns of each other (L3:MIN_SC_HITS)
+///   4. track candidates   - number of DTrackCandidate objects
+///                           (L3:MIN_TRACK_CANDIDATES)
+///
+/// The first stage to fail discards the event so that the more expensive
+/// objects are only made for events that pass the cheap cuts. A stage
+/// whose threshold is set to 0 is skipped. If L3:LATENCY_BUDGET (ms) is
+/// non-zero and is used up before the next stage is started, the event
+/// is decided by L3:KEEP_ON_TIMEOUT without running the remaining stages.
+/// Stages are not interrupted once started, so the budget can be exceeded
+/// by at most the time of one stage.
+///
+/// The default thresholds have not been tuned on data yet. In both
+/// cases L3:FRACTION_TO_KEEP is applied to events that would otherwise
+/// be kept.
 class DL3Trigger_factory:public jana::JFactory<DL3Trigger>{
 	public:
 		DL3Trigger_factory(){};
@@ -18,12 +46,29 @@ class DL3Trigger_factory:public jana::JFactory<DL3Trigger>{
 
 		double FRACTION_TO_KEEP;
 
+		bool STAGED;
+		unsigned int MIN_HITS;
+		double MIN_CAL_ESUM;
+		unsigned int MIN_SC_HITS;
+		double SC_WINDOW;
+		unsigned int MIN_TRACK_CANDIDATES;
+		double LATENCY_BUDGET;
+		bool KEEP_ON_TIMEOUT;
+
 	private:
 		jerror_t init(void);						///< Called once at program start.
 		jerror_t brun(jana::JEventLoop *eventLoop, int runnumber);	///< Called everytime a new run number is detected.
 		jerror_t evnt(jana::JEventLoop *eventLoop, int eventnumber);	///< Called every event.
 		jerror_t erun(void);						///< Called everytime run number changes, provided brun has been called.
 		jerror_t fini(void);						///< Called after last event of last event source has been processed.
+
+		bool PassHitMultiplicity(jana::JEventLoop *loop);
+		bool PassCalorimeterEnergy(jana::JEventLoop *loop);
+		bool PassStartCounter(jana::JEventLoop *loop);
+		bool PassTrackCandidates(jana::JEventLoop *loop);
+		double ElapsedTime(const struct timeval &start);
+
+		double unattenuate_to_center;
 };
 
 #endif // _DL3Trigger_factory_
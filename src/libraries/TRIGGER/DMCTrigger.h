@@ -15,6 +15,9 @@ class DMCTrigger:public jana::JObject{
 	public:
 		JOBJECT_PUBLIC(DMCTrigger);
 		
+		DMCTrigger():L1a_fired(false),L1b_fired(false),L1c_fired(false),
+			Ebcal(0.0),Efcal(0.0),Nschits(0),fired_configs(0){}
+		
 		bool L1a_fired; // BCAL + 4FCAL >2 GeV && BCAL > 200 MeV && FCAL > 30 MeV
 		bool L1b_fired; // BCAL + 4FCAL >2 GeV && BCAL > 30 MeV && FCAL > 30 MeV && NSC>0
 		bool L1c_fired; // FCAL > 250MeV
@@ -23,6 +26,10 @@ class DMCTrigger:public jana::JObject{
 		double Efcal;
 		unsigned int Nschits;
 		
+		uint64_t fired_configs; // bit n set if trigger configuration n of TRIGGER:CONFIGS fired
+		
+		bool Fired(unsigned int iconfig) const {return (fired_configs>>iconfig) & 0x1;}
+		
 		// This method is used primarily for pretty printing
 		// the second argument to AddString is printf style format
 		void toStrings(vector<pair<string,string> > &items)const{
@@ -31,6 +38,7 @@ class DMCTrigger:public jana::JObject{
 			AddString(items, "Ebcal", "%5.3f", Ebcal);
 			AddString(items, "Efcal", "%5.3f", Efcal);
 			AddString(items, "Nschits", "%2d", Nschits);
+			AddString(items, "fired_configs", "0x%lx", (unsigned long)fired_configs);
 		}
 		
 };
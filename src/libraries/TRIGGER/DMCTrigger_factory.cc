@@ -8,15 +8,24 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
 #include <cmath>
+#include <cstdlib>
+#include <limits>
 using namespace std;
 
+#if USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include <JANA/JApplication.h>
 #include "DMCTrigger_factory.h"
 using namespace jana;
 
 #include <BCAL/DBCALHit.h>
 #include <FCAL/DFCALHit.h>
+#include <FCAL/DFCALGeometry.h>
 #include <START_COUNTER/DSCHit.h>
 
 
@@ -25,6 +34,17 @@ using namespace jana;
 //------------------
 jerror_t DMCTrigger_factory::init(void)
 {
+	string CONFIGS = "";
+	string GAIN_FILE = "";
+	gPARMS->SetDefaultParameter("TRIGGER:CONFIGS", CONFIGS, "Additional trigger configurations to emulate (see DMCTrigger_factory.h)");
+	gPARMS->SetDefaultParameter("TRIGGER:GAIN_FILE", GAIN_FILE, "File with per-channel trigger gains for BCAL and FCAL");
+
+	bcal_gains.assign(BCALIndex(DBCALGeometry::NBCALMODS, 15, 15, 1)+1, 1.0);
+	fcal_gains.assign(kBlocksTall*kBlocksWide, 1.0);
+
+	if(!ParseConfigs(CONFIGS)) return VALUE_OUT_OF_RANGE;
+	if(GAIN_FILE!="" && !ReadGains(GAIN_FILE)) return RESOURCE_UNAVAILABLE;
+
 	return NOERROR;
 }
 
@@ -82,28 +102,41 @@ jerror_t DMCTrigger_factory::evnt(JEventLoop *loop, int eventnumber)
 	///
 	/// The FCAL energy is just a straight sum of the FCAL hits
 	
-	double BCAL_Eupstream = 0.0;
-	double BCAL_Edownstream = 0.0;
+	// Pack hits into contiguous arrays with the trigger gains applied
+	bcal_E.clear();
+	bcal_t.clear();
 	for(unsigned int i=0; i< bcalhits.size(); i++){
 		const DBCALHit* bcalhit = bcalhits[i];
-		
-		if(bcalhit->end == DBCALGeometry::kUpstream){
-			BCAL_Eupstream += bcalhit->E;
-		}else{
-			BCAL_Edownstream += bcalhit->E;
-		}
+		int idx = BCALIndex(bcalhit->module, bcalhit->layer, bcalhit->sector, bcalhit->end);
+		float gain = idx>=0 ? bcal_gains[idx]:1.0;
+		bcal_E.push_back(gain*bcalhit->E);
+		bcal_t.push_back(bcalhit->t);
 	}
-	
-	// Calculate "energy" sum for BCAL in GeV-ish units
-	double Ebcal = unattenuate_to_center * (BCAL_Eupstream + BCAL_Edownstream)/2.0;
-	
-	// Sum up FCAL energy
-	double Efcal = 0.0;
+	fcal_E.clear();
+	fcal_t.clear();
 	for(unsigned int i=0; i< fcalhits.size(); i++){
 		const DFCALHit* fcalhit = fcalhits[i];
-		
-		Efcal += fcalhit->E;
+		int idx = fcalhit->row*kBlocksWide + fcalhit->column;
+		float gain = (idx>=0 && idx<(int)fcal_gains.size()) ? fcal_gains[idx]:1.0;
+		fcal_E.push_back(gain*fcalhit->E);
+		fcal_t.push_back(fcalhit->t);
 	}
+	sc_E.clear();
+	sc_t.clear();
+	for(unsigned int i=0; i< schits.size(); i++){
+		sc_E.push_back(schits[i]->dE);
+		sc_t.push_back(schits[i]->t);
+	}
+	Pack(bcal_E, bcal_t);
+	Pack(fcal_E, fcal_t);
+	Pack(sc_E, sc_t);
+
+	// Calculate "energy" sum for BCAL in GeV-ish units
+	const float INF = numeric_limits<float>::infinity();
+	double Ebcal = unattenuate_to_center * MaskedSum(bcal_E, bcal_t, -INF, -INF, INF)/2.0;
+	
+	// Sum up FCAL energy
+	double Efcal = MaskedSum(fcal_E, fcal_t, -INF, -INF, INF);
 	
 	// Number of start counter hits
 	unsigned int Nschits = schits.size();
@@ -120,11 +153,212 @@ jerror_t DMCTrigger_factory::evnt(JEventLoop *loop, int eventnumber)
 	trig->Efcal = Efcal;
 	trig->Nschits = Nschits;
 	
+	// Additional configurations
+	for(unsigned int i=0; i<configs.size(); i++){
+		const TriggerConfig &c = configs[i];
+		double Eb = unattenuate_to_center * MaskedSum(bcal_E, bcal_t, c.Ebcal_hit, c.tmin, c.tmax)/2.0;
+		double Ef = MaskedSum(fcal_E, fcal_t, c.Efcal_hit, c.tmin, c.tmax);
+		if(c.Wbcal*Eb + c.Wfcal*Ef < c.Esum) continue;
+		if(Eb < c.Ebcal || Ef < c.Efcal) continue;
+		if(c.Nsc>0 && MaskedCount(sc_E, sc_t, c.Esc_hit, c.tmin, c.tmax) < c.Nsc) continue;
+		trig->fired_configs |= ((uint64_t)0x1<<i);
+	}
+
 	_data.push_back(trig);
 
 	return NOERROR;
 }
 
+//------------------
+// Pack
+//------------------
+void DMCTrigger_factory::Pack(vector<float> &E, vector<float> &t)
+{
+	/// Pad the arrays to a multiple of 4 so the sums can be done 4 at a
+	/// time without a remainder loop. Padding hits have a time of NaN so
+	/// they fail every time window comparison.
+	while(E.size()%4){
+		E.push_back(0.0);
+		t.push_back(numeric_limits<float>::quiet_NaN());
+	}
+}
+
+//------------------
+// MaskedSum
+//------------------
+double DMCTrigger_factory::MaskedSum(const vector<float> &E, const vector<float> &t, float Ethr, float tmin, float tmax)
+{
+	/// Sum of the energies of hits with E>=Ethr and tmin<=t<=tmax.
+	/// Padding hits (see Pack) are always excluded.
+	unsigned int N = E.size();
+	if(N==0) return 0.0;
+	const float *e = &E[0];
+	const float *tt = &t[0];
+
+#if USE_SSE2
+	__m128 vEthr = _mm_set1_ps(Ethr);
+	__m128 vtmin = _mm_set1_ps(tmin);
+	__m128 vtmax = _mm_set1_ps(tmax);
+	__m128d sum_lo = _mm_setzero_pd();
+	__m128d sum_hi = _mm_setzero_pd();
+	for(unsigned int i=0; i<N; i+=4){
+		__m128 ve = _mm_loadu_ps(e+i);
+		__m128 vt = _mm_loadu_ps(tt+i);
+		__m128 mask = _mm_and_ps(_mm_cmpge_ps(vt, vtmin), _mm_cmple_ps(vt, vtmax));
+		mask = _mm_and_ps(mask, _mm_cmpge_ps(ve, vEthr));
+		ve = _mm_and_ps(ve, mask);
+		sum_lo = _mm_add_pd(sum_lo, _mm_cvtps_pd(ve));
+		sum_hi = _mm_add_pd(sum_hi, _mm_cvtps_pd(_mm_movehl_ps(ve, ve)));
+	}
+	double s[2];
+	_mm_storeu_pd(s, _mm_add_pd(sum_lo, sum_hi));
+	return s[0] + s[1];
+#else
+	double sum = 0.0;
+	for(unsigned int i=0; i<N; i++){
+		bool keep = e[i]>=Ethr && tt[i]>=tmin && tt[i]<=tmax;
+		sum += keep ? e[i]:0.0f;
+	}
+	return sum;
+#endif
+}
+
+//------------------
+// MaskedCount
+//------------------
+unsigned int DMCTrigger_factory::MaskedCount(const vector<float> &E, const vector<float> &t, float Ethr, float tmin, float tmax)
+{
+	/// Number of hits with E>=Ethr and tmin<=t<=tmax. Padding hits (see
+	/// Pack) are always excluded.
+	unsigned int N = E.size();
+	if(N==0) return 0;
+	const float *e = &E[0];
+	const float *tt = &t[0];
+
+#if USE_SSE2
+	__m128 vEthr = _mm_set1_ps(Ethr);
+	__m128 vtmin = _mm_set1_ps(tmin);
+	__m128 vtmax = _mm_set1_ps(tmax);
+	__m128i count = _mm_setzero_si128();
+	for(unsigned int i=0; i<N; i+=4){
+		__m128 ve = _mm_loadu_ps(e+i);
+		__m128 vt = _mm_loadu_ps(tt+i);
+		__m128 mask = _mm_and_ps(_mm_cmpge_ps(vt, vtmin), _mm_cmple_ps(vt, vtmax));
+		mask = _mm_and_ps(mask, _mm_cmpge_ps(ve, vEthr));
+		count = _mm_sub_epi32(count, _mm_castps_si128(mask)); // mask is -1 where set
+	}
+	int c[4];
+	_mm_storeu_si128((__m128i*)c, count);
+	return c[0] + c[1] + c[2] + c[3];
+#else
+	unsigned int count = 0;
+	for(unsigned int i=0; i<N; i++){
+		if(e[i]>=Ethr && tt[i]>=tmin && tt[i]<=tmax) count++;
+	}
+	return count;
+#endif
+}
+
+//------------------
+// BCALIndex
+//------------------
+int DMCTrigger_factory::BCALIndex(int module, int layer, int sector, int end)
+{
+	/// Index into bcal_gains. Returns -1 if out of range.
+	if(module<1 || module>DBCALGeometry::NBCALMODS) return -1;
+	if(layer<0 || layer>15 || sector<0 || sector>15) return -1;
+	if(end<0 || end>1) return -1;
+
+	return ((((module-1)<<4) + layer)<<4 | sector)<<1 | end;
+}
+
+//------------------
+// ParseConfigs
+//------------------
+bool DMCTrigger_factory::ParseConfigs(string configs_str)
+{
+	/// Fill "configs" from the TRIGGER:CONFIGS string.
+	configs.clear();
+
+	stringstream ss_configs(configs_str);
+	string config_str;
+	while(getline(ss_configs, config_str, ';')){
+		if(config_str.find_first_not_of(" \t")==string::npos) continue;
+		TriggerConfig c;
+		stringstream ss_config(config_str);
+		string item;
+		while(getline(ss_config, item, ',')){
+			size_t pos = item.find('=');
+			if(pos==string::npos){
+				jerr << "Bad item \"" << item << "\" in TRIGGER:CONFIGS (should be key=value)" << endl;
+				return false;
+			}
+			string key = item.substr(0, pos);
+			key.erase(0, key.find_first_not_of(" \t"));
+			key.erase(key.find_last_not_of(" \t")+1);
+			double val = atof(item.substr(pos+1).c_str());
+			if(key=="Esum") c.Esum = val;
+			else if(key=="Wbcal") c.Wbcal = val;
+			else if(key=="Wfcal") c.Wfcal = val;
+			else if(key=="Ebcal") c.Ebcal = val;
+			else if(key=="Efcal") c.Efcal = val;
+			else if(key=="Nsc") c.Nsc = (unsigned int)val;
+			else if(key=="Ebcal_hit") c.Ebcal_hit = val;
+			else if(key=="Efcal_hit") c.Efcal_hit = val;
+			else if(key=="Esc_hit") c.Esc_hit = val;
+			else if(key=="tmin") c.tmin = val;
+			else if(key=="tmax") c.tmax = val;
+			else{
+				jerr << "Unknown key \"" << key << "\" in TRIGGER:CONFIGS" << endl;
+				return false;
+			}
+		}
+		configs.push_back(c);
+	}
+
+	if(configs.size()>64){
+		jerr << "Too many trigger configurations (" << configs.size() << ") in TRIGGER:CONFIGS. Max is 64." << endl;
+		return false;
+	}
+
+	return true;
+}
+
+//------------------
+// ReadGains
+//------------------
+bool DMCTrigger_factory::ReadGains(string fname)
+{
+	/// Read per-channel trigger gains (see DMCTrigger_factory.h)
+	ifstream ifs(fname.c_str());
+	if(!ifs.is_open()){
+		jerr << "Unable to open trigger gain file \"" << fname << "\"" << endl;
+		return false;
+	}
+
+	string line;
+	while(getline(ifs, line)){
+		stringstream ss(line);
+		string det;
+		if(!(ss >> det) || det[0]=='#') continue;
+		if(det=="FCAL"){
+			int row, column;
+			float gain;
+			if(!(ss >> row >> column >> gain)) continue;
+			if(row<0 || row>=kBlocksTall || column<0 || column>=kBlocksWide) continue;
+			fcal_gains[row*kBlocksWide + column] = gain;
+		}else if(det=="BCAL"){
+			int module, layer, sector, end;
+			float gain;
+			if(!(ss >> module >> layer >> sector >> end >> gain)) continue;
+			int idx = BCALIndex(module, layer, sector, end);
+			if(idx>=0) bcal_gains[idx] = gain;
+		}
+	}
+
+	return true;
+}
+
 //------------------
 // erun
 //------------------
@@ -8,6 +8,9 @@
 #ifndef _DMCTrigger_factory_
 #define _DMCTrigger_factory_
 
+#include <vector>
+#include <string>
+
 #include <JANA/JFactory.h>
 #include "DMCTrigger.h"
 
@@ -28,6 +31,44 @@
 /// The values of BCAL and FCAL and NSC used to make the decision
 /// are kept in the DMCTrigger object at Ebcal, Efcal, and Nschits
 /// respectively.
+///
+/// Additional trigger configurations can be emulated in the same pass
+/// over the event by setting TRIGGER:CONFIGS. This is a ';' separated
+/// list of configurations, each a ',' separated list of key=value
+/// pairs. Keys that are not given take the default shown:
+///
+///   Esum=2.0       minimum Wbcal*BCAL + Wfcal*FCAL (GeV)
+///   Wbcal=1.0      BCAL weight in the sum
+///   Wfcal=4.0      FCAL weight in the sum
+///   Ebcal=0.0      minimum BCAL energy (GeV)
+///   Efcal=0.0      minimum FCAL energy (GeV)
+///   Nsc=0          minimum number of start counter hits
+///   Ebcal_hit=0.0  BCAL hit threshold (GeV, before attenuation correction)
+///   Efcal_hit=0.0  FCAL hit threshold (GeV)
+///   Esc_hit=0.0    start counter hit threshold (GeV)
+///   tmin=-1000.0   start of the time window hits are summed over (ns)
+///   tmax=1000.0    end of the time window hits are summed over (ns)
+///
+/// e.g. to scan the sum threshold:
+///
+///   -PTRIGGER:CONFIGS="Esum=1.0;Esum=1.5;Esum=2.0;Esum=2.5"
+///
+/// Bit n of DMCTrigger::fired_configs is set if configuration n fired.
+/// Up to 64 configurations may be given.
+///
+/// Per-channel trigger gains can be read from the text file given by
+/// TRIGGER:GAIN_FILE. Each line is one of
+///
+///   FCAL row column gain
+///   BCAL module layer sector end gain
+///
+/// with end being 0 for upstream and 1 for downstream. Channels not in
+/// the file have a gain of 1. The gains are applied to the hit energies
+/// before the thresholds for all configurations, including L1a-c.
+///
+/// The hits are packed into contiguous energy and time arrays once per
+/// event and each configuration is then a masked sum over those arrays.
+/// The sums use SSE2 when built with it (USE_SSE2).
 
 class DMCTrigger_factory:public jana::JFactory<DMCTrigger>{
 	public:
@@ -42,8 +83,42 @@ class DMCTrigger_factory:public jana::JFactory<DMCTrigger>{
 		jerror_t erun(void);						///< Called everytime run number changes, provided brun has been called.
 		jerror_t fini(void);						///< Called after last event of last event source has been processed.
 
+		class TriggerConfig{
+			public:
+				TriggerConfig():Esum(2.0),Wbcal(1.0),Wfcal(4.0),Ebcal(0.0),Efcal(0.0),Nsc(0),
+					Ebcal_hit(0.0),Efcal_hit(0.0),Esc_hit(0.0),tmin(-1000.0),tmax(1000.0){}
+
+				double Esum;
+				double Wbcal;
+				double Wfcal;
+				double Ebcal;
+				double Efcal;
+				unsigned int Nsc;
+				float Ebcal_hit;
+				float Efcal_hit;
+				float Esc_hit;
+				float tmin;
+				float tmax;
+		};
+
+		bool ParseConfigs(std::string configs_str);
+		bool ReadGains(std::string fname);
+		static int BCALIndex(int module, int layer, int sector, int end);
+		static void Pack(std::vector<float> &E, std::vector<float> &t);
+		static double MaskedSum(const std::vector<float> &E, const std::vector<float> &t, float Ethr, float tmin, float tmax);
+		static unsigned int MaskedCount(const std::vector<float> &E, const std::vector<float> &t, float Ethr, float tmin, float tmax);
+
 		bool REQUIRE_START_COUNTER;
 		double unattenuate_to_center;
+
+		std::vector<TriggerConfig> configs;
+		std::vector<float> bcal_gains;
+		std::vector<float> fcal_gains;
+
+		// Packed hit arrays, kept here so they are only allocated once
+		std::vector<float> bcal_E, bcal_t;
+		std::vector<float> fcal_E, fcal_t;
+		std::vector<float> sc_E, sc_t;
 };
 
 #endif // _DMCTrigger_factory_
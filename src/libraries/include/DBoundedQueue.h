@@ -0,0 +1,125 @@
+// $Id$
+//
+//    File: DBoundedQueue.h
+//
+
+#ifndef _DBoundedQueue_
+#define _DBoundedQueue_
+
+#include <pthread.h>
+#include <deque>
+
+/// Simple bounded, blocking FIFO for handing objects between threads.
+///
+/// Producers call Push() which blocks while the queue holds "max_size"
+/// items. Consumers call Pop() which blocks until an item is available
+/// or until all producers have called Done(). Pop() returns false only
+/// once the queue is both empty and finished, so the consumer loop is
+/// simply:
+///
+///   T item;
+///   while(queue.Pop(item)){ ... }
+///
+/// The queue also keeps a couple of counters (maximum depth seen and
+/// the number of times a producer had to wait) that callers can print
+/// to see whether the reading or the writing side is the bottleneck.
+template<typename T>
+class DBoundedQueue{
+	public:
+		DBoundedQueue(unsigned int max_size=100, unsigned int Nproducers=1)
+			:max_size(max_size==0 ? 1:max_size), Nproducers(Nproducers)
+			,max_depth(0), Npush_waits(0), Npop_waits(0)
+		{
+			pthread_mutex_init(&mutex, NULL);
+			pthread_cond_init(&cond_not_full, NULL);
+			pthread_cond_init(&cond_not_empty, NULL);
+		}
+
+		~DBoundedQueue(){
+			pthread_cond_destroy(&cond_not_empty);
+			pthread_cond_destroy(&cond_not_full);
+			pthread_mutex_destroy(&mutex);
+		}
+
+		/// Add an item, blocking while the queue is full. Returns false
+		/// (and does not add the item) if Abort() has been called.
+		bool Push(const T &item){
+			pthread_mutex_lock(&mutex);
+			while(q.size()>=max_size && Nproducers>0){
+				Npush_waits++;
+				pthread_cond_wait(&cond_not_full, &mutex);
+			}
+			bool ok = Nproducers>0;
+			if(ok){
+				q.push_back(item);
+				if(q.size() > max_depth) max_depth = q.size();
+				pthread_cond_signal(&cond_not_empty);
+			}
+			pthread_mutex_unlock(&mutex);
+			return ok;
+		}
+
+		/// Remove the oldest item, blocking until one is available.
+		/// Returns false when the queue is empty and all producers are done.
+		bool Pop(T &item){
+			pthread_mutex_lock(&mutex);
+			while(q.empty() && Nproducers>0){
+				Npop_waits++;
+				pthread_cond_wait(&cond_not_empty, &mutex);
+			}
+			bool ok = !q.empty();
+			if(ok){
+				item = q.front();
+				q.pop_front();
+				pthread_cond_signal(&cond_not_full);
+			}
+			pthread_mutex_unlock(&mutex);
+			return ok;
+		}
+
+		/// Called once by each producer when it will push no more items.
+		void Done(void){
+			pthread_mutex_lock(&mutex);
+			if(Nproducers>0) Nproducers--;
+			pthread_cond_broadcast(&cond_not_empty);
+			pthread_cond_broadcast(&cond_not_full);
+			pthread_mutex_unlock(&mutex);
+		}
+
+		/// Wake everyone up and refuse further items (e.g. on SIGINT).
+		/// Items already queued can still be popped.
+		void Abort(void){
+			pthread_mutex_lock(&mutex);
+			Nproducers = 0;
+			pthread_cond_broadcast(&cond_not_empty);
+			pthread_cond_broadcast(&cond_not_full);
+			pthread_mutex_unlock(&mutex);
+		}
+
+		unsigned int Size(void){
+			pthread_mutex_lock(&mutex);
+			unsigned int n = q.size();
+			pthread_mutex_unlock(&mutex);
+			return n;
+		}
+
+		unsigned int GetMaxDepth(void) const {return max_depth;}
+		unsigned long GetNpushWaits(void) const {return Npush_waits;}
+		unsigned long GetNpopWaits(void) const {return Npop_waits;}
+
+	private:
+		DBoundedQueue(const DBoundedQueue&);             // not copyable
+		DBoundedQueue& operator=(const DBoundedQueue&);
+
+		std::deque<T> q;
+		unsigned int max_size;
+		unsigned int Nproducers;
+		unsigned int max_depth;
+		unsigned long Npush_waits;
+		unsigned long Npop_waits;
+		pthread_mutex_t mutex;
+		pthread_cond_t cond_not_full;
+		pthread_cond_t cond_not_empty;
+};
+
+#endif // _DBoundedQueue_
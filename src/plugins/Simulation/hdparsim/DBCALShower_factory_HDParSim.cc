@@ -0,0 +1,158 @@
+// $Id$
+//
+//    File: DBCALShower_factory_HDParSim.cc
+//
+
+
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+using namespace std;
+
+#include <JANA/JApplication.h>
+
+#include <TRACKING/DMCThrown.h>
+
+#include "DTrackingResolutionGEANTphoton.h"
+#include "DBCALShower_factory_HDParSim.h"
+using namespace jana;
+
+//------------------
+// PathToRadius
+//------------------
+static double PathToRadius(const TVector3 &vertex, const TVector3 &dir, double R)
+{
+	/// Distance along the unit vector dir from vertex to the cylinder of
+	/// radius R around the beam line. Returns a negative value if the
+	/// line does not reach it.
+	double a = dir.Perp2();
+	if(a<=0.0)return -1.0;
+	double b = vertex.X()*dir.X() + vertex.Y()*dir.Y();
+	double c = vertex.Perp2() - R*R;
+	double disc = b*b - a*c;
+	if(disc<0.0)return -1.0;
+
+	return (-b + sqrt(disc))/a;
+}
+
+//------------------
+// DBCALShower_factory_HDParSim   (Constructer)
+//------------------
+DBCALShower_factory_HDParSim::DBCALShower_factory_HDParSim(void)
+{
+	res = NULL;
+}
+
+//------------------
+// init
+//------------------
+jerror_t DBCALShower_factory_HDParSim::init(void)
+{
+	// The tables are read here rather than in the constructor so that
+	// they are only needed if this factory is actually used. Reading
+	// them opens ROOT files and switches gDirectory so it must be done
+	// while holding the ROOT lock since init() runs in every thread.
+	japp->RootWriteLock();
+	res = new DTrackingResolutionGEANTphoton();
+	japp->RootUnLock();
+
+	// Allow user to specify that the efficiency cut should not be applied
+	APPLY_EFFICIENCY_PHOTON = true; // do apply efficiency cut by default
+	BCAL_R = 65.0;
+	BCAL_ZMIN = 17.0;
+	BCAL_ZMAX = 407.0;
+	BCAL_TIME_RES = 0.2;
+
+	gPARMS->SetDefaultParameter("HDPARSIM:APPLY_EFFICIENCY_PHOTON", APPLY_EFFICIENCY_PHOTON);
+	gPARMS->SetDefaultParameter("HDPARSIM:BCAL_R", BCAL_R, "inner radius of BCAL in cm");
+	gPARMS->SetDefaultParameter("HDPARSIM:BCAL_ZMIN", BCAL_ZMIN, "z of upstream end of BCAL in cm");
+	gPARMS->SetDefaultParameter("HDPARSIM:BCAL_ZMAX", BCAL_ZMAX, "z of downstream end of BCAL in cm");
+	gPARMS->SetDefaultParameter("HDPARSIM:BCAL_TIME_RES", BCAL_TIME_RES, "BCAL shower time resolution in ns");
+
+	return NOERROR;
+}
+
+//------------------
+// brun
+//------------------
+jerror_t DBCALShower_factory_HDParSim::brun(jana::JEventLoop *eventLoop, int runnumber)
+{
+	return NOERROR;
+}
+
+//------------------
+// evnt
+//------------------
+jerror_t DBCALShower_factory_HDParSim::evnt(JEventLoop *loop, int eventnumber)
+{
+	// Make a shower for each thrown photon that points at the inner
+	// surface of the BCAL. The energy and direction are smeared using
+	// the photon tables and the shower is placed where the smeared
+	// direction meets the inner surface.
+	vector<const DMCThrown*> throwns;
+	loop->Get(throwns);
+
+	for(unsigned int i=0; i<throwns.size(); i++){
+		const DMCThrown *thrown = throwns[i];
+		if(thrown->type!=1)continue;
+
+		DVector3 dvertex = thrown->position();
+		DVector3 dmom = thrown->momentum();
+		TVector3 vertex(dvertex.X(), dvertex.Y(), dvertex.Z());
+		TVector3 mom(dmom.X(), dmom.Y(), dmom.Z());
+		double path = PathToRadius(vertex, mom.Unit(), BCAL_R);
+		if(path<0.0)continue;
+		TVector3 pos = vertex + path*mom.Unit();
+		if(pos.Z()<BCAL_ZMIN || pos.Z()>BCAL_ZMAX)continue;
+
+		// Simultaneously smear the momentum of the particle and test whether
+		// it passes the efficiency/acceptance cut.
+		double E_res, theta_res, phi_res;
+		res->GetResolution(thrown->type, mom, E_res, theta_res, phi_res);
+		bool keep = res->Smear(thrown->type, mom);
+		if(!keep && APPLY_EFFICIENCY_PHOTON)continue;
+
+		path = PathToRadius(vertex, mom.Unit(), BCAL_R);
+		if(path<0.0)continue;
+		pos = vertex + path*mom.Unit();
+
+		DBCALShower *shower = new DBCALShower;
+		shower->E = shower->E_raw = mom.Mag();
+		shower->x = pos.X();
+		shower->y = pos.Y();
+		shower->z = pos.Z();
+		shower->t = thrown->time() + path/29.9792458 + rnd.Gaus(0.0, BCAL_TIME_RES);
+		shower->xErr = shower->yErr = BCAL_R*phi_res/1000.0;
+		shower->zErr = path*theta_res/1000.0/sin(mom.Theta());
+		shower->tErr = BCAL_TIME_RES;
+		shower->N_cell = 1;
+		shower->xyzCovariance.ResizeTo(3,3);
+		shower->xyzCovariance(0,0) = shower->xErr*shower->xErr;
+		shower->xyzCovariance(1,1) = shower->yErr*shower->yErr;
+		shower->xyzCovariance(2,2) = shower->zErr*shower->zErr;
+		shower->AddAssociatedObject(thrown);
+
+		_data.push_back(shower);
+	}
+
+	return NOERROR;
+}
+
+//------------------
+// erun
+//------------------
+jerror_t DBCALShower_factory_HDParSim::erun(void)
+{
+	return NOERROR;
+}
+
+//------------------
+// fini
+//------------------
+jerror_t DBCALShower_factory_HDParSim::fini(void)
+{
+	if(res)delete res;
+
+	return NOERROR;
+}
+
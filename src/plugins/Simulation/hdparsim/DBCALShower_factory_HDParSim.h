@@ -1,22 +1,22 @@
 // $Id$
 //
-//    File: DPhoton_factory_HDParSim.h
-// Created: Tue Feb  3 11:29:30 EST 2009
-// Creator: davidl (on Darwin harriet.jlab.org 9.6.0 i386)
+//    File: DBCALShower_factory_HDParSim.h
 //
 
-#ifndef _DPhoton_factory_HDParSim_
-#define _DPhoton_factory_HDParSim_
+#ifndef _DBCALShower_factory_HDParSim_
+#define _DBCALShower_factory_HDParSim_
+
+#include <TRandom3.h>
 
 #include <JANA/JFactory.h>
-#include "PID/DPhoton.h"
+#include <BCAL/DBCALShower.h>
 
 #include "DTrackingResolution.h"
 
-class DPhoton_factory_HDParSim:public jana::JFactory<DPhoton>{
+class DBCALShower_factory_HDParSim:public jana::JFactory<DBCALShower>{
 	public:
-		DPhoton_factory_HDParSim();
-		~DPhoton_factory_HDParSim(){};
+		DBCALShower_factory_HDParSim();
+		~DBCALShower_factory_HDParSim(){};
 		const char* Tag(void){return "HDParSim";}
 
 	private:
@@ -27,9 +27,14 @@ class DPhoton_factory_HDParSim:public jana::JFactory<DPhoton>{
 		jerror_t fini(void);						///< Called after last event of last event source has been processed.
 
 		bool APPLY_EFFICIENCY_PHOTON;
+		double BCAL_R;		///< inner radius of BCAL (cm)
+		double BCAL_ZMIN;	///< upstream end of BCAL (cm)
+		double BCAL_ZMAX;	///< downstream end of BCAL (cm)
+		double BCAL_TIME_RES;	///< shower time resolution (ns)
 
 		DTrackingResolution *res;
+		TRandom3 rnd;
 };
 
-#endif // _DPhoton_factory_HDParSim_
+#endif // _DBCALShower_factory_HDParSim_
 
@@ -0,0 +1,186 @@
+// $Id$
+//
+//    File: DEventProcessor_hdparsim.cc
+//
+
+#include <cmath>
+#include <iostream>
+using namespace std;
+
+#include <TDirectoryFile.h>
+#include <TROOT.h>
+
+#include <JANA/JApplication.h>
+
+#include <TRACKING/DTrackTimeBased.h>
+#include <FCAL/DFCALShower.h>
+#include <BCAL/DBCALShower.h>
+
+#include "DEventProcessor_hdparsim.h"
+using namespace jana;
+
+static const char *type_names[] = {"pion", "kaon", "proton", "electron", "photon"};
+
+//------------------
+// init
+//------------------
+jerror_t DEventProcessor_hdparsim::init(void)
+{
+	MAKE_HISTS = false;
+	MATCH_ANGLE = 0.05;
+
+	gPARMS->SetDefaultParameter("HDPARSIM:MAKE_HISTS", MAKE_HISTS, "Fill the histograms used to make and check the hdparsim tables");
+	gPARMS->SetDefaultParameter("HDPARSIM:MATCH_ANGLE", MATCH_ANGLE, "Largest angle in rad between a thrown photon and its shower");
+
+	if(!MAKE_HISTS)return NOERROR;
+
+	japp->RootWriteLock();
+
+	TDirectory *savedir = gDirectory;
+	TDirectory *dir = (TDirectory*)gROOT->FindObject("hdparsim");
+	if(!dir)dir = new TDirectoryFile("hdparsim","hdparsim");
+	dir->cd();
+
+	// Binning is the same as that of the tables: x is theta in degrees
+	// and y is momentum (energy for photons) in GeV/c
+	for(int i=0; i<kNtypes; i++){
+		TDirectory *typedir = dir->mkdir(type_names[i]);
+		typedir->cd();
+		const char *dp_name = i==kPhoton ? "dE_over_E":"dpt_over_pt";
+		hists[i].thrown = new TH2F("thrown", "Thrown;#theta (deg);p (GeV/c)", 70, 0.0, 140.0, 50, 0.0, 10.0);
+		hists[i].found = new TH2F("found", "Reconstructed;#theta (deg);p (GeV/c)", 70, 0.0, 140.0, 50, 0.0, 10.0);
+		hists[i].dp_over_p = new TH3F(dp_name, dp_name, 70, 0.0, 140.0, 50, 0.0, 10.0, 200, -0.5, 0.5);
+		hists[i].dtheta = new TH3F("dtheta", "#theta residual (mrad)", 70, 0.0, 140.0, 50, 0.0, 10.0, 200, -50.0, 50.0);
+		hists[i].dphi = new TH3F("dphi", "#phi residual (mrad)", 70, 0.0, 140.0, 50, 0.0, 10.0, 200, -100.0, 100.0);
+		dir->cd();
+	}
+
+	savedir->cd();
+
+	japp->RootUnLock();
+
+	return NOERROR;
+}
+
+//------------------
+// TypeIndex
+//------------------
+int DEventProcessor_hdparsim::TypeIndex(int geanttype)
+{
+	switch(geanttype){
+		case 1: return kPhoton;
+		case 2: case 3: return kElectron;
+		case 8: case 9: return kPion;
+		case 11: case 12: return kKaon;
+		case 14: case 15: return kProton;
+	}
+	return -1;
+}
+
+//------------------
+// Fill
+//------------------
+void DEventProcessor_hdparsim::Fill(Hists &h, const DMCThrown *thrown, const TVector3 *mom)
+{
+	/// Fill the histograms for one thrown particle. mom is the
+	/// reconstructed momentum, or NULL if the particle was not found.
+	DVector3 dmom = thrown->momentum();
+	TVector3 thrown_mom(dmom.X(), dmom.Y(), dmom.Z());
+	double theta = thrown_mom.Theta()*180.0/M_PI;
+	double p = thrown_mom.Mag();
+
+	h.thrown->Fill(theta, p);
+	if(!mom)return;
+	h.found->Fill(theta, p);
+
+	double dp_over_p;
+	if(thrown->type==1){
+		dp_over_p = (mom->Mag() - p)/p;
+	}else{
+		dp_over_p = (mom->Perp() - thrown_mom.Perp())/thrown_mom.Perp();
+	}
+	double dphi = mom->Phi() - thrown_mom.Phi();
+	while(dphi<-M_PI)dphi+=2.0*M_PI;
+	while(dphi>=M_PI)dphi-=2.0*M_PI;
+
+	h.dp_over_p->Fill(theta, p, dp_over_p);
+	h.dtheta->Fill(theta, p, 1000.0*(mom->Theta() - thrown_mom.Theta()));
+	h.dphi->Fill(theta, p, 1000.0*dphi);
+}
+
+//------------------
+// evnt
+//------------------
+jerror_t DEventProcessor_hdparsim::evnt(JEventLoop *loop, int eventnumber)
+{
+	if(!MAKE_HISTS)return NOERROR;
+
+	vector<const DMCThrown*> throwns;
+	vector<const DTrackTimeBased*> tracks;
+	vector<const DFCALShower*> fcalshowers;
+	vector<const DBCALShower*> bcalshowers;
+	loop->Get(throwns);
+	loop->Get(tracks);
+	loop->Get(fcalshowers);
+	loop->Get(bcalshowers);
+
+	// Shower positions and energies. The directions are taken from the
+	// thrown vertex when matching below.
+	vector<TVector3> shower_pos;
+	vector<double> shower_E;
+	for(unsigned int i=0; i<fcalshowers.size(); i++){
+		DVector3 pos = fcalshowers[i]->getPosition();
+		shower_pos.push_back(TVector3(pos.X(), pos.Y(), pos.Z()));
+		shower_E.push_back(fcalshowers[i]->getEnergy());
+	}
+	for(unsigned int i=0; i<bcalshowers.size(); i++){
+		shower_pos.push_back(TVector3(bcalshowers[i]->x, bcalshowers[i]->y, bcalshowers[i]->z));
+		shower_E.push_back(bcalshowers[i]->E);
+	}
+
+	japp->RootWriteLock();
+
+	for(unsigned int i=0; i<throwns.size(); i++){
+		const DMCThrown *thrown = throwns[i];
+		int type = TypeIndex(thrown->type);
+		if(type<0)continue;
+
+		DVector3 dvertex = thrown->position();
+		DVector3 dmom = thrown->momentum();
+		TVector3 vertex(dvertex.X(), dvertex.Y(), dvertex.Z());
+		TVector3 thrown_mom(dmom.X(), dmom.Y(), dmom.Z());
+
+		TVector3 mom;
+		bool found = false;
+		if(type==kPhoton){
+			// Closest shower in angle, as seen from the thrown vertex
+			double best_angle = MATCH_ANGLE;
+			for(unsigned int j=0; j<shower_pos.size(); j++){
+				TVector3 dir = shower_pos[j] - vertex;
+				double angle = dir.Angle(thrown_mom);
+				if(angle>best_angle)continue;
+				best_angle = angle;
+				mom = shower_E[j]*dir.Unit();
+				found = true;
+			}
+		}else{
+			// Of the tracks matched to this particle, the one with the best FOM
+			double best_FOM = -1.0;
+			for(unsigned int j=0; j<tracks.size(); j++){
+				if(tracks[j]->dMCThrownMatchMyID!=thrown->myid)continue;
+				if(tracks[j]->FOM<=best_FOM)continue;
+				best_FOM = tracks[j]->FOM;
+				DVector3 tmom = tracks[j]->momentum();
+				mom.SetXYZ(tmom.X(), tmom.Y(), tmom.Z());
+				found = true;
+			}
+		}
+
+		Fill(hists[type], thrown, found ? &mom:NULL);
+	}
+
+	japp->RootUnLock();
+
+	return NOERROR;
+}
+
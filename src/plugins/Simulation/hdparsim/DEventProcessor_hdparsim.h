@@ -0,0 +1,65 @@
+// $Id$
+//
+//    File: DEventProcessor_hdparsim.h
+//
+
+#ifndef _DEventProcessor_hdparsim_
+#define _DEventProcessor_hdparsim_
+
+#include <TH2.h>
+#include <TH3.h>
+
+#include <JANA/JEventProcessor.h>
+#include <JANA/JEventLoop.h>
+
+#include <TRACKING/DMCThrown.h>
+
+/// Fills the histograms the parameterized simulation is built from and
+/// checked against. Run on a full simulation + reconstruction sample,
+/// the hdparsim_tables.C macro turns them into the resolution and
+/// efficiency tables. Run on both a full and a parameterized sample,
+/// the hdparsim_validation.C macro compares the two. Nothing is done
+/// unless HDPARSIM:MAKE_HISTS is set.
+///
+/// The reconstructed objects are taken from the default factories, so
+/// use -PDEFTAG:DTrackTimeBased=HDParSim etc. for the parameterized
+/// sample.
+class DEventProcessor_hdparsim:public jana::JEventProcessor{
+	public:
+		DEventProcessor_hdparsim(){};
+		~DEventProcessor_hdparsim(){};
+		const char* className(void){return "DEventProcessor_hdparsim";}
+
+		enum{
+			kPion,
+			kKaon,
+			kProton,
+			kElectron,
+			kPhoton,
+			kNtypes
+		};
+
+		class Hists{
+			public:
+				TH2F *thrown;		///< thrown particles vs p vs theta
+				TH2F *found;		///< reconstructed particles vs thrown p vs theta
+				TH3F *dp_over_p;	///< dpt/pt (dE/E for photons) vs p vs theta
+				TH3F *dtheta;		///< theta residual (mrad) vs p vs theta
+				TH3F *dphi;		///< phi residual (mrad) vs p vs theta
+		};
+
+	private:
+		jerror_t init(void);						///< Called once at program start.
+		jerror_t evnt(jana::JEventLoop *eventLoop, int eventnumber);	///< Called every event.
+
+		static int TypeIndex(int geanttype);
+		void Fill(Hists &h, const DMCThrown *thrown, const TVector3 *mom);
+
+		bool MAKE_HISTS;
+		double MATCH_ANGLE;	///< largest angle between thrown photon and shower (rad)
+
+		Hists hists[kNtypes];
+};
+
+#endif // _DEventProcessor_hdparsim_
+
@@ -0,0 +1,130 @@
+// $Id$
+//
+//    File: DFCALShower_factory_HDParSim.cc
+//
+
+
+#include <iostream>
+#include <iomanip>
+using namespace std;
+
+#include <JANA/JApplication.h>
+
+#include <TRACKING/DMCThrown.h>
+
+#include "DTrackingResolutionGEANTphoton.h"
+#include "DFCALShower_factory_HDParSim.h"
+using namespace jana;
+
+//------------------
+// DFCALShower_factory_HDParSim   (Constructer)
+//------------------
+DFCALShower_factory_HDParSim::DFCALShower_factory_HDParSim(void)
+{
+	res = NULL;
+}
+
+//------------------
+// init
+//------------------
+jerror_t DFCALShower_factory_HDParSim::init(void)
+{
+	// The tables are read here rather than in the constructor so that
+	// they are only needed if this factory is actually used. Reading
+	// them opens ROOT files and switches gDirectory so it must be done
+	// while holding the ROOT lock since init() runs in every thread.
+	japp->RootWriteLock();
+	res = new DTrackingResolutionGEANTphoton();
+	japp->RootUnLock();
+
+	// Allow user to specify that the efficiency cut should not be applied
+	APPLY_EFFICIENCY_PHOTON = true; // do apply efficiency cut by default
+	FCAL_Z = 625.3;
+	FCAL_RMIN = 6.0;
+	FCAL_RMAX = 120.0;
+	FCAL_TIME_RES = 0.4;
+
+	gPARMS->SetDefaultParameter("HDPARSIM:APPLY_EFFICIENCY_PHOTON", APPLY_EFFICIENCY_PHOTON);
+	gPARMS->SetDefaultParameter("HDPARSIM:FCAL_Z", FCAL_Z, "z of FCAL face in cm");
+	gPARMS->SetDefaultParameter("HDPARSIM:FCAL_RMIN", FCAL_RMIN, "inner radius of FCAL acceptance in cm");
+	gPARMS->SetDefaultParameter("HDPARSIM:FCAL_RMAX", FCAL_RMAX, "outer radius of FCAL acceptance in cm");
+	gPARMS->SetDefaultParameter("HDPARSIM:FCAL_TIME_RES", FCAL_TIME_RES, "FCAL shower time resolution in ns");
+
+	return NOERROR;
+}
+
+//------------------
+// brun
+//------------------
+jerror_t DFCALShower_factory_HDParSim::brun(jana::JEventLoop *eventLoop, int runnumber)
+{
+	return NOERROR;
+}
+
+//------------------
+// evnt
+//------------------
+jerror_t DFCALShower_factory_HDParSim::evnt(JEventLoop *loop, int eventnumber)
+{
+	// Make a shower for each thrown photon that points at the FCAL face.
+	// The energy and direction are smeared using the photon tables and
+	// the shower is placed where the smeared direction meets the face.
+	vector<const DMCThrown*> throwns;
+	loop->Get(throwns);
+
+	for(unsigned int i=0; i<throwns.size(); i++){
+		const DMCThrown *thrown = throwns[i];
+		if(thrown->type!=1)continue;
+
+		DVector3 dvertex = thrown->position();
+		DVector3 dmom = thrown->momentum();
+		TVector3 vertex(dvertex.X(), dvertex.Y(), dvertex.Z());
+		TVector3 mom(dmom.X(), dmom.Y(), dmom.Z());
+		if(mom.Z()<=0.0)continue;
+		double path = (FCAL_Z - vertex.Z())/mom.CosTheta();
+		TVector3 pos = vertex + path*mom.Unit();
+		if(pos.Perp()<FCAL_RMIN || pos.Perp()>FCAL_RMAX)continue;
+
+		// Simultaneously smear the momentum of the particle and test whether
+		// it passes the efficiency/acceptance cut.
+		double E_res, theta_res, phi_res;
+		res->GetResolution(thrown->type, mom, E_res, theta_res, phi_res);
+		bool keep = res->Smear(thrown->type, mom);
+		if(!keep && APPLY_EFFICIENCY_PHOTON)continue;
+		if(mom.Z()<=0.0)continue;
+
+		path = (FCAL_Z - vertex.Z())/mom.CosTheta();
+		pos = vertex + path*mom.Unit();
+		double pos_err = path*theta_res/1000.0;
+
+		DFCALShower *shower = new DFCALShower;
+		shower->setEnergy(mom.Mag());
+		shower->setPosition(DVector3(pos.X(), pos.Y(), pos.Z()));
+		shower->setPosError(pos_err, pos_err, 0.0);
+		shower->setTime(thrown->time() + path/29.9792458 + rnd.Gaus(0.0, FCAL_TIME_RES));
+		shower->AddAssociatedObject(thrown);
+
+		_data.push_back(shower);
+	}
+
+	return NOERROR;
+}
+
+//------------------
+// erun
+//------------------
+jerror_t DFCALShower_factory_HDParSim::erun(void)
+{
+	return NOERROR;
+}
+
+//------------------
+// fini
+//------------------
+jerror_t DFCALShower_factory_HDParSim::fini(void)
+{
+	if(res)delete res;
+
+	return NOERROR;
+}
+
@@ -0,0 +1,40 @@
+// $Id$
+//
+//    File: DFCALShower_factory_HDParSim.h
+//
+
+#ifndef _DFCALShower_factory_HDParSim_
+#define _DFCALShower_factory_HDParSim_
+
+#include <TRandom3.h>
+
+#include <JANA/JFactory.h>
+#include <FCAL/DFCALShower.h>
+
+#include "DTrackingResolution.h"
+
+class DFCALShower_factory_HDParSim:public jana::JFactory<DFCALShower>{
+	public:
+		DFCALShower_factory_HDParSim();
+		~DFCALShower_factory_HDParSim(){};
+		const char* Tag(void){return "HDParSim";}
+
+	private:
+		jerror_t init(void);						///< Called once at program start.
+		jerror_t brun(jana::JEventLoop *eventLoop, int runnumber);	///< Called everytime a new run number is detected.
+		jerror_t evnt(jana::JEventLoop *eventLoop, int eventnumber);	///< Called every event.
+		jerror_t erun(void);						///< Called everytime run number changes, provided brun has been called.
+		jerror_t fini(void);						///< Called after last event of last event source has been processed.
+
+		bool APPLY_EFFICIENCY_PHOTON;
+		double FCAL_Z;		///< z of FCAL face (cm)
+		double FCAL_RMIN;	///< inner radius of FCAL acceptance (cm)
+		double FCAL_RMAX;	///< outer radius of FCAL acceptance (cm)
+		double FCAL_TIME_RES;	///< shower time resolution (ns)
+
+		DTrackingResolution *res;
+		TRandom3 rnd;
+};
+
+#endif // _DFCALShower_factory_HDParSim_
+
@@ -13,8 +13,13 @@
 using namespace jana;
 
 #include "DTrackTimeBased_factory_HDParSim.h"
-#include "DPhoton_factory_HDParSim.h"
+#include "DFCALShower_factory_HDParSim.h"
+#include "DBCALShower_factory_HDParSim.h"
+#include "DTOFPoint_factory_HDParSim.h"
 
+/// The HDParSim factories are EXPERIMENTAL. The REST-level showers and
+/// TOF points and the kaon and electron tables have not been compared to
+/// full simulation yet (see hdparsim_validation.C).
 class DFactoryGeneratorHDParSim: public JFactoryGenerator{
 	public:
 		DFactoryGeneratorHDParSim(){pthread_mutex_init(&root_mutex, NULL);}
@@ -26,7 +31,9 @@ class DFactoryGeneratorHDParSim: public JFactoryGenerator{
 			pthread_mutex_lock(&root_mutex);
 			
 			loop->AddFactory(new DTrackTimeBased_factory_HDParSim());
-			loop->AddFactory(new DPhoton_factory_HDParSim());
+			loop->AddFactory(new DFCALShower_factory_HDParSim());
+			loop->AddFactory(new DBCALShower_factory_HDParSim());
+			loop->AddFactory(new DTOFPoint_factory_HDParSim());
 
 			pthread_mutex_unlock(&root_mutex);
 
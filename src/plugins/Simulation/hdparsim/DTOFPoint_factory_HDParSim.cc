@@ -0,0 +1,92 @@
+// $Id$
+//
+//    File: DTOFPoint_factory_HDParSim.cc
+//
+
+
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+using namespace std;
+
+#include <JANA/JApplication.h>
+
+#include <TRACKING/DTrackTimeBased.h>
+#include <TRACKING/DReferenceTrajectory.h>
+
+#include "DTOFPoint_factory_HDParSim.h"
+using namespace jana;
+
+//------------------
+// init
+//------------------
+jerror_t DTOFPoint_factory_HDParSim::init(void)
+{
+	TOF_TIME_RES = 0.1;
+	TOF_POS_RES = 1.5;
+	TOF_DE = 0.0045;
+
+	gPARMS->SetDefaultParameter("HDPARSIM:TOF_TIME_RES", TOF_TIME_RES, "TOF point time resolution in ns");
+	gPARMS->SetDefaultParameter("HDPARSIM:TOF_POS_RES", TOF_POS_RES, "TOF point position resolution in cm");
+	gPARMS->SetDefaultParameter("HDPARSIM:TOF_DE", TOF_DE, "energy deposited in the TOF at normal incidence in GeV");
+
+	return NOERROR;
+}
+
+//------------------
+// brun
+//------------------
+jerror_t DTOFPoint_factory_HDParSim::brun(jana::JEventLoop *eventLoop, int runnumber)
+{
+	eventLoop->GetSingle(tofGeom);
+
+	half_length = tofGeom->LONGBARLENGTH/2.0;
+	half_hole = tofGeom->LONGBARLENGTH/2.0 - tofGeom->SHORTBARLENGTH;
+
+	return NOERROR;
+}
+
+//------------------
+// evnt
+//------------------
+jerror_t DTOFPoint_factory_HDParSim::evnt(JEventLoop *loop, int eventnumber)
+{
+	// Make a point for each thrown charged particle that crosses the
+	// TOF. The unsmeared tracks from the DTrackTimeBased:THROWN factory
+	// already have a reference trajectory swum through the field, so
+	// the position and flight time at the TOF come from that.
+	vector<const DTrackTimeBased*> particles_thrn;
+	loop->Get(particles_thrn, "THROWN");
+
+	DVector3 origin(0.0, 0.0, tofGeom->CenterMPlane);
+	DVector3 norm(0.0, 0.0, 1.0);
+	for(unsigned int i=0; i<particles_thrn.size(); i++){
+		const DTrackTimeBased *track = particles_thrn[i];
+		if(!track->rt)continue;
+
+		DVector3 pos, mom;
+		double s, t;
+		if(track->rt->GetIntersectionWithPlane(origin, norm, pos, mom, &s, &t, SYS_TOF)!=NOERROR)continue;
+		if(s<=0.0 || mom.Z()<=0.0)continue;
+		if(fabs(pos.X())>half_length || fabs(pos.Y())>half_length)continue;
+		if(fabs(pos.X())<half_hole && fabs(pos.Y())<half_hole)continue;
+
+		DTOFPoint *point = new DTOFPoint;
+		point->pos.SetXYZ(pos.X() + rnd.Gaus(0.0, TOF_POS_RES),
+						pos.Y() + rnd.Gaus(0.0, TOF_POS_RES),
+						pos.Z());
+		point->t = track->time() + t + rnd.Gaus(0.0, TOF_TIME_RES);
+		point->tErr = TOF_TIME_RES;
+		point->dE = TOF_DE*mom.Mag()/mom.Z();
+		point->dHorizontalBar = tofGeom->y2bar(pos.Y());
+		point->dVerticalBar = tofGeom->y2bar(pos.X());
+		point->dHorizontalBarStatus = 3;
+		point->dVerticalBarStatus = 3;
+		point->AddAssociatedObject(track);
+
+		_data.push_back(point);
+	}
+
+	return NOERROR;
+}
+
@@ -0,0 +1,37 @@
+// $Id$
+//
+//    File: DTOFPoint_factory_HDParSim.h
+//
+
+#ifndef _DTOFPoint_factory_HDParSim_
+#define _DTOFPoint_factory_HDParSim_
+
+#include <TRandom3.h>
+
+#include <JANA/JFactory.h>
+#include <TOF/DTOFPoint.h>
+#include <TOF/DTOFGeometry.h>
+
+class DTOFPoint_factory_HDParSim:public jana::JFactory<DTOFPoint>{
+	public:
+		DTOFPoint_factory_HDParSim(){};
+		~DTOFPoint_factory_HDParSim(){};
+		const char* Tag(void){return "HDParSim";}
+
+	private:
+		jerror_t init(void);						///< Called once at program start.
+		jerror_t brun(jana::JEventLoop *eventLoop, int runnumber);	///< Called everytime a new run number is detected.
+		jerror_t evnt(jana::JEventLoop *eventLoop, int eventnumber);	///< Called every event.
+
+		double TOF_TIME_RES;	///< point time resolution (ns)
+		double TOF_POS_RES;	///< point position resolution (cm)
+		double TOF_DE;		///< energy deposited at normal incidence (GeV)
+
+		const DTOFGeometry *tofGeom;
+		double half_length;	///< half-length of the long bars (cm)
+		double half_hole;	///< half-width of the beam hole (cm)
+		TRandom3 rnd;
+};
+
+#endif // _DTOFPoint_factory_HDParSim_
+
@@ -26,7 +26,7 @@ using namespace jana;
 //------------------
 DTrackTimeBased_factory_HDParSim::DTrackTimeBased_factory_HDParSim()
 {
-	res = new DTrackingResolutionGEANT();
+	res = NULL;
 }
 
 //------------------
@@ -34,6 +34,14 @@ DTrackTimeBased_factory_HDParSim::DTrackTimeBased_factory_HDParSim()
 //------------------
 jerror_t DTrackTimeBased_factory_HDParSim::init(void)
 {
+	// The tables are read here rather than in the constructor so that
+	// they are only needed if this factory is actually used. Reading
+	// them opens ROOT files and switches gDirectory so it must be done
+	// while holding the ROOT lock since init() runs in every thread.
+	japp->RootWriteLock();
+	res = new DTrackingResolutionGEANT();
+	japp->RootUnLock();
+
 	// Here, we allow the user to set scale factors for each of the 
 	// resolutions so that 1/2 err and double error type simulations
 	// can be done. The default scale factors should be 1, but we go
@@ -146,6 +154,8 @@ jerror_t DTrackTimeBased_factory_HDParSim::erun(void)
 //------------------
 jerror_t DTrackTimeBased_factory_HDParSim::fini(void)
 {
+	if(res)delete res;
+
 	return NOERROR;
 }
 
@@ -11,12 +11,18 @@ using namespace std;
 
 #include "DTrackingResolution.h"
 #include "DFactoryGeneratorHDParSim.h"
+#include "DEventProcessor_hdparsim.h"
 
 // Routine used If we're a plugin
 extern "C"{
 void InitPlugin(JApplication *app){
 	InitJANAPlugin(app);
+	// The REST-level output (showers, TOF points, kaon and electron
+	// tables) has not yet been checked against full simulation with
+	// hdparsim_validation.C.
+	jout<<"hdparsim: EXPERIMENTAL - REST-level output not yet validated against full simulation"<<endl;
 	app->AddFactoryGenerator(new DFactoryGeneratorHDParSim());
+	app->AddProcessor(new DEventProcessor_hdparsim());
 }
 } // "C"
 
@@ -99,8 +105,8 @@ bool DTrackingResolution::Smear(int geanttype, TVector3 &mom)
 		theta_new = mom.Theta();
 	}
 	phi_new = mom.Phi() + rnd.Gaus(0.0, phi_res)/1000.0;
-	while(phi_new<-M_PI)phi_new+=M_PI;
-	while(phi_new>=M_PI)phi_new-=M_PI;
+	while(phi_new<-M_PI)phi_new+=2.0*M_PI;
+	while(phi_new>=M_PI)phi_new-=2.0*M_PI;
 	
 	// Overwrite input vector with new values.
 	// For photons, the value returned in "pt_res" is actually the
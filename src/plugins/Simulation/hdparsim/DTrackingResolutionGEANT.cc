@@ -8,6 +8,7 @@
 #include <TROOT.h>
 #include <TApplication.h>
 
+#include <cstdio>
 #include <iostream>
 using namespace std;
 
@@ -28,6 +29,8 @@ DTrackingResolutionGEANT::DTrackingResolutionGEANT()
 	
 	ReadTableInfo("hd_res_charged_pion.root", pion_info);
 	ReadTableInfo("hd_res_charged_proton.root", proton_info);
+	ReadOptionalTableInfo("hd_res_charged_kaon.root", kaon_info);
+	ReadOptionalTableInfo("hd_res_charged_electron.root", electron_info);
 
 	if(savedir)savedir->cd();
 
@@ -111,6 +114,21 @@ void DTrackingResolutionGEANT::ReadTableInfo(const char *fname, TableInfo &ti)
 	
 }
 
+//----------------
+// ReadOptionalTableInfo
+//----------------
+void DTrackingResolutionGEANT::ReadOptionalTableInfo(const char *fname, TableInfo &ti)
+{
+	/// Tables for the less common particle types are not on the web
+	/// site. They are only used if a local file exists, which can be
+	/// made from full simulation with the hdparsim_tables.C macro.
+	FILE *f = fopen(fname, "r");
+	if(!f)return;
+	fclose(f);
+	
+	ReadTableInfo(fname, ti);
+}
+
 //---------------------------------
 // ~DTrackingResolutionGEANT    (Destructor)
 //---------------------------------
@@ -118,22 +136,39 @@ DTrackingResolutionGEANT::~DTrackingResolutionGEANT()
 {
 	if(pion_info.file)delete pion_info.file;
 	if(proton_info.file)delete proton_info.file;
+	if(kaon_info.file)delete kaon_info.file;
+	if(electron_info.file)delete electron_info.file;
 }
 
 //----------------
-// GetResolution
+// GetTableInfo
 //----------------
-void DTrackingResolutionGEANT::GetResolution(int geanttype, const TVector3 &mom, double &pt_res, double &theta_res, double &phi_res)
+DTrackingResolutionGEANT::TableInfo& DTrackingResolutionGEANT::GetTableInfo(int geanttype)
 {
 	switch(geanttype){
-		case 14:
-			GetResolution(proton_info, geanttype, mom, pt_res, theta_res, phi_res);
+		case 14: // proton
+		case 15: // anti-proton
+			return proton_info;
+		case 11: // K+
+		case 12: // K-
+			if(kaon_info.file)return kaon_info;
+			break;
+		case 2: // e+
+		case 3: // e-
+			if(electron_info.file)return electron_info;
 			break;
-		case 8: // pi+
-		case 9: // pi-
-		default: // assume everything else is close to pion resolutions
-			GetResolution(pion_info, geanttype, mom, pt_res, theta_res, phi_res);
 	}
+	
+	// assume everything else is close to pion resolutions
+	return pion_info;
+}
+
+//----------------
+// GetResolution
+//----------------
+void DTrackingResolutionGEANT::GetResolution(int geanttype, const TVector3 &mom, double &pt_res, double &theta_res, double &phi_res)
+{
+	GetResolution(GetTableInfo(geanttype), geanttype, mom, pt_res, theta_res, phi_res);
 }
 
 //----------------
@@ -141,15 +176,7 @@ void DTrackingResolutionGEANT::GetResolution(int geanttype, const TVector3 &mom,
 //----------------
 double DTrackingResolutionGEANT::GetEfficiency(int geanttype, const TVector3 &mom)
 {
-	switch(geanttype){
-		case 14:
-			return GetEfficiency(proton_info, geanttype, mom);
-			break;
-		case 8: // pi+
-		case 9: // pi-
-		default: // assume everything else is close to pion resolutions
-			return GetEfficiency(pion_info, geanttype, mom);
-	}
+	return GetEfficiency(GetTableInfo(geanttype), geanttype, mom);
 }
 
 //----------------
@@ -18,6 +18,7 @@ class DTrackingResolutionGEANT:public DTrackingResolution{
 
 		class TableInfo{
 			public:
+				TableInfo():file(NULL){}
 				TFile *file;
 				TH2D* pt_res_hist;
 				TH2D* theta_res_hist;
@@ -31,6 +32,8 @@ class DTrackingResolutionGEANT:public DTrackingResolution{
 		static const char* static_className(void){return "DTrackingResolutionGEANT";}
 
 		void ReadTableInfo(const char *fname, TableInfo &ti);
+		void ReadOptionalTableInfo(const char *fname, TableInfo &ti);
+		TableInfo& GetTableInfo(int geanttype);
 		
 		// Accessor methods called through virtual method of DTrackingResolution
 		void GetResolution(int geanttype, const TVector3 &mom, double &pt_res, double &theta_res, double &phi_res);
@@ -43,6 +46,8 @@ class DTrackingResolutionGEANT:public DTrackingResolution{
 	private:
 		TableInfo pion_info;
 		TableInfo proton_info;
+		TableInfo kaon_info;     ///< optional, pion tables are used if absent
+		TableInfo electron_info; ///< optional, pion tables are used if absent
 };
 
 #endif // _DTrackingResolutionGEANT_
@@ -1,16 +1,206 @@
+#include <deque>
+#include <set>
+#include <pthread.h>
+#include <sys/time.h>
+
 #include "DEventWriterEVIO.h"
 
+//Buffers owned by one DEventWriterEVIO (i.e. one thread). Buffers are taken by the owning thread and given back by the writer thread.
+class DEVIOBufferPool
+{
+	public:
+		DEVIOBufferPool(void) : dNumOutstanding(0)
+		{
+			pthread_mutex_init(&dMutex, NULL);
+			pthread_cond_init(&dAllReturned, NULL);
+		}
+		~DEVIOBufferPool(void)
+		{
+			for(size_t loc_i = 0; loc_i < dFreeBuffers.size(); ++loc_i)
+				delete dFreeBuffers[loc_i];
+			pthread_cond_destroy(&dAllReturned);
+			pthread_mutex_destroy(&dMutex);
+		}
+
+		vector<uint32_t>* Get_Buffer(void)
+		{
+			vector<uint32_t>* locBuffer = NULL;
+			pthread_mutex_lock(&dMutex);
+			{
+				if(!dFreeBuffers.empty())
+				{
+					locBuffer = dFreeBuffers.back();
+					dFreeBuffers.pop_back();
+				}
+				++dNumOutstanding;
+			}
+			pthread_mutex_unlock(&dMutex);
+			return (locBuffer != NULL) ? locBuffer : new vector<uint32_t>();
+		}
+
+		void Return_Buffer(vector<uint32_t>* locBuffer)
+		{
+			pthread_mutex_lock(&dMutex);
+			{
+				dFreeBuffers.push_back(locBuffer);
+				if(--dNumOutstanding == 0)
+					pthread_cond_signal(&dAllReturned);
+			}
+			pthread_mutex_unlock(&dMutex);
+		}
+
+		void Wait_ForAllReturned(void)
+		{
+			pthread_mutex_lock(&dMutex);
+			while(dNumOutstanding > 0)
+				pthread_cond_wait(&dAllReturned, &dMutex);
+			pthread_mutex_unlock(&dMutex);
+		}
+
+	private:
+		pthread_mutex_t dMutex;
+		pthread_cond_t dAllReturned;
+		vector<vector<uint32_t>*> dFreeBuffers;
+		size_t dNumOutstanding;
+};
+
+class DEVIOQueueItem
+{
+	public:
+		string dOutputFileName;
+		vector<uint32_t>* dBuffer;
+		DEVIOBufferPool* dPool;
+};
+
 //file-scope so shared amongst threads; only accessed below via locks
 size_t gEVIONumOutputThreads = 0;
-map<string, int>* gEVIOOutputFilePointers = NULL;
+map<string, int>* gEVIOOutputFilePointers = NULL; //only accessed by the writer thread (and after it is joined)
+
+//output queue: accessed only while holding gEVIOQueueMutex
+static pthread_mutex_t gEVIOQueueMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gEVIOQueueNotEmpty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t gEVIOQueueNotFull = PTHREAD_COND_INITIALIZER;
+static deque<DEVIOQueueItem> gEVIOQueue;
+static size_t gEVIOQueueMaxSize = 64;
+static bool gEVIOWriterDone = false;
+static pthread_t gEVIOWriterThread;
+static set<string> gEVIOFailedOutputFiles; //files that could not be opened or written: later events for them are refused
+
+//output statistics: accessed only while holding gEVIOQueueMutex (or after the writer thread is joined)
+static size_t gEVIONumEventsQueued = 0;
+static size_t gEVIONumEventsWritten = 0;
+static double gEVIOQueueDepthSum = 0.0;
+static size_t gEVIOQueueDepthMax = 0;
+static size_t gEVIONumStalls = 0;
+static double gEVIOStallTime = 0.0; //seconds, summed over all threads
+static size_t gEVIONumBatches = 0;
+static double gEVIONumBytesWritten = 0.0;
+
+static double Get_Time(void)
+{
+	struct timeval locTime;
+	gettimeofday(&locTime, NULL);
+	return double(locTime.tv_sec) + double(locTime.tv_usec)/1.0E6;
+}
+
+static void* EVIOWriterThread(void* locArg)
+{
+	deque<DEVIOQueueItem> locBatch;
+	while(true)
+	{
+		//take everything currently in the queue
+		pthread_mutex_lock(&gEVIOQueueMutex);
+		{
+			while(gEVIOQueue.empty() && !gEVIOWriterDone)
+				pthread_cond_wait(&gEVIOQueueNotEmpty, &gEVIOQueueMutex);
+			if(gEVIOQueue.empty())
+			{
+				pthread_mutex_unlock(&gEVIOQueueMutex);
+				break; //done and nothing left to write
+			}
+			locBatch.swap(gEVIOQueue);
+			++gEVIONumBatches;
+			pthread_cond_broadcast(&gEVIOQueueNotFull);
+		}
+		pthread_mutex_unlock(&gEVIOQueueMutex);
+
+		//write them in the order they were queued
+		double locNumBytes = 0.0;
+		size_t locNumWritten = 0;
+		set<string> locFailedFiles;
+		for(size_t loc_i = 0; loc_i < locBatch.size(); ++loc_i)
+		{
+			DEVIOQueueItem& locItem = locBatch[loc_i];
+#if HAVE_EVIO
+			map<string, int>::iterator locIterator = gEVIOOutputFilePointers->find(locItem.dOutputFileName);
+			if(locIterator == gEVIOOutputFilePointers->end())
+			{
+				//not open, open it
+				if(DEventWriterEVIO::Open_OutputFile(locItem.dOutputFileName))
+					locIterator = gEVIOOutputFilePointers->find(locItem.dOutputFileName);
+			}
+			if((locIterator != gEVIOOutputFilePointers->end()) && (locIterator->second >= 0)) //handle is -1 if the open failed
+			{
+				int locStatus = evWrite(locIterator->second, &(*locItem.dBuffer)[0]);
+				if(locStatus == S_SUCCESS)
+				{
+					locNumBytes += 4.0*double(locItem.dBuffer->size());
+					++locNumWritten;
+				}
+				else
+				{
+					//don't write anything more to it
+					jerr << "Error writing event to EVIO file " << locItem.dOutputFileName << " (status = " << locStatus << "). Later events for it will be dropped." << endl;
+					evClose(locIterator->second);
+					locIterator->second = -1;
+					locFailedFiles.insert(locItem.dOutputFileName);
+				}
+			}
+			else
+				locFailedFiles.insert(locItem.dOutputFileName);
+#endif // HAVE_EVIO
+			locItem.dPool->Return_Buffer(locItem.dBuffer);
+		}
+		locBatch.clear();
+
+		pthread_mutex_lock(&gEVIOQueueMutex);
+		gEVIONumBytesWritten += locNumBytes;
+		gEVIONumEventsWritten += locNumWritten;
+		gEVIOFailedOutputFiles.insert(locFailedFiles.begin(), locFailedFiles.end());
+		pthread_mutex_unlock(&gEVIOQueueMutex);
+	}
+
+	return NULL;
+}
 
 DEventWriterEVIO::DEventWriterEVIO(JEventLoop* locEventLoop)
 {
+	dBufferPool = new DEVIOBufferPool();
+
 	japp->WriteLock("EVIOWriter");
 	{
 		++gEVIONumOutputThreads;
 		if(gEVIOOutputFilePointers == NULL)
+		{
+			//first thread: start the writer thread
 			gEVIOOutputFilePointers = new map<string, int>();
+
+			int locQueueSize = gEVIOQueueMaxSize;
+			gPARMS->SetDefaultParameter("EVIOOUT:QUEUE_SIZE", locQueueSize, "Maximum number of events waiting to be written to EVIO output files");
+			gEVIOQueueMaxSize = (locQueueSize > 0) ? locQueueSize : 1;
+
+			gEVIOWriterDone = false;
+			gEVIONumEventsQueued = 0;
+			gEVIONumEventsWritten = 0;
+			gEVIOFailedOutputFiles.clear();
+			gEVIOQueueDepthSum = 0.0;
+			gEVIOQueueDepthMax = 0;
+			gEVIONumStalls = 0;
+			gEVIOStallTime = 0.0;
+			gEVIONumBatches = 0;
+			gEVIONumBytesWritten = 0.0;
+			pthread_create(&gEVIOWriterThread, NULL, EVIOWriterThread, NULL);
+		}
 	}
 	japp->Unlock("EVIOWriter");
 }
@@ -71,9 +261,9 @@ string DEventWriterEVIO::Get_OutputFileName(JEventLoop* locEventLoop, string loc
 	return (locSourceFileName_Pathless + string(".") + locOutputFileNameSubString + string(".evio"));
 }
 
-bool DEventWriterEVIO::Open_OutputFile(JEventLoop* locEventLoop, string locOutputFileName) const
+bool DEventWriterEVIO::Open_OutputFile(string locOutputFileName)
 {
-	//ASSUMES A LOCK HAS ALREADY BEEN ACQUIRED (by Write_EVIOEvent)
+	//CALLED ONLY BY THE WRITER THREAD
 #if HAVE_EVIO
 	//open it
 	int locEVIOHandle = 0;
@@ -82,12 +272,10 @@ bool DEventWriterEVIO::Open_OutputFile(JEventLoop* locEventLoop, string locOutpu
 
 	//evaluate status
 	if(locStatus != S_SUCCESS)
-		jerr << "Unable to open EVIO file." << endl;
+		jerr << "Unable to open EVIO file " << locOutputFileName << ". Events for it will be dropped." << endl;
 	else
-	{
 		jout << "Output EVIO file " << locOutputFileName << " created." << endl;
-		(*gEVIOOutputFilePointers)[locOutputFileName] = locEVIOHandle; //store the handle
-	}
+	(*gEVIOOutputFilePointers)[locOutputFileName] = (locStatus == S_SUCCESS) ? locEVIOHandle : -1; //store the handle (don't retry failures)
 
 	return (locStatus == S_SUCCESS);
 
@@ -101,21 +289,41 @@ bool DEventWriterEVIO::Write_EVIOEvent(JEventLoop* locEventLoop, string locOutpu
 {
 #if HAVE_EVIO
 	string locOutputFileName = Get_OutputFileName(locEventLoop, locOutputFileNameSubString);
-	japp->WriteLock("EVIOWriter");
+
+	//refuse events for a file the writer thread already failed to open or write
+	pthread_mutex_lock(&gEVIOQueueMutex);
+	bool locFileFailed = (gEVIOFailedOutputFiles.find(locOutputFileName) != gEVIOFailedOutputFiles.end());
+	pthread_mutex_unlock(&gEVIOQueueMutex);
+	if(locFileFailed)
+		return false;
+
+	//copy the event into a buffer of our own: the source's buffer is gone once the event is done
+	DEVIOQueueItem locItem;
+	locItem.dOutputFileName = locOutputFileName;
+	locItem.dPool = dBufferPool;
+	locItem.dBuffer = dBufferPool->Get_Buffer();
+	locItem.dBuffer->assign(locEVIOBuffer, locEVIOBuffer + locEVIOBuffer[0] + 1); //first word is the length of the rest of the event
+
+	//queue it for the writer thread
+	pthread_mutex_lock(&gEVIOQueueMutex);
 	{
-		//check to see if the EVIO file is open
-		if(gEVIOOutputFilePointers->find(locOutputFileName) == gEVIOOutputFilePointers->end())
+		if(gEVIOQueue.size() >= gEVIOQueueMaxSize)
 		{
-			//not open, open it
-			if(!Open_OutputFile(locEventLoop, locOutputFileName))
-				return false; //failed to open
+			double locStartTime = Get_Time();
+			while(gEVIOQueue.size() >= gEVIOQueueMaxSize)
+				pthread_cond_wait(&gEVIOQueueNotFull, &gEVIOQueueMutex);
+			gEVIOStallTime += Get_Time() - locStartTime;
+			++gEVIONumStalls;
 		}
 
-		//open: get handle, write event
-		int locEVIOHandle = (*gEVIOOutputFilePointers)[locOutputFileName];
-		evWrite(locEVIOHandle, locEVIOBuffer);
+		gEVIOQueue.push_back(locItem);
+		++gEVIONumEventsQueued;
+		gEVIOQueueDepthSum += double(gEVIOQueue.size());
+		if(gEVIOQueue.size() > gEVIOQueueDepthMax)
+			gEVIOQueueDepthMax = gEVIOQueue.size();
+		pthread_cond_signal(&gEVIOQueueNotEmpty);
 	}
-	japp->Unlock("EVIOWriter");
+	pthread_mutex_unlock(&gEVIOQueueMutex);
 
 	return true;
 #else
@@ -125,7 +333,10 @@ bool DEventWriterEVIO::Write_EVIOEvent(JEventLoop* locEventLoop, string locOutpu
 
 DEventWriterEVIO::~DEventWriterEVIO(void)
 {
-#if HAVE_EVIO
+	//wait for the writer thread to finish with this thread's events
+	dBufferPool->Wait_ForAllReturned();
+	delete dBufferPool;
+
 	japp->WriteLock("EVIOWriter");
 	{
 		--gEVIONumOutputThreads;
@@ -140,20 +351,36 @@ DEventWriterEVIO::~DEventWriterEVIO(void)
 			japp->Unlock("EVIOWriter");
 			return; //not the last thread writing to EVIO files
 		}
-		
-		//last thread writing to EVIO files: close all files and free all memory
+
+		//last thread writing to EVIO files: stop the writer thread, close all files and free all memory
+		pthread_mutex_lock(&gEVIOQueueMutex);
+		gEVIOWriterDone = true;
+		pthread_cond_signal(&gEVIOQueueNotEmpty);
+		pthread_mutex_unlock(&gEVIOQueueMutex);
+		pthread_join(gEVIOWriterThread, NULL);
+
+#if HAVE_EVIO
 		map<string, int>::iterator locIterator = gEVIOOutputFilePointers->begin();
 		for(; locIterator != gEVIOOutputFilePointers->end(); ++locIterator)
 		{
 			string locOutputFileName = locIterator->first;
 			int locEVIOHandle = locIterator->second;
+			if(locEVIOHandle < 0)
+				continue; //failed to open
 			evClose(locEVIOHandle);
 			std::cout << "Closed EVIO file " << locOutputFileName << std::endl;
 		}
+#endif // HAVE_EVIO
 		delete gEVIOOutputFilePointers;
 		gEVIOOutputFilePointers = NULL;
+
+		if(gEVIONumEventsQueued > 0)
+		{
+			std::cout << "EVIO output: " << gEVIONumEventsQueued << " events queued, " << gEVIONumEventsWritten << " (" << gEVIONumBytesWritten/1.0E6 << " MB) written in "
+				<< gEVIONumBatches << " batches; queue depth mean " << gEVIOQueueDepthSum/double(gEVIONumEventsQueued)
+				<< ", max " << gEVIOQueueDepthMax << " (limit " << gEVIOQueueMaxSize << "); threads stalled on a full queue "
+				<< gEVIONumStalls << " times for " << gEVIOStallTime << " s total" << std::endl;
+		}
 	}
 	japp->Unlock("EVIOWriter");
-#endif // HAVE_EVIO
 }
-
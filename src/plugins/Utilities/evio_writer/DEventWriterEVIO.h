@@ -17,6 +17,21 @@
 using namespace std;
 using namespace jana;
 
+class DEVIOBufferPool;
+
+/// Events are written asynchronously. Write_EVIOEvent copies the event
+/// into a buffer from this thread's pool and puts it on a bounded queue
+/// shared by all threads. A single writer thread takes everything in the
+/// queue at once, opens output files as needed, writes the events in the
+/// order they were queued and gives the buffers back to their pools. The
+/// queue is only locked long enough to add or take pointers, so threads
+/// no longer wait on each other's disk I/O. If the queue is full
+/// (EVIOOUT:QUEUE_SIZE events) the calling thread waits. The queue depth
+/// and the time spent waiting are printed when the files are closed.
+///
+/// Since the writing happens later, Write_EVIOEvent returning true only
+/// means the event was queued. Once the writer thread fails to open or
+/// write a file, later calls for that file return false.
 class DEventWriterEVIO : public JObject
 {
 	public:
@@ -29,9 +44,12 @@ class DEventWriterEVIO : public JObject
 
 		string Get_OutputFileName(JEventLoop* locEventLoop, string locOutputFileNameSubString) const;
 
+		static bool Open_OutputFile(string locOutputFileName); //called only by the writer thread
+
 	private:
 		bool Write_EVIOEvent(JEventLoop* locEventLoop, string locOutputFileNameSubString, uint32_t* locEVIOBuffer) const;
-		bool Open_OutputFile(JEventLoop* locEventLoop, string locOutputFileName) const;
+
+		DEVIOBufferPool* dBufferPool; //this thread's output buffers
 };
 
 #endif //_DEventWriterEVIO_
@@ -18,6 +18,10 @@
 //  Reads translation table in via -PRAWEVENT:TRANSLATION=fileName.xml
 //    default is fakeTranslationTable.xml
 //
+//  Events are converted in parallel by all processing threads and written
+//    in event number order, see -PRAWEVENT:REORDER_WINDOW. Use
+//    -PRAWEVENT:NOROOT=1 for large samples.
+//
 //  mc2coda expects time in natural units of the readout module: 
 //       25 ps/count for CAENTDC
 //       60 ps/count for F1TDC32
@@ -65,7 +69,7 @@
 
 #ifdef HAVE_EVIO
 
-// root histograms...probably not thread-safe
+// root histograms, filled via FillHist() since they are shared by all threads
 static TH1F *tofEnergies;
 static TH1F *fcalEnergies;
 static TH1F *bcalEnergies;
@@ -93,19 +97,6 @@ extern "C" {
 
 
 
-// Replace use of BOOST lexical_cast with a simple templated function
-// so that BOOST is no longer required.   1/24/2014  DL
-//#include <boost/lexical_cast.hpp>
-//using namespace boost;
-template<typename T>
-string lexical_cast(T t)
-{
-   stringstream ss;
-   ss << t;
-   return ss.str();
-}
-
-
 // to protect writing to output file
 static pthread_mutex_t rawMutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -147,7 +138,22 @@ static string detectorMap[MAXDCRATE][MAXDSLOT][MAXDCHANNEL];
 
 static string expName = "HallD";
 static CODA_EXP_INFO *expID     = NULL;
-static CODA_EVENT_INFO *eventID = NULL;
+
+// each processing thread fills its own event, all of them are also kept
+// in eventIDs so they can be freed at the end
+static __thread CODA_EVENT_INFO *eventID = NULL;
+static vector<CODA_EVENT_INFO*> eventIDs;
+
+
+// Events are converted in parallel but written in event number order.
+// Finished events wait in pendingEvents until the next event number is
+// ready or more than reorderWindow events are waiting, in which case the
+// lowest numbered one is written anyway (e.g. when events were skipped
+// upstream). The buffers are reused. All of this is protected by rawMutex.
+static multimap<int, vector<uint32_t>*> pendingEvents;
+static vector<vector<uint32_t>*> freeEventBuffers;
+static int nextEventNumber = 1;
+static int reorderWindow   = 64;
 
 static int nCrate   = 0;
 static int maxCrateNum = 0;
@@ -259,6 +265,50 @@ bool operator == (cscRef a, cscRef b) {
    return a.crate == b.crate;
 }
 
+
+// Dense copy of the cscMap entries with one key prefix (e.g. "cdcadc"),
+// indexed by the values in the key rather than by the key string. The
+// labels used for the end of a counter ("UP"/"DW", "N"/"S", "U"/"D" and
+// "A"/"B") become 0/1. The arrays are filled once in init so translating
+// a hit is just an index calculation.
+class cscArray {
+  public:
+    cscArray() : ndim(0) {dims[0] = dims[1] = dims[2] = dims[3] = 0;}
+    void Fill(const string &prefix);
+    cscRef Get(int i0, int i1=0, int i2=0, int i3=0) const;
+
+  private:
+    static int FieldValue(const string &field);
+    int Index(int i0, int i1, int i2, int i3) const {
+       return ((i0*dims[1] + i1)*dims[2] + i2)*dims[3] + i3;
+    }
+
+    string prefix;
+    int ndim;
+    int dims[4];
+    vector<cscVal> vals;
+};
+
+static cscArray tofadcCSC, toftdcCSC;
+static cscArray bcaladcCSC, bcaltdcCSC;
+static cscArray fcaladcCSC;
+static cscArray fdcanodeCSC, fdccathodeCSC;
+static cscArray cdcadcCSC;
+static cscArray stadcCSC, sttdcCSC;
+static cscArray tagmadcCSC, tagmtdcCSC;
+static cscArray taghadcCSC, taghtdcCSC;
+static cscArray pscadcCSC, psctdcCSC;
+static cscArray psadcCSC;
+
+
+// Histograms are shared by all threads. Use -PRAWEVENT:NOROOT=1 when
+// converting large samples to avoid the lock.
+static void FillHist(TH1F *h, double x) {
+   japp->RootWriteLock();
+   h->Fill(x);
+   japp->RootUnLock();
+}
+
 #endif //HAVE_EVIO
 
 // JEventProcessor_rawevent (Constructor) invoked once only
@@ -302,6 +352,12 @@ JEventProcessor_rawevent::JEventProcessor_rawevent() {
   // option to turn off root
   gPARMS->SetDefaultParameter("RAWEVENT:NOROOT",noroot);
 
+  // how far events may be held back to write them in order
+  gPARMS->SetDefaultParameter("RAWEVENT:REORDER_WINDOW",reorderWindow,
+          "Max. number of converted events held back so that events are"
+          " written in event number order. Set to 0 to write events in the"
+          " order they are finished.");
+
   // option to dump hits
   gPARMS->SetDefaultParameter("RAWEVENT:DUMPHITS",dumphits);
 
@@ -346,8 +402,14 @@ JEventProcessor_rawevent::JEventProcessor_rawevent() {
 JEventProcessor_rawevent::~JEventProcessor_rawevent() {
 #ifdef HAVE_EVIO
   if (nomc2coda == 0) {
+    for (unsigned int i=0; i<eventIDs.size(); i++)
+      mc2codaFreeEvent(eventIDs[i]);
+    eventIDs.clear();
     mc2codaFree(expID);
   }
+  for (unsigned int i=0; i<freeEventBuffers.size(); i++)
+    delete freeEventBuffers[i];
+  freeEventBuffers.clear();
 #endif //HAVE_EVIO
 }
 
@@ -414,6 +476,25 @@ jerror_t JEventProcessor_rawevent::init(void) {
      }
   }
 
+  // dense lookup arrays used to translate hits
+  tofadcCSC.Fill("tofadc");
+  toftdcCSC.Fill("toftdc");
+  bcaladcCSC.Fill("bcaladc");
+  bcaltdcCSC.Fill("bcaltdc");
+  fcaladcCSC.Fill("fcaladc");
+  fdcanodeCSC.Fill("fdcanode");
+  fdccathodeCSC.Fill("fdccathode");
+  cdcadcCSC.Fill("cdcadc");
+  stadcCSC.Fill("stadc");
+  sttdcCSC.Fill("sttdc");
+  tagmadcCSC.Fill("tagmadc");
+  tagmtdcCSC.Fill("tagmtdc");
+  taghadcCSC.Fill("taghadc");
+  taghtdcCSC.Fill("taghtdc");
+  pscadcCSC.Fill("pscadc");
+  psctdcCSC.Fill("psctdc");
+  psadcCSC.Fill("psadc");
+
   // root histograms
   if (noroot == 0) {
     tofEnergies  = new TH1F("tofe",  "TOF energies in keV",1000,0.,5000.);
@@ -457,7 +538,13 @@ jerror_t JEventProcessor_rawevent::brun(JEventLoop *eventLoop, int runnumber) {
   }
   mc2codaSetRunNumber(runNumber);
 
-  // close old output file
+  // write any events still waiting and close old output file. The new
+  // run starts numbering over, so start the ordering over as well (if it
+  // doesn't start at 1 the reorder window sorts out where it begins).
+  pthread_mutex_lock(&rawMutex);
+  WritePendingEvents(true);
+  nextEventNumber = 1;
+  pthread_mutex_unlock(&rawMutex);
   if (chan != NULL) {
     chan->close();
     delete(chan);
@@ -777,7 +864,6 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
   CODA_HIT_INFO hit[10];
   uint32_t mcData[10];
   int stat,nhits,hc;
-  static bool first_time = true;
 
 
   // initialize event buffer info
@@ -788,9 +874,11 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
 
   // open event, default max event size is 1 MB
   if (nomc2coda == 0) {
-    if (first_time) {
-      first_time=false;
+    if (eventID == NULL) {
+      pthread_mutex_lock(&rawMutex);
       eventID = mc2codaOpenEvent(expID, (uint64_t)eventnumber, trigTime/trigtick, eventType, MAXEVENTSIZE);
+      if (eventID != NULL) eventIDs.push_back(eventID);
+      pthread_mutex_unlock(&rawMutex);
       if (eventID == NULL) {
         jerr << "?NULL return from mc2codaOpenEvent()" << std::endl << std::endl;
         exit(EXIT_FAILURE);
@@ -844,9 +932,9 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
       //jout << " t = " << dcdchits[i]->t << ", shifted = " << t << endl;
       
       if (noroot == 0)
-         cdcCharges->Fill(dcdchits[i]->q);
+         FillHist(cdcCharges, dcdchits[i]->q);
       if (noroot == 0)
-         cdcTimes->Fill(dcdchits[i]->t-tMin/1000);
+         FillHist(cdcTimes, dcdchits[i]->t-tMin/1000);
 
       cscRef cscADC = DCDCHitTranslationADC(dcdchits[i]);
       if (cscADC == CSCREF_NULL)
@@ -914,9 +1002,9 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
       uint32_t t  = dtofrawhits[i]->t*1000.-tMin;  // in picoseconds
     
       if (noroot == 0)
-         tofEnergies->Fill(dtofrawhits[i]->dE*1000000.);
+         FillHist(tofEnergies, dtofrawhits[i]->dE*1000000.);
       if (noroot == 0)
-         tofTimes->Fill(dtofrawhits[i]->t-tMin/1000);
+         FillHist(tofTimes, dtofrawhits[i]->t-tMin/1000);
 
       hc++;
       hitCount++;
@@ -1010,9 +1098,9 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
       uint32_t t = dbcalhits[i]->t*1000.-tMin;     // in picoseconds
 
       if (noroot == 0)
-         bcalEnergies->Fill(dbcalhits[i]->E*1000.);
+         FillHist(bcalEnergies, dbcalhits[i]->E*1000.);
       if (noroot == 0)
-         bcalTimes->Fill(dbcalhits[i]->t-tMin/1000);
+         FillHist(bcalTimes, dbcalhits[i]->t-tMin/1000);
 
       cscRef cscADC = DBCALHitTranslationADC(dbcalhits[i]);
       if (cscADC == CSCREF_NULL)
@@ -1115,7 +1203,7 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
       int32_t t     = dbcaltdchits[i]->t*1000.-tMin;  // in picoseconds
 
       if (noroot == 0)
-         bcalTimes->Fill(dbcaltdchits[i]->t-tMin/1000);
+         FillHist(bcalTimes, dbcaltdchits[i]->t-tMin/1000);
 
       cscRef cscTDC = DBCALHitTranslationTDC(dbcaltdchits[i]);
       if (cscTDC == CSCREF_NULL)
@@ -1181,9 +1269,9 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
       uint32_t t     = dfcalhits[i]->t*1000.-tMin;  // in picoseconds
       
       if (noroot == 0)
-         fcalEnergies->Fill(dfcalhits[i]->E*1000000.);
+         FillHist(fcalEnergies, dfcalhits[i]->E*1000000.);
       if (noroot == 0)
-         fcalTimes->Fill(dfcalhits[i]->t-tMin/1000);
+         FillHist(fcalTimes, dfcalhits[i]->t-tMin/1000);
 
       hc++;
       hitCount++;
@@ -1250,8 +1338,8 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
       uint32_t t = dfdchits[i]->t*1000.-tMin; // in picoseconds
       
       if (noroot == 0)
-         fdcCharges->Fill(dfdchits[i]->q);
-      if (noroot == 0)fdcTimes->Fill(dfdchits[i]->t-tMin/1000);
+         FillHist(fdcCharges, dfdchits[i]->q);
+      if (noroot == 0)FillHist(fdcTimes, dfdchits[i]->t-tMin/1000);
 
       int type = dfdchits[i]->type;
       // FADC125
@@ -1359,9 +1447,9 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
       uint32_t t     = dsthits[i]->t*1000.-tMin;  // in picoseconds
 
       if (noroot == 0)
-         stEnergies->Fill(dsthits[i]->dE*1000000.);
+         FillHist(stEnergies, dsthits[i]->dE*1000000.);
       if (noroot == 0)
-         stTimes->Fill(dsthits[i]->t-tMin/1000);
+         FillHist(stTimes, dsthits[i]->t-tMin/1000);
 
       hc++;
       hitCount++;
@@ -1461,9 +1549,9 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
 	  continue;
 
       if (noroot == 0)
-        tagmEnergies->Fill(dtagmhits[i]->npix_fadc);
+        FillHist(tagmEnergies, dtagmhits[i]->npix_fadc);
       if (noroot == 0)
-        tagmTimes->Fill(dtagmhits[i]->time_fadc-tMin/1000);
+        FillHist(tagmTimes, dtagmhits[i]->time_fadc-tMin/1000);
 
       cscRef cscADC = DTAGMHitTranslationADC(dtagmhits[i]);
       if (! (cscADC == CSCREF_NULL)) {
@@ -1569,9 +1657,9 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
 	  continue;
 
       if (noroot == 0)
-        taghEnergies->Fill(dtaghhits[i]->npe_fadc);
+        FillHist(taghEnergies, dtaghhits[i]->npe_fadc);
       if (noroot == 0)
-        taghTimes->Fill(dtaghhits[i]->time_fadc-tMin/1000);
+        FillHist(taghTimes, dtaghhits[i]->time_fadc-tMin/1000);
 
       cscRef cscADC = DTAGHHitTranslationADC(dtaghhits[i]);
       if (! (cscADC == CSCREF_NULL)) {
@@ -1860,10 +1948,23 @@ jerror_t JEventProcessor_rawevent::evnt(JEventLoop *eventLoop, int eventnumber)
     }
   }
 
-  // write event
-  pthread_mutex_lock(&rawMutex);
-  chan->write(eventID->evbuf);
-  pthread_mutex_unlock(&rawMutex);
+  // copy event into a write buffer and queue it for writing in order
+  if (nomc2coda == 0) {
+    vector<uint32_t> *buf = NULL;
+    pthread_mutex_lock(&rawMutex);
+    if (!freeEventBuffers.empty()) {
+      buf = freeEventBuffers.back();
+      freeEventBuffers.pop_back();
+    }
+    pthread_mutex_unlock(&rawMutex);
+    if (buf == NULL) buf = new vector<uint32_t>;
+    buf->assign(eventID->evbuf, eventID->evbuf + eventID->evbuf[0] + 1);
+
+    pthread_mutex_lock(&rawMutex);
+    pendingEvents.insert(pair<int, vector<uint32_t>*>(eventnumber, buf));
+    WritePendingEvents(false);
+    pthread_mutex_unlock(&rawMutex);
+  }
 
 #else
 cout << "Built without EVIO" << endl;
@@ -1886,7 +1987,10 @@ jerror_t JEventProcessor_rawevent::erun(void) {
   // ...
 
 
-  // close evio output file and delete channel
+  // write events still waiting, then close evio output file and delete channel
+  pthread_mutex_lock(&rawMutex);
+  WritePendingEvents(true);
+  pthread_mutex_unlock(&rawMutex);
   if (chan != NULL) {
     chan->close();
     delete(chan);
@@ -1910,6 +2014,29 @@ jerror_t JEventProcessor_rawevent::fini(void) {
 
 //----------------------------------------------------------------------------
 
+#ifdef HAVE_EVIO
+
+// Write queued events that are next in order, or all of them if flush is
+// true. Must be called with rawMutex locked.
+void JEventProcessor_rawevent::WritePendingEvents(bool flush) {
+
+  while (!pendingEvents.empty()) {
+    multimap<int, vector<uint32_t>*>::iterator iter = pendingEvents.begin();
+    if (!flush && (iter->first > nextEventNumber) && ((int)pendingEvents.size() <= reorderWindow))
+      break;
+
+    if (chan != NULL) chan->write(&(*iter->second)[0]);
+    nextEventNumber = iter->first + 1;
+    freeEventBuffers.push_back(iter->second);
+    pendingEvents.erase(iter);
+  }
+}
+
+#endif //HAVE_EVIO
+
+
+//----------------------------------------------------------------------------
+
 
 
 
@@ -2387,23 +2514,90 @@ void JEventProcessor_rawevent::EndElement(void *userData, const char *xmlname) {
 
 //--------------------------------------------------------------------------
 //--------------------------------------------------------------------------
-//  aux routines encode hit info into string for inverse lookup table
+//  dense lookup arrays filled from the translation table
+//--------------------------------------------------------------------------
+//--------------------------------------------------------------------------
+
+
+int cscArray::FieldValue(const string &field) {
+  if (field == "UP" || field == "N" || field == "U" || field == "A") return(0);
+  if (field == "DW" || field == "S" || field == "D" || field == "B") return(1);
+  if (field.empty() || field.find_first_not_of("0123456789") != string::npos) return(-1);
+  return(atoi(field.c_str()));
+}
+
+
+//--------------------------------------------------------------------------
+
+
+void cscArray::Fill(const string &prefix) {
+
+  this->prefix = prefix;
+  ndim = 0;
+  for (int i=0; i<4; i++) dims[i] = 1;
+
+  // find the entries for this prefix and the size needed for each index
+  string start = prefix + "::";
+  vector< vector<int> > indices;
+  vector<cscVal> cscs;
+  map<string,cscVal>::iterator iter = cscMap.lower_bound(start);
+  for (; iter != cscMap.end() && iter->first.compare(0, start.size(), start) == 0; iter++) {
+    vector<int> idx;
+    stringstream ss(iter->first.substr(start.size()));
+    string field;
+    while (getline(ss, field, ':')) idx.push_back(FieldValue(field));
+
+    bool ok = !idx.empty() && idx.size() <= 4 && (ndim == 0 || (int)idx.size() == ndim);
+    for (unsigned int i=0; i<idx.size(); i++) if (idx[i] < 0) ok = false;
+    if (!ok) {
+      jerr << "?cscArray...unable to index translation table entry " << iter->first << std::endl;
+      continue;
+    }
+
+    ndim = idx.size();
+    for (int i=0; i<ndim; i++) if (idx[i] >= dims[i]) dims[i] = idx[i] + 1;
+    idx.resize(4, 0);
+    indices.push_back(idx);
+    cscs.push_back(iter->second);
+  }
+
+  vals.assign(dims[0]*dims[1]*dims[2]*dims[3], CDCBAL_NULL);
+  for (unsigned int i=0; i<indices.size(); i++) {
+    vector<int> &idx = indices[i];
+    vals[Index(idx[0], idx[1], idx[2], idx[3])] = cscs[i];
+  }
+}
+
+
+//--------------------------------------------------------------------------
+
+
+cscRef cscArray::Get(int i0, int i1, int i2, int i3) const {
+  if (i0 >= 0 && i0 < dims[0] && i1 >= 0 && i1 < dims[1] &&
+      i2 >= 0 && i2 < dims[2] && i3 >= 0 && i3 < dims[3]) {
+    cscRef csc = vals[Index(i0, i1, i2, i3)];
+    if (!(csc == CSCREF_NULL))
+      return(csc);
+  }
+
+  int idx[4] = {i0, i1, i2, i3};
+  jerr << "?unknown map entry " << prefix << "::" << idx[0];
+  for (int i=1; i<ndim; i++) jerr << ":" << idx[i];
+  jerr << std::endl;
+
+  return(CSCREF_NULL);
+}
+
+
+//--------------------------------------------------------------------------
+//--------------------------------------------------------------------------
+//  aux routines look up the (crate,slot,channel) for a hit
 //--------------------------------------------------------------------------
 //--------------------------------------------------------------------------
 
 
 cscRef JEventProcessor_rawevent::DTOFHitTranslationADC(const DTOFHit* hit) const {
-  string end;
-  if (hit->plane == 0) {
-    end = (hit->end == 0 ? "UP":"DW");
-  }else{
-    end = (hit->end == 0 ? "N":"S");
-  }
-  string s = "tofadc::" + lexical_cast(hit->plane) + ":"
-                        + lexical_cast(hit->bar) + ":" + end;
-  if (cscMap.count(s) <= 0)
-     jerr << "?unknown map entry " << s << std::endl;
-  return(cscMap[s]);
+  return(tofadcCSC.Get(hit->plane, hit->bar, hit->end));
 }
 
 
@@ -2411,17 +2605,7 @@ cscRef JEventProcessor_rawevent::DTOFHitTranslationADC(const DTOFHit* hit) const
 
 
 cscRef JEventProcessor_rawevent::DTOFHitTranslationTDC(const DTOFHit* hit) const {
-  string end;
-  if (hit->plane == 0) {
-    end = (hit->end == 0 ? "UP":"DW");
-  }else{
-    end = (hit->end == 0 ? "N":"S");
-  }
-  string s = "toftdc::" + lexical_cast(hit->plane) + ":"
-                        + lexical_cast(hit->bar) + ":" + end;
-  if (cscMap.count(s) <= 0)
-     jerr << "?unknown map entry " << s << std::endl;
-  return(cscMap[s]);
+  return(toftdcCSC.Get(hit->plane, hit->bar, hit->end));
 }
 
 
@@ -2429,13 +2613,7 @@ cscRef JEventProcessor_rawevent::DTOFHitTranslationTDC(const DTOFHit* hit) const
 
 
 cscRef JEventProcessor_rawevent::DBCALHitTranslationADC(const DBCALHit *hit) const {
-  string end = hit->end == 0 ? "U":"D";
-  string s = "bcaladc::" + lexical_cast(hit->module) + ":" 
-                         + lexical_cast(hit->sector) + ":" 
-                         + lexical_cast(hit->layer) + ":" + end;
-  if (cscMap.count(s) <= 0)
-     jerr << "?unknown map entry " << s << std::endl;
-  return(cscMap[s]);
+  return(bcaladcCSC.Get(hit->module, hit->sector, hit->layer, hit->end));
 }
 
 
@@ -2448,13 +2626,7 @@ cscRef JEventProcessor_rawevent::DBCALHitTranslationTDC(const DBCALTDCHit *hit)
   // have this. Ignore those hits here.
   if (hit->layer > 3)
      return CSCREF_NULL;
-  string end = hit->end == 0 ? "U":"D";
-  string s = "bcaltdc::" + lexical_cast(hit->module) + ":" 
-                         + lexical_cast(hit->sector) + ":" 
-                         + lexical_cast(hit->layer) + ":" + end;
-  if (cscMap.count(s) <= 0)
-     jerr << "?unknown map entry " << s << std::endl;
-  return(cscMap[s]);
+  return(bcaltdcCSC.Get(hit->module, hit->sector, hit->layer, hit->end));
 }
 
 
@@ -2462,11 +2634,7 @@ cscRef JEventProcessor_rawevent::DBCALHitTranslationTDC(const DBCALTDCHit *hit)
 
 
 cscRef JEventProcessor_rawevent::DFCALHitTranslationADC(const DFCALHit* hit) const {
-  string s = "fcaladc::" + lexical_cast(hit->row) + ":" 
-                         + lexical_cast(hit->column);
-  if (cscMap.count(s) <= 0)
-     jerr << "?unknown map entry " << s << std::endl;
-  return(cscMap[s]);
+  return(fcaladcCSC.Get(hit->row, hit->column));
 }
 
 
@@ -2474,11 +2642,7 @@ cscRef JEventProcessor_rawevent::DFCALHitTranslationADC(const DFCALHit* hit) con
 
 
 cscRef JEventProcessor_rawevent::DFDCAnodeHitTranslation(const DFDCHit* hit) const {
-  string s = "fdcanode::"  + lexical_cast(hit->gPlane) + ":" 
-                           + lexical_cast(hit->element);
-  if (cscMap.count(s) <= 0)
-     jerr << "?unknown map entry " << s << std::endl;
-  return(cscMap[s]);
+  return(fdcanodeCSC.Get(hit->gPlane, hit->element));
 }
 
 
@@ -2486,11 +2650,7 @@ cscRef JEventProcessor_rawevent::DFDCAnodeHitTranslation(const DFDCHit* hit) con
 
 
 cscRef JEventProcessor_rawevent::DFDCCathodeHitTranslation(const DFDCHit* hit) const {
-  string s = "fdccathode::"  + lexical_cast(hit->gPlane) + ":"
-                             + lexical_cast(hit->element);
-  if (cscMap.count(s) <= 0)
-    jerr << "?unknown map entry " << s << std::endl;
-  return(cscMap[s]);
+  return(fdccathodeCSC.Get(hit->gPlane, hit->element));
 }
 
 
@@ -2498,11 +2658,7 @@ cscRef JEventProcessor_rawevent::DFDCCathodeHitTranslation(const DFDCHit* hit) c
 
 
 cscRef JEventProcessor_rawevent::DCDCHitTranslationADC(const DCDCHit* hit) const {
-  string s = "cdcadc::" + lexical_cast(hit->ring) + ":" 
-                       + lexical_cast(hit->straw);
-  if (cscMap.count(s) <= 0)
-     jerr << "?unknown map entry " << s << std::endl;
-  return(cscMap[s]);
+  return(cdcadcCSC.Get(hit->ring, hit->straw));
 }
 
 
@@ -2510,10 +2666,7 @@ cscRef JEventProcessor_rawevent::DCDCHitTranslationADC(const DCDCHit* hit) const
 
 
 cscRef JEventProcessor_rawevent::DSTHitTranslationADC(const DSCHit* hit) const {
-  string s = "stadc::" + lexical_cast(hit->sector);
-  if (cscMap.count(s) <= 0)
-     jerr << "?unknown map entry " << s << std::endl;
-  return(cscMap[s]);
+  return(stadcCSC.Get(hit->sector));
 }
 
 
@@ -2521,10 +2674,7 @@ cscRef JEventProcessor_rawevent::DSTHitTranslationADC(const DSCHit* hit) const {
 
 
 cscRef JEventProcessor_rawevent::DSTHitTranslationTDC(const DSCHit* hit) const {
-  string s = "sttdc::" + lexical_cast(hit->sector);
-  if (cscMap.count(s) <= 0)
-     jerr << "?unknown map entry " << s << std::endl;
-  return(cscMap[s]);
+  return(sttdcCSC.Get(hit->sector));
 }
 
 
@@ -2534,11 +2684,7 @@ cscRef JEventProcessor_rawevent::DSTHitTranslationTDC(const DSCHit* hit) const {
 cscRef JEventProcessor_rawevent::DTAGMHitTranslationTDC(const DTAGMHit* hit) const {
   if ( hit->column > 100)
     return CSCREF_NULL;
-  string s = "tagmtdc::" + lexical_cast(hit->row) + ":"
-                         + lexical_cast(hit->column);
-  if (cscMap.count(s) <= 0)
-    jerr << "?unknown map entry " << s << std::endl;
-  return cscMap[s];
+  return(tagmtdcCSC.Get(hit->row, hit->column));
 }
 
 
@@ -2548,11 +2694,7 @@ cscRef JEventProcessor_rawevent::DTAGMHitTranslationTDC(const DTAGMHit* hit) con
 cscRef JEventProcessor_rawevent::DTAGMHitTranslationADC(const DTAGMHit* hit) const {
   if ( hit->column > 100)
     return CSCREF_NULL;
-  string s = "tagmadc::" + lexical_cast(hit->row) + ":"
-                         + lexical_cast(hit->column);
-  if (cscMap.count(s) <= 0)
-    jerr << "?unknown map entry " << s << std::endl;
-  return cscMap[s];
+  return(tagmadcCSC.Get(hit->row, hit->column));
 }
 
 
@@ -2562,10 +2704,7 @@ cscRef JEventProcessor_rawevent::DTAGMHitTranslationADC(const DTAGMHit* hit) con
 cscRef JEventProcessor_rawevent::DTAGHHitTranslationTDC(const DTAGHHit* hit) const {
   if ( hit->counter_id > 274)
     return CSCREF_NULL;
-  string s = "taghtdc::" + lexical_cast(hit->counter_id);
-  if (cscMap.count(s) <= 0)
-    jerr << "?unknown map entry " << s << std::endl;
-  return cscMap[s];
+  return(taghtdcCSC.Get(hit->counter_id));
 }
 
 
@@ -2575,10 +2714,7 @@ cscRef JEventProcessor_rawevent::DTAGHHitTranslationTDC(const DTAGHHit* hit) con
 cscRef JEventProcessor_rawevent::DTAGHHitTranslationADC(const DTAGHHit* hit) const {
   if ( hit->counter_id > 274)
     return CSCREF_NULL;
-  string s = "taghadc::" + lexical_cast(hit->counter_id);
-  if (cscMap.count(s) <= 0)
-    jerr << "?unknown map entry " << s << std::endl;
-  return cscMap[s];
+  return(taghadcCSC.Get(hit->counter_id));
 }
 
 //----------------------------------------------------------------------------
@@ -2586,11 +2722,7 @@ cscRef JEventProcessor_rawevent::DTAGHHitTranslationADC(const DTAGHHit* hit) con
 
 cscRef JEventProcessor_rawevent::DPSCHitTranslationTDC(const DPSCHit* hit) const {
   int module_id = 8*hit->arm + hit->module;
-  string s = "pscadc::" + lexical_cast(module_id);
-  cerr << "checking = " << s << endl;
-  if (cscMap.count(s) <= 0)
-    jerr << "?unknown map entry " << s << std::endl;
-  return cscMap[s];
+  return(psctdcCSC.Get(module_id));
 }
 
 
@@ -2599,23 +2731,14 @@ cscRef JEventProcessor_rawevent::DPSCHitTranslationTDC(const DPSCHit* hit) const
 
 cscRef JEventProcessor_rawevent::DPSCHitTranslationADC(const DPSCHit* hit) const {
   int module_id = 8*hit->arm + hit->module;
-  string s = "pscadc::" + lexical_cast(module_id);
-  cerr << "checking = " << s << endl;
-  if (cscMap.count(s) <= 0)
-    jerr << "?unknown map entry " << s << std::endl;
-  return cscMap[s];
+  return(pscadcCSC.Get(module_id));
 }
 
 //----------------------------------------------------------------------------
 
 
 cscRef JEventProcessor_rawevent::DPSHitTranslationADC(const DPSHit* hit) const {
-  string arm = hit->arm==0 ? "A" : "B";
-  string s = "psadc::" + arm + ":" + lexical_cast(hit->column);
-  cerr << "checking = " << s << endl;
-  if (cscMap.count(s) <= 0)
-    jerr << "?unknown map entry " << s << std::endl;
-  return cscMap[s];
+  return(psadcCSC.Get(hit->arm, hit->column));
 }
 
 #endif
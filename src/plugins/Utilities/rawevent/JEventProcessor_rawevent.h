@@ -80,6 +80,9 @@ class JEventProcessor_rawevent : public jana::JEventProcessor {
                 static void StartElement(void *userData, const char *xmlname, const char **atts);
                 static void EndElement(void *userData, const char *xmlname);
 
+                // writes converted events to the output file in order
+                static void WritePendingEvents(bool flush);
+
 
                 // these routines access the translation tables
                 cscRef DTOFHitTranslationADC(const DTOFHit* hit) const;
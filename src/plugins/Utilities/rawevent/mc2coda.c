@@ -20,7 +20,10 @@ int mc2coda_maxevsize = 0;
 
 /* Local variables */
 static int mc2coda_ncrates_defined = 0;
-static unsigned int *dabufp, *StartOfRocBank;
+/* Bank write pointers used by mc2codaCloseEvent and the module writers.
+ These are thread local so several threads can close their own events
+ at the same time. */
+static __thread unsigned int *dabufp, *StartOfRocBank;
 static unsigned int RUN_NUMBER = 1;
 
 static double start_time = 0.0; // (us) initialized in mc2codaInitExp to represent program start time
@@ -187,6 +190,8 @@ mc2codaOpenEvent(CODA_EXP_INFO *expID, uint64_t eventNum, uint64_t trigTime, uns
 	evinfo->trigtime = trigTime + trel_ns;
 	evinfo->evtype = eventType&0x0000ffff;
 	evinfo->expid   = expID;
+	evinfo->hdata_first   = NULL;
+	evinfo->hdata_current = NULL;
 	
 	/* Allocate Hit Arrays for each valid crate/slot */
 	for (ii=0; ii<(expID->ncrates); ii++) {
@@ -255,15 +260,48 @@ mc2codaOpenEvent(CODA_EXP_INFO *expID, uint64_t eventNum, uint64_t trigTime, uns
 	return(evinfo);
 }
 
+/* Reserve nwords of hit data in the event's chunk list, moving on to
+ the next chunk (allocating it the first time) when the current one is
+ full. Returns NULL if nwords will not fit in a chunk. */
+static uint32_t *
+HitDataAlloc(CODA_EVENT_INFO *event, uint32_t nwords)
+{
+	CODA_HDATA_CHUNK *chunk = event->hdata_current;
+	uint32_t *hdata;
+	
+	if(nwords > HDATA_CHUNK_WORDS) return(NULL);
+	
+	if((chunk == NULL) || ((chunk->nwords + nwords) > HDATA_CHUNK_WORDS)) {
+		if((chunk != NULL) && (chunk->next != NULL)) {
+			chunk = chunk->next;
+		}else{
+			CODA_HDATA_CHUNK *newchunk = (CODA_HDATA_CHUNK *) malloc(sizeof(CODA_HDATA_CHUNK));
+			newchunk->next = NULL;
+			if(chunk == NULL)
+				event->hdata_first = newchunk;
+			else
+				chunk->next = newchunk;
+			chunk = newchunk;
+		}
+		chunk->nwords = 0;
+		event->hdata_current = chunk;
+	}
+	
+	hdata = &chunk->data[chunk->nwords];
+	chunk->nwords += nwords;
+	
+	return(hdata);
+}
+
 /* Write Monte Carlo hit(s) info into the event.
  
- This routine allocates local hit structures and copies hit infomation
- into them and then updates a list. Once the function returns the original
- hit structures can be freed or cleared.
+ This routine copies hit infomation into the hit structures of the event
+ and its hit data into the event's data chunks, then updates a list. Once
+ the function returns the original hit structures can be freed or cleared.
  
- This routine must be reentrant so that different threads can write hits
- asynchonously. No attempt is made to reorder hits. Only copy them and
- updates list totals.
+ Different threads may write hits into different events at the same time.
+ An event itself must only be filled by one thread. No attempt is made to
+ reorder hits. Only copy them and updates list totals.
  
  Returns: # of hits written to the Event
  
@@ -312,19 +350,23 @@ mc2codaWrite(CODA_EVENT_INFO *event, int nHits, struct coda_hit_info *codaHits)
 		}else{
 		
 			cnt   = event->hcount[crate][slot];
-			if(cnt > MAX_HITS_PER_SLOT) {
+			if(cnt >= MAX_HITS_PER_SLOT) {
 				printf("mc2codaWrite: ERROR: No available space to store hit %d for crate/slot = %d/%d\n",
 					   codaHits->hit_id,crate,slot);
 			} else {
-				tmpH = (CODA_HIT_INFO *)&event->hits[crate][slot][cnt];
-				if(tmpH == NULL){
+				if(event->hits[crate][slot] == NULL){
 					printf("%s:%d ERROR!! no CODA_HIT_INFO structure allocated for crate=%d, slot=%d\n", __FILE__, __LINE__, crate+1, slot+1);
 					continue;
 				}
+				tmpH = (CODA_HIT_INFO *)&event->hits[crate][slot][cnt];
 
 				memcpy((char *)&(tmpH->hit_id),(char *)&(codaHits[ii].hit_id),sizeof(CODA_HIT_INFO)) ;
-				/* printf("DEBUG: malloc data array\n"); */
-				tmpH->hdata = (uint32_t *) malloc((codaHits[ii].nwords)<<2);
+				tmpH->hdata = HitDataAlloc(event, codaHits[ii].nwords);
+				if(tmpH->hdata == NULL){
+					printf("mc2codaWrite: ERROR: Too many data words (%d) for hit %d\n",
+						   codaHits[ii].nwords, codaHits[ii].hit_id);
+					continue;
+				}
 				memcpy((char *)(tmpH->hdata), (char *)(codaHits[ii].hdata),(codaHits[ii].nwords)<<2);
 				
 				event->hcount[crate][slot] += 1;
@@ -484,8 +526,7 @@ mc2codaResetEvent(CODA_EVENT_INFO *eventID, uint64_t eventNum, uint64_t trigTime
 {
 	
 	CODA_EXP_INFO  *exp;
-	CODA_HIT_INFO  *tmpH;
-	int ii, jj, kk, ccnt, lcnt;
+	int ii, jj, ccnt, nbytes;
 	
 	
 	if(eventID != NULL) {
@@ -501,23 +542,15 @@ mc2codaResetEvent(CODA_EVENT_INFO *eventID, uint64_t eventNum, uint64_t trigTime
 		return(-1);
 	}
 	
-	/* First free the data arrays that have been allocated for individual hits */
+	/* First clear the hit counts and rewind the hit data chunks. The
+	 chunks themselves are kept for the next event */
 	for (ii=0; ii<ccnt; ii++) {
 		for(jj=1; jj<(MAX_SLOTS); jj++) {  /* Skip CPU slot */
-			if(eventID->hits[ii][jj] != NULL) {
-				/* crate,slot array exists, now check if it has hits */
-				lcnt = eventID->hcount[ii][jj];
-				if(lcnt) {
-					/* free all the hit data */
-					for(kk=0;kk<lcnt;kk++) {
-						tmpH = (CODA_HIT_INFO *) &eventID->hits[ii][jj][kk];
-						free(tmpH->hdata);
-					}
-					eventID->hcount[ii][jj] = 0;  /* Set Hit count to 0 */
-				}
-			}
+			eventID->hcount[ii][jj] = 0;  /* Set Hit count to 0 */
 		}
 	}
+	if(eventID->hdata_first != NULL) eventID->hdata_first->nwords = 0;
+	eventID->hdata_current = eventID->hdata_first;
 	
 	/* Get current time relative to program start to record in trigger time */
 	struct timeval tp;
@@ -532,8 +565,12 @@ mc2codaResetEvent(CODA_EVENT_INFO *eventID, uint64_t eventNum, uint64_t trigTime
 	eventID->trigtime = trigTime + trel_ns;
 	eventID->evtype = eventType&0x0000ffff;
 	
+	/* Only the part of the buffer used by the last event needs clearing.
+	 The length of that event is still in the first word */
 	if(eventID->maxBytes > 0) {
-		bzero((char *)eventID->evbuf, eventID->maxBytes);
+		nbytes = (eventID->evbuf[0] + 1)<<2;
+		if((nbytes <= 0) || (nbytes > eventID->maxBytes)) nbytes = eventID->maxBytes;
+		bzero((char *)eventID->evbuf, nbytes);
 	}else{
 		printf("mc2codaResetEvent: ERROR: Event buffer size is invalid (%d)\n",eventID->maxBytes);
 		return(-1);
@@ -578,8 +615,8 @@ mc2codaFreeEvent(CODA_EVENT_INFO *eventID)
 {
 	
 	CODA_EXP_INFO  *exp;
-	CODA_HIT_INFO  *tmpH;
-	int ii, jj, kk, ccnt, lcnt;
+	CODA_HDATA_CHUNK *chunk, *next;
+	int ii, jj, ccnt;
 	
 	/* Get the crate and Hit counts */
 	exp = eventID->expid;
@@ -595,21 +632,18 @@ mc2codaFreeEvent(CODA_EVENT_INFO *eventID)
 			printf("mc2codaFreeEvent: ERROR invalid pointer to Event Buffer\n");
 		}
 		
-		/* Free all the allocated Arrays of Hit structures and their associated data array*/
+		/* Free the hit data chunks */
+		for(chunk=eventID->hdata_first; chunk!=NULL; chunk=next) {
+			next = chunk->next;
+			free(chunk);
+		}
+		eventID->hdata_first = eventID->hdata_current = NULL;
+		
+		/* Free all the allocated Arrays of Hit structures */
 		for (ii=0; ii<ccnt; ii++) {
 			for(jj=1; jj<(MAX_SLOTS); jj++) {  /* Skip CPU slot */
 				
 				if(eventID->hits[ii][jj] != NULL) {
-					/* crate,slot array exists, now check if it has hits */
-					lcnt = eventID->hcount[ii][jj];
-					if(lcnt) {
-						/* free all the hit data */
-						for(kk=0;kk<lcnt;kk++) {
-							/* printf("DEBUG: freeing data\n"); */
-							tmpH = (CODA_HIT_INFO *) &eventID->hits[ii][jj][kk];
-							free(tmpH->hdata);
-						}
-					}
 					/* Now free the hit structure array */
 					/* printf("DEBUG: freeing Hit array for crate,slot = %d,%d\n",ii,jj); */
 					free(eventID->hits[ii][jj]);
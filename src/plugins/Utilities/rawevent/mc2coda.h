@@ -101,6 +101,17 @@ typedef struct coda_exp_info {
 } CODA_EXP_INFO;
 
 
+/* Hit data words are copied into chunks owned by the event rather than
+ malloc'ed hit by hit. The chunks are kept between events and rewound
+ by mc2codaResetEvent. */
+#define HDATA_CHUNK_WORDS  16384
+
+typedef struct coda_hdata_chunk {
+	struct coda_hdata_chunk *next;
+	int nwords;                  /* words in use */
+	uint32_t data[HDATA_CHUNK_WORDS];
+} CODA_HDATA_CHUNK;
+
 typedef struct coda_event_info {
 	uint64_t eventid;
 	uint64_t trigtime;
@@ -111,6 +122,8 @@ typedef struct coda_event_info {
 	struct coda_hit_info *hits[MAX_CRATES][MAX_SLOTS];
 	int maxBytes;
 	unsigned int *evbuf;
+	CODA_HDATA_CHUNK *hdata_first;     /* first hit data chunk */
+	CODA_HDATA_CHUNK *hdata_current;   /* chunk currently being filled */
 } CODA_EVENT_INFO;
 
 
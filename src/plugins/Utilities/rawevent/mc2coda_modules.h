@@ -7,6 +7,52 @@ void GetPedestals(uint32_t *peds, uint32_t Npeds);
 
 #define SUPPRESS_DRIFT_CHAMBER_HITS_OVERFLOW_WARNINGS 1
 
+#define MAX_MODULE_CHAN 72   /* most channels of any module below */
+
+
+/* Sort the hits stored for one crate/slot into channel order so the
+ * module writers can walk the hits of each channel directly rather than
+ * scanning every hit in the slot once per channel. Only hits for the
+ * given module type and mode are kept and hits keep their original order
+ * within a channel. On return the hits for channel chan are
+ * sorted[first[chan]] ... sorted[first[chan+1]-1].
+ */
+static void
+sort_hits_by_channel (CODA_EVENT_INFO *event, int roc, int slot, int module,
+                      int mode, int nchan, int *first, CODA_HIT_INFO **sorted)
+{
+   int ii, chan, hcnt;
+   int next[MAX_MODULE_CHAN+1];
+   CODA_HIT_INFO *hits, *hit;
+   
+   hcnt = event->hcount[(roc-1)][(slot-1)];
+   hits = event->hits[(roc-1)][(slot-1)];
+   
+   for (chan=0; chan<=nchan; chan++) first[chan] = 0;
+   
+   /* count the hits in each channel */
+   for (ii=0; ii<hcnt; ii++) {
+      hit = &hits[ii];
+      if ( (roc == hit->crate_id) && (slot == hit->slot_id) &&
+           (hit->chan_id >= 0) && (hit->chan_id < nchan) &&
+           (hit->module_id == module) && (hit->module_mode == mode) )
+         first[hit->chan_id+1]++;
+   }
+   for (chan=0; chan<nchan; chan++) {
+      first[chan+1] += first[chan];
+      next[chan] = first[chan];
+   }
+   
+   /* and fill them in */
+   for (ii=0; ii<hcnt; ii++) {
+      hit = &hits[ii];
+      if ( (roc == hit->crate_id) && (slot == hit->slot_id) &&
+           (hit->chan_id >= 0) && (hit->chan_id < nchan) &&
+           (hit->module_id == module) && (hit->module_mode == mode) )
+         sorted[next[hit->chan_id]++] = hit;
+   }
+}
+
 
 /* FADC 250 Paramters */
 #define FADC250_MAX_CHAN      16
@@ -45,24 +91,23 @@ int
 fadc250_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
 {
    
-   int ii, jj, chan, hcnt, nwords;
+   int ii, jj, chan, nwords;
    uint32_t  eventNum;
    uint64_t  timestamp;
    unsigned int *start = dabufp;
-   CODA_HIT_INFO *hit;
-   CODA_HIT_INFO *chit[MAX_HITS_PER_CHAN];
+   CODA_HIT_INFO **chit;
+   CODA_HIT_INFO *sorted[MAX_HITS_PER_SLOT];
+   int first[FADC250_MAX_CHAN+1];
    
    eventNum  = (event->eventid)&0xffffffff;
    timestamp = (event->trigtime);
-   hcnt      =  event->hcount[(roc-1)][(slot-1)];
+   sort_hits_by_channel(event, roc, slot, FADC250, mode,
+                        FADC250_MAX_CHAN, first, sorted);
    
    FADC250_BL_HEADER(slot,eventNum,1);
    FADC250_EV_HEADER(slot,eventNum);
    FADC250_EV_TS_LOW(timestamp);
    
-   /*printf("fadc250:_write_data: DEBUG: %d hits available"
-    *       " for  slot %d roc %d.\n",hcnt, slot, roc);
-    */
 	
 	// Get pedestal values (possibly randmized)
 	uint32_t peds[FADC250_MAX_CHAN+1];
@@ -71,36 +116,14 @@ fadc250_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
    /*Loop over all channels */
    for (chan=0; chan<FADC250_MAX_CHAN; chan++) {
       
-      /* check for all hits for this channel */
-      jj=0;
-      for (ii=0; ii<hcnt; ii++) {
-         hit = (CODA_HIT_INFO *) &event->hits[(roc-1)][(slot-1)][ii];
-         /* printf("%d %d %d %d\n",hit->crate_id,hit->slot_id,
-          *                        hit->chan_id,hit->module_id);
-          */
-         if ( (roc == hit->crate_id) && (slot == hit->slot_id) && 
-              (chan == hit->chan_id) && (hit->module_id == FADC250) &&
-              (hit->module_mode == mode) )
-         {
-            /* printf("fadc250:_write_data: DEBUG: found hit %d for roc"
-             *        " %d slot %d chan %d.\n",jj, roc,slot,chan);
-             */
-            
-            chit[jj] = hit;
-            jj++;
-            if (jj >= MAX_HITS_PER_CHAN) {
-               printf("fadc250_write_data: ERROR: HIT overflow (%d) for "
-                      "crate,slot,chan = %d,%d,%d (Bank will be corrupt)\n",
-                      jj,roc,slot,chan);
-               return 0;
-            }
-            else if (jj > FADC250_MAX_HITS) {
-               printf("fadc250_write_data: WARN: Too many hits (%d) for"
-                      " (crate, slot, chan) = %d, %d, %d (truncating)\n",
-                      jj,roc,slot,chan);
-               jj = FADC250_MAX_HITS;
-            }
-         }
+      /* hits for this channel */
+      chit = &sorted[first[chan]];
+      jj   = first[chan+1] - first[chan];
+      if (jj > FADC250_MAX_HITS) {
+         printf("fadc250_write_data: WARN: Too many hits (%d) for"
+                " (crate, slot, chan) = %d, %d, %d (truncating)\n",
+                jj,roc,slot,chan);
+         jj = FADC250_MAX_HITS;
       }
       /* printf("write hit data %d\n",jj); */
       uint32_t ped = peds[FADC250_MAX_CHAN]; // common pedestal for all channels
@@ -169,16 +192,18 @@ int
 fadc125_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
 {
    
-   int ii, jj, chan, hcnt, nwords;
+   int ii, jj, chan, nwords;
    uint32_t  eventNum;
    uint64_t  timestamp;
    unsigned int *start = dabufp;
-   CODA_HIT_INFO *hit;
-   CODA_HIT_INFO *chit[MAX_HITS_PER_CHAN];
+   CODA_HIT_INFO **chit;
+   CODA_HIT_INFO *sorted[MAX_HITS_PER_SLOT];
+   int first[FADC125_MAX_CHAN+1];
    
    eventNum  = (event->eventid)&0xffffffff;
    timestamp = (event->trigtime);
-   hcnt      =  event->hcount[(roc-1)][(slot-1)];
+   sort_hits_by_channel(event, roc, slot, FADC125, mode,
+                        FADC125_MAX_CHAN, first, sorted);
    
    /* Global timestamp is in 4ns ticks. The local clock on the FADC 125
     * is half that so change timestamp to 8ns ticks (divide by two).
@@ -193,46 +218,19 @@ fadc125_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
    FADC125_EV_HEADER(slot,eventNum);
    FADC125_EV_TS_LOW(timestamp);
    
-   /*  printf("fadc125_write_data: %d hits checking slot %d roc %d.\n",
-    *         hcnt, slot, roc);
-    */
-   
    /*Loop over all channels */
    for (chan=0; chan < FADC125_MAX_CHAN; chan++) {
       
-      /* check for all hits for this channel */
-      jj=0;
-      for (ii=0; ii < hcnt; ii++) {
-         hit = (CODA_HIT_INFO *) &event->hits[(roc-1)][(slot-1)][ii];
-         /* printf("%d %d %d %d\n",hit->crate_id,hit->slot_id,
-          *        hit->chan_id,hit->module_id);
-          */
-         if ( (roc == hit->crate_id) && (slot == hit->slot_id) &&
-              (chan == hit->chan_id) && (hit->module_id == FADC125) &&
-              (hit->module_mode == mode) )
-         {
-            /* printf("fadc125:_write_data: DEBUG: found hit for crate"
-             *        " %d slot %d chan %d.\n",roc,slot,chan);
-             */
-            chit[jj] = hit;
-            jj++;
-            if (jj >= MAX_HITS_PER_CHAN) {
-               printf("fadc125_write_data: ERROR: HIT overflow (%d)"
-                      " for (crate, slot, chan) = %d, %d, %d\n",
-                      jj,roc,slot,chan);
-               printf("fadc125_write_data: ERROR: "
-                      "ROC Bank will be corrupted\n");
-               return 0;
-            }
-            else if (jj > FADC125_MAX_HITS) {
+      /* hits for this channel */
+      chit = &sorted[first[chan]];
+      jj   = first[chan+1] - first[chan];
+      if (jj > FADC125_MAX_HITS) {
 #ifndef SUPPRESS_DRIFT_CHAMBER_HITS_OVERFLOW_WARNINGS
-               printf("fadc125_write_data: WARN: Too many hits (%d)"
-                      " for (crate, slot, chan) = %d, %d, %d\n",
-                      jj,roc,slot,chan);
+         printf("fadc125_write_data: WARN: Too many hits (%d)"
+                " for (crate, slot, chan) = %d, %d, %d\n",
+                jj,roc,slot,chan);
 #endif
-               jj = FADC125_MAX_HITS;
-            }
-         }
+         jj = FADC125_MAX_HITS;
       }
       /* printf("write hit data %d\n",jj); */
       uint32_t ped = peds[FADC125_MAX_CHAN]; // common pedestal for all channels
@@ -298,19 +296,21 @@ int
 f1tdc32_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
 {
    
-   int ii, jj, chan, hcnt, nwords;
+   int ii, jj, chan, nwords;
    int chip, chan_on_chip;
    uint64_t tsdiv;
    uint32_t ts, cdata;
    uint32_t  eventNum;
    uint64_t  timestamp;
    unsigned int *start = dabufp;
-   CODA_HIT_INFO *hit;
-   CODA_HIT_INFO *chit[MAX_HITS_PER_CHAN];
+   CODA_HIT_INFO **chit;
+   CODA_HIT_INFO *sorted[MAX_HITS_PER_SLOT];
+   int first[F1TDC32_MAX_CHAN+1];
    
    eventNum  = (event->eventid)&0xffffffff;
    timestamp = (event->trigtime);
-   hcnt      =  event->hcount[(roc-1)][(slot-1)];
+   sort_hits_by_channel(event, roc, slot, F1TDC32, mode,
+                        F1TDC32_MAX_CHAN, first, sorted);
    
    /* Set default value for cdata bits - 3 bits - 100b = 0x4
     *  res locked, ouput fifo ok, hit fifo ok 
@@ -328,10 +328,6 @@ f1tdc32_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
    F1TDC32_EV_HEADER(slot,eventNum);
    F1TDC32_EV_TS_LOW(tsdiv);
    
-   /* printf("f1tdc32:_write_data: %d hits checking slot"
-    *        " %d roc %d.\n",hcnt, slot, roc);
-    */
-   
    /*Loop over all channels */
    for (chan=0; chan<F1TDC32_MAX_CHAN; chan++) {
 
@@ -344,29 +340,12 @@ f1tdc32_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
          F1TDC32_F1_HEADER(cdata,chip, 7,(eventNum&0x3f), (ts&0x1ff));
       }
             
-      /* check for all hits for this channel */
-      jj=0;
-      for (ii=0; ii<hcnt; ii++) {
-         hit = (CODA_HIT_INFO *) &event->hits[(roc-1)][(slot-1)][ii];
-         /* printf("%d %d %d %d\n",hit->crate_id,hit->slot_id,
-          *        hit->chan_id,hit->module_id);
-          */
-         if ( (roc == hit->crate_id) && (slot == hit->slot_id) &&
-              (chan == hit->chan_id)&& (hit->module_id == F1TDC32) &&
-              (hit->module_mode == mode) )
-         {
-            /* printf("f1tdc32:_write_data: DEBUG: found hit for crate %d"
-             *       " slot %d chan %d.\n",roc,slot,chan); 
-             */
-            
-            chit[jj] = hit;
-            jj++;
-            if (jj >= F1TDC32_MAX_HITS) {
-               printf("f1tdc32_write_data: ERROR: Too many hits for channel\n");
-               jj--;
-					break;
-            }
-         }
+      /* hits for this channel */
+      chit = &sorted[first[chan]];
+      jj   = first[chan+1] - first[chan];
+      if (jj >= F1TDC32_MAX_HITS) {
+         printf("f1tdc32_write_data: ERROR: Too many hits for channel\n");
+         jj = F1TDC32_MAX_HITS - 1;
       }
       /* printf("write hit data %d\n",jj); */
       for (ii=0; ii < jj; ii++) {
@@ -438,19 +417,21 @@ int
 f1tdc48_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
 {
    
-   int ii, jj, chan, hcnt, nwords;
+   int ii, jj, chan, nwords;
    int chip, chan_on_chip;
    uint64_t tsdiv;
    uint32_t ts, cdata;
    uint32_t  eventNum;
    uint64_t  timestamp;
    unsigned int *start = dabufp;
-   CODA_HIT_INFO *hit;
-   CODA_HIT_INFO *chit[MAX_HITS_PER_CHAN];
+   CODA_HIT_INFO **chit;
+   CODA_HIT_INFO *sorted[MAX_HITS_PER_SLOT];
+   int first[F1TDC48_MAX_CHAN+1];
    
    eventNum  = (event->eventid)&0xffffffff;
    timestamp = (event->trigtime);
-   hcnt      =  event->hcount[(roc-1)][(slot-1)];
+   sort_hits_by_channel(event, roc, slot, F1TDC48, mode,
+                        F1TDC48_MAX_CHAN, first, sorted);
 
    /* Set default value for cdata bits - 3 bits - 100b = 0x4
     * res locked, ouput fifo ok, hit fifo ok 
@@ -468,10 +449,6 @@ f1tdc48_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
    F1TDC48_EV_HEADER(slot,eventNum);
    F1TDC48_EV_TS_LOW(tsdiv);
    
-   /*  printf("f1tdc48_write_data: %d hits checking slot %d roc %d.\n",
-    *         hcnt, slot, roc); 
-    */
-   
    /* Loop over all channels */
    for (chan=0; chan < F1TDC48_MAX_CHAN; chan++) {
       
@@ -484,29 +461,12 @@ f1tdc48_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
          F1TDC48_F1_HEADER(cdata,chip,7,(eventNum&0x3f), (ts&0x1ff));
       }
       
-      /* check for all hits for this channel */
-      jj=0;
-      for (ii=0; ii < hcnt; ii++) {
-         hit = (CODA_HIT_INFO *) &event->hits[(roc-1)][(slot-1)][ii];
-         /* printf("%d %d %d %d\n",hit->crate_id,hit->slot_id,
-          *        hit->chan_id,hit->module_id);
-          */
-         if ( (roc == hit->crate_id) && (slot == hit->slot_id) &&
-              (chan == hit->chan_id) && (hit->module_id == F1TDC48) &&
-              (hit->module_mode == mode) )
-         {
-            /* printf("f1tdc48_write_data: DEBUG: found hit for crate %d"
-             *        " slot %d chan %d.\n",roc,slot,chan);
-             */
-            
-            chit[jj] = hit;
-            jj++;
-            if (jj >= F1TDC48_MAX_HITS) {
-               printf("f1tdc48_write_data: ERROR: Too many hits for channel\n");
-               jj--;
-					break;
-            }
-         }
+      /* hits for this channel */
+      chit = &sorted[first[chan]];
+      jj   = first[chan+1] - first[chan];
+      if (jj >= F1TDC48_MAX_HITS) {
+         printf("f1tdc48_write_data: ERROR: Too many hits for channel\n");
+         jj = F1TDC48_MAX_HITS - 1;
       }
       /* printf("write hit data %d\n",jj); */
       for (ii=0; ii < jj; ii++) {
@@ -564,18 +524,20 @@ f1tdc48_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
 int
 caen1290_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
 {
-   int ii, jj, chan, hcnt, nwords=0, wcnt=0;
+   int ii, jj, chan, nwords=0, wcnt=0;
    //uint64_t tsdiv;
    uint32_t chip, stat, edge = 0;
    uint32_t  eventNum;
    // uint64_t  timestamp;
    unsigned int *start = dabufp;
-   CODA_HIT_INFO *hit;
-   CODA_HIT_INFO *chit[MAX_HITS_PER_CHAN];
+   CODA_HIT_INFO **chit;
+   CODA_HIT_INFO *sorted[MAX_HITS_PER_SLOT];
+   int first[CAEN1290_MAX_CHAN+1];
    
    eventNum  = (event->eventid)&0xffffffff;
    // timestamp = (event->trigtime);
-   hcnt      =  event->hcount[(roc-1)][(slot-1)];
+   sort_hits_by_channel(event, roc, slot, CAEN1290, mode,
+                        CAEN1290_MAX_CHAN, first, sorted);
    
    
    /* Set Status to 0 for now */
@@ -584,10 +546,6 @@ caen1290_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
    
    CAEN1290_BL_HEADER(slot,eventNum);
    
-   /*  printf("caen1290_write_data: %d hits checking slot %d"
-    *         " roc %d.\n",hcnt, slot, roc);
-    */
-   
    /* Loop over all channels */
    chip = 0;
    for (chan=0; chan < CAEN1290_MAX_CHAN; chan++) {
@@ -599,30 +557,14 @@ caen1290_write_data (CODA_EVENT_INFO *event, int roc, int slot, int mode)
          chip++;
       }
       
-      /* check for all hits for this channel */
-      jj=0;
-      for (ii=0; ii < hcnt; ii++) {
-         hit = (CODA_HIT_INFO *) &event->hits[(roc-1)][(slot-1)][ii];
-         /* printf("%d %d %d %d\n",hit->crate_id,hit->slot_id,
-          *        hit->chan_id,hit->module_id);
-          */
-         if ( (roc == hit->crate_id) && (slot == hit->slot_id) &&
-              (chan == hit->chan_id) && (hit->module_id == CAEN1290) &&
-              (hit->module_mode == mode) )
-         {
-            /*printf("caen1290_write_data: DEBUG: found hit for crate %d"
-             *       " slot %d chan %d.\n",roc,slot,chan);
-             */
-            
-            chit[jj] = hit;
-            jj++;
-            wcnt++;
-            if (jj >= CAEN1290_MAX_HITS) {
-               printf("caen1290_write_data: ERROR: Too many hits for channel\n");
-               return 0;
-            }
-         }
+      /* hits for this channel */
+      chit = &sorted[first[chan]];
+      jj   = first[chan+1] - first[chan];
+      if (jj >= CAEN1290_MAX_HITS) {
+         printf("caen1290_write_data: ERROR: Too many hits for channel\n");
+         return 0;
       }
+      wcnt += jj;
       /* printf("write hit data %d\n",jj); */
       for (ii=0; ii < jj; ii++) {
          CAEN1290_TDC_DATA(edge,chan,chit[ii]->hdata[0]);
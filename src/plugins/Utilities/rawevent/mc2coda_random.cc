@@ -1,10 +1,17 @@
 #include <stdint.h>
+#include <pthread.h>
 #include <cmath>
 using namespace std;
 
 #include <TRandom2.h>
 
-static TRandom2 randgen;
+// Each thread gets its own generator so that events can be converted in
+// parallel. Seeds are handed out 1, 2, 3, ... in the order the threads
+// first ask for pedestals so a single threaded job gets the same sequence
+// as before.
+static __thread TRandom2 *randgen = NULL;
+static pthread_mutex_t randgen_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int randgen_last_seed = 0;
 bool NO_PEDESTAL = true;              // flag to completely disable pedestal generation
 bool NO_RANDOM_PEDESTAL = false;       // turn off random components of pedestals
 float MEAN_PEDESTAL = 100.0;           // mean pedestal in single sample fADC counts
@@ -48,8 +55,14 @@ void GetPedestals(uint32_t *peds, uint32_t Npeds)
 		for(uint32_t i=0; i<Npeds-1; i++) peds[i] = 0;	
 		peds[Npeds - 1] = (uint32_t)MEAN_PEDESTAL;
 	}else{
-		for(uint32_t i=0; i<Npeds-1; i++) peds[i] = round(randgen.Gaus(0.0, SIGMA_INDIVIDUAL_PEDESTAL));
-		peds[Npeds - 1] = round(randgen.Gaus(MEAN_PEDESTAL, SIGMA_COMMON_PEDESTAL));
+		if(randgen == NULL){
+			pthread_mutex_lock(&randgen_mutex);
+			unsigned int seed = ++randgen_last_seed;
+			pthread_mutex_unlock(&randgen_mutex);
+			randgen = new TRandom2(seed);
+		}
+		for(uint32_t i=0; i<Npeds-1; i++) peds[i] = round(randgen->Gaus(0.0, SIGMA_INDIVIDUAL_PEDESTAL));
+		peds[Npeds - 1] = round(randgen->Gaus(MEAN_PEDESTAL, SIGMA_COMMON_PEDESTAL));
 	}
 
 }
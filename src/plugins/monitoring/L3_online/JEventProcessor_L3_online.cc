@@ -8,10 +8,12 @@
 #include <stdint.h>
 #include <vector>
 #include <random>
+#include <iostream>
 
 
 #include "JEventProcessor_L3_online.h"
 #include <JANA/JApplication.h>
+#include <TRIGGER/DL3Trigger.h>
 
 using namespace std;
 using namespace jana;
@@ -20,10 +22,14 @@ using namespace jana;
 // for root
 #include <TDirectory.h>
 #include <TH1.h>
+#include <TH2.h>
 
 
 // root hist pointers
 static TH1I * l3;
+static TH2I * l3_decision_vs_stage;
+static TH1F * l3_time;
+static TH2F * l3_time_vs_stage;
 
 
 
@@ -43,6 +49,8 @@ extern "C"{
 
 
 JEventProcessor_L3_online::JEventProcessor_L3_online() {
+  BENCHMARK = false;
+  Nevents = 0;
 }
 
 
@@ -57,6 +65,10 @@ JEventProcessor_L3_online::~JEventProcessor_L3_online() {
 
 jerror_t JEventProcessor_L3_online::init(void) {
 
+  // e.g. hd_root -PPLUGINS=L3_online -PL3:BENCHMARK=1 -PNTHREADS=1 file.evio
+  gPARMS->SetDefaultParameter("L3:BENCHMARK",BENCHMARK,"Print L3 event rate and per-stage decisions at end of job");
+
+
   // lock all root operations
   japp->RootWriteLock();
 
@@ -66,8 +78,23 @@ jerror_t JEventProcessor_L3_online::init(void) {
   gDirectory->mkdir("l3")->cd();
 
 
-  // book hist
-  l3 = new TH1I("l3","l3",100,0,100);
+  // book hists
+  l3 = new TH1I("l3","L3 decision;;events",3,0,3);
+  l3->GetXaxis()->SetBinLabel(1,"no decision");
+  l3->GetXaxis()->SetBinLabel(2,"keep");
+  l3->GetXaxis()->SetBinLabel(3,"discard");
+
+  int nstages = DL3Trigger::kNSTAGES;
+  l3_decision_vs_stage = new TH2I("l3_decision_vs_stage","L3 decision vs. deciding stage;;decision",nstages,0,nstages,3,0,3);
+  l3_time_vs_stage = new TH2F("l3_time_vs_stage","L3 time vs. deciding stage;;time (ms)",nstages,0,nstages,200,0.0,20.0);
+  for(int i=0; i<nstages; i++) {
+    const char *name = DL3Trigger::StageName((DL3Trigger::L3_stage_t)i);
+    l3_decision_vs_stage->GetXaxis()->SetBinLabel(i+1,name);
+    l3_time_vs_stage->GetXaxis()->SetBinLabel(i+1,name);
+  }
+  for(int i=1; i<=3; i++) l3_decision_vs_stage->GetYaxis()->SetBinLabel(i,l3->GetXaxis()->GetBinLabel(i));
+
+  l3_time = new TH1F("l3_time","L3 time per event;time (ms);events",1000,0.0,100.0);
 
 
   // back to main dir
@@ -102,9 +129,26 @@ jerror_t JEventProcessor_L3_online::evnt(JEventLoop *eventLoop, int eventnumber)
   // since multiple threads may call this method at the same time.
 
 
+  const DL3Trigger *l3trig = NULL;
+  try {
+    eventLoop->GetSingle(l3trig);
+  } catch(...) {}
+  if(l3trig==NULL) return NOERROR;
+
+  struct timeval now;
+  gettimeofday(&now,NULL);
+
+
   japp->RootWriteLock();
 
   // fill hist
+  l3->Fill(l3trig->L3_decision);
+  l3_decision_vs_stage->Fill(l3trig->stage,l3trig->L3_decision);
+  l3_time->Fill(l3trig->time_ms);
+  l3_time_vs_stage->Fill(l3trig->stage,l3trig->time_ms);
+
+  if(Nevents++==0) tstart = now;
+  tlast = now;
 
   japp->RootUnLock(); 
 
@@ -128,6 +172,30 @@ jerror_t JEventProcessor_L3_online::erun(void) {
 
 jerror_t JEventProcessor_L3_online::fini(void) {
   // Called before program exit after event processing is finished.
+
+  if(!BENCHMARK || Nevents==0) return NOERROR;
+
+  // Rate is measured from the first to the last event seen here, so
+  // program startup and the first event's initialization are not counted.
+  double tdiff = (double)(tlast.tv_sec-tstart.tv_sec) + (double)(tlast.tv_usec-tstart.tv_usec)/1.0E6;
+  unsigned int Nkept = (unsigned int)l3->GetBinContent(DL3Trigger::kKEEP_EVENT+1);
+
+  cout << endl << "L3 benchmark:" << endl;
+  cout << "  events: " << Nevents << "  kept: " << Nkept << endl;
+  if(tdiff>0.0) cout << "  rate: " << (double)(Nevents-1)/tdiff << " events/s" << endl;
+  cout << "  mean L3 time: " << l3_time->GetMean() << " ms/event" << endl;
+  for(int i=0; i<DL3Trigger::kNSTAGES; i++) {
+    double Ndecided = l3_decision_vs_stage->Integral(i+1,i+1,1,3);
+    if(Ndecided==0.0) continue;
+    double Ndiscarded = l3_decision_vs_stage->GetBinContent(i+1,DL3Trigger::kDISCARD_EVENT+1);
+    TH1D *h = l3_time_vs_stage->ProjectionY("_py",i+1,i+1);
+    cout << "  " << DL3Trigger::StageName((DL3Trigger::L3_stage_t)i) << ": " << Ndecided << " decided ("
+         << 100.0*Ndecided/(double)Nevents << "%), " << Ndiscarded << " discarded, mean time "
+         << h->GetMean() << " ms" << endl;
+    delete h;
+  }
+  cout << endl;
+
   return NOERROR;
 }
 
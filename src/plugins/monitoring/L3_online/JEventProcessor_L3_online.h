@@ -8,6 +8,8 @@
 #ifndef _JEventProcessor_L3_online_
 #define _JEventProcessor_L3_online_
 
+#include <sys/time.h>
+
 #include <JANA/JEventProcessor.h>
 
 
@@ -24,6 +26,10 @@ class JEventProcessor_L3_online:public jana::JEventProcessor{
   jerror_t evnt(jana::JEventLoop *eventLoop, int eventnumber);	///< Called every event.
   jerror_t erun(void);						///< Called everytime run number changes, provided brun has been called.
   jerror_t fini(void);						///< Called after last event of last event source has been processed.
+
+  bool BENCHMARK;                 // print rate and per-stage decisions at the end
+  unsigned int Nevents;
+  struct timeval tstart, tlast;   // times of first and last event seen
 };
 
 #endif // _JEventProcessor_L3_online_
@@ -7,6 +7,8 @@
 #include <vector>
 #include <utility>
 #include <map>
+#include <cstdlib>
+#include <sys/time.h>
 
 #include "AMPTOOLS_DATAIO/ROOTDataReader.h"
 #include "AMPTOOLS_AMPS/TwoPSAngles.h"
@@ -31,6 +33,7 @@ int main( int argc, char* argv[] ){
   // set default parameters
   
   bool useMinos = false;
+  int nBenchmark = 0;
 
   string configfile;
   string seedfile;
@@ -48,11 +51,15 @@ int main( int argc, char* argv[] ){
       if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
       else  seedfile = argv[++i]; }
     if (arg == "-n") useMinos = true;
+    if (arg == "-b"){
+      if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+      else  nBenchmark = atoi( argv[++i] ); }
     if (arg == "-h"){
       cout << endl << " Usage for: " << argv[0] << endl << endl;
       cout << "   -n \t\t\t\t\t use MINOS instead of MIGRAD" << endl;
       cout << "   -c <file>\t\t\t\t config file" << endl;
       cout << "   -s <output file>\t\t\t for seeding next fit based on this fit (optional)" << endl;
+      cout << "   -b <n>\t\t\t\t time <n> likelihood evaluations before fitting (optional)" << endl;
       exit(1);}
   }
   
@@ -78,6 +85,20 @@ int main( int argc, char* argv[] ){
   AmpToolsInterface ati( cfgInfo );
   
   cout << "LIKELIHOOD BEFORE MINIMIZATION:  " << ati.likelihood() << endl;
+
+  if( nBenchmark > 0 ){
+    
+    struct timeval start, stop;
+    gettimeofday( &start, NULL );
+    for( int i = 0; i < nBenchmark; ++i ) ati.likelihood();
+    gettimeofday( &stop, NULL );
+    
+    double seconds = ( stop.tv_sec - start.tv_sec ) +
+                     1.0e-6 * ( stop.tv_usec - start.tv_usec );
+    cout << "LIKELIHOOD EVALUATIONS:  " << nBenchmark << " in "
+         << seconds << " s  (" << ( seconds > 0 ? nBenchmark / seconds : 0 )
+         << " per second)" << endl;
+  }
   
   MinuitMinimizationManager* fitManager = ati.minuitMinimizationManager();
   
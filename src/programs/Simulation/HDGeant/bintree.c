@@ -2,55 +2,173 @@
  * bintree.c - library for managing binary tree of hits pointers
  *
  *	version 1.0 	-Richard Jones July 16, 2001
+ *
+ *	version 2.0	- the unbalanced binary tree is replaced by a hash
+ *			  table over block-allocated twigs.  GEANT produces
+ *			  marks in nearly increasing order, which made the
+ *			  tree degenerate into a list.  The twigs are sorted
+ *			  when picking starts so that pickTwig still returns
+ *			  them in order of increasing mark.
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <bintree.h>
 
-void** getTwig(binTree_t** tree, int mark)
+#define TWIG_BLOCK_SIZE 256
+#define MIN_TABLE_BITS 8
+
+static binTwig_t* twigAt(binTree_t* store, int index)
+{
+   return &store->blocks[index/TWIG_BLOCK_SIZE][index%TWIG_BLOCK_SIZE];
+}
+
+static unsigned int hashMark(binTree_t* store, int mark)
+{
+   return ((unsigned int)mark * 2654435761U) >> (32 - store->tablebits);
+}
+
+static void clearTable(binTree_t* store)
+{
+   memset(store->table, 0, (sizeof(int) << store->tablebits));
+}
+
+static void insertIndex(binTree_t* store, int index)
 {
-   binTree_t* node = *tree;
-   if (node == 0)
+   unsigned int mask = (1U << store->tablebits) - 1;
+   unsigned int slot = hashMark(store, twigAt(store, index)->mark);
+   while (store->table[slot])
    {
-      node = *tree = malloc(sizeof(binTree_t));
-      node->mark = mark;
-      node->left = 0;
-      node->right = 0;
-      node->this_node = 0;
-      return &node->this_node;
+      slot = (slot + 1) & mask;
    }
-   else if (mark == node->mark)
+   store->table[slot] = index + 1;
+}
+
+static void growTable(binTree_t* store)
+{
+   int index;
+   store->tablebits++;
+   store->table = realloc(store->table, (sizeof(int) << store->tablebits));
+   clearTable(store);
+   for (index = 0; index < store->ntwigs; ++index)
    {
-      return &node->this_node;
+      insertIndex(store, index);
    }
-   else if (mark < node->mark)
+}
+
+static binTwig_t* newTwig(binTree_t* store, int mark)
+{
+   binTwig_t* twig;
+   if (store->ntwigs == store->nblocks*TWIG_BLOCK_SIZE)
+   {
+      store->blocks = realloc(store->blocks,
+                              (store->nblocks + 1)*sizeof(binTwig_t*));
+      store->blocks[store->nblocks++] =
+                              malloc(TWIG_BLOCK_SIZE*sizeof(binTwig_t));
+   }
+   twig = twigAt(store, store->ntwigs);
+   twig->mark = mark;
+   twig->this_node = 0;
+   if (2*(store->ntwigs + 1) > (1 << store->tablebits))
    {
-      return getTwig(&node->left, mark);
+      store->ntwigs++;
+      growTable(store);
    }
    else
    {
-      assert (node->mark >= 0);
-      return getTwig(&node->right, mark);
+      insertIndex(store, store->ntwigs++);
+   }
+   return twig;
+}
+
+/* empty the store, keeping its memory for the next event */
+static void resetStore(binTree_t* store)
+{
+   store->ntwigs = 0;
+   store->npicked = 0;
+   store->picking = 0;
+   clearTable(store);
+}
+
+/* getTwig was called after pickTwig stopped part way (on a null twig):
+ * move the twigs that were not picked back into insertion mode */
+static void stopPicking(binTree_t* store)
+{
+   int nleft = store->ntwigs - store->npicked;
+   binTwig_t* left = malloc((nleft > 0 ? nleft : 1)*sizeof(binTwig_t));
+   int n;
+   for (n = 0; n < nleft; ++n)
+   {
+      left[n] = *store->picks[store->npicked + n];
+   }
+   resetStore(store);
+   for (n = 0; n < nleft; ++n)
+   {
+      newTwig(store, left[n].mark)->this_node = left[n].this_node;
+   }
+   free(left);
+}
+
+static int compareMarks(const void* a, const void* b)
+{
+   int ma = (*(binTwig_t* const*)a)->mark;
+   int mb = (*(binTwig_t* const*)b)->mark;
+   return (ma < mb)? -1 : (ma > mb);
+}
+
+void** getTwig(binTree_t** tree, int mark)
+{
+   binTree_t* store = *tree;
+   unsigned int mask;
+   unsigned int slot;
+   if (store == 0)
+   {
+      store = *tree = calloc(1, sizeof(binTree_t));
+      store->tablebits = MIN_TABLE_BITS;
+      store->table = calloc(1, (sizeof(int) << store->tablebits));
    }
+   else if (store->picking)
+   {
+      stopPicking(store);
+   }
+   mask = (1U << store->tablebits) - 1;
+   for (slot = hashMark(store, mark); store->table[slot];
+        slot = (slot + 1) & mask)
+   {
+      binTwig_t* twig = twigAt(store, store->table[slot] - 1);
+      if (twig->mark == mark)
+      {
+         return &twig->this_node;
+      }
+   }
+   return &newTwig(store, mark)->this_node;
 }
 
 void* pickTwig(binTree_t** tree)
 {
-   binTree_t* node = *tree;
-   if (node == 0)
+   binTree_t* store = *tree;
+   void* twig;
+   if (store == 0 || store->ntwigs == 0)
    {
       return 0;
    }
-   else if (node->left)
+   else if (store->picking == 0)
    {
-      return pickTwig(&node->left);
+      int index;
+      store->picks = realloc(store->picks, store->ntwigs*sizeof(binTwig_t*));
+      for (index = 0; index < store->ntwigs; ++index)
+      {
+         store->picks[index] = twigAt(store, index);
+      }
+      qsort(store->picks, store->ntwigs, sizeof(binTwig_t*), compareMarks);
+      store->npicked = 0;
+      store->picking = 1;
    }
-   else
+   twig = store->picks[store->npicked++]->this_node;
+   if (store->npicked == store->ntwigs)
    {
-      void* twig = node->this_node;
-      *tree = node->right;
-      free(node);
-      return twig;
+      resetStore(store);
    }
+   return twig;
 }
@@ -1,8 +1,27 @@
-typedef struct hitTree_s {
+/*
+ * bintree.h - store for per-event hit pointers, indexed by mark
+ *
+ * getTwig returns the slot for a given mark, creating an empty (null)
+ * slot if the mark has not been seen before.  pickTwig removes and
+ * returns the slot contents in order of increasing mark, as the binary
+ * tree this replaces did.  The slots are kept in a hash table with
+ * storage that is reused from one event to the next.
+ */
+
+typedef struct binTwig_s {
   int mark;
-  struct hitTree_s* left;
-  struct hitTree_s* right;
   void* this_node;
+} binTwig_t;
+
+typedef struct hitTree_s {
+  binTwig_t** blocks;     /* storage for the twigs, in fixed-size blocks */
+  int nblocks;
+  int ntwigs;             /* twigs in use */
+  int* table;             /* hash table of twig index+1, 0 for empty */
+  int tablebits;
+  binTwig_t** picks;      /* twigs sorted by mark once picking starts */
+  int npicked;
+  int picking;
 } binTree_t;
 
 void** getTwig(binTree_t** tree, int mark);
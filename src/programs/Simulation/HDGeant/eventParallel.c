@@ -0,0 +1,327 @@
+/*
+ * eventParallel - run the HDGeant event loop in several processes forked
+ *		from one initialized HDGeant, writing a single output file.
+ *
+ * Interface:
+ *	setWorkers(count) - select the event-parallel mode with <count>
+ *			worker processes, called from main before hdgeant
+ *	startWorkers()	- fork the workers once initialization is done;
+ *			returns the worker rank in each worker, and -1 in
+ *			the parent after it has merged their output
+ *	workerEvent(nevent,ievent,iseed1,iseed2) - called by gukine at the
+ *			start of each event to pick the next event for this
+ *			process and the random number seeds for it
+ *	endOfEvents()	- called by gukine when the input stream runs out
+ *	stopWorker()	- end a worker process after its last event
+ *
+ * Geometry, field maps and cross section tables are set up once before
+ * the fork and shared by the workers copy-on-write.  Events are dealt out
+ * round-robin:  with n workers, worker r simulates events r, r+n, r+2n,...
+ * and skips over the others on the input stream.  Each event is simulated
+ * with random number seeds derived from the initial seeds and the event
+ * number, so it comes out the same whichever process simulates it.  The
+ * workers send their events through pipes to the parent, which writes
+ * them to the output file in event order.  A worker sends a zero-length
+ * record for an event it did not write, so that the parent can keep
+ * count.  The output file is thus the same for any number of workers.
+ * Setting a single worker uses the per-event seeds without forking.
+ *
+ * Histograms booked in the workers are not saved.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <HDDM/hddm_s.h>
+#include <eventParallel.h>
+
+#include "controlparams.h"
+
+extern s_iostream_t* thisOutputStream;
+extern s_iostream_t* thisInputStream;
+extern s_HDDM_t* thisInputEvent;
+
+int skipInput (int count);
+int closeOutput ();
+
+static int nWorkers = 0;	/* 0 for the usual sequential event loop */
+static int workerRank = -1;	/* rank of this process, -1 if not forked */
+static int eventIndex = -1;	/* index of the current event */
+static int inputIndex = 0;	/* index of the next event gukine reads */
+static int eventsEnded = 0;
+static unsigned int initialSeeds[2];
+
+void setWorkers (int count)
+{
+   nWorkers = (count > 0)? count : 0;
+}
+
+static unsigned long long mixBits (unsigned long long x)
+{
+   x ^= x >> 30;
+   x *= 0xbf58476d1ce4e5b9ULL;
+   x ^= x >> 27;
+   x *= 0x94d049bb133111ebULL;
+   x ^= x >> 31;
+   return x;
+}
+
+static int readRecord (int fd, unsigned char* buf, int len)
+{
+   int got = 0;
+   while (got < len)
+   {
+      int n = read(fd, buf + got, len - got);
+      if (n <= 0)
+      {
+         break;
+      }
+      got += n;
+   }
+   return got;
+}
+
+/* copy the workers' events to the output file in event order */
+static int mergeOutput (int* fds)
+{
+   unsigned char head[4];
+   unsigned char* record = 0;
+   unsigned int recordSize = 0;
+   int failed = 0;
+   int r;
+   for (r = 0; readRecord(fds[r], head, 4) == 4; r = (r + 1) % nWorkers)
+   {
+      unsigned int size = ((unsigned int)head[0] << 24) | (head[1] << 16) |
+                          (head[2] << 8) | head[3];
+      if (size == 0)
+      {
+         continue;	/* nothing was written for this event */
+      }
+      if (size > recordSize)
+      {
+         record = realloc(record, recordSize = size);
+      }
+      if (readRecord(fds[r], record, size) != size)
+      {
+         fprintf(stderr,"Error in mergeOutput:");
+         fprintf(stderr," truncated event from worker %d.\n", r);
+         failed = 1;
+         break;
+      }
+      if (thisOutputStream &&
+          (fwrite(head, 1, 4, thisOutputStream->fd) != 4 ||
+           fwrite(record, 1, size, thisOutputStream->fd) != size))
+      {
+         fprintf(stderr,"Fatal error in mergeOutput:");
+         fprintf(stderr," write failed to hddm output file.\n");
+         exit(7);
+      }
+   }
+   free(record);
+
+   /* The first worker to stop has reached the end of the events, after
+    * which nothing more should arrive from the others. */
+   for (r = 0; r < nWorkers; ++r)
+   {
+      if (readRecord(fds[r], head, 1) != 0)
+      {
+         fprintf(stderr,"Error in mergeOutput:");
+         fprintf(stderr," worker %d has events beyond the end of the run.\n",
+                 r);
+         failed = 1;
+         while (readRecord(fds[r], head, 4) > 0);
+      }
+      close(fds[r]);
+   }
+   return failed;
+}
+
+int startWorkers ()
+{
+   int* fds;
+   pid_t* pids;
+   int failed;
+   int r;
+
+   if (nWorkers < 2)
+   {
+      return 0;
+   }
+
+   /* nothing buffered may be left over to be written again by each worker */
+   fflush(0);
+
+   fds = malloc(nWorkers*sizeof(int));
+   pids = malloc(nWorkers*sizeof(pid_t));
+   for (r = 0; r < nWorkers; ++r)
+   {
+      int p[2];
+      if (pipe(p) != 0 || (pids[r] = fork()) < 0)
+      {
+         perror("Fatal error in startWorkers");
+         exit(7);
+      }
+      else if (pids[r] == 0)
+      {
+         int i;
+         for (i = 0; i < r; ++i)
+         {
+            close(fds[i]);
+         }
+         close(p[0]);
+         free(fds);
+         free(pids);
+         workerRank = r;
+         if (thisOutputStream)
+         {
+            fclose(thisOutputStream->fd);
+            if ((thisOutputStream->fd = fdopen(p[1], "w")) == 0)
+            {
+               perror("Fatal error in startWorkers");
+               exit(7);
+            }
+         }
+         else
+         {
+            close(p[1]);
+         }
+         return workerRank;
+      }
+      close(p[1]);
+      fds[r] = p[0];
+   }
+   printf("Simulating events in %d worker processes\n", nWorkers);
+
+   failed = mergeOutput(fds);
+   for (r = 0; r < nWorkers; ++r)
+   {
+      int status;
+      if (waitpid(pids[r], &status, 0) != pids[r] ||
+          !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      {
+         fprintf(stderr,"Error in startWorkers:");
+         fprintf(stderr," worker %d did not finish normally.\n", r);
+         failed = 1;
+      }
+   }
+   free(fds);
+   free(pids);
+   if (failed)
+   {
+      fprintf(stderr,"Fatal error in startWorkers:");
+      fprintf(stderr," output file is incomplete.\n");
+      exit(7);
+   }
+   return -1;
+}
+
+int workerEvent (int nevent, int* ievent, int* iseed1, int* iseed2)
+{
+   unsigned long long hash;
+   int next;
+
+   if (nWorkers == 0)
+   {
+      return 0;
+   }
+   else if (eventIndex < 0)
+   {
+      initialSeeds[0] = *iseed1;
+      initialSeeds[1] = *iseed2;
+      next = (workerRank > 0)? workerRank : 0;
+   }
+   else
+   {
+      next = eventIndex + ((workerRank < 0)? 1 : nWorkers);
+   }
+   eventIndex = next;
+   if (nevent > 0 && next >= nevent)
+   {
+      eventsEnded = 1;
+      return 2;
+   }
+
+   /* pass over the input events that belong to the other workers */
+   if (thisInputStream && next > inputIndex)
+   {
+      int count = next - inputIndex;
+      if (controlparams_.get_next_evt == 0)
+      {
+         flush_s_HDDM(thisInputEvent, 0);
+         thisInputEvent = 0;
+         controlparams_.get_next_evt = 1;
+         --count;
+      }
+      if (count > 0)
+      {
+         skipInput(count);
+      }
+   }
+   inputIndex = next + 1;
+
+   hash = mixBits(((unsigned long long)initialSeeds[0] << 32) +
+                  initialSeeds[1] + 0x9e3779b97f4a7c15ULL*(next + 1));
+   *iseed1 = 1 + (int)(hash % 2147483562ULL);
+   hash = mixBits(hash);
+   *iseed2 = 1 + (int)(hash % 2147483398ULL);
+   *ievent = next + 1;
+   return 1;
+}
+
+void endOfEvents ()
+{
+   eventsEnded = 1;
+}
+
+int eventParallelIndex ()
+{
+   return (nWorkers == 0)? -1 : eventIndex;
+}
+
+int eventParallelOutput ()
+{
+   if (nWorkers == 0)
+   {
+      return EVENT_OUTPUT_FILE;
+   }
+   else if (eventsEnded)
+   {
+      return EVENT_OUTPUT_DROP;
+   }
+   return (workerRank < 0)? EVENT_OUTPUT_FILE : EVENT_OUTPUT_PIPE;
+}
+
+void stopWorker ()
+{
+   if (workerRank >= 0)
+   {
+      closeOutput();
+      exit(0);
+   }
+}
+
+/* entry points from Fortran */
+
+int startworkers_ ()
+{
+   return startWorkers();
+}
+
+int workerevent_ (int* nevent, int* ievent, int* iseed1, int* iseed2)
+{
+   return workerEvent(*nevent, ievent, iseed1, iseed2);
+}
+
+void endofevents_ ()
+{
+   endOfEvents();
+}
+
+void stopworker_ ()
+{
+   stopWorker();
+}
@@ -0,0 +1,25 @@
+/*
+ * eventParallel.h - interface to the event-parallel driver for HDGeant,
+ *		see eventParallel.c for a description.
+ */
+
+/* return values of eventParallelOutput() */
+#define EVENT_OUTPUT_DROP -1	/* past the last event, write nothing */
+#define EVENT_OUTPUT_FILE 0	/* write to the output file as usual */
+#define EVENT_OUTPUT_PIPE 1	/* forked worker, writing to the merger */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void setWorkers (int count);
+int startWorkers (void);
+int workerEvent (int nevent, int* ievent, int* iseed1, int* iseed2);
+void endOfEvents (void);
+int eventParallelIndex (void);
+int eventParallelOutput (void);
+void stopWorker (void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -6,6 +6,7 @@
  *	openOutput(filename) - open output stream to file <filename>
  *      loadOutput()  - load output event from hit structures
  *      flushOutput() - flush current event structure to output stream
+ *      skipOutput()  - pass over current event without writing it
  *	closeOutput() - close currently open output stream
  *
  * Richard Jones
@@ -19,6 +20,7 @@
 
 #include <HDDM/hddm_s.h>
 #include <hddmOutput.h>
+#include <eventParallel.h>
 
 #include "memcheck.h"
 
@@ -40,7 +42,12 @@ int openOutput (char* filename)
 
 int flushOutput ()
 {
-   if (thisOutputEvent != 0)
+   if (thisOutputEvent != 0 && eventParallelOutput() == EVENT_OUTPUT_DROP)
+   {
+      flush_s_HDDM(thisOutputEvent, 0);
+      thisOutputEvent = 0;
+   }
+   else if (thisOutputEvent != 0)
    {
       if (flush_s_HDDM(thisOutputEvent, thisOutputStream) != 0) {
          fprintf(stderr,"Fatal error in flushOutput:");
@@ -53,6 +60,21 @@ int flushOutput ()
    return 0;
 }
 
+int skipOutput ()
+{
+   /* a worker tells the merger that this event was not written */
+   if (thisOutputStream && eventParallelOutput() == EVENT_OUTPUT_PIPE)
+   {
+      static const char zero[4] = {0, 0, 0, 0};
+      if (fwrite(zero, 1, 4, thisOutputStream->fd) != 4) {
+         fprintf(stderr,"Fatal error in skipOutput:");
+         fprintf(stderr," write failed to hddm output pipe.\n");
+         exit(7);
+      }
+   }
+   return 0;
+}
+
 int closeOutput ()
 {
    if (thisOutputStream)
@@ -66,6 +88,7 @@ int closeOutput ()
 int loadOutput ()
 {
    int packages_hit=0;
+   int eventIndex = eventParallelIndex();
    s_HitView_t *hitView;
 	
 	Nevents++;
@@ -84,9 +107,12 @@ int loadOutput ()
       thisOutputEvent->physicsEvents = make_s_PhysicsEvents(1);
       thisOutputEvent->physicsEvents->mult = 1;
       thisOutputEvent->physicsEvents->in[0].eventNo = ++eventNo;
+      if (eventIndex >= 0) {
+         thisOutputEvent->physicsEvents->in[0].eventNo = eventIndex + 1;
+      }
    }
 	
-	if (Nevents == 1) {
+	if ((eventIndex < 0)? Nevents == 1 : eventIndex == 0) {
 		if (thisOutputEvent->geometry == HDDM_NULL) {
 			thisOutputEvent->geometry = make_s_Geometry();
 		}
@@ -164,6 +190,11 @@ int flushoutput_ ()
    return flushOutput();
 }
 
+int skipoutput_ ()
+{
+   return skipOutput();
+}
+
 int loadoutput_ ()
 {
    return loadOutput();
@@ -29,6 +29,9 @@ void Usage(void);
 // Get access to FORTRAN common block with some control flags
 #include "controlparams.h"
 
+// Event-parallel mode, see eventParallel.c
+#include "eventParallel.h"
+
 //------------------
 // main
 //------------------
@@ -52,6 +55,9 @@ int main(int narg, char *argv[])
 		
 		if(arg=="-h" || arg=="--help")Usage();
 		if(arg=="-checksum" || arg=="--checksum")print_xml_md5_checksum = true;
+		if(arg.find("-workers=")==0){
+			setWorkers(atoi(arg.substr(arg.find("=")+1).c_str()));
+		}
 		if(arg.find("-xml")==0){
 			controlparams_.runtime_geom = 1;
 			if(arg.find("=")!=string::npos){
@@ -138,11 +144,17 @@ void Usage(void)
 	cout<<"    -xml[=main_HDDS.xml]  Dynamically generate geometry"<<endl;
 	cout<<"    -checksum             Print the MD5 checksum of the "<<endl;
 	cout<<"                          geometry and exit"<<endl;
+	cout<<"    -workers=N            Simulate events in N processes"<<endl;
+	cout<<"                          forked after initialization"<<endl;
 	cout<<endl;
 	cout<<"If the -xml option is given and no file is specified,"<<endl;
 	cout<<"then a value of: "<<HDDS_XML<<endl;
 	cout<<"is used."<<endl;
 	cout<<endl;
+	cout<<"With -workers=N each event is simulated with random number"<<endl;
+	cout<<"seeds derived from its event number, and the output file is"<<endl;
+	cout<<"the same for any N. Histograms are not saved in this mode."<<endl;
+	cout<<endl;
 
 	exit(0);
 }
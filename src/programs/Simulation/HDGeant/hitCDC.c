@@ -40,6 +40,19 @@ static float THRESH_KEV	     =   1.;
 static float THRESH_MV = 1.;
 static float STRAW_RADIUS    =   0.776;
 static float CDC_TIME_WINDOW = 1000.0; //time window for accepting CDC hits, ns
+
+/* waveform buffer, kept from one straw to the next */
+static float* cdc_samples = 0;
+static int cdc_samples_size = 0;
+
+static float* getSampleBuffer(int num_samples)
+{
+  if (num_samples > cdc_samples_size) {
+    cdc_samples=(float *)realloc(cdc_samples,num_samples*sizeof(float));
+    cdc_samples_size=num_samples;
+  }
+  return cdc_samples;
+}
 static float ELECTRON_CHARGE =1.6022e-4; /* fC */
 static float GAS_GAIN = 1e5;
 
@@ -592,7 +605,7 @@ s_CentralDC_t* pickCentralDC ()
   	    
 	    // Temporary histogram in 1 ns bins to store waveform data
 	    int num_samples=(int)CDC_TIME_WINDOW;
-	    float *samples=(float *)malloc(num_samples*sizeof(float));
+	    float *samples=getSampleBuffer(num_samples);
 	    for (i=0;i<num_samples;i++) {
 	      samples[i]=cdc_wire_signal((float)i,hits);
 	      //printf("%f %f\n",(float)i,samples[i]);
@@ -624,7 +637,6 @@ s_CentralDC_t* pickCentralDC ()
 	   if (q > 0) {
 	     hits->in[iok-1].q = q;
 	   }
-	   free(samples);
 	  }
 	 
          if (iok)
@@ -59,6 +59,19 @@ static float THRESH_STRIPS        =5. ;  /* pC */
 static float ELECTRON_CHARGE =1.6022e-4; /* fC */
 static float DIFFUSION_COEFF  =   1.1e-6; // cm^2/s --> 200 microns at 1 cm
 static float FDC_TIME_WINDOW = 1000.0; //time window for accepting FDC hits, ns
+
+/* waveform buffer, shared by the anode and cathode pulse simulation */
+static float* fdc_samples = 0;
+static int fdc_samples_size = 0;
+
+static float* getSampleBuffer(int num_samples)
+{
+  if (num_samples > fdc_samples_size) {
+    fdc_samples=(float *)realloc(fdc_samples,num_samples*sizeof(float));
+    fdc_samples_size=num_samples;
+  }
+  return fdc_samples;
+}
 static float GAS_GAIN = 8e4;
 
 // Note by RTJ:
@@ -953,7 +966,7 @@ s_ForwardDC_t* pickForwardDC ()
 	   
 	   // Temporary histogram in 1 ns bins to store waveform data
 	   int num_samples=(int)FDC_TIME_WINDOW;
-	   float *samples=(float *)malloc(num_samples*sizeof(float));
+	   float *samples=getSampleBuffer(num_samples);
 	   for (i=0;i<num_samples;i++){
 	     samples[i]=wire_signal((float)i,ahits);
 	     //printf("%f %f\n",(float)i,samples[i]);
@@ -987,7 +1000,6 @@ s_ForwardDC_t* pickForwardDC ()
 	       returned_to_baseline=0;   
 	     }
 	   }
-	   free(samples);
 	 } // Simulation of clusters within cell
 
 	 if (iok)
@@ -1036,7 +1048,7 @@ s_ForwardDC_t* pickForwardDC ()
 	   
 	    // Temporary histogram in 1 ns bins to store waveform data
 	    int num_samples=(int)(FDC_TIME_WINDOW);
-	    float *samples=(float *)malloc(num_samples*sizeof(float));
+	    float *samples=getSampleBuffer(num_samples);
 	    for (i=0;i<num_samples;i++){
 	      samples[i]=cathode_signal((float)i,chits);
 		 //printf("t %f V %f\n",(float)i,samples[i]);
@@ -1085,7 +1097,6 @@ s_ForwardDC_t* pickForwardDC ()
 	      }
 	    }
 	    
-	    free(samples);
 	  }// Simulate clusters within cell
 	
 	  if (iok)
@@ -8,6 +8,8 @@
 #include <map>
 #include <cassert>
 #include <cstdlib>
+#include <ctime>
+#include <sys/time.h>
 
 #include "particleType.h"
 
@@ -19,6 +21,7 @@
 
 #include "AMPTOOLS_MCGEN/ProductionMechanism.h"
 #include "AMPTOOLS_MCGEN/GammaPToXYP.h"
+#include "AMPTOOLS_MCGEN/BatchGenerator.h"
 
 #include "IUAmpTools/AmpToolsInterface.h"
 #include "IUAmpTools/ConfigFileParser.h"
@@ -28,17 +31,13 @@
 #include "TFile.h"
 #include "TLorentzVector.h"
 #include "TLorentzRotation.h"
+#include "TRandom.h"
 
 using std::complex;
 using namespace std;
 
 int main( int argc, char* argv[] ){
   
-	// random number initialization - this is not GlueX standard and
-	// should be standardized in the future
-	
-	srand48( time( NULL ) );
-	
 	string  configfile("");
 	string  outname("");
 	string  hddmname("");
@@ -58,6 +57,8 @@ int main( int argc, char* argv[] ){
 	int nEvents = 10000;
 	int batchSize = 10000;
 	
+	long seed = time( NULL );
+	
 	//parse command line:
 	for (int i = 1; i < argc; i++){
 		
@@ -93,6 +94,9 @@ int main( int argc, char* argv[] ){
                 if (arg == "-b"){
                         if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
                         else  beamHighE = atof( argv[++i] ); }
+		if (arg == "-s"){
+			if ((i+1 == argc) || (argv[i+1][0] == '-')) arg = "-h";
+			else  seed = atol( argv[++i] ); }
 		if (arg == "-d"){
 			diag = true; }
 		if (arg == "-f"){
@@ -109,6 +113,7 @@ int main( int argc, char* argv[] ){
                         cout << "\t -p  <value>\t Coherent peak photon energy [optional]" << endl;
                         cout << "\t -a  <value>\t Minimum photon energy to simulate events [optional]" << endl;
                         cout << "\t -b  <value>\t Maximum photon energy to simulate events [optional]" << endl;
+			cout << "\t -s  <value>\t Random number seed [optional]" << endl;
 			cout << "\t -f \t\t Generate flat in M(X) (no physics) [optional]" << endl;
 			cout << "\t -d \t\t Plot only diagnostic histograms [optional]" << endl << endl;
 			exit(1);
@@ -126,6 +131,19 @@ int main( int argc, char* argv[] ){
 	assert( cfgInfo->reactionList().size() == 1 );
 	ReactionInfo* reaction = cfgInfo->reactionList()[0];
 	
+	// random number initialization - this is not GlueX standard and
+	// should be standardized in the future
+	//
+	// drand48() and gRandom are used only by the event generator, which
+	// runs on its own thread;  accept/reject and the vertex position use
+	// the separate stream below
+	
+	srand48( seed );
+	gRandom->SetSeed( seed );
+	unsigned short acceptSeed[3] = { 0x5EED,
+	                                 (unsigned short)( seed & 0xFFFF ),
+	                                 (unsigned short)( ( seed >> 16 ) & 0xFFFF ) };
+	
 	// setup AmpToolsInterface
 	AmpToolsInterface::registerAmplitude( TwoPiAngles() );
 	AmpToolsInterface::registerAmplitude( BreitWigner() );
@@ -170,24 +188,41 @@ int main( int argc, char* argv[] ){
 	
 	TH2F* CosTheta_psi = new TH2F( "CosTheta_psi", "cos#theta vs. #psi", 180, -3.14, 3.14, 100, -1, 1);
 	
+	if( batchSize < 1E4 ){
+		
+		cout << "WARNING:  small batches could have batch-to-batch variations\n"
+		     << "          due to different maximum intensities!" << endl;
+	}
+	
+	struct timeval startTime, stopTime;
+	gettimeofday( &startTime, NULL );
+	
+	// four-vectors for the next batch are generated on a separate thread
+	// while the current batch is processed
+	BatchGenerator< GammaPToXYP > batchGen( resProd, batchSize );
+	vector< Kinematics* > batch;
+	
 	int eventCounter = 0;
+	int generatedCounter = 0;
 	while( eventCounter < nEvents ){
 		
-		if( batchSize < 1E4 ){
-			
-			cout << "WARNING:  small batches could have batch-to-batch variations\n"
-			     << "          due to different maximum intensities!" << endl;
-		}
-		
 		cout << "Generating four-vectors..." << endl;
 		
+		// Only start on the batch after this one if it will be needed:  surely
+		// if this batch can't finish the job, probably if it won't at the
+		// acceptance seen so far.  A batch that turns out to be needed anyway
+		// is generated when it is asked for.
+		int batchesDone = generatedCounter / batchSize;
+		bool generateNext = ( eventCounter + batchSize < nEvents ) ||
+		  ( batchesDone > 0 && eventCounter + eventCounter / batchesDone < nEvents );
+		batchGen.nextBatch( batch, generateNext );
+		
 		ati.clearEvents();
 		for( int i = 0; i < batchSize; ++i ){
 			
-			Kinematics* kin = resProd.generate();
-			ati.loadEvent( kin, i, batchSize );
-			delete kin;
+			ati.loadEvent( batch[i], i, batchSize );
 		}
+		generatedCounter += batchSize;
 		
 		cout << "Processing events..." << endl;
 		
@@ -210,7 +245,7 @@ int main( int argc, char* argv[] ){
 			if( !diag ){
 				
 				// obtain this by looking at the maximum value of intensity * genWeight
-				double rand = drand48() * maxInten;
+				double rand = erand48( acceptSeed ) * maxInten;
 				
 				if( weightedInten > rand || genFlat ){
 					
@@ -253,7 +288,8 @@ int main( int argc, char* argv[] ){
 					// we want to save events with weight 1
 					evt->setWeight( 1.0 );
 					
-					if( hddmOut ) hddmOut->writeEvent( *evt, pTypes );
+					if( hddmOut ) hddmOut->writeEvent( *evt, pTypes, 0, 0,
+					                                   50 + 30 * erand48( acceptSeed ) );
 					rootOut.writeEvent( *evt );
 					++eventCounter;
 				}
@@ -276,6 +312,15 @@ int main( int argc, char* argv[] ){
 		cout << eventCounter << " events were processed." << endl;
 	}
 	
+	gettimeofday( &stopTime, NULL );
+	double seconds = ( stopTime.tv_sec - startTime.tv_sec ) +
+	                 1.0e-6 * ( stopTime.tv_usec - startTime.tv_usec );
+	
+	cout << generatedCounter << " events generated, " << eventCounter
+	     << " accepted (efficiency " << (double)eventCounter / generatedCounter
+	     << ") in " << seconds << " s:  "
+	     << ( seconds > 0 ? eventCounter / seconds : 0 ) << " events/s" << endl;
+	
 	mass->Write();
 	massW->Write();
 	intenW->Write();
@@ -50,6 +50,7 @@ void Usage(char* progName )
   cout << "    -n <value>\t Minimum number of events to generate (allows spill-over)" << endl;
   cout << "    -N <value>\t Exact number of events to generate" << endl;
   cout << "    -f \t\t Generate flat in M(X) (no physics)" << endl;
+  cout << "    -r \t\t Generate the 5-body decay with RAMBO (faster)" << endl;
   cout << "    -d \t\t Compute diagnostic histograms" << endl ;
   cout << "    -s <value>\t Specify random number generator seed" << endl;
   cout << "    -b <value>\t Batch size for intensities in accept/reject alg. (def. 200k)" << endl; 
@@ -71,7 +72,7 @@ int main( int argc, char* argv[] ){
   string  outname("gen_5pi"), allGenFName, inMCFName;
   b1piAmpCheck AmpCheck;
   bool diag = false, genFlat = false, StrictEvtLimit=false;
-  bool saveAll=false, readInEvents=false;
+  bool saveAll=false, readInEvents=false, useRambo=false;
   
   // default upper and lower bounds 
   double lowMass = 0.7, highMass = 3.0, Mpipm,Mpi0;
@@ -135,6 +136,8 @@ int main( int argc, char* argv[] ){
       diag = true; }
     if (arg == "-f"){  
       genFlat = true; }
+    if (arg == "-r"){  
+      useRambo = true; }
     if (arg == "-h"){
       Usage(argv[0]);
       exit(1);
@@ -257,7 +260,9 @@ int main( int argc, char* argv[] ){
     ( genFlat ? ProductionMechanism::kFlat : ProductionMechanism::kResonant );
   
   //generate over a range mass -- the daughters are pi-,pi+,omega
-  GammaPToNPartP resProd( lowMass, highMass, part_masses,type );
+  GammaPToNPartP resProd( lowMass, highMass, part_masses,type, 4.0, 9.0,
+			  useRambo ? NBodyPhaseSpaceFactory::kRambo :
+			  NBodyPhaseSpaceFactory::kRauboldLynch );
   //GammaPTob1piP resProd( lowMass, highMass, type );
   
   // seed the distribution with a sum of noninterfering Breit-Wigners
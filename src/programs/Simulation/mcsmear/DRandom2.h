@@ -2,62 +2,74 @@
 //
 
 // Random number generator used in mcsmear. All random numbers
-// should come from the global "gDRandom" object declared here.
+// should come from the generator returned by GetDRandom() declared
+// here. Each thread gets its own generator which is reseeded at the
+// start of every event (see GetAndSetSeeds in smear.cc) so that the
+// smeared output does not depend on which thread handled the event.
 //
-// Because we want to record the seeds used for every event,
-// we use the TRandom2 class. This one has only 3 seed values
-// (as opposed to 24 for TRandom1 and 624 for TRandom3) but 
-// is fast with a large period (10^26).
+// Because we want to record the seeds used for every event, the
+// generator state is described by 3 seed values which are stored
+// in the event (the same three used to be the state of ROOT's
+// TRandom2, hence the name of the class).
 //
-// Because the seeds in TRandom2 are declared protected in
-// the class with no methods to access/set them, we derive
-// a new class, DRandom2 from TRandom2. This allows us access
-// to the numbers for easy recording/retrieving. 
+// The generator itself is counter based: the n-th number drawn
+// after setting the seeds is a hash of a key made from the seeds
+// and the counter n. There is no dependence from one number to the
+// next, so the Fill* methods can generate a whole block of numbers
+// in a loop the compiler is able to vectorize. The smearing routines
+// use these to draw all of the numbers needed for a detector at once
+// rather than making a call per hit.
 
+#ifndef _DRandom2_
+#define _DRandom2_
 
-#include <TRandom2.h>
-#include <iostream>
-using std::cerr;
-using std::endl;
+#include <vector>
+#include <Rtypes.h>
 
-class DRandom2:public TRandom2{
+class DRandom2{
 	public:
-		
-		DRandom2(UInt_t seed=1):TRandom2(seed){}
-	
-		void GetSeeds(UInt_t &seed, UInt_t &seed1, UInt_t &seed2){
-			seed = this->fSeed;
-			seed1 = this->fSeed1;
-			seed2 = this->fSeed2;
+
+		DRandom2(UInt_t seed=1);
+
+		void GetSeeds(UInt_t &seed, UInt_t &seed1, UInt_t &seed2);
+		void SetSeeds(UInt_t &seed, UInt_t &seed1, UInt_t &seed2);
+
+		/// Uniform in (0,1)
+		double Rndm(void){ return ToDouble(Next()); }
+		double Gaus(double mean=0.0, double sigma=1.0);
+		int Poisson(double mean);
+
+		/// Fill vals with n numbers uniform in (0,1)
+		void FillUniform(std::vector<double> &vals, unsigned int n);
+		/// Fill vals with n numbers from a unit normal distribution
+		void FillGaus(std::vector<double> &vals, unsigned int n);
+		/// Fill vals with one Poisson distributed number for each mean
+		void FillPoisson(std::vector<double> &vals, const std::vector<double> &means);
+
+	private:
+		static const ULong64_t kGamma = 0x9E3779B97F4A7C15ULL;
+
+		// SplitMix64 finalizer
+		static ULong64_t Mix(ULong64_t z){
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			return z ^ (z >> 31);
 		}
-		
-		void SetSeeds(UInt_t &seed, UInt_t &seed1, UInt_t &seed2){
-		
-			// See the comments in TRandom2::SetSeed(int)
-			if( (seed<2) | (seed1<8) | (seed2<16) ){
-				cerr << endl;
-				cerr << "*********************************************************" << endl;
-				cerr << "WARNING: Random seeds passed to DRandom2::SetSeeds have" << endl;
-				cerr << "forbidden values: " << endl;
-				cerr << "  seed = " << seed << "  (must be at least 2)" <<endl;
-				cerr << "  seed1 = " << seed1 << "  (must be at least 8)" <<endl;
-				cerr << "  seed1 = " << seed2 << "  (must be at least 16)" <<endl;
-				cerr << "See comments in source for TRandom2::SetSeed(int)" <<endl;
-				cerr << "The seeds will all be adjusted to be in range." <<endl;
-				cerr << "*********************************************************" << endl;
-				cerr << endl;
-				seed += 2;
-				seed1 += 8;
-				seed2 += 15;
-			}
-		
-		
-			this->fSeed = seed;		
-			this->fSeed1 = seed1;		
-			this->fSeed2 = seed2;		
+		// Top 53 bits mapped to the open interval (0,1)
+		static double ToDouble(ULong64_t x){
+			return ((double)(x >> 11) + 0.5) * (1.0/9007199254740992.0);
 		}
-};
+		ULong64_t Next(void){ return Mix(fKey + (++fCounter)*kGamma); }
 
-extern DRandom2 gDRandom;
+		UInt_t fSeed;
+		UInt_t fSeed1;
+		UInt_t fSeed2;
+		ULong64_t fKey;
+		ULong64_t fCounter;
+		bool fHaveSpare;
+		double fSpare;
+};
 
+DRandom2& GetDRandom(void);
 
+#endif // _DRandom2_
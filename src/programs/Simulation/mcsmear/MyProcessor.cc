@@ -5,10 +5,13 @@
 //
 
 #include <iostream>
+#include <sstream>
 #include <cmath>
 using namespace std;
 
 #include <strings.h>
+#include <signal.h>
+#include <sys/time.h>
 
 #include "MyProcessor.h"
 
@@ -20,27 +23,61 @@ using namespace std;
 extern void Smear(hddm_s::HDDM *record);
 extern char *OUTFILENAME;
 
-static pthread_mutex_t output_file_mutex;
-static pthread_t output_file_mutex_last_owner;
+//..........................
+// Each processing thread serializes its events into its own memory
+// buffer using an uncompressed hddm_s::ostream with the same integrity
+// settings as the output file. The bytes produced are exactly what the
+// output stream would have written for the record before compression.
+//..........................
+class ThreadSerializer{
+   public:
+      ThreadSerializer(bool integrity_checks) {
+         fout = new hddm_s::ostream(sstr);
+         if (integrity_checks)
+            fout->setIntegrityChecks(hddm_s::k_crc32_integrity);
+      }
+      ~ThreadSerializer() {
+         delete fout;
+      }
+      std::string *Serialize(hddm_s::HDDM &record) {
+         sstr.str("");        // drop header and previous record
+         *fout << record;
+         return new std::string(sstr.str());
+      }
+
+   private:
+      std::ostringstream sstr;
+      hddm_s::ostream *fout;
+};
+
+static pthread_key_t serializer_key;
+
+// Events abandoned by threads killed with SIGHUP. The signal handler
+// only stores the sequence number in the next free slot. The other
+// processing threads pick them up from there (see UpdateSkips).
+#define MAX_HUP_SKIPS 256
+static volatile unsigned long hup_skipped_seqs[MAX_HUP_SKIPS];
+static volatile int hup_nskipped = 0;
+
+// Sequence number of the event this thread is working on (0 if none)
+static __thread unsigned long current_seq = 0;
+
+static void DeleteThreadSerializer(void *ptr)
+{
+   delete (ThreadSerializer*)ptr;
+}
 
 void mcsmear_thread_HUP_sighandler(int sig)
 {
-   jerr<<" Caught HUP signal for thread 0x"<<hex<<pthread_self()<<dec<<" thread exiting..."<<endl;
-
-   // We use output_file_mutex_owner to keep track (sort of)
-   // of which thread has the mutex locked. This mutex is only
-   // locked at the end of the evnt method. Once the lock is
-   // obtained, this value is set to hold the id of the thread
-   // that locked it. It may help in debugging to know the last
-   // known thread to have locked the mutex when the signal
-   // handler was called
-   jerr<<endl;
-   jerr<<" Last thread to lock output file mutex: 0x"<<hex<<pthread_self()<<dec<<endl;
-   jerr<<" Attempting to unlock mutex to avoid deadlock." <<endl;
-   jerr<<" However, the output file is likely corrupt at" <<endl;
-   jerr<<" this point and the process should be restarted ..." <<endl;
-   jerr<<endl;
-   pthread_mutex_unlock(&output_file_mutex);
+   // The event this thread was working on will never be written. Only
+   // flag it here since hardly anything is safe to call from a signal
+   // handler. SIGHUP is blocked while the pending mutex is held so the
+   // thread can't exit with it locked.
+   if (current_seq != 0) {
+      int slot = __sync_fetch_and_add(&hup_nskipped, 1);
+      if (slot < MAX_HUP_SKIPS)
+         hup_skipped_seqs[slot] = current_seq;
+   }
    pthread_exit(NULL);
 }
 
@@ -93,20 +130,23 @@ jerror_t MyProcessor::init(void)
       jout << " HDDM integrity checks disabled" << std::endl;
    }
 
-   // We set the mutex type to "ERRORCHECK" so that if the
-   // signal handler is called, we can unlock the mutex
-   // safely whether we have it locked or not.
-   pthread_mutexattr_t attr;
-   pthread_mutexattr_init(&attr);
-   pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
-   pthread_mutex_init(&output_file_mutex, NULL);
-   
-   // pthreads does not provide an "invalid" value for 
-   // a pthread_t that we can initialize with. Furthermore,
-   // the pthread_t may be a simple as an integer or as
-   // a complicated structure. Hence, to make this portable
-   // we clear it with bzero.
-   bzero(&output_file_mutex_last_owner, sizeof(pthread_t));
+   max_pending = 1000;
+   gPARMS->SetDefaultParameter("MCSMEAR:OUTPUT_QUEUE_SIZE", max_pending,
+                          "Maximum number of smeared events held waiting to"
+                          " be written in input order.");
+   if (max_pending < 1)
+      max_pending = 1;
+
+   pthread_mutex_init(&pending_mutex, NULL);
+   pthread_cond_init(&pending_cond, NULL);
+   pthread_key_create(&serializer_key, DeleteThreadSerializer);
+
+   // Start output thread
+   next_seq = 1;
+   skip_below = 0;
+   hup_nhandled = 0;
+   writer_done = false;
+   pthread_create(&writer_thread, NULL, WriterThreadLaunch, this);
    
    return NOERROR;
 }
@@ -126,16 +166,23 @@ jerror_t MyProcessor::evnt(JEventLoop *loop, int eventnumber)
    hddm_s::HDDM *record = (hddm_s::HDDM*)event.GetRef();
    if (!record)
       return NOERROR;
+   unsigned long seq = hddm_source->GetEventSequence(record);
+
+   ThreadSerializer *ser = (ThreadSerializer*)pthread_getspecific(serializer_key);
+   if (ser == NULL) {
+      ser = new ThreadSerializer(HDDM_USE_INTEGRITY_CHECKS);
+      pthread_setspecific(serializer_key, ser);
+   }
+   current_seq = seq;
    
    // Smear values and add noise hits
    Smear(record);
    
-   // Write event to output file
-   pthread_mutex_lock(&output_file_mutex);
-   output_file_mutex_last_owner = pthread_self();
-   *fout << *record;
-   Nevents_written++;
-   pthread_mutex_unlock(&output_file_mutex);
+   // Serialize here and let the output thread do the ordering,
+   // compression and writing.
+   std::string *buf = ser->Serialize(*record);
+   QueueEvent(seq, buf, hddm_source);
+   current_seq = 0;
 
    return NOERROR;
 }
@@ -145,6 +192,13 @@ jerror_t MyProcessor::evnt(JEventLoop *loop, int eventnumber)
 //------------------------------------------------------------------
 jerror_t MyProcessor::fini(void)
 {
+   // Flush everything still waiting and stop the output thread
+   pthread_mutex_lock(&pending_mutex);
+   writer_done = true;
+   pthread_cond_broadcast(&pending_cond);
+   pthread_mutex_unlock(&pending_mutex);
+   pthread_join(writer_thread, NULL);
+
    if (fout)
       delete fout;
    if (ofs) {
@@ -156,3 +210,133 @@ jerror_t MyProcessor::fini(void)
    
    return NOERROR;
 }
+
+//------------------------------------------------------------------
+// QueueEvent   -Hand a serialized event to the output thread
+//------------------------------------------------------------------
+void MyProcessor::QueueEvent(unsigned long seq, std::string *buf,
+                             DEventSourceHDDM *source)
+{
+   // Don't let a SIGHUP kill this thread while it holds the lock
+   sigset_t hupset, oldset;
+   sigemptyset(&hupset);
+   sigaddset(&hupset, SIGHUP);
+   pthread_sigmask(SIG_BLOCK, &hupset, &oldset);
+   pthread_mutex_lock(&pending_mutex);
+
+   UpdateSkips(source);
+
+   // Don't let the reordering buffer grow without limit while waiting
+   // on a slow event. The event the writer is waiting for never blocks.
+   // If the writer is waiting for an event that will never come, only
+   // the threads waiting here can find out, so check every so often.
+   while (seq >= next_seq + max_pending && !writer_done) {
+      struct timeval now;
+      gettimeofday(&now, NULL);
+      struct timespec timeout;
+      timeout.tv_sec = now.tv_sec + 1;
+      timeout.tv_nsec = now.tv_usec*1000;
+      pthread_cond_timedwait(&pending_cond, &pending_mutex, &timeout);
+      UpdateSkips(source);
+   }
+
+   if (seq >= next_seq && pending.find(seq) == pending.end())
+      pending[seq] = buf;
+   else
+      delete buf;   // already skipped or duplicate
+   pthread_cond_broadcast(&pending_cond);
+   pthread_mutex_unlock(&pending_mutex);
+   pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+}
+
+//------------------------------------------------------------------
+// UpdateSkips   -Find events the writer should no longer wait for
+//------------------------------------------------------------------
+void MyProcessor::UpdateSkips(DEventSourceHDDM *source)
+{
+   // Called by a processing thread with pending_mutex locked. A slot
+   // that has been claimed by the HUP handler but not yet filled in is
+   // left for later. The source is told to forget the killed thread's
+   // event so that it doesn't hold back the oldest live sequence.
+   bool changed = false;
+   int nskipped = hup_nskipped;
+   if (nskipped > MAX_HUP_SKIPS)
+      nskipped = MAX_HUP_SKIPS;
+   while (hup_nhandled < nskipped && hup_skipped_seqs[hup_nhandled] != 0) {
+      unsigned long seq = hup_skipped_seqs[hup_nhandled++];
+      jerr<<endl;
+      jerr<<" A thread was killed by a HUP signal. Event "<<seq<<endl;
+      jerr<<" (in input order) will be missing from the output file."<<endl;
+      jerr<<endl;
+      hup_skipped.insert(seq);
+      source->ReleaseEventSequence(seq);
+      changed = true;
+   }
+
+   // Events older than the oldest one the source still holds can no
+   // longer arrive (e.g. they were dropped or threw an exception).
+   unsigned long oldest_live = source->GetOldestLiveSequence();
+   if (oldest_live > skip_below) {
+      skip_below = oldest_live;
+      changed = true;
+   }
+
+   if (changed)
+      pthread_cond_broadcast(&pending_cond);
+}
+
+//------------------------------------------------------------------
+// WriterThreadLaunch
+//------------------------------------------------------------------
+void* MyProcessor::WriterThreadLaunch(void *arg)
+{
+   ((MyProcessor*)arg)->WriterThread();
+   return NULL;
+}
+
+//------------------------------------------------------------------
+// WriterThread   -Write events in input order
+//------------------------------------------------------------------
+void MyProcessor::WriterThread(void)
+{
+   pthread_mutex_lock(&pending_mutex);
+   while (true) {
+
+      // Events that can no longer arrive (e.g. skipped by JANA) are
+      // passed over. At the end, any remaining gaps are passed over.
+      while (pending.find(next_seq) == pending.end()) {
+         if (pending.empty() && writer_done)
+            break;
+         if (next_seq < skip_below || hup_skipped.erase(next_seq)) {
+            next_seq++;
+            pthread_cond_broadcast(&pending_cond);
+         }
+         else if (writer_done) {
+            next_seq = pending.begin()->first;
+         }
+         else {
+            pthread_cond_wait(&pending_cond, &pending_mutex);
+         }
+      }
+      if (pending.empty() && writer_done)
+         break;
+
+      std::map<unsigned long, std::string*>::iterator iter = pending.begin();
+      std::string *buf = iter->second;
+      pending.erase(iter);
+      next_seq++;
+      pthread_cond_broadcast(&pending_cond);
+      pthread_mutex_unlock(&pending_mutex);
+
+      // Writing to the ofstream goes through the compression
+      // streambuf installed by fout.
+      if (buf) {
+         ofs->write(buf->data(), buf->size());
+         Nevents_written++;
+         delete buf;
+      }
+
+      pthread_mutex_lock(&pending_mutex);
+   }
+   pthread_mutex_unlock(&pending_mutex);
+}
@@ -7,6 +7,8 @@
 ///
 
 #include <string>
+#include <map>
+#include <set>
 
 #include <JANA/JEventProcessor.h>
 #include <JANA/JEventLoop.h>
@@ -15,6 +17,8 @@ using namespace jana;
 #include <fstream>
 #include <HDDM/hddm_s.hpp>
 
+class DEventSourceHDDM;
+
 
 
 class MyProcessor:public JEventProcessor
@@ -31,10 +35,34 @@ class MyProcessor:public JEventProcessor
       jerror_t fini(void);                              ///< Called after last event of last event source has been processed.
 
       ofstream *ofs;
-      hddm_s::ostream *fout; 
+      hddm_s::ostream *fout;
       unsigned long Nevents_written;
 
    private:
       int  HDDM_USE_COMPRESSION;
       bool HDDM_USE_INTEGRITY_CHECKS;
+
+      // Events are smeared and serialized (without compression) by the
+      // processing threads and then handed to a single writer thread
+      // which puts them back into input order and pushes them through
+      // the compressing output stream. A NULL buffer marks an event
+      // that produced no output. Events older than the oldest one
+      // the source still holds can no longer arrive and are skipped.
+      void QueueEvent(unsigned long seq, std::string *buf,
+                      DEventSourceHDDM *source);
+      static void* WriterThreadLaunch(void *arg);
+      void WriterThread(void);
+
+      void UpdateSkips(DEventSourceHDDM *source);
+
+      pthread_t writer_thread;
+      pthread_mutex_t pending_mutex;
+      pthread_cond_t pending_cond;
+      std::map<unsigned long, std::string*> pending;
+      unsigned long next_seq;
+      unsigned long skip_below;
+      unsigned long max_pending;
+      bool writer_done;
+      std::set<unsigned long> hup_skipped;   // flagged by the HUP handler
+      int hup_nhandled;                      // slots already collected
 };
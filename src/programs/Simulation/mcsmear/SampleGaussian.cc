@@ -6,30 +6,243 @@
 //
 #include <stdlib.h>
 #include <math.h>
+#include <pthread.h>
+#include <vector>
+using std::vector;
+
+#include <TRandom2.h>
 
 #include "DRandom2.h"
 
-// Note, the argument is zero to cause the seeds to
-// be initialized using the UUID (see code for ROOT's
-// TRandom2 constructor) No argument, or an argument 
-// greater than zero will result in the same seeds 
-// being set every time mcsmear is run.
-DRandom2 gDRandom(0); // declared extern in DRandom2.h
+static pthread_key_t drandom_key;
+static pthread_once_t drandom_key_once = PTHREAD_ONCE_INIT;
+
+static void DeleteDRandom(void *ptr)
+{
+	delete (DRandom2*)ptr;
+}
+
+static void MakeDRandomKey(void)
+{
+	pthread_key_create(&drandom_key, DeleteDRandom);
+}
+
+//--------------------------
+// GetDRandom
+//--------------------------
+DRandom2& GetDRandom(void)
+{
+	/// Return the generator belonging to the calling thread,
+	/// creating it on first use.
+	pthread_once(&drandom_key_once, MakeDRandomKey);
+	DRandom2 *rnd = (DRandom2*)pthread_getspecific(drandom_key);
+	if(rnd == NULL){
+		// Note, the argument is zero to cause the seeds to
+		// be initialized using the UUID (see DRandom2::DRandom2).
+		// These are only used if the seeds are not set for the
+		// event in GetAndSetSeeds.
+		rnd = new DRandom2(0);
+		pthread_setspecific(drandom_key, rnd);
+	}
+	return *rnd;
+}
+
+//--------------------------
+// DRandom2::DRandom2
+//--------------------------
+DRandom2::DRandom2(UInt_t seed)
+{
+	// A seed of zero means pick unique seeds. Borrow the
+	// UUID based initialization of ROOT's TRandom2 for this.
+	UInt_t s[3] = {seed, seed+1, seed+2};
+	if(seed == 0){
+		TRandom2 init(0);
+		for(int i=0; i<3; i++) s[i] = init.Integer(kMaxUInt);
+	}
+	SetSeeds(s[0], s[1], s[2]);
+}
+
+//--------------------------
+// DRandom2::SetSeeds
+//--------------------------
+void DRandom2::SetSeeds(UInt_t &seed, UInt_t &seed1, UInt_t &seed2)
+{
+	/// Start a new sequence. The three seeds are hashed together
+	/// into the key so that seeds which differ only by a small
+	/// offset (e.g. the event number) give unrelated sequences.
+	fSeed  = seed;
+	fSeed1 = seed1;
+	fSeed2 = seed2;
+	fKey = Mix(((ULong64_t)seed << 32) ^ Mix(((ULong64_t)seed1 << 32) ^ Mix((ULong64_t)seed2 + kGamma)));
+	fCounter = 0;
+	fHaveSpare = false;
+}
+
+//--------------------------
+// DRandom2::GetSeeds
+//--------------------------
+void DRandom2::GetSeeds(UInt_t &seed, UInt_t &seed1, UInt_t &seed2)
+{
+	/// Return seeds that reproduce the numbers drawn from here on.
+	/// If numbers were already drawn since the seeds were last set
+	/// (i.e. the generator was not reseeded for this event) then
+	/// new seeds are drawn from the current sequence and the
+	/// generator is restarted with them.
+	if(fCounter!=0 || fHaveSpare){
+		UInt_t s[3];
+		for(int i=0; i<3; i++) s[i] = (UInt_t)(Next() >> 32);
+		SetSeeds(s[0], s[1], s[2]);
+	}
+	seed  = fSeed;
+	seed1 = fSeed1;
+	seed2 = fSeed2;
+}
+
+//--------------------------
+// DRandom2::Gaus
+//--------------------------
+double DRandom2::Gaus(double mean, double sigma)
+{
+	/// Box-Muller. The second number of each pair is kept
+	/// for the next call.
+	if(fHaveSpare){
+		fHaveSpare = false;
+		return mean + sigma*fSpare;
+	}
+	double r = sqrt(-2.0*log(Rndm()));
+	double phi = 2.0*M_PI*Rndm();
+	fSpare = r*sin(phi);
+	fHaveSpare = true;
+
+	return mean + sigma*r*cos(phi);
+}
+
+//--------------------------
+// DRandom2::Poisson
+//--------------------------
+int DRandom2::Poisson(double mean)
+{
+	if(mean <= 0.0) return 0;
+
+	if(mean < 30.0){
+		// Inversion using a single uniform number
+		double u = Rndm();
+		double p = exp(-mean);
+		double F = p;
+		int k = 0;
+		while(u > F && k < 1000){
+			k++;
+			p *= mean/(double)k;
+			F += p;
+		}
+		return k;
+	}
+
+	// Transformed rejection with squeeze (PTRS) of W. Hormann,
+	// Insurance: Mathematics and Economics 12, 39 (1993)
+	double slam = sqrt(mean);
+	double loglam = log(mean);
+	double b = 0.931 + 2.53*slam;
+	double a = -0.059 + 0.02483*b;
+	double invalpha = 1.1239 + 1.1328/(b - 3.4);
+	double vr = 0.9277 - 3.6224/(b - 2.0);
+	while(true){
+		double U = Rndm() - 0.5;
+		double V = Rndm();
+		double us = 0.5 - fabs(U);
+		double k = floor((2.0*a/us + b)*U + mean + 0.43);
+		if(us >= 0.07 && V <= vr) return (int)k;
+		if(k < 0.0 || (us < 0.013 && V > us)) continue;
+		if(log(V) + log(invalpha) - log(a/(us*us) + b) <= -mean + k*loglam - lgamma(k + 1.0)) return (int)k;
+	}
+}
+
+//--------------------------
+// DRandom2::FillUniform
+//--------------------------
+void DRandom2::FillUniform(vector<double> &vals, unsigned int n)
+{
+	vals.resize(n);
+	if(n == 0) return;
+
+	// Each element depends only on its own counter value so
+	// this loop has no carried dependence.
+	double *v = &vals[0];
+	ULong64_t base = fKey + (fCounter + 1)*kGamma;
+	for(unsigned int i=0; i<n; i++){
+		v[i] = ToDouble(Mix(base + (ULong64_t)i*kGamma));
+	}
+	fCounter += n;
+}
+
+//--------------------------
+// DRandom2::FillGaus
+//--------------------------
+void DRandom2::FillGaus(vector<double> &vals, unsigned int n)
+{
+	/// Box-Muller applied to pairs of uniform numbers drawn as
+	/// a single block. An odd last element comes from Gaus().
+	unsigned int npairs = n/2;
+	FillUniform(vals, 2*npairs);
+	vals.resize(n);
+	if(n == 0) return;
+
+	double *v = &vals[0];
+	for(unsigned int i=0; i<npairs; i++){
+		double r = sqrt(-2.0*log(v[2*i]));
+		double phi = 2.0*M_PI*v[2*i+1];
+		v[2*i]   = r*cos(phi);
+		v[2*i+1] = r*sin(phi);
+	}
+	if(n != 2*npairs) v[n-1] = Gaus();
+}
+
+//--------------------------
+// DRandom2::FillPoisson
+//--------------------------
+void DRandom2::FillPoisson(vector<double> &vals, const vector<double> &means)
+{
+	/// Small means (the usual case for photo-electron counts) only
+	/// need one uniform number each. These are drawn as a block up
+	/// front and the rest are sampled one at a time afterwards.
+	unsigned int n = means.size();
+	FillUniform(vals, n);
+	for(unsigned int i=0; i<n; i++){
+		double mean = means[i];
+		if(mean <= 0.0){
+			vals[i] = 0.0;
+		}else if(mean < 30.0){
+			double u = vals[i];
+			double p = exp(-mean);
+			double F = p;
+			int k = 0;
+			while(u > F && k < 1000){
+				k++;
+				p *= mean/(double)k;
+				F += p;
+			}
+			vals[i] = (double)k;
+		}
+	}
+	for(unsigned int i=0; i<n; i++){
+		if(means[i] >= 30.0) vals[i] = (double)Poisson(means[i]);
+	}
+}
 
 //--------------------------
 // SampleGaussian
 //--------------------------
 double SampleGaussian(double sigma)
 {
-	return gDRandom.Gaus(0.0, sigma);
+	return GetDRandom().Gaus(0.0, sigma);
 }
 
 //--------------------------
 // SamplePoisson
 //--------------------------
 double SamplePoisson(double lambda)
-{	
-	return gDRandom.Poisson(lambda);
+{
+	return GetDRandom().Poisson(lambda);
 }
 
 //--------------------------
@@ -39,7 +252,7 @@ double SampleRange(double x1, double x2)
 {
 	double s, f;
 	double xlo, xhi;
-	
+
 	if(x1<x2){
 		xlo = x1;
 		xhi = x2;
@@ -48,9 +261,41 @@ double SampleRange(double x1, double x2)
 		xhi = x1;
 	}
 
-	s  = gDRandom.Rndm();
+	s  = GetDRandom().Rndm();
 	f  = xlo + s*(xhi-xlo);
-	
+
 	return f;
 }
 
+//--------------------------
+// SampleGaussian
+//--------------------------
+void SampleGaussian(vector<double> &vals, unsigned int n, double sigma)
+{
+	/// Fill vals with n numbers sampled from a gaussian of width sigma
+	GetDRandom().FillGaus(vals, n);
+	if(sigma == 1.0) return;
+	for(unsigned int i=0; i<n; i++) vals[i] *= sigma;
+}
+
+//--------------------------
+// SamplePoisson
+//--------------------------
+void SamplePoisson(vector<double> &vals, const vector<double> &lambda)
+{
+	/// Fill vals with one number sampled from a Poisson
+	/// distribution for each mean in lambda
+	GetDRandom().FillPoisson(vals, lambda);
+}
+
+//--------------------------
+// SampleRange
+//--------------------------
+void SampleRange(vector<double> &vals, unsigned int n, double x1, double x2)
+{
+	/// Fill vals with n numbers uniformly distributed between x1 and x2
+	double xlo = x1<x2 ? x1:x2;
+	double xhi = x1<x2 ? x2:x1;
+	GetDRandom().FillUniform(vals, n);
+	for(unsigned int i=0; i<n; i++) vals[i] = xlo + vals[i]*(xhi-xlo);
+}
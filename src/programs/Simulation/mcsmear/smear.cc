@@ -54,8 +54,6 @@ void SmearFMWPC(hddm_s::HDDM *record);
 void InitCDCGeometry(void);
 void InitFDCGeometry(void);
 
-pthread_mutex_t mutex_fdc_smear_function = PTHREAD_MUTEX_INITIALIZER;
-
 bool CDC_GEOMETRY_INITIALIZED = false;
 int CDC_MAX_RINGS=0;
 extern vector<unsigned int> NCDC_STRAWS;
@@ -63,6 +61,7 @@ extern vector<double> CDC_RING_RADIUS;
 
 DFCALGeometry *fcalGeom = NULL;
 DCCALGeometry *ccalGeom = NULL;
+static pthread_once_t calgeom_once = PTHREAD_ONCE_INIT;
 bool FDC_GEOMETRY_INITIALIZED = false;
 unsigned int NFDC_WIRES_PER_PLANE;
 extern vector<double> FDC_LAYER_Z;
@@ -71,6 +70,9 @@ extern double FDC_RATE_COEFFICIENT;
 double SampleGaussian(double sigma);
 double SamplePoisson(double lambda);
 double SampleRange(double x1, double x2);
+void SampleGaussian(vector<double> &vals, unsigned int n, double sigma);
+void SamplePoisson(vector<double> &vals, const vector<double> &lambda);
+void SampleRange(vector<double> &vals, unsigned int n, double x1, double x2);
 
 // Do we or do we not add noise hits
 extern bool ADD_NOISE;
@@ -81,6 +83,14 @@ extern bool SMEAR_HITS;
 // Use or ignore random number seeds found in HDDM file
 extern bool IGNORE_SEEDS;
 
+// Seeds given on the command line. These are offset by the event
+// number to get the seeds for each event.
+static bool CMDLINE_SEEDS_SET = false;
+static UInt_t CMDLINE_SEEDS[3] = {0, 0, 0};
+
+// Mutex used to control accessing the ROOT global memory
+extern pthread_mutex_t root_mutex;
+
 // The error on the drift time in the CDC. The drift times
 // for the actual CDC hits coming from the input file
 // are smeared by a gaussian with this sigma.
@@ -203,6 +213,59 @@ extern double TRIGGER_LOOKBACK_TIME;
 
 extern bool DROP_TRUTH_HITS;
 
+//..........................
+// HistFills is used to buffer the diagnostic histogram fills made
+// while smearing one event. They are applied all at once with the
+// ROOT mutex held when the object goes out of scope so that the
+// smearing routines themselves can run on many threads at once.
+//..........................
+class HistFills{
+   public:
+      ~HistFills() { Flush(); }
+
+      void Fill(TH1 *h, double x) {
+         fills.push_back(fill_t(h, x, 0.0, false));
+      }
+      void Fill(TH2 *h, double x, double y) {
+         fills.push_back(fill_t(h, x, y, true));
+      }
+      void Flush(void) {
+         if (fills.empty())
+            return;
+         pthread_mutex_lock(&root_mutex);
+         for (unsigned int i=0; i < fills.size(); i++) {
+            fill_t &f = fills[i];
+            if (f.is2D)
+               ((TH2*)f.h)->Fill(f.x, f.y);
+            else
+               f.h->Fill(f.x);
+         }
+         pthread_mutex_unlock(&root_mutex);
+         fills.clear();
+      }
+
+   private:
+      struct fill_t {
+         fill_t(TH1 *h, double x, double y, bool is2D)
+          : h(h), x(x), y(y), is2D(is2D) {}
+         TH1 *h;
+         double x;
+         double y;
+         bool is2D;
+      };
+      vector<fill_t> fills;
+};
+
+//-----------
+// InitCalGeometry
+//-----------
+static void InitCalGeometry(void)
+{
+   // Called exactly once through pthread_once
+   fcalGeom = new DFCALGeometry();
+   ccalGeom = new DCCALGeometry();
+}
+
 // Polynomial interpolation on a grid.
 // Adapted from Numerical Recipes in C (2nd Edition), pp. 121-122.
 void polint(float *xa, float *ya,int n,float x, float *y,float *dy){
@@ -288,13 +351,14 @@ void SetSeeds(const char *vals)
    stringstream ss(vals);
    Int_t seed1, seed2, seed3;
    ss >> seed1 >> seed2 >> seed3;
-   UInt_t *useed1 = reinterpret_cast<UInt_t*>(&seed1);
-   UInt_t *useed2 = reinterpret_cast<UInt_t*>(&seed2);
-   UInt_t *useed3 = reinterpret_cast<UInt_t*>(&seed3);
-   gDRandom.SetSeeds(*useed1, *useed2, *useed3);
+   CMDLINE_SEEDS[0] = *reinterpret_cast<UInt_t*>(&seed1);
+   CMDLINE_SEEDS[1] = *reinterpret_cast<UInt_t*>(&seed2);
+   CMDLINE_SEEDS[2] = *reinterpret_cast<UInt_t*>(&seed3);
+   CMDLINE_SEEDS_SET = true;
 
    cout << "Seeds set from command line. Any random number" << endl;
    cout << "seeds found in the input file will be ignored!" << endl;
+   cout << "(Each event uses these seeds offset by its event number.)" << endl;
    IGNORE_SEEDS = true;
 }
 
@@ -307,11 +371,39 @@ void GetAndSetSeeds(hddm_s::HDDM *record)
    // If so, use them to set the seeds for the random number
    // generator. Otherwise, make sure the seeds that are used
    // are stored in the output event.
+   //
+   // The generator belongs to the calling thread and is reseeded
+   // here for every event. This is what makes the output independent
+   // of the number of threads and of the order in which they pick
+   // up events.
    
    if (record == 0)
       return;
-   else if (record->getReactions().size() == 0)
+
+   DRandom2 &rnd = GetDRandom();
+   int eventNo = 0;
+   if (record->getPhysicsEvents().size() > 0)
+      eventNo = record->getPhysicsEvent().getEventNo();
+
+   // Command line seeds take precedence over everything else
+   UInt_t seed1, seed2, seed3;
+   if (CMDLINE_SEEDS_SET) {
+      seed1 = CMDLINE_SEEDS[0] + eventNo;
+      seed2 = CMDLINE_SEEDS[1] + eventNo;
+      seed3 = CMDLINE_SEEDS[2] + eventNo;
+      rnd.SetSeeds(seed1, seed2, seed3);
+   }
+
+   if (record->getReactions().size() == 0) {
+      // Nowhere to record the seeds, just make them reproducible
+      if (!CMDLINE_SEEDS_SET && !IGNORE_SEEDS) {
+         seed1 = 259921049 + eventNo;
+         seed2 = 442249570 + eventNo;
+         seed3 = 709975946 + eventNo;
+         rnd.SetSeeds(seed1, seed2, seed3);
+      }
       return;
+   }
 
    hddm_s::ReactionList::iterator reiter = record->getReactions().begin();
    if (reiter->getRandoms().size() == 0) {
@@ -323,7 +415,6 @@ void GetAndSetSeeds(hddm_s::HDDM *record)
       blank_rand().setSeed4(0);
    }
 
-   UInt_t seed1, seed2, seed3;
    hddm_s::Random my_rand = reiter->getRandom();
 
    if (!IGNORE_SEEDS) {
@@ -339,18 +430,17 @@ void GetAndSetSeeds(hddm_s::HDDM *record)
       // are set here to the fractional part of the cube roots of
       // the first three primes, truncated to 9 digits.
       if ((seed1 == 0) || (seed2 == 0) || (seed3 == 0)){
-         int eventNo = record->getPhysicsEvent().getEventNo();
          seed1 = 259921049 + eventNo;
          seed2 = 442249570 + eventNo;
          seed3 = 709975946 + eventNo;
       }
       
       // Set the seeds in the random generator.
-      gDRandom.SetSeeds(seed1, seed2, seed3);
+      rnd.SetSeeds(seed1, seed2, seed3);
    }
 
    // Copy seeds from generator to local variables
-   gDRandom.GetSeeds(seed1, seed2, seed3);
+   rnd.GetSeeds(seed1, seed2, seed3);
 
    // Copy seeds from local variables to event record
    my_rand.setSeed1(seed1);
@@ -370,10 +460,20 @@ void SmearCDC(hddm_s::HDDM *record)
 
    double t_max = TRIGGER_LOOKBACK_TIME + CDC_TIME_WINDOW;
    double threshold = CDC_THRESHOLD_FACTOR * CDC_PEDESTAL_SIGMA; // for sparcification
+   HistFills hists;
 
-   // Loop over all cdcStraw tags
+   // Draw the charge and time smearing for all truth hits at once
    hddm_s::CdcStrawList straws = record->getCdcStraws();
    hddm_s::CdcStrawList::iterator iter;
+   unsigned int Nthits = 0;
+   for (iter = straws.begin(); iter != straws.end(); ++iter)
+      Nthits += iter->getCdcStrawTruthHits().size();
+   vector<double> qsmear, tsmear;
+   SampleGaussian(qsmear, Nthits, CDC_PEDESTAL_SIGMA);
+   SampleGaussian(tsmear, Nthits, CDC_TDRIFT_SIGMA*1.0e9);
+   unsigned int ithit = 0;
+
+   // Loop over all cdcStraw tags
    for (iter = straws.begin(); iter != straws.end(); ++iter) {
  
       // If the element already contains a cdcStrawHit list then delete it.
@@ -392,20 +492,20 @@ void SmearCDC(hddm_s::HDDM *record)
       // Create new cdcStrawHit from cdcStrawTruthHit information
       hddm_s::CdcStrawTruthHitList thits = iter->getCdcStrawTruthHits();
       hddm_s::CdcStrawTruthHitList::iterator titer;
-      for (titer = thits.begin(); titer != thits.end(); ++ titer) {
+      for (titer = thits.begin(); titer != thits.end(); ++ titer, ++ithit) {
          // Pedestal-smeared charge
-         double q = titer->getQ() + SampleGaussian(CDC_PEDESTAL_SIGMA);
+         double q = titer->getQ() + qsmear[ithit];
          // Smear out the CDC drift time using the specified sigma.
          // This is for timing resolution from the electronics;
          // diffusion is handled in hdgeant.
-         double t = titer->getT() + SampleGaussian(CDC_TDRIFT_SIGMA)*1.0e9;
+         double t = titer->getT() + tsmear[ithit];
          if (t > TRIGGER_LOOKBACK_TIME && t < t_max && q > threshold) {
             if (iter->getRing() == 1) {
                double t_corr = t-0.33;
-               cdc_drift_time->Fill(t_corr, titer->getD());
-               cdc_drift_smear->Fill(t_corr, titer->getD()-
+               hists.Fill(cdc_drift_time, t_corr, titer->getD());
+               hists.Fill(cdc_drift_smear, t_corr, titer->getD()-
                                              (0.0285*sqrt(t_corr)+0.014));
-               cdc_charge->Fill(q);
+               hists.Fill(cdc_charge, q);
             }
             hits = iter->addCdcStrawHits();
             hits().setT(t);
@@ -437,15 +537,24 @@ void AddNoiseHitsCDC(hddm_s::HDDM *record)
    vector<int> ring_number;
    int Nnoise_straws = 0;
    int Nnoise_hits = 0;
+
+   // One uniform number per straw, drawn as a single block
+   unsigned int Nstraws_total = 0;
+   for (unsigned int ring=1; ring <= NCDC_STRAWS.size(); ring++)
+      Nstraws_total += NCDC_STRAWS[ring-1];
+   vector<double> u;
+   SampleRange(u, Nstraws_total, 0.0, 1.0);
+   unsigned int istraw = 0;
+
    for(unsigned int ring=1; ring <= NCDC_STRAWS.size(); ring++){
       double p[2] = {10.4705, -0.103046};
       double r_prime = (double)(ring+3);
       double N = exp(p[0] + r_prime*p[1]);
       N *= CDC_TIME_WINDOW;
-      for (unsigned int straw=1; straw<=NCDC_STRAWS[ring-1]; straw++) {
+      for (unsigned int straw=1; straw<=NCDC_STRAWS[ring-1]; straw++, istraw++) {
          // Indivdual straw rates should be way less than 1/event so
          // we just use the rate as a probablity.
-         double Nhits = SampleRange(0.0, 1.0)<N ? 1.0:0.0;
+         double Nhits = u[istraw]<N ? 1.0:0.0;
          if(Nhits<1.0)continue;
          int iNhits = (int)floor(Nhits);
          Nstraw_hits.push_back(iNhits);
@@ -458,6 +567,13 @@ void AddNoiseHitsCDC(hddm_s::HDDM *record)
 
    double t_max = TRIGGER_LOOKBACK_TIME + CDC_TIME_WINDOW;
    double threshold = CDC_THRESHOLD_FACTOR * CDC_PEDESTAL_SIGMA; // for sparcification
+   HistFills hists;
+
+   // Charges and times for all of the noise hits
+   vector<double> qnoise, tnoise;
+   SampleGaussian(qnoise, Nnoise_hits, CDC_PEDESTAL_SIGMA);
+   SampleRange(tnoise, Nnoise_hits, TRIGGER_LOOKBACK_TIME, t_max);
+   unsigned int inoise = 0;
    
    // Loop over straws with noise hits
    hddm_s::CentralDCList cdc = record->getCentralDCs();
@@ -476,14 +592,14 @@ void AddNoiseHitsCDC(hddm_s::HDDM *record)
          iter->setRing(ring_number[j]);
          iter->setStraw(straw_number[j]);
       }
-      for (int k=0; k < Nstraw_hits[j]; k++) {
-         double q = SampleGaussian(CDC_PEDESTAL_SIGMA);
+      for (int k=0; k < Nstraw_hits[j]; k++, inoise++) {
+         double q = qnoise[inoise];
          if (q > threshold) {
             hddm_s::CdcStrawHitList hits = iter->addCdcStrawHits();
             hits().setQ(q);
-            hits().setT(SampleRange(TRIGGER_LOOKBACK_TIME,t_max));
-            cdc_charge->Fill(hits().getQ());   
-            cdc_drift_time->Fill(hits().getT(), 0.);
+            hits().setT(tnoise[inoise]);
+            hists.Fill(cdc_charge, hits().getQ());
+            hists.Fill(cdc_drift_time, hits().getT(), 0.);
          }
       }
    }
@@ -495,17 +611,40 @@ void AddNoiseHitsCDC(hddm_s::HDDM *record)
 void SmearFDC(hddm_s::HDDM *record)
 {
    // Calculate ped noise level based on position resolution
-   //   FDC_PED_NOISE = -0.004594 + 0.008711*FDC_CATHODE_SIGMA +
-   //                    0.000010*FDC_CATHODE_SIGMA*FDC_CATHODE_SIGMA; //pC
-   FDC_PED_NOISE = -0.0938 + 0.0485*FDC_CATHODE_SIGMA;
+   //   ped_noise = -0.004594 + 0.008711*FDC_CATHODE_SIGMA +
+   //                0.000010*FDC_CATHODE_SIGMA*FDC_CATHODE_SIGMA; //pC
+   // This is kept local (rather than overwriting FDC_PED_NOISE)
+   // since this routine may run on several threads at once.
+   double ped_noise = -0.0938 + 0.0485*FDC_CATHODE_SIGMA;
    if (FDC_ELOSS_OFF)
-      FDC_PED_NOISE *= 7.0; // empirical  4/29/2009 DL
+      ped_noise *= 7.0; // empirical  4/29/2009 DL
 
    double t_max = TRIGGER_LOOKBACK_TIME + FDC_TIME_WINDOW;
-   double threshold = FDC_THRESHOLD_FACTOR * FDC_PED_NOISE; // for sparcification
+   double threshold = FDC_THRESHOLD_FACTOR * ped_noise; // for sparcification
+   HistFills hists;
 
+   // Draw the smearing for all cathode and anode truth hits at once
    hddm_s::FdcChamberList chambers = record->getFdcChambers();
    hddm_s::FdcChamberList::iterator iter;
+   unsigned int Ncathode_thits = 0;
+   unsigned int Nanode_thits = 0;
+   for (iter = chambers.begin(); iter != chambers.end(); ++iter) {
+      hddm_s::FdcCathodeStripList strips = iter->getFdcCathodeStrips();
+      hddm_s::FdcCathodeStripList::iterator siter;
+      for (siter = strips.begin(); siter != strips.end(); ++siter)
+         Ncathode_thits += siter->getFdcCathodeTruthHits().size();
+      hddm_s::FdcAnodeWireList wires = iter->getFdcAnodeWires();
+      hddm_s::FdcAnodeWireList::iterator witer;
+      for (witer = wires.begin(); witer != wires.end(); ++witer)
+         Nanode_thits += witer->getFdcAnodeTruthHits().size();
+   }
+   vector<double> qsmear, tsmear_cathode, tsmear_anode;
+   SampleGaussian(qsmear, Ncathode_thits, ped_noise);
+   SampleGaussian(tsmear_cathode, Ncathode_thits, FDC_TDRIFT_SIGMA*1.0e9);
+   SampleGaussian(tsmear_anode, Nanode_thits, FDC_TDRIFT_SIGMA*1.0e9);
+   unsigned int icathode = 0;
+   unsigned int ianode = 0;
+
    for (iter = chambers.begin(); iter != chambers.end(); ++iter) {
 
       // Add pedestal noise to strip charge data
@@ -517,18 +656,17 @@ void SmearFDC(hddm_s::HDDM *record)
           hddm_s::FdcCathodeTruthHitList thits = 
                                          siter->getFdcCathodeTruthHits();
           hddm_s::FdcCathodeTruthHitList::iterator titer;
-          for (titer = thits.begin(); titer != thits.end(); ++titer) {
+          for (titer = thits.begin(); titer != thits.end(); ++titer, ++icathode) {
             //if (SampleRange(0.0, 1.0) <= FDC_HIT_DROP_FRACTION)
             //   continue;
-            double q = titer->getQ() + SampleGaussian(FDC_PED_NOISE);
-            double t = titer->getT() +
-                       SampleGaussian(FDC_TDRIFT_SIGMA)*1.0e9;
+            double q = titer->getQ() + qsmear[icathode];
+            double t = titer->getT() + tsmear_cathode[icathode];
             if (q > threshold && t > TRIGGER_LOOKBACK_TIME && t < t_max) {
                hddm_s::FdcCathodeHitList hits = siter->addFdcCathodeHits();
                hits().setQ(q);
                hits().setT(t);
             }
-            fdc_cathode_charge->Fill(q);
+            hists.Fill(fdc_cathode_charge, q);
          }
 
          if (DROP_TRUTH_HITS)
@@ -543,8 +681,8 @@ void SmearFDC(hddm_s::HDDM *record)
          witer->deleteFdcAnodeHits();
          hddm_s::FdcAnodeTruthHitList thits = witer->getFdcAnodeTruthHits();
          hddm_s::FdcAnodeTruthHitList::iterator titer;
-         for (titer = thits.begin(); titer != thits.end(); ++titer) {
-            double t = titer->getT() + SampleGaussian(FDC_TDRIFT_SIGMA)*1.0e9;
+         for (titer = thits.begin(); titer != thits.end(); ++titer, ++ianode) {
+            double t = titer->getT() + tsmear_anode[ianode];
             if (t > TRIGGER_LOOKBACK_TIME && t < t_max) {
                hddm_s::FdcAnodeHitList hits = witer->addFdcAnodeHits();
                hits().setT(t);
@@ -553,13 +691,13 @@ void SmearFDC(hddm_s::HDDM *record)
             if (witer->getLayer() == 1 && witer->getModule() == 1) {
                // 3.7 ns flight time for c=1 to first fdc plane
                double dt = t - titer->getT() - 3.7;
-               fdc_drift_time_smear_hist->Fill(0., dt);
-               fdc_drift_dist_smear_hist->Fill(0.,
+               hists.Fill(fdc_drift_time_smear_hist, 0., dt);
+               hists.Fill(fdc_drift_dist_smear_hist, 0.,
                          dt*(0.5*0.02421/sqrt(titer->getT())+5.09e-4));
-               fdc_drift_time->Fill(t - 3.7, 0.);
+               hists.Fill(fdc_drift_time, t - 3.7, 0.);
             }
          }
-         fdc_anode_mult->Fill(witer->getFdcAnodeHits().size());
+         hists.Fill(fdc_anode_mult, witer->getFdcAnodeHits().size());
 
          if (DROP_TRUTH_HITS)
             witer->deleteFdcAnodeTruthHits();
@@ -601,15 +739,21 @@ void AddNoiseHitsFDC(hddm_s::HDDM *record)
    vector<int> layer_number;
    int Nnoise_wires = 0;
    int Nnoise_hits = 0;
+
+   // One uniform number per wire, drawn as a single block
+   vector<double> u;
+   SampleRange(u, FDC_LAYER_Z.size()*96, 0.0, 1.0);
+   unsigned int iwire = 0;
+
    for (unsigned int layer=1; layer <= FDC_LAYER_Z.size(); layer++) {
       double No = FDC_RATE_COEFFICIENT*exp((double)layer*log(4.0)/24.0);
-      for (unsigned int wire=1; wire <= 96; wire++) {
+      for (unsigned int wire=1; wire <= 96; wire++, iwire++) {
          double rwire = fabs(96.0/2.0 - (double)wire);
          double N = No*log((rwire+0.5)/(rwire-0.5));
 
          // Indivdual wire rates should be way less than 1/event so
          // we just use the rate as a probablity.
-         double Nhits = (SampleRange(0.0, 1.0) < N)? 1.0 : 0.0;
+         double Nhits = (u[iwire] < N)? 1.0 : 0.0;
          if (Nhits < 1.0)
             continue;
          int iNhits = (int)floor(Nhits);
@@ -623,6 +767,14 @@ void AddNoiseHitsFDC(hddm_s::HDDM *record)
 
    double t_max = TRIGGER_LOOKBACK_TIME + FDC_TIME_WINDOW;
    //double threshold = FDC_THRESHOLD_FACTOR * FDC_PED_NOISE; // for sparcification
+   HistFills hists;
+
+   // Energies and times for all of the noise hits
+   double dEsigma=FDC_THRESH_KEV/FDC_THRESHOLD_FACTOR;
+   vector<double> dEnoise, tnoise;
+   SampleGaussian(dEnoise, Nnoise_hits, dEsigma);
+   SampleRange(tnoise, Nnoise_hits, TRIGGER_LOOKBACK_TIME, t_max);
+   unsigned int inoise = 0;
 
    hddm_s::ForwardDCList fdc = record->getForwardDCs();
    hddm_s::FdcCathodeStripList strips = record->getFdcCathodeStrips();
@@ -655,15 +807,14 @@ void AddNoiseHitsFDC(hddm_s::HDDM *record)
          witer->setWire(wire_number[j]);
       }
 
-      double dEsigma=FDC_THRESH_KEV/FDC_THRESHOLD_FACTOR;
-      for (int k=0; k < Nwire_hits[j]; k++) {
+      for (int k=0; k < Nwire_hits[j]; k++, inoise++) {
          // Simulated random hit as pedestal noise 
-         double dE = SampleGaussian(dEsigma);
+         double dE = dEnoise[inoise];
          if (dE > FDC_THRESH_KEV) {
             hddm_s::FdcAnodeHitList hits = witer->addFdcAnodeHits();
             hits().setDE(dE); // what should this be?
-            hits().setT(SampleRange(TRIGGER_LOOKBACK_TIME, t_max));
-            fdc_drift_time->Fill(hits().getT(), 0.);
+            hits().setT(tnoise[inoise]);
+            hists.Fill(fdc_drift_time, hits().getT(), 0.);
          }
       }
    }
@@ -685,16 +836,26 @@ void SmearFCAL(hddm_s::HDDM *record)
    /// To access the "truth" values in DANA, get the DFCALHit objects using the
    /// "TRUTH" tag.
    
-   if (!fcalGeom)
-      fcalGeom = new DFCALGeometry();
+   pthread_once(&calgeom_once, InitCalGeometry);
 
+   // Draw unit normals for the energy and the time of every
+   // truth hit at once. The energy resolution depends on the
+   // hit energy so these are scaled hit by hit below.
    hddm_s::FcalBlockList blocks = record->getFcalBlocks();
    hddm_s::FcalBlockList::iterator iter;
+   unsigned int Nthits = 0;
+   for (iter = blocks.begin(); iter != blocks.end(); ++iter)
+      Nthits += iter->getFcalTruthHits().size();
+   vector<double> Esmear, tsmear;
+   SampleGaussian(Esmear, Nthits, 1.0);
+   SampleGaussian(tsmear, Nthits, 200.0e-3);
+   unsigned int ithit = 0;
+
    for (iter = blocks.begin(); iter != blocks.end(); ++iter) {
       iter->deleteFcalHits();
       hddm_s::FcalTruthHitList thits = iter->getFcalTruthHits();
       hddm_s::FcalTruthHitList::iterator titer;
-      for (titer = thits.begin(); titer != thits.end(); ++titer) {
+      for (titer = thits.begin(); titer != thits.end(); ++titer, ++ithit) {
          // Simulation simulates a grid of blocks for simplicity. 
          // Do not bother smearing inactive blocks. They will be
          // discarded in DEventSourceHDDM.cc while being read in
@@ -703,9 +864,9 @@ void SmearFCAL(hddm_s::HDDM *record)
             continue;
          // Smear the energy and timing of the hit
          double sigma = FCAL_PHOT_STAT_COEF/sqrt(titer->getE());
-         double E = titer->getE() * (1.0 + SampleGaussian(sigma));
+         double E = titer->getE() * (1.0 + sigma*Esmear[ithit]);
          // Smear the time by 200 ps (fixed for now) 7/2/2009 DL
-         double t = titer->getT() + SampleGaussian(200.0e-3);
+         double t = titer->getT() + tsmear[ithit];
          // Apply a single block threshold. 
          if (E >= FCAL_BLOCK_THRESHOLD) {
             hddm_s::FcalHitList hits = iter->addFcalHits();
@@ -727,8 +888,7 @@ void SmearCCAL(hddm_s::HDDM *record)
    /// Smear the CCAL hits using the same procedure as the FCAL above.
    /// See those comments for details.
 
-   if (!ccalGeom)
-      ccalGeom = new DCCALGeometry();
+   pthread_once(&calgeom_once, InitCalGeometry);
 
    hddm_s::CcalBlockList blocks = record->getCcalBlocks();   
    hddm_s::CcalBlockList::iterator iter;
@@ -449,8 +449,11 @@ void GetSiPMHits(hddm_s::HDDM *record,
       }
    }
    
-   if (hNincident_particles)
+   if (hNincident_particles) {
+      pthread_mutex_lock(&root_mutex);
       hNincident_particles->Fill(incident_particles.size());
+      pthread_mutex_unlock(&root_mutex);
+   }
 }
 
 //-----------
@@ -475,8 +478,13 @@ void ApplySamplingFluctuations(map<bcal_index, CellHits> &SiPMHits, vector<Incid
    if(NO_SAMPLING_FLUCTUATIONS)return;
    if(NO_SAMPLING_FLOOR_TERM)BCAL_SAMPLINGCOEFB=0.0; // (redundant, yes, but located in more obvious place here)
 
+   // Draw the fluctuations for all cells at once
+   vector<double> gaus;
+   GetDRandom().FillGaus(gaus, SiPMHits.size());
+   unsigned int igaus = 0;
+
    map<bcal_index, CellHits>::iterator iter=SiPMHits.begin();
-   for(; iter!=SiPMHits.end(); iter++){
+   for(; iter!=SiPMHits.end(); iter++, igaus++){
       CellHits &cellhits = iter->second;
       
       // Find fractional sampling sigma based on deposited energy (whole colorimeter, not just fibers)
@@ -487,7 +495,7 @@ void ApplySamplingFluctuations(map<bcal_index, CellHits> &SiPMHits, vector<Incid
       sigmaSamp *= Etruth;
 
       // Randomly sample the fluctuation
-      double Esmeared = gDRandom.Gaus(Etruth,sigmaSamp);
+      double Esmeared = Etruth + sigmaSamp*gaus[igaus];
 
       // Calculate ratio of smeared to unsmeared
       double ratio = Esmeared/Etruth;
@@ -584,16 +592,21 @@ void ApplyPoissonStatistics(map<bcal_index, CellHits> &SiPMHits)
 
    if(NO_POISSON_STATISTICS)return;
 
+   // Convert to number of PE and sample all cells at once
+   vector<double> mean_pe(SiPMHits.size(), 0.0);
    map<bcal_index, CellHits>::iterator iter=SiPMHits.begin();
-   for(; iter!=SiPMHits.end(); iter++){
+   for(unsigned int i=0; iter!=SiPMHits.end(); iter++, i++){
+      if(iter->second.E>0.0) mean_pe[i] = iter->second.E/BCAL_mevPerPE;
+   }
+   vector<double> Npe;
+   GetDRandom().FillPoisson(Npe, mean_pe);
+
+   iter=SiPMHits.begin();
+   for(unsigned int i=0; iter!=SiPMHits.end(); iter++, i++){
       CellHits &cellhits = iter->second;
 
       if(cellhits.E>0.0){
-         // Convert to number of PE
-         double mean_pe = cellhits.E/BCAL_mevPerPE;
-         
-         int Npe = gDRandom.Poisson(mean_pe);
-         double ratio = (double)Npe/mean_pe;
+         double ratio = Npe[i]/mean_pe[i];
 
          cellhits.E *= ratio;
       }
@@ -695,7 +708,6 @@ void SimpleDarkHitsSmear(map<int, SumHits> &bcalfADC)
 
    if(NO_DARK_PULSES)return;
    
-   double Esmeared = 0;
    double sigma = 0;
    double sigma1 = 43.*BCAL_MEV_PER_ADC_COUNT;  // Approximated from https://logbooks.jlab.org/entry/3339692 (10 degree, 1.4 V OB pedestal data)
    double sigma2 = 46.*BCAL_MEV_PER_ADC_COUNT;  // Approximated from https://logbooks.jlab.org/entry/3339692 (10 degree, 1.4 V OB pedestal data)
@@ -703,7 +715,11 @@ void SimpleDarkHitsSmear(map<int, SumHits> &bcalfADC)
    double sigma4 = 52.*BCAL_MEV_PER_ADC_COUNT;  // Approximated from https://logbooks.jlab.org/entry/3339692 (10 degree, 1.4 V OB pedestal data)
    // Values from logbook entry are in units of integrated ADC counts.  Average SiPM gain ~ 0.029 MeV per integrated ADC count.
 
-   // Loop over all fADC readout cells
+   // Loop over all fADC readout cells, collecting the ones with hits
+   // so the noise for all of them can be drawn as a single block.
+   vector<SumHits*> cells;
+   vector<double> cell_sigma;
+   unsigned int Nsamples = 0;
    for(int imodule=1; imodule<=DBCALGeometry::NBCALMODS; imodule++){
 
       int n_layers = DBCALGeometry::NBCALLAYSIN + DBCALGeometry::NBCALLAYSOUT;
@@ -725,17 +741,26 @@ void SimpleDarkHitsSmear(map<int, SumHits> &bcalfADC)
             // if it doesn't.
             SumHits &sumhits = bcalfADC[fADCId];
 
-            for(int ii = 0; ii < (int)sumhits.EUP.size(); ii++){
-              Esmeared = gDRandom.Gaus(sumhits.EUP[ii],sigma);
-              sumhits.EUP[ii] = Esmeared;
-            }
-            for(int ii = 0; ii < (int)sumhits.EDN.size(); ii++){
-              Esmeared = gDRandom.Gaus(sumhits.EDN[ii],sigma);
-              sumhits.EDN[ii] = Esmeared;
-            }
+            if(sumhits.EUP.empty() && sumhits.EDN.empty()) continue;
+            cells.push_back(&sumhits);
+            cell_sigma.push_back(sigma);
+            Nsamples += sumhits.EUP.size() + sumhits.EDN.size();
          }
       }
    }
+
+   vector<double> gaus;
+   GetDRandom().FillGaus(gaus, Nsamples);
+   unsigned int igaus = 0;
+   for(unsigned int i=0; i<cells.size(); i++){
+      SumHits &sumhits = *cells[i];
+      for(unsigned int ii = 0; ii < sumhits.EUP.size(); ii++){
+         sumhits.EUP[ii] += cell_sigma[i]*gaus[igaus++];
+      }
+      for(unsigned int ii = 0; ii < sumhits.EDN.size(); ii++){
+         sumhits.EDN[ii] += cell_sigma[i]*gaus[igaus++];
+      }
+   }
 }
 
 //-----------
@@ -750,33 +775,45 @@ void ApplyTimeSmearing(double sigma_ns, double sigma_ns_TDC, map<int, fADCHitLis
 
    if(NO_T_SMEAR) return;
 
+   // Count the hits so the smearing can be drawn as one block
+   unsigned int Nhits = 0;
    map<int, fADCHitList>::iterator it = fADCHits.begin();
    for(; it!=fADCHits.end(); it++){
+      Nhits += it->second.uphits.size() + it->second.dnhits.size();
+   }
+   map<int, TDCHitList>::iterator itTDC = TDCHits.begin();
+   for(; itTDC!=TDCHits.end(); itTDC++){
+      Nhits += itTDC->second.uphits.size() + itTDC->second.dnhits.size();
+   }
+   vector<double> gaus;
+   GetDRandom().FillGaus(gaus, Nhits);
+   unsigned int igaus = 0;
+
+   for(it = fADCHits.begin(); it!=fADCHits.end(); it++){
       fADCHitList &hitlist = it->second;
       
       // upstream
       for(unsigned int i=0; i<hitlist.uphits.size(); i++){
-         hitlist.uphits[i].t += gDRandom.Gaus(sigma_ns);
+         hitlist.uphits[i].t += sigma_ns*gaus[igaus++];
       }
 
       // downstream
       for(unsigned int i=0; i<hitlist.dnhits.size(); i++){
-         hitlist.dnhits[i].t += gDRandom.Gaus(sigma_ns);
+         hitlist.dnhits[i].t += sigma_ns*gaus[igaus++];
       }
    }
 
-   map<int, TDCHitList>::iterator itTDC = TDCHits.begin();
-   for(; itTDC!=TDCHits.end(); itTDC++){
+   for(itTDC = TDCHits.begin(); itTDC!=TDCHits.end(); itTDC++){
       TDCHitList &TDChitlist = itTDC->second;
       
       // upstream
       for(unsigned int i=0; i<TDChitlist.uphits.size(); i++){
-         TDChitlist.uphits[i] += gDRandom.Gaus(sigma_ns_TDC);
+         TDChitlist.uphits[i] += sigma_ns_TDC*gaus[igaus++];
       }
 
       // downstream
       for(unsigned int i=0; i<TDChitlist.dnhits.size(); i++){
-         TDChitlist.dnhits[i] += gDRandom.Gaus(sigma_ns_TDC);
+         TDChitlist.dnhits[i] += sigma_ns_TDC*gaus[igaus++];
       }
    }
 }
@@ -11,6 +11,9 @@ using namespace std;
 #include <signal.h>
 #include <time.h>
 #include <stdlib.h>
+#include <pthread.h>
+
+#include <DBoundedQueue.h>
 
 #include <evioFileChannel.hxx>
 #include <evioUtil.hxx>
@@ -30,6 +33,8 @@ void Process(unsigned int &NEvents, unsigned int &NEvents_read);
 vector<char*> INFILENAMES;
 char *OUTFILENAME = NULL;
 int QUIT = 0;
+bool USE_THREADS = false;
+unsigned int QUEUE_DEPTH = 100;
 
 
 
@@ -69,6 +74,8 @@ void ParseCommandLineArguments(int narg, char* argv[])
 			switch(ptr[1]){
 				case 'h': Usage();						break;
 				case 'o': OUTFILENAME=&ptr[2];		break;
+				case 't': USE_THREADS = true;			break;
+				case 'q': QUEUE_DEPTH = atoi(&ptr[2])>1 ? atoi(&ptr[2]):1;	break;
 			}
 		}else{
 			INFILENAMES.push_back(argv[i]);
@@ -97,6 +104,8 @@ void Usage(void)
 	cout<<endl;
 	cout<<"options:"<<endl;
 	cout<<"    -oOutputfile  Set output filename (def. merged_files.evio)"<<endl;
+	cout<<"    -t            Read and parse each input file on its own thread"<<endl;
+	cout<<"    -qDepth       Events buffered per input thread (def. 100)"<<endl;
 	cout<<endl;
 	cout<<" This will merge events from 1 or more EVIO files into a single EVIO file."<<endl;
 	cout<<"This is done at the event level by copying all EVIO banks from the top-level" << endl;
@@ -117,6 +126,46 @@ void ctrlCHandle(int x)
 	cerr<<endl<<"SIGINT received ("<<QUIT<<")....."<<endl;
 }
 
+//-----------
+// DOMReader
+//-----------
+// Reads events from one input file and builds their DOM trees on a
+// separate thread so that parsing of all inputs proceeds in parallel.
+class DOMReader{
+	public:
+		DOMReader(evioFileChannel *chan, const char *filename):chan(chan),filename(filename),queue(QUEUE_DEPTH){}
+
+		evioFileChannel *chan;
+		const char *filename;
+		DBoundedQueue<evioDOMTree*> queue;
+
+		static void* Launch(void *arg){
+			((DOMReader*)arg)->Run();
+			return NULL;
+		}
+
+		void Run(void){
+			while(!QUIT){
+				try{
+					if(! chan->read() ) {
+						cout << endl << "No more events in " << filename << endl;
+						break;
+					}
+				}catch(evioException e){
+					cerr << e.what() << endl;
+					QUIT=true;
+					break;
+				}
+				evioDOMTree *dom = new evioDOMTree(chan);
+				if(!queue.Push(dom)){
+					delete dom;
+					break;
+				}
+			}
+			queue.Done();
+		}
+};
+
 //-----------
 // Process
 //-----------
@@ -135,6 +184,17 @@ void Process(unsigned int &NEvents, unsigned int &NEvents_read)
 		chan->open();
 		ichan.push_back(chan);
 	}
+
+	// Optionally start one reader thread per input file
+	vector<DOMReader*> readers;
+	vector<pthread_t> threads;
+	if(USE_THREADS){
+		threads.resize(ichan.size());
+		for(unsigned int i=0; i<ichan.size(); i++){
+			readers.push_back(new DOMReader(ichan[i], INFILENAMES[i]));
+			pthread_create(&threads[i], NULL, DOMReader::Launch, readers[i]);
+		}
+	}
 	
 	// Loop until an input file runs out of events
 	time_t last_time = time(NULL);
@@ -143,6 +203,12 @@ void Process(unsigned int &NEvents, unsigned int &NEvents_read)
 		// Read in event from each input file, creating a DOM tree for each
 		vector<evioDOMTree*> doms;
 		for(unsigned int i=0; i<ichan.size(); i++){
+			if(USE_THREADS){
+				evioDOMTree *dom;
+				if(!readers[i]->queue.Pop(dom)) break;
+				doms.push_back(dom);
+				continue;
+			}
 			try{
 				if(! ichan[i]->read() ) {
 					cout << endl << "No more events in " << INFILENAMES[i] << endl;
@@ -210,6 +276,15 @@ void Process(unsigned int &NEvents, unsigned int &NEvents_read)
 		
 		if(QUIT)break;
 	}
+
+	// Stop reader threads, discarding anything they read ahead
+	for(unsigned int i=0; i<readers.size(); i++){
+		readers[i]->queue.Abort();
+		evioDOMTree *dom;
+		while(readers[i]->queue.Pop(dom)) delete dom;
+		pthread_join(threads[i], NULL);
+		delete readers[i];
+	}
 	
 	// Close all input files
 	for(unsigned int i=0; i<ichan.size(); i++){
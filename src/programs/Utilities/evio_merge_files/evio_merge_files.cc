@@ -11,6 +11,9 @@ using namespace std;
 #include <signal.h>
 #include <time.h>
 #include <stdlib.h>
+#include <pthread.h>
+
+#include <DBoundedQueue.h>
 
 #include <evioFileChannel.hxx>
 #include <evioUtil.hxx>
@@ -26,10 +29,13 @@ void ParseCommandLineArguments(int narg, char* argv[]);
 void Usage(void);
 void ctrlCHandle(int x);
 void Process(unsigned int &NEvents, unsigned int &NEvents_read);
+void ProcessThreaded(unsigned int &NEvents, unsigned int &NEvents_read);
 
 vector<char*> INFILENAMES;
 char *OUTFILENAME = NULL;
 int QUIT = 0;
+unsigned int NTHREADS = 0;
+unsigned int QUEUE_DEPTH = 200;
 
 
 
@@ -47,7 +53,10 @@ int main(int narg,char* argv[])
 	unsigned int NEvents_read = 0;
 
 	// Process all events
-	Process(NEvents, NEvents_read);
+	if(NTHREADS>0)
+		ProcessThreaded(NEvents, NEvents_read);
+	else
+		Process(NEvents, NEvents_read);
 	
 	cout<<endl;
 	cout<<" "<<NEvents_read<<" events read, "<<NEvents<<" events written"<<endl;
@@ -69,6 +78,8 @@ void ParseCommandLineArguments(int narg, char* argv[])
 			switch(ptr[1]){
 				case 'h': Usage();						break;
 				case 'o': OUTFILENAME=&ptr[2];		break;
+				case 't': NTHREADS = atoi(&ptr[2])>1 ? atoi(&ptr[2]):1;	break;
+				case 'q': QUEUE_DEPTH = atoi(&ptr[2])>1 ? atoi(&ptr[2]):1;	break;
 			}
 		}else{
 			INFILENAMES.push_back(argv[i]);
@@ -97,6 +108,9 @@ void Usage(void)
 	cout<<endl;
 	cout<<"options:"<<endl;
 	cout<<"    -oOutputfile  Set output filename (def. merged.evio)"<<endl;
+	cout<<"    -tNthreads    Read up to Nthreads input files in parallel and"<<endl;
+	cout<<"                  copy events as raw buffers without building DOM trees"<<endl;
+	cout<<"    -qDepth       Events buffered per input thread (def. 200)"<<endl;
 	cout<<endl;
 	cout<<" This will merge together multiple EVIO files into a single EVIO file."<<endl;
 	cout<<" "<<endl;
@@ -212,3 +226,146 @@ void Process(unsigned int &NEvents, unsigned int &NEvents_read)
 
 }
 
+
+//-----------
+// RawEvent
+//-----------
+// Copy of one event buffer, handed from a reader thread to the writer
+class RawEvent{
+	public:
+		RawEvent(const uint32_t *buff){
+			uint32_t Nwords = buff[0] + 1;   // first word is length of remainder
+			words.assign(buff, buff + Nwords);
+		}
+		vector<uint32_t> words;
+};
+
+//-----------
+// RawReader
+//-----------
+class RawReader{
+	public:
+		RawReader(const char *filename):filename(filename),queue(QUEUE_DEPTH),ok(true){}
+
+		const char *filename;
+		DBoundedQueue<RawEvent*> queue;
+		bool ok;
+
+		static void* Launch(void *arg){
+			((RawReader*)arg)->Run();
+			return NULL;
+		}
+
+		void Run(void){
+			evioFileChannel *ichan = NULL;
+			try{
+				ichan = new evioFileChannel(filename, "r");
+				ichan->open();
+				while(!QUIT){
+					if(! ichan->read() ) break;
+					RawEvent *event = new RawEvent(ichan->getBuffer());
+					if(!queue.Push(event)){
+						delete event;
+						break;
+					}
+				}
+			}catch(evioException e){
+				cerr << endl << filename << " : " << e.what() << endl;
+				ok = false;
+			}
+			if(ichan){
+				try{
+					ichan->close();
+				}catch(...){}
+				delete ichan;
+			}
+			queue.Done();
+		}
+};
+
+//-----------
+// ProcessThreaded
+//-----------
+void ProcessThreaded(unsigned int &NEvents, unsigned int &NEvents_read)
+{
+	/// Each input file is read on its own thread (up to NTHREADS at once)
+	/// and events are passed to this thread as raw EVIO buffers which are
+	/// written out unmodified. Events are written in input file order so
+	/// the output is the same as for the serial merge.
+
+	// Output file
+	cout<<" output file: "<<OUTFILENAME<<endl;
+	evioFileChannel ochan(OUTFILENAME, "w");
+	ochan.open();
+
+	cout<<" Reading with up to "<<NTHREADS<<" input threads (queue depth "<<QUEUE_DEPTH<<")"<<endl;
+
+	unsigned int Nfiles = INFILENAMES.size();
+	vector<RawReader*> readers(Nfiles, (RawReader*)NULL);
+	vector<pthread_t> threads(Nfiles);
+	unsigned int Nstarted = 0;
+	unsigned long Nwriter_waits = 0;
+
+	time_t last_time = time(NULL);
+	for(unsigned int i=0; i<Nfiles; i++){
+
+		// Keep up to NTHREADS readers running ahead of the writer
+		while(Nstarted<Nfiles && Nstarted<i+NTHREADS && !QUIT){
+			readers[Nstarted] = new RawReader(INFILENAMES[Nstarted]);
+			pthread_create(&threads[Nstarted], NULL, RawReader::Launch, readers[Nstarted]);
+			Nstarted++;
+		}
+		if(i>=Nstarted) break;
+
+		cout << "Opening input file : \"" << INFILENAMES[i] << "\"" << endl;
+
+		RawEvent *event;
+		while(readers[i]->queue.Pop(event)){
+			NEvents_read++;
+			try{
+				ochan.write(&event->words[0]);
+				NEvents++;
+			}catch(evioException e){
+				cerr << e.what() << endl;
+				QUIT=true;
+			}
+			delete event;
+
+			// Update ticker
+			time_t now = time(NULL);
+			if(now != last_time){
+				cout<<"  "<<NEvents_read<<" events read     ("<<NEvents<<" event written) \r";cout.flush();
+				last_time = now;
+			}
+
+			if(QUIT){
+				readers[i]->queue.Abort();
+				break;
+			}
+		}
+		while(readers[i]->queue.Pop(event)) delete event;
+
+		pthread_join(threads[i], NULL);
+		Nwriter_waits += readers[i]->queue.GetNpopWaits();
+		if(!readers[i]->ok) QUIT=true;
+		delete readers[i];
+		readers[i] = NULL;
+		cout << endl << "No more events in " << INFILENAMES[i] << endl;
+		if(QUIT) break;
+	}
+
+	// Clean up any readers left behind by an early exit
+	for(unsigned int i=0; i<Nstarted; i++){
+		if(readers[i]==NULL) continue;
+		readers[i]->queue.Abort();
+		RawEvent *event;
+		while(readers[i]->queue.Pop(event)) delete event;
+		pthread_join(threads[i], NULL);
+		delete readers[i];
+	}
+
+	cout<<" writer waited on input "<<Nwriter_waits<<" times"<<endl;
+
+	// Close output file
+	ochan.close();
+}
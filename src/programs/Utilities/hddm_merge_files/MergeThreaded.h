@@ -0,0 +1,155 @@
+// $Id$
+//
+// Multi-threaded merge of decoded HDDM records. Each input file is
+// opened and decoded on its own thread, feeding a bounded queue. The
+// calling thread drains the queues in input-file order and does all
+// of the writing (and therefore all of the output compression), so
+// the output file is identical to that of the serial merge. At most
+// NTHREADS input files are being read ahead at any one time.
+
+#ifndef _MergeThreaded_
+#define _MergeThreaded_
+
+#include <pthread.h>
+#include <stdexcept>
+
+#include <DBoundedQueue.h>
+
+#include "hddm_merge_files.h"
+
+template<typename T_HDDM, typename T_ISTREAM>
+class MergeReader{
+   public:
+      MergeReader(const char *filename)
+         :filename(filename), queue(QUEUE_DEPTH), ok(true) {}
+
+      const char *filename;
+      DBoundedQueue<T_HDDM*> queue;
+      bool ok;
+
+      static void* Launch(void *arg) {
+         ((MergeReader*)arg)->Run();
+         return NULL;
+      }
+
+      void Run(void) {
+         std::ifstream ifs(filename);
+         if (! ifs.is_open()) {
+            std::cerr << " Error opening input file \"" << filename
+                      << "\"!" << std::endl;
+            ok = false;
+            queue.Done();
+            return;
+         }
+         try {
+            T_ISTREAM fin(ifs);
+            while (ifs.good() && !QUIT) {
+               T_HDDM *record = new T_HDDM;
+               fin >> *record;
+               if (! queue.Push(record)) {
+                  delete record;
+                  break;
+               }
+            }
+         }
+         catch (std::exception &e) {
+            std::cerr << std::endl << " Error reading \"" << filename
+                      << "\": " << e.what() << std::endl;
+            ok = false;
+         }
+         queue.Done();
+      }
+};
+
+template<typename T_HDDM, typename T_ISTREAM, typename T_OSTREAM>
+void MergeThreaded(T_OSTREAM &fout, unsigned int &NEvents,
+                   unsigned int &NEvents_read)
+{
+   typedef MergeReader<T_HDDM,T_ISTREAM> reader_t;
+
+   unsigned int Nfiles = INFILENAMES.size();
+   std::vector<reader_t*> readers(Nfiles, (reader_t*)NULL);
+   std::vector<pthread_t> threads(Nfiles);
+   unsigned int Nstarted = 0;
+   unsigned long Nwriter_waits = 0;
+   unsigned long Nreader_waits = 0;
+   bool failed = false;
+
+   std::cout << " Reading with up to " << NTHREADS
+             << " input threads (queue depth " << QUEUE_DEPTH << ")"
+             << std::endl;
+
+   time_t last_time = time(NULL);
+   for (unsigned int i=0; i<Nfiles; i++) {
+
+      // Keep up to NTHREADS readers running ahead of the writer
+      while (Nstarted < Nfiles && Nstarted < i+NTHREADS && !QUIT) {
+         readers[Nstarted] = new reader_t(INFILENAMES[Nstarted]);
+         pthread_create(&threads[Nstarted], NULL, reader_t::Launch,
+                        readers[Nstarted]);
+         Nstarted++;
+      }
+      if (i >= Nstarted)
+         break;
+
+      std::cout << " input file: " << INFILENAMES[i] << std::endl;
+
+      T_HDDM *record;
+      while (readers[i]->queue.Pop(record)) {
+         NEvents_read++;
+         fout << *record;
+         NEvents++;
+         delete record;
+
+         // Update ticker
+         time_t now = time(NULL);
+         if (now != last_time) {
+            std::cout << "  " << NEvents_read << " events read     ("
+                      << NEvents << " event written) \r";
+            std::cout.flush();
+            last_time = now;
+         }
+
+         // Stop on SIGINT. Readers still running are aborted and
+         // anything they already decoded is discarded below.
+         if (QUIT) {
+            readers[i]->queue.Abort();
+            break;
+         }
+      }
+      while (readers[i]->queue.Pop(record))
+         delete record;
+
+      pthread_join(threads[i], NULL);
+      Nwriter_waits += readers[i]->queue.GetNpopWaits();
+      Nreader_waits += readers[i]->queue.GetNpushWaits();
+      if (! readers[i]->ok)
+         failed = true;
+      delete readers[i];
+      readers[i] = NULL;
+      if (failed || QUIT)
+         break;
+   }
+
+   // Clean up any readers left behind by an early exit
+   for (unsigned int i=0; i<Nstarted; i++) {
+      if (readers[i] == NULL)
+         continue;
+      readers[i]->queue.Abort();
+      T_HDDM *record;
+      while (readers[i]->queue.Pop(record))
+         delete record;
+      pthread_join(threads[i], NULL);
+      delete readers[i];
+   }
+
+   std::cout << std::endl;
+   std::cout << " writer waited on input " << Nwriter_waits
+             << " times, readers waited on output " << Nreader_waits
+             << " times" << std::endl;
+
+   if (failed)
+      exit(-1);
+}
+
+#endif // _MergeThreaded_
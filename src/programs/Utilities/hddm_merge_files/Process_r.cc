@@ -3,6 +3,7 @@
 // Created Oct 25, 2013  Kei Moriya
 
 #include "hddm_merge_files.h"
+#include "MergeThreaded.h"
 
 #include <HDDM/hddm_r.hpp>
 using namespace hddm_r;
@@ -39,6 +40,15 @@ void Process_r(unsigned int &NEvents, unsigned int &NEvents_read)
       std::cout << " HDDM integrity checks disabled" << std::endl;
    }
 
+   // Read and decode inputs on separate threads if requested
+   if (NTHREADS > 1) {
+      MergeThreaded<hddm_r::HDDM, hddm_r::istream>(*ostr, NEvents,
+                                                    NEvents_read);
+      delete ostr;
+      ofs.close();
+      return;
+   }
+
    // Loop over input files
    time_t last_time = time(NULL);
    for (unsigned int i=0; i<INFILENAMES.size(); i++) {
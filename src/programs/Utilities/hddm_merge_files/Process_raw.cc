@@ -0,0 +1,344 @@
+// $Id$
+//
+// Raw record copy for hddm_merge_files. When none of the inputs are
+// compressed and no compression is requested on output, the records
+// can be moved from input to output as opaque byte blocks without
+// ever being decoded. This works for any HDDM class as long as all
+// of the input files carry the same template header. Each input file
+// is read on its own thread (up to NTHREADS at once) and the blocks
+// are written in input-file order so the result is the same as the
+// decode/encode merge.
+
+#include "hddm_merge_files.h"
+
+#include <string.h>
+#include <pthread.h>
+#include <string>
+
+#include <DBoundedQueue.h>
+
+// Records are grouped into blocks of about this many bytes before
+// being handed to the writer to keep queue traffic low.
+static const size_t RAW_BLOCK_SIZE = 4*1024*1024;
+
+// Compression bits as defined in the generated hddm_X.hpp headers
+static const int RAW_BITS_COMPRESSION = 0xf0;
+
+class RawBlock{
+   public:
+      RawBlock():Nrecords(0) {}
+      std::vector<char> data;
+      unsigned int Nrecords;
+};
+
+//-----------
+// GetXDRint  --  decode a big-endian 32 bit XDR integer
+//-----------
+static int GetXDRint(const char *buf)
+{
+   const unsigned char *b = (const unsigned char*)buf;
+   return (int)(((unsigned int)b[0]<<24) | ((unsigned int)b[1]<<16) |
+                ((unsigned int)b[2]<<8) | (unsigned int)b[3]);
+}
+
+//-----------
+// PutXDRint
+//-----------
+static void PutXDRint(char *buf, int val)
+{
+   unsigned int v = (unsigned int)val;
+   buf[0] = (char)(v>>24);
+   buf[1] = (char)(v>>16);
+   buf[2] = (char)(v>>8);
+   buf[3] = (char)v;
+}
+
+//-----------
+// ReadHeader  --  read the xml template header up to </HDDM>
+//-----------
+static bool ReadHeader(std::istream &ifs, std::string &header)
+{
+   header = "";
+   std::string line;
+   while (std::getline(ifs, line).good()) {
+      header += line + "\n";
+      if (line == "</HDDM>")
+         return header.substr(0,6) == "<HDDM ";
+   }
+   return false;
+}
+
+//-----------
+// ReadStatusToken  --  consume leading status tokens, returning the
+//                      stream status bits (0 if there is no token)
+//-----------
+static bool ReadStatusToken(std::istream &ifs, int &status_bits)
+{
+   status_bits = 0;
+   char buf[16];
+   while (true) {
+      ifs.read(buf, 4);
+      if (ifs.eof() && ifs.gcount() == 0) {
+         ifs.clear();
+         return true;
+      }
+      if (! ifs.good())
+         return false;
+      if (GetXDRint(buf) != 1) {
+         ifs.seekg(-4, std::ios_base::cur);
+         return ifs.good();
+      }
+      ifs.read(buf+4, 12);
+      if (! ifs.good() || GetXDRint(buf+4) != 8 || GetXDRint(buf+8) != 0)
+         return false;
+      status_bits = GetXDRint(buf+12);
+   }
+}
+
+class RawReader{
+   public:
+      RawReader(const char *filename, int status_bits)
+         :filename(filename), status_bits(status_bits),
+          queue(QUEUE_DEPTH<8 ? 2:QUEUE_DEPTH/4), ok(true) {}
+
+      const char *filename;
+      int status_bits;
+      DBoundedQueue<RawBlock*> queue;
+      bool ok;
+
+      static void* Launch(void *arg) {
+         ((RawReader*)arg)->Run();
+         return NULL;
+      }
+
+      void Run(void);
+};
+
+//-----------
+// RawReader::Run
+//-----------
+void RawReader::Run(void)
+{
+   std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+   std::string header;
+   int bits;
+   if (! ifs.is_open() || ! ReadHeader(ifs, header) ||
+       ! ReadStatusToken(ifs, bits) || bits != status_bits)
+   {
+      std::cerr << std::endl << " Error re-reading header of \""
+                << filename << "\"!" << std::endl;
+      ok = false;
+      queue.Done();
+      return;
+   }
+   int trailer = (status_bits & 0x01)? 4 : 0;  // crc32 word
+
+   RawBlock *block = new RawBlock;
+   block->data.reserve(RAW_BLOCK_SIZE + 100000);
+   char sizebuf[16];
+   while (! QUIT) {
+      ifs.read(sizebuf, 4);
+      if (ifs.gcount() == 0 && ifs.eof())
+         break;
+      if (! ifs.good()) {
+         std::cerr << std::endl << " Truncated record in \""
+                   << filename << "\"" << std::endl;
+         ok = false;
+         break;
+      }
+      int size = GetXDRint(sizebuf);
+      if (size == 1) {
+         // mid-stream status token, must not change anything
+         ifs.read(sizebuf+4, 12);
+         if (! ifs.good() || GetXDRint(sizebuf+12) != status_bits) {
+            std::cerr << std::endl << " Stream flags change in mid-file \""
+                      << filename << "\", cannot raw copy!" << std::endl;
+            ok = false;
+            break;
+         }
+         continue;
+      }
+      if (size < 0) {
+         std::cerr << std::endl << " Corrupt record size in \""
+                   << filename << "\"" << std::endl;
+         ok = false;
+         break;
+      }
+      size_t start = block->data.size();
+      block->data.resize(start + 4 + size + trailer);
+      memcpy(&block->data[start], sizebuf, 4);
+      ifs.read(&block->data[start+4], size + trailer);
+      if (! ifs.good()) {
+         std::cerr << std::endl << " Truncated record in \""
+                   << filename << "\"" << std::endl;
+         block->data.resize(start);
+         ok = false;
+         break;
+      }
+      block->Nrecords++;
+      if (block->data.size() >= RAW_BLOCK_SIZE) {
+         if (! queue.Push(block)) {
+            block = NULL;
+            break;
+         }
+         block = new RawBlock;
+         block->data.reserve(RAW_BLOCK_SIZE + 100000);
+      }
+   }
+   if (block) {
+      if (block->Nrecords == 0 || ! queue.Push(block))
+         delete block;
+   }
+   queue.Done();
+}
+
+//-----------
+// Process_raw  --  merge without decoding, returns false if the inputs
+//                  are not suitable for raw copying (nothing written)
+//-----------
+bool Process_raw(unsigned int &NEvents, unsigned int &NEvents_read)
+{
+   if (HDDM_USE_COMPRESSION) {
+      std::cout << " Raw copy is not possible with output compression"
+                   " enabled, records will be decoded" << std::endl;
+      return false;
+   }
+
+   // Check that all inputs share one header and uncompressed format
+   std::string header;
+   int status_bits = 0;
+   for (unsigned int i=0; i<INFILENAMES.size(); i++) {
+      std::ifstream ifs(INFILENAMES[i], std::ios::in | std::ios::binary);
+      if (! ifs.is_open()) {
+         std::cout << " Error opening input file \"" << INFILENAMES[i]
+                   << "\"!" << std::endl;
+         exit(-1);
+      }
+      std::string hdr;
+      int bits;
+      if (! ReadHeader(ifs, hdr) || ! ReadStatusToken(ifs, bits)) {
+         std::cout << " Invalid hddm header in \"" << INFILENAMES[i]
+                   << "\"" << std::endl;
+         exit(-1);
+      }
+      if (i == 0) {
+         header = hdr;
+         status_bits = bits;
+      }
+      else if (hdr != header) {
+         std::cout << " \"" << INFILENAMES[i] << "\" has a different"
+                      " hddm template, records will be decoded"
+                   << std::endl;
+         return false;
+      }
+      else if (bits != status_bits) {
+         std::cout << " \"" << INFILENAMES[i] << "\" has different"
+                      " stream flags, records will be decoded" << std::endl;
+         return false;
+      }
+      if ((bits & RAW_BITS_COMPRESSION) != 0) {
+         std::cout << " \"" << INFILENAMES[i] << "\" is compressed,"
+                      " records will be decoded" << std::endl;
+         return false;
+      }
+   }
+   if (HDDM_USE_INTEGRITY_CHECKS != ((status_bits & 0x01) != 0)) {
+      std::cout << " Output integrity checks follow the input files ("
+                << (((status_bits & 0x01) != 0)? "on":"off") << ")"
+                << std::endl;
+   }
+
+   // Output file
+   std::cout << " output file: " << OUTFILENAME << " (raw copy)" << std::endl;
+   std::ofstream ofs(OUTFILENAME, std::ios::out | std::ios::binary);
+   if (! ofs.is_open()) {
+      std::cout << " Error opening output file \"" << OUTFILENAME
+                << "\"!" << std::endl;
+      exit(-1);
+   }
+   ofs << header;
+   if (status_bits != 0) {
+      char token[16];
+      PutXDRint(token, 1);
+      PutXDRint(token+4, 8);
+      PutXDRint(token+8, 0);
+      PutXDRint(token+12, status_bits);
+      ofs.write(token, 16);
+   }
+
+   unsigned int Nfiles = INFILENAMES.size();
+   std::vector<RawReader*> readers(Nfiles, (RawReader*)NULL);
+   std::vector<pthread_t> threads(Nfiles);
+   unsigned int Nstarted = 0;
+   bool failed = false;
+
+   time_t last_time = time(NULL);
+   for (unsigned int i=0; i<Nfiles; i++) {
+      while (Nstarted < Nfiles && Nstarted < i+NTHREADS && !QUIT) {
+         readers[Nstarted] = new RawReader(INFILENAMES[Nstarted],
+                                           status_bits);
+         pthread_create(&threads[Nstarted], NULL, RawReader::Launch,
+                        readers[Nstarted]);
+         Nstarted++;
+      }
+      if (i >= Nstarted)
+         break;
+
+      std::cout << " input file: " << INFILENAMES[i] << std::endl;
+
+      RawBlock *block;
+      while (readers[i]->queue.Pop(block)) {
+         ofs.write(&block->data[0], block->data.size());
+         NEvents_read += block->Nrecords;
+         NEvents += block->Nrecords;
+         delete block;
+         if (! ofs.good()) {
+            std::cout << std::endl << " Write error on output file!"
+                      << std::endl;
+            failed = true;
+            readers[i]->queue.Abort();
+            break;
+         }
+
+         // Update ticker
+         time_t now = time(NULL);
+         if (now != last_time) {
+            std::cout << "  " << NEvents_read << " events read     ("
+                      << NEvents << " event written) \r";
+            std::cout.flush();
+            last_time = now;
+         }
+         if (QUIT) {
+            readers[i]->queue.Abort();
+            break;
+         }
+      }
+      while (readers[i]->queue.Pop(block))
+         delete block;
+
+      pthread_join(threads[i], NULL);
+      if (! readers[i]->ok)
+         failed = true;
+      delete readers[i];
+      readers[i] = NULL;
+      if (failed || QUIT)
+         break;
+   }
+
+   // Clean up any readers left behind by an early exit
+   for (unsigned int i=0; i<Nstarted; i++) {
+      if (readers[i] == NULL)
+         continue;
+      readers[i]->queue.Abort();
+      RawBlock *block;
+      while (readers[i]->queue.Pop(block))
+         delete block;
+      pthread_join(threads[i], NULL);
+      delete readers[i];
+   }
+
+   ofs.close();
+   if (failed)
+      exit(-1);
+   return true;
+}
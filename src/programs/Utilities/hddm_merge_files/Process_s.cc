@@ -3,6 +3,7 @@
 // Created Oct 25, 2013  Kei Moriya
 
 #include "hddm_merge_files.h"
+#include "MergeThreaded.h"
 
 #include <HDDM/hddm_s.hpp>
 
@@ -37,6 +38,15 @@ void Process_s(unsigned int &NEvents, unsigned int &NEvents_read)
       std::cout << " HDDM integrity checks disabled" << std::endl;
    }
 
+   // Read and decode inputs on separate threads if requested
+   if (NTHREADS > 1) {
+      MergeThreaded<hddm_s::HDDM, hddm_s::istream>(*fout, NEvents,
+                                                    NEvents_read);
+      delete fout;
+      ofs.close();
+      return;
+   }
+
    // Loop over input files
    time_t last_time = time(NULL);
    for (unsigned int i=0; i<INFILENAMES.size(); i++) {
@@ -14,6 +14,9 @@ char *OUTFILENAME = NULL;
 int QUIT = 0;
 bool HDDM_USE_COMPRESSION = false;
 bool HDDM_USE_INTEGRITY_CHECKS = false;
+unsigned int NTHREADS = 1;
+unsigned int QUEUE_DEPTH = 200;
+bool RAW_COPY = false;
 
 
 //-----------
@@ -29,8 +32,12 @@ int main(int narg,char* argv[])
    unsigned int NEvents = 0;
    unsigned int NEvents_read = 0;
 
-   // Each HDDM class must have it's own cull routine
-   if (HDDM_CLASS == "s")
+   // Raw copy skips decoding altogether when the inputs allow it,
+   // otherwise each HDDM class must have it's own cull routine
+   if (RAW_COPY && Process_raw(NEvents, NEvents_read)) {
+      // records were copied without being decoded
+   }
+   else if (HDDM_CLASS == "s")
       Process_s(NEvents, NEvents_read);
    else if (HDDM_CLASS == "r")
       Process_r(NEvents, NEvents_read);
@@ -73,6 +80,15 @@ void ParseCommandLineArguments(int narg, char* argv[])
             case 'I':
                HDDM_USE_INTEGRITY_CHECKS = true;
                break;
+            case 't':
+               NTHREADS = (atoi(&ptr[2]) > 1)? atoi(&ptr[2]) : 1;
+               break;
+            case 'q':
+               QUEUE_DEPTH = (atoi(&ptr[2]) > 1)? atoi(&ptr[2]) : 1;
+               break;
+            case 'R':
+               RAW_COPY = true;
+               break;
          }
       }
       else {
@@ -109,6 +125,14 @@ void Usage(void)
                 " the output hddm stream" << std::endl;
    std::cout << "    -C            Enable data compression on"
                 " the output hddm stream" << std::endl;
+   std::cout << "    -tNthreads    Read and decode up to Nthreads input"
+                " files in parallel (def. 1)" << std::endl;
+   std::cout << "    -qDepth       Records buffered per input thread"
+                " (def. 200)" << std::endl;
+   std::cout << "    -R            Copy records without decoding them"
+                " when no input" << std::endl;
+   std::cout << "                  is compressed and -C is not given"
+             << std::endl;
    std::cout << std::endl;
    std::cout << " This will merge 1 or more HDDM files "
                 "into a single HDDM file." << std::endl;
@@ -16,6 +16,9 @@ extern char *OUTFILENAME;
 extern int QUIT;
 extern bool HDDM_USE_COMPRESSION;
 extern bool HDDM_USE_INTEGRITY_CHECKS;
+extern unsigned int NTHREADS;
+extern unsigned int QUEUE_DEPTH;
+extern bool RAW_COPY;
 
 #define _DBG_ cout<<__FILE__<<":"<<__LINE__<<" "
 #define _DBG__ cout<<__FILE__<<":"<<__LINE__<<endl
@@ -23,3 +26,4 @@ extern bool HDDM_USE_INTEGRITY_CHECKS;
 
 void Process_s(unsigned int &NEvents, unsigned int &NEvents_read);
 void Process_r(unsigned int &NEvents, unsigned int &NEvents_read);
+bool Process_raw(unsigned int &NEvents, unsigned int &NEvents_read);
@@ -0,0 +1,582 @@
+// $Id$
+//
+// rest2columns  --  convert REST files into the columnar format
+//                   read by DEventSourceRESTColumns (see
+//                   libraries/HDDM/DRESTColumns.h)
+//
+// Only untagged objects are converted. Monte Carlo truth (reaction,
+// vertices) is not, so analyses that need it should stay on the
+// REST files themselves.
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#include <csignal>
+#include <cmath>
+#include <ctime>
+
+#include <HDDM/hddm_r.hpp>
+#include <HDDM/DRESTColumns.h>
+
+using namespace std;
+using namespace DRESTColumns;
+
+void ParseCommandLineArguments(int narg, char* argv[]);
+void Usage(void);
+void ctrlCHandle(int x);
+void Convert(hddm_r::ReconstructedPhysicsEvent &re);
+
+vector<char*> INFILENAMES;
+char *OUTFILENAME = NULL;
+unsigned int EVENTS_PER_CHUNK = 10000;
+int QUIT = 0;
+
+DRESTColumnWriter *WRITER = NULL;
+unsigned int COLUMN[kNcolumns];  // column handles, group handles for offsets
+
+inline void NewRow(column_id_t offsets) { WRITER->NewRow(COLUMN[offsets]); }
+inline void FillInt(column_id_t id, int val) { WRITER->Fill(COLUMN[id], val); }
+inline void FillFloat(column_id_t id, float val) { WRITER->Fill(COLUMN[id], val); }
+
+
+//-----------
+// main
+//-----------
+int main(int narg,char* argv[])
+{
+   // Set up to catch SIGINTs for graceful exits
+   signal(SIGINT, ctrlCHandle);
+
+   ParseCommandLineArguments(narg, argv);
+
+   std::cout << " output file: " << OUTFILENAME << std::endl;
+   WRITER = new DRESTColumnWriter(OUTFILENAME, EVENTS_PER_CHUNK);
+   if (! WRITER->IsOpen()) {
+      std::cout << " Error opening output file \"" << OUTFILENAME
+                << "\"!" << std::endl;
+      exit(-1);
+   }
+
+   // The table of columns lists each group's offsets column first
+   // followed by its fields.
+   unsigned int group = 0;
+   for (int i=0; i < kNcolumns; i++) {
+      string name = COLUMNS[i].name;
+      size_t dot = name.find('.');
+      if (COLUMNS[i].type == kOffset) {
+         group = WRITER->AddGroup(name.substr(0, dot));
+         COLUMN[i] = group;
+      }
+      else {
+         COLUMN[i] = WRITER->AddColumn(group, name.substr(dot+1),
+                                       COLUMNS[i].type);
+      }
+   }
+
+   // Loop over input files
+   unsigned int NEvents = 0;
+   time_t last_time = time(NULL);
+   for (unsigned int i=0; i<INFILENAMES.size(); i++) {
+      std::cout << " input file: " << INFILENAMES[i] << std::endl;
+
+      std::ifstream ifs(INFILENAMES[i]);
+      if (!ifs.is_open()) {
+         std::cout << " Error opening input file \"" << INFILENAMES[i]
+                   << "\"!" << std::endl;
+         exit(-1);
+      }
+      hddm_r::istream istr(ifs);
+
+      hddm_r::HDDM record;
+      while (!QUIT) {
+         try {
+            istr >> record;
+         }
+         catch(std::runtime_error &e) {
+            break;
+         }
+         if (!ifs.good()) {
+            break;
+         }
+         hddm_r::ReconstructedPhysicsEvent &re
+                     = record.getReconstructedPhysicsEvent();
+
+         // Skip comment records
+         if (re.getRunNo() == 0 && re.getEventNo() == 0) {
+            continue;
+         }
+
+         WRITER->StartEvent(re.getRunNo(), re.getEventNo());
+         Convert(re);
+         if (!WRITER->EndEvent()) {
+            std::cout << " Error converting event " << re.getEventNo()
+                      << std::endl;
+            exit(-1);
+         }
+         NEvents++;
+
+         // Update ticker
+         time_t t = time(NULL);
+         if (t != last_time) {
+            std::cout << "\r  " << NEvents << " events converted"
+                      << std::flush;
+            last_time = t;
+         }
+      }
+   }
+
+   bool ok = WRITER->Close();
+   delete WRITER;
+
+   std::cout << std::endl;
+   std::cout << " " << NEvents << " events written" << std::endl;
+   return ok? 0 : -1;
+}
+
+//-----------
+// Convert
+//-----------
+void Convert(hddm_r::ReconstructedPhysicsEvent &re)
+{
+   /// Fill the columns for one event. Only the untagged elements are
+   /// used and the indices stored in the match groups refer to them.
+
+   // RF time
+   const hddm_r::RFtimeList &rftimes = re.getRFtimes();
+   hddm_r::RFtimeList::iterator rfiter;
+   for (rfiter = rftimes.begin(); rfiter != rftimes.end(); ++rfiter) {
+      if (rfiter->getJtag() != "")
+         continue;
+      NewRow(kRFOffsets);
+      FillFloat(kRFTsync, rfiter->getTsync());
+   }
+
+   // Tagger
+   const hddm_r::TaggerHitList &tags = re.getTaggerHits();
+   hddm_r::TaggerHitList::iterator tagiter;
+   for (tagiter = tags.begin(); tagiter != tags.end(); ++tagiter) {
+      if (tagiter->getJtag() != "")
+         continue;
+      NewRow(kTaggerOffsets);
+      FillFloat(kTaggerE, tagiter->getE());
+      FillFloat(kTaggerT, tagiter->getT());
+      FillInt(kTaggerSystem, 0);
+   }
+   const hddm_r::TagmBeamPhotonList &tagms = re.getTagmBeamPhotons();
+   hddm_r::TagmBeamPhotonList::iterator tagmiter;
+   for (tagmiter = tagms.begin(); tagmiter != tagms.end(); ++tagmiter) {
+      if (tagmiter->getJtag() != "")
+         continue;
+      NewRow(kTaggerOffsets);
+      FillFloat(kTaggerE, tagmiter->getE());
+      FillFloat(kTaggerT, tagmiter->getT());
+      FillInt(kTaggerSystem, 1);
+   }
+   const hddm_r::TaghBeamPhotonList &taghs = re.getTaghBeamPhotons();
+   hddm_r::TaghBeamPhotonList::iterator taghiter;
+   for (taghiter = taghs.begin(); taghiter != taghs.end(); ++taghiter) {
+      if (taghiter->getJtag() != "")
+         continue;
+      NewRow(kTaggerOffsets);
+      FillFloat(kTaggerE, taghiter->getE());
+      FillFloat(kTaggerT, taghiter->getT());
+      FillInt(kTaggerSystem, 2);
+   }
+
+   // Start counter
+   const hddm_r::StartHitList &starts = re.getStartHits();
+   hddm_r::StartHitList::iterator sciter;
+   for (sciter = starts.begin(); sciter != starts.end(); ++sciter) {
+      if (sciter->getJtag() != "")
+         continue;
+      NewRow(kSCOffsets);
+      FillInt(kSCSector, sciter->getSector());
+      FillFloat(kSCdE, sciter->getDE());
+      FillFloat(kSCT, sciter->getT());
+   }
+
+   // TOF. The points are kept for converting old tofMatchParams below.
+   vector<hddm_r::TofPoint*> tofpoints;
+   const hddm_r::TofPointList &tofs = re.getTofPoints();
+   hddm_r::TofPointList::iterator tofiter;
+   for (tofiter = tofs.begin(); tofiter != tofs.end(); ++tofiter) {
+      if (tofiter->getJtag() != "")
+         continue;
+      tofpoints.push_back(&*tofiter);
+      NewRow(kTOFOffsets);
+      FillFloat(kTOFX, tofiter->getX());
+      FillFloat(kTOFY, tofiter->getY());
+      FillFloat(kTOFZ, tofiter->getZ());
+      FillFloat(kTOFT, tofiter->getT());
+      FillFloat(kTOFdE, tofiter->getDE());
+      FillFloat(kTOFTerr, tofiter->getTerr());
+      int status = -1;
+      const hddm_r::TofStatusList &statuses = tofiter->getTofStatuses();
+      hddm_r::TofStatusList::iterator siter;
+      for (siter = statuses.begin(); siter != statuses.end(); ++siter) {
+         status = siter->getStatus();
+      }
+      FillInt(kTOFStatus, status);
+   }
+
+   // FCAL
+   const hddm_r::FcalShowerList &fcals = re.getFcalShowers();
+   hddm_r::FcalShowerList::iterator fcaliter;
+   for (fcaliter = fcals.begin(); fcaliter != fcals.end(); ++fcaliter) {
+      if (fcaliter->getJtag() != "")
+         continue;
+      NewRow(kFCALOffsets);
+      FillFloat(kFCALX, fcaliter->getX());
+      FillFloat(kFCALY, fcaliter->getY());
+      FillFloat(kFCALZ, fcaliter->getZ());
+      FillFloat(kFCALT, fcaliter->getT());
+      FillFloat(kFCALE, fcaliter->getE());
+      FillFloat(kFCALXerr, fcaliter->getXerr());
+      FillFloat(kFCALYerr, fcaliter->getYerr());
+      FillFloat(kFCALZerr, fcaliter->getZerr());
+   }
+
+   // BCAL
+   const hddm_r::BcalShowerList &bcals = re.getBcalShowers();
+   hddm_r::BcalShowerList::iterator bcaliter;
+   for (bcaliter = bcals.begin(); bcaliter != bcals.end(); ++bcaliter) {
+      if (bcaliter->getJtag() != "")
+         continue;
+      NewRow(kBCALOffsets);
+      FillFloat(kBCALX, bcaliter->getX());
+      FillFloat(kBCALY, bcaliter->getY());
+      FillFloat(kBCALZ, bcaliter->getZ());
+      FillFloat(kBCALT, bcaliter->getT());
+      FillFloat(kBCALE, bcaliter->getE());
+      FillFloat(kBCALXerr, bcaliter->getXerr());
+      FillFloat(kBCALYerr, bcaliter->getYerr());
+      FillFloat(kBCALZerr, bcaliter->getZerr());
+      FillFloat(kBCALTerr, bcaliter->getTerr());
+      int ncell = -1;
+      const hddm_r::BcalClusterList &clusters = bcaliter->getBcalClusters();
+      hddm_r::BcalClusterList::iterator citer;
+      for (citer = clusters.begin(); citer != clusters.end(); ++citer) {
+         ncell = citer->getNcell();
+      }
+      FillInt(kBCALNcell, ncell);
+   }
+
+   // Charged tracks
+   const hddm_r::ChargedTrackList &tracks = re.getChargedTracks();
+   hddm_r::ChargedTrackList::iterator triter;
+   for (triter = tracks.begin(); triter != tracks.end(); ++triter) {
+      if (triter->getJtag() != "")
+         continue;
+      NewRow(kTrackOffsets);
+      FillInt(kTrackCandidateId, triter->getCandidateId());
+      FillInt(kTrackPtype, (int)triter->getPtype());
+
+      const hddm_r::TrackFit &fit = triter->getTrackFit();
+      FillInt(kTrackNdof, fit.getNdof());
+      FillFloat(kTrackChisq, fit.getChisq());
+      FillFloat(kTrackX0, fit.getX0());
+      FillFloat(kTrackY0, fit.getY0());
+      FillFloat(kTrackZ0, fit.getZ0());
+      FillFloat(kTrackPx, fit.getPx());
+      FillFloat(kTrackPy, fit.getPy());
+      FillFloat(kTrackPz, fit.getPz());
+      FillFloat(kTrackT0, fit.getT0());
+      FillFloat(kTrackT0err, fit.getT0err());
+      FillInt(kTrackT0det, fit.getT0det());
+      FillFloat(kTrackE11, fit.getE11());
+      FillFloat(kTrackE12, fit.getE12());
+      FillFloat(kTrackE13, fit.getE13());
+      FillFloat(kTrackE14, fit.getE14());
+      FillFloat(kTrackE15, fit.getE15());
+      FillFloat(kTrackE22, fit.getE22());
+      FillFloat(kTrackE23, fit.getE23());
+      FillFloat(kTrackE24, fit.getE24());
+      FillFloat(kTrackE25, fit.getE25());
+      FillFloat(kTrackE33, fit.getE33());
+      FillFloat(kTrackE34, fit.getE34());
+      FillFloat(kTrackE35, fit.getE35());
+      FillFloat(kTrackE44, fit.getE44());
+      FillFloat(kTrackE45, fit.getE45());
+      FillFloat(kTrackE55, fit.getE55());
+
+      int CDCrings = 0;
+      int FDCplanes = 0;
+      const hddm_r::HitlayersList &layers = triter->getHitlayerses();
+      hddm_r::HitlayersList::iterator liter;
+      for (liter = layers.begin(); liter != layers.end(); ++liter) {
+         CDCrings = liter->getCDCrings();
+         FDCplanes = liter->getFDCplanes();
+      }
+      FillInt(kTrackCDCrings, CDCrings);
+      FillInt(kTrackFDCplanes, FDCplanes);
+
+      int mcmatch = 0;
+      int ithrown = -1;
+      int numhitsmatch = 0;
+      const hddm_r::McmatchList &matches = triter->getMcmatchs();
+      hddm_r::McmatchList::iterator miter;
+      for (miter = matches.begin(); miter != matches.end(); ++miter) {
+         mcmatch = 1;
+         ithrown = miter->getIthrown();
+         numhitsmatch = miter->getNumhitsmatch();
+      }
+      FillInt(kTrackMcmatch, mcmatch);
+      FillInt(kTrackIthrown, ithrown);
+      FillInt(kTrackNumhitsmatch, numhitsmatch);
+
+      int NsampleFDC = 0;
+      int NsampleCDC = 0;
+      float dxFDC = 0.0;
+      float dxCDC = 0.0;
+      float dEdxFDC = 0.0;
+      float dEdxCDC = 0.0;
+      const hddm_r::DEdxDCList &dedx = triter->getDEdxDCs();
+      hddm_r::DEdxDCList::iterator diter = dedx.begin();
+      if (diter != dedx.end()) {
+         NsampleFDC = diter->getNsampleFDC();
+         NsampleCDC = diter->getNsampleCDC();
+         dxFDC = diter->getDxFDC();
+         dxCDC = diter->getDxCDC();
+         dEdxFDC = diter->getDEdxFDC();
+         dEdxCDC = diter->getDEdxCDC();
+      }
+      FillInt(kTrackNsampleFDC, NsampleFDC);
+      FillFloat(kTrackDxFDC, dxFDC);
+      FillFloat(kTrackDEdxFDC, dEdxFDC);
+      FillInt(kTrackNsampleCDC, NsampleCDC);
+      FillFloat(kTrackDxCDC, dxCDC);
+      FillFloat(kTrackDEdxCDC, dEdxCDC);
+   }
+
+   // Trigger
+   const hddm_r::TriggerList &triggers = re.getTriggers();
+   hddm_r::TriggerList::iterator trigiter;
+   for (trigiter = triggers.begin(); trigiter != triggers.end(); ++trigiter) {
+      if (trigiter->getJtag() != "")
+         continue;
+      NewRow(kTriggerOffsets);
+      FillInt(kTriggerL1a, trigiter->getL1a()? 1 : 0);
+      FillInt(kTriggerL1b, trigiter->getL1b()? 1 : 0);
+      FillInt(kTriggerL1c, trigiter->getL1c()? 1 : 0);
+   }
+
+   // Detector matches. The old (v1) versions of the match parameters
+   // are converted in the same way DEventSourceREST does it.
+   const hddm_r::DetectorMatchesList &dms = re.getDetectorMatcheses();
+   hddm_r::DetectorMatchesList::iterator iter;
+   for (iter = dms.begin(); iter != dms.end(); ++iter) {
+      if (iter->getJtag() != "")
+         continue;
+      NewRow(kMatchesOffsets);
+
+      const hddm_r::BcalMatchParams_v2List &bcalList_v2 = iter->getBcalMatchParams_v2s();
+      hddm_r::BcalMatchParams_v2List::iterator bcalIter_v2;
+      for (bcalIter_v2 = bcalList_v2.begin(); bcalIter_v2 != bcalList_v2.end(); ++bcalIter_v2) {
+         NewRow(kBCALMatchOffsets);
+         FillInt(kBCALMatchTrack, bcalIter_v2->getTrack());
+         FillInt(kBCALMatchShower, bcalIter_v2->getShower());
+         FillFloat(kBCALMatchDx, bcalIter_v2->getDx());
+         FillFloat(kBCALMatchDeltaphi, bcalIter_v2->getDeltaphi());
+         FillFloat(kBCALMatchDeltaz, bcalIter_v2->getDeltaz());
+         FillFloat(kBCALMatchPathlength, bcalIter_v2->getPathlength());
+         FillFloat(kBCALMatchTflight, bcalIter_v2->getTflight());
+         FillFloat(kBCALMatchTflightvar, bcalIter_v2->getTflightvar());
+      }
+      const hddm_r::BcalMatchParamsList &bcalList = iter->getBcalMatchParamses();
+      hddm_r::BcalMatchParamsList::iterator bcalIter;
+      for (bcalIter = bcalList.begin(); bcalIter != bcalList.end(); ++bcalIter) {
+         NewRow(kBCALMatchOffsets);
+         FillInt(kBCALMatchTrack, bcalIter->getTrack());
+         FillInt(kBCALMatchShower, bcalIter->getShower());
+         FillFloat(kBCALMatchDx, bcalIter->getDx());
+         FillFloat(kBCALMatchDeltaphi, M_PI);
+         FillFloat(kBCALMatchDeltaz, 999.9);
+         FillFloat(kBCALMatchPathlength, bcalIter->getPathlength());
+         FillFloat(kBCALMatchTflight, bcalIter->getTflight());
+         FillFloat(kBCALMatchTflightvar, bcalIter->getTflightvar());
+      }
+
+      const hddm_r::FcalMatchParamsList &fcalList = iter->getFcalMatchParamses();
+      hddm_r::FcalMatchParamsList::iterator fcalIter;
+      for (fcalIter = fcalList.begin(); fcalIter != fcalList.end(); ++fcalIter) {
+         NewRow(kFCALMatchOffsets);
+         FillInt(kFCALMatchTrack, fcalIter->getTrack());
+         FillInt(kFCALMatchShower, fcalIter->getShower());
+         FillFloat(kFCALMatchDx, fcalIter->getDx());
+         FillFloat(kFCALMatchDoca, fcalIter->getDoca());
+         FillFloat(kFCALMatchPathlength, fcalIter->getPathlength());
+         FillFloat(kFCALMatchTflight, fcalIter->getTflight());
+         FillFloat(kFCALMatchTflightvar, fcalIter->getTflightvar());
+      }
+
+      const hddm_r::ScMatchParamsList &scList = iter->getScMatchParamses();
+      hddm_r::ScMatchParamsList::iterator scIter;
+      for (scIter = scList.begin(); scIter != scList.end(); ++scIter) {
+         NewRow(kSCMatchOffsets);
+         FillInt(kSCMatchTrack, scIter->getTrack());
+         FillInt(kSCMatchHit, scIter->getHit());
+         FillFloat(kSCMatchDEdx, scIter->getDEdx());
+         FillFloat(kSCMatchThit, scIter->getThit());
+         FillFloat(kSCMatchThitvar, scIter->getThitvar());
+         FillFloat(kSCMatchEhit, scIter->getEhit());
+         FillFloat(kSCMatchPathlength, scIter->getPathlength());
+         FillFloat(kSCMatchTflight, scIter->getTflight());
+         FillFloat(kSCMatchTflightvar, scIter->getTflightvar());
+         FillFloat(kSCMatchDeltaphi, scIter->getDeltaphi());
+      }
+
+      const hddm_r::TofMatchParams_v2List &tofList_v2 = iter->getTofMatchParams_v2s();
+      hddm_r::TofMatchParams_v2List::iterator tofIter_v2;
+      for (tofIter_v2 = tofList_v2.begin(); tofIter_v2 != tofList_v2.end(); ++tofIter_v2) {
+         NewRow(kTOFMatchOffsets);
+         FillInt(kTOFMatchTrack, tofIter_v2->getTrack());
+         FillInt(kTOFMatchHit, tofIter_v2->getHit());
+         FillFloat(kTOFMatchDEdx, tofIter_v2->getDEdx());
+         FillFloat(kTOFMatchThit, tofIter_v2->getThit());
+         FillFloat(kTOFMatchThitvar, tofIter_v2->getThitvar());
+         FillFloat(kTOFMatchEhit, tofIter_v2->getEhit());
+         FillFloat(kTOFMatchDeltax, tofIter_v2->getDeltax());
+         FillFloat(kTOFMatchDeltay, tofIter_v2->getDeltay());
+         FillFloat(kTOFMatchPathlength, tofIter_v2->getPathlength());
+         FillFloat(kTOFMatchTflight, tofIter_v2->getTflight());
+         FillFloat(kTOFMatchTflightvar, tofIter_v2->getTflightvar());
+      }
+      const hddm_r::TofMatchParamsList &tofList = iter->getTofMatchParamses();
+      hddm_r::TofMatchParamsList::iterator tofIter;
+      for (tofIter = tofList.begin(); tofIter != tofList.end(); ++tofIter) {
+         unsigned int hit = tofIter->getHit();
+         if (hit >= tofpoints.size()) {
+            std::cout << " tofMatchParams refers to a missing tofPoint"
+                      << std::endl;
+            continue;
+         }
+         hddm_r::TofPoint *point = tofpoints[hit];
+         NewRow(kTOFMatchOffsets);
+         FillInt(kTOFMatchTrack, tofIter->getTrack());
+         FillInt(kTOFMatchHit, hit);
+         FillFloat(kTOFMatchDEdx, tofIter->getDEdx());
+         FillFloat(kTOFMatchThit, point->getT());
+         FillFloat(kTOFMatchThitvar, point->getTerr()*point->getTerr());
+         FillFloat(kTOFMatchEhit, point->getDE());
+         FillFloat(kTOFMatchDeltax, 999.9);
+         FillFloat(kTOFMatchDeltay, 999.9);
+         FillFloat(kTOFMatchPathlength, tofIter->getPathlength());
+         FillFloat(kTOFMatchTflight, tofIter->getTflight());
+         FillFloat(kTOFMatchTflightvar, tofIter->getTflightvar());
+      }
+
+      const hddm_r::BcalDOCAtoTrack_v2List &bcaldocaList_v2 = iter->getBcalDOCAtoTrack_v2s();
+      hddm_r::BcalDOCAtoTrack_v2List::iterator bcaldocaIter_v2;
+      for (bcaldocaIter_v2 = bcaldocaList_v2.begin(); bcaldocaIter_v2 != bcaldocaList_v2.end(); ++bcaldocaIter_v2) {
+         NewRow(kBCALDocaOffsets);
+         FillInt(kBCALDocaShower, bcaldocaIter_v2->getShower());
+         FillFloat(kBCALDocaDeltaphi, bcaldocaIter_v2->getDeltaphi());
+         FillFloat(kBCALDocaDeltaz, bcaldocaIter_v2->getDeltaz());
+      }
+      const hddm_r::BcalDOCAtoTrackList &bcaldocaList = iter->getBcalDOCAtoTracks();
+      hddm_r::BcalDOCAtoTrackList::iterator bcaldocaIter;
+      for (bcaldocaIter = bcaldocaList.begin(); bcaldocaIter != bcaldocaList.end(); ++bcaldocaIter) {
+         NewRow(kBCALDocaOffsets);
+         FillInt(kBCALDocaShower, bcaldocaIter->getShower());
+         FillFloat(kBCALDocaDeltaphi, M_PI);
+         FillFloat(kBCALDocaDeltaz, 999.9);
+      }
+
+      const hddm_r::FcalDOCAtoTrackList &fcaldocaList = iter->getFcalDOCAtoTracks();
+      hddm_r::FcalDOCAtoTrackList::iterator fcaldocaIter;
+      for (fcaldocaIter = fcaldocaList.begin(); fcaldocaIter != fcaldocaList.end(); ++fcaldocaIter) {
+         NewRow(kFCALDocaOffsets);
+         FillInt(kFCALDocaShower, fcaldocaIter->getShower());
+         FillFloat(kFCALDocaDoca, fcaldocaIter->getDoca());
+      }
+
+      const hddm_r::TflightPCorrelationList &correlationList = iter->getTflightPCorrelations();
+      hddm_r::TflightPCorrelationList::iterator correlationIter;
+      for (correlationIter = correlationList.begin(); correlationIter != correlationList.end(); ++correlationIter) {
+         NewRow(kTflightPCorrOffsets);
+         FillInt(kTflightPCorrTrack, correlationIter->getTrack());
+         FillInt(kTflightPCorrSystem, correlationIter->getSystem());
+         FillFloat(kTflightPCorrCorrelation, correlationIter->getCorrelation());
+      }
+   }
+}
+
+//-----------
+// ParseCommandLineArguments
+//-----------
+void ParseCommandLineArguments(int narg, char* argv[])
+{
+   INFILENAMES.clear();
+
+   for (int i=1; i<narg; i++) {
+      char *ptr = argv[i];
+
+      if (ptr[0] == '-') {
+         switch(ptr[1]) {
+            case 'h':
+               Usage();
+               break;
+            case 'o':
+               OUTFILENAME=&ptr[2];
+               break;
+            case 'n':
+               EVENTS_PER_CHUNK = (atoi(&ptr[2]) > 1)? atoi(&ptr[2]) : 1;
+               break;
+         }
+      }
+      else {
+         INFILENAMES.push_back(argv[i]);
+      }
+   }
+
+   if (INFILENAMES.size() == 0) {
+      std::cout << std::endl << "You must enter a filename!"
+                << std::endl << std::endl;
+      Usage();
+   }
+
+   if (OUTFILENAME == NULL) {
+      OUTFILENAME = new char[256];
+      sprintf(OUTFILENAME,"rest_columns.rcol");
+   }
+}
+
+//-----------
+// Usage
+//-----------
+void Usage(void)
+{
+   std::cout << std::endl << "Usage:" << std::endl;
+   std::cout << "     rest2columns [options] "
+                "file1.hddm file2.hddm ..." << std::endl;
+   std::cout << std::endl;
+   std::cout << "options:" << std::endl;
+   std::cout << "    -oOutputfile  Set output filename "
+             << "(def. rest_columns.rcol)" << std::endl;
+   std::cout << "    -nNevents     Events per chunk of columns"
+                " (def. 10000)" << std::endl;
+   std::cout << std::endl;
+   std::cout << " This will convert 1 or more REST files into a single"
+                " column file which" << std::endl;
+   std::cout << " can be used as a JANA event source in their place."
+                " The file name should" << std::endl;
+   std::cout << " end in \".rcol\". Only untagged objects are kept and"
+                " Monte Carlo truth" << std::endl;
+   std::cout << " information is dropped." << std::endl;
+   std::cout << std::endl;
+
+   exit(0);
+}
+
+//-----------------------------------------------------------------
+// ctrlCHandle
+//-----------------------------------------------------------------
+void ctrlCHandle(int x)
+{
+   QUIT++;
+   std::cerr << std::endl << "SIGINT received (" << QUIT << ")....."
+             << std::endl;
+}